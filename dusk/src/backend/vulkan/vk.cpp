@@ -346,27 +346,30 @@ VkFormat vulkan::getVkVertexAttributeFormat(VertexAttributeFormat format)
         case VertexAttributeFormat::X32Y32_FLOAT:       return VK_FORMAT_R32G32_SFLOAT;
         case VertexAttributeFormat::X32Y32Z32_FLOAT:    return VK_FORMAT_R32G32B32_SFLOAT;
         case VertexAttributeFormat::X32Y32Z32W32_FLOAT: return VK_FORMAT_R32G32B32A32_SFLOAT;
+        case VertexAttributeFormat::X16Y16_FLOAT:       return VK_FORMAT_R16G16_SFLOAT;
+        case VertexAttributeFormat::X16Y16_SNORM:       return VK_FORMAT_R16G16_SNORM;
+        case VertexAttributeFormat::X16Y16Z16W16_UNORM: return VK_FORMAT_R16G16B16A16_UNORM;
         default:                                        break;
     }
 
     return VK_FORMAT_UNDEFINED;
 }
 
-DynamicArray<VkVertexInputBindingDescription> vulkan::getVertexBindingDescription()
+DynamicArray<VkVertexInputBindingDescription> vulkan::getVertexBindingDescription(VertexFormat format)
 {
     DynamicArray<VkVertexInputBindingDescription> bindingDescriptions(1);
     bindingDescriptions[0].binding   = 0;
-    bindingDescriptions[0].stride    = sizeof(Vertex);
+    bindingDescriptions[0].stride    = format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
     bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
     return bindingDescriptions;
 }
 
-DynamicArray<VkVertexInputAttributeDescription> vulkan::getVertexAtrributeDescription()
+DynamicArray<VkVertexInputAttributeDescription> vulkan::getVertexAtrributeDescription(VertexFormat format)
 {
     DynamicArray<VkVertexInputAttributeDescription> attributeDescriptions {};
 
     // get vertex struct info
-    auto attribuitesInfo = Vertex::getVertexAttributesDescription();
+    auto attribuitesInfo = format == VertexFormat::Packed ? PackedVertex::getVertexAttributesDescription() : Vertex::getVertexAttributesDescription();
     for (uint32_t attribIndex = 0u; attribIndex < attribuitesInfo.size(); ++attribIndex)
     {
         auto& attribute = attribuitesInfo[attribIndex];
@@ -712,4 +715,52 @@ size_t vulkan::getBytesPerPixel(VkFormat format)
     }
 }
 
+bool vulkan::isSRGBFormat(VkFormat format)
+{
+    return getLinearVkFormat(format) != format;
+}
+
+VkFormat vulkan::getLinearVkFormat(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_R8_SRGB:       return VK_FORMAT_R8_UNORM;
+        case VK_FORMAT_R8G8_SRGB:     return VK_FORMAT_R8G8_UNORM;
+        case VK_FORMAT_R8G8B8_SRGB:   return VK_FORMAT_R8G8B8_UNORM;
+        case VK_FORMAT_B8G8R8_SRGB:   return VK_FORMAT_B8G8R8_UNORM;
+        case VK_FORMAT_R8G8B8A8_SRGB: return VK_FORMAT_R8G8B8A8_UNORM;
+        case VK_FORMAT_B8G8R8A8_SRGB: return VK_FORMAT_B8G8R8A8_UNORM;
+
+        default:                      return format;
+    }
+}
+
+bool vulkan::hasStencilComponent(VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_S8_UINT:
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT: return true;
+
+        default:                           return false;
+    }
+}
+
+void vulkan::insertDispatchBarrier(VkCommandBuffer cmdBuffer)
+{
+    VkMemoryBarrier2 barrier { VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+    barrier.srcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+    barrier.dstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+
+    VkDependencyInfo dependencyInfo { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+    dependencyInfo.memoryBarrierCount = 1;
+    dependencyInfo.pMemoryBarriers    = &barrier;
+
+    vkCmdPipelineBarrier2(cmdBuffer, &dependencyInfo);
+}
+
 } // namespace dusk
\ No newline at end of file
@@ -47,8 +47,8 @@ const char* getVkPresentModeString(VkPresentModeKHR presentMode);
 VkFormat getVkVertexAttributeFormat(VertexAttributeFormat format);
 
 // vertex descriptor functions
-DynamicArray<VkVertexInputBindingDescription>   getVertexBindingDescription();
-DynamicArray<VkVertexInputAttributeDescription> getVertexAtrributeDescription();
+DynamicArray<VkVertexInputBindingDescription>   getVertexBindingDescription(VertexFormat format = VertexFormat::Full);
+DynamicArray<VkVertexInputAttributeDescription> getVertexAtrributeDescription(VertexFormat format = VertexFormat::Full);
 
 // Buffer usage and type related funcs
 VkBufferUsageFlags getBufferUsageFlagBits(uint32_t usage);
@@ -65,6 +65,17 @@ VkAttachmentStoreOp getStoreOp(GfxStoreOperation storeOp);
 VkFormat            getPixelVkFormat(PixelFormat format);
 PixelFormat         getPixelFormat(VkFormat format);
 size_t              getBytesPerPixel(VkFormat format);
+bool                isSRGBFormat(VkFormat format);
+VkFormat            getLinearVkFormat(VkFormat format);
+bool                hasStencilComponent(VkFormat format);
+
+// Command recording helpers
+
+/**
+ * @brief Make storage writes of previous dispatches visible to the next ones.
+ * Images which stay in general layout within a pass aren't ordered by render graph.
+ */
+void insertDispatchBarrier(VkCommandBuffer cmdBuffer);
 } // namespace vulkan
 
 } // namespace dusk
\ No newline at end of file
@@ -48,7 +48,13 @@ VulkanResult vulkan::createGPUAllocator(const VulkanContext& context, VulkanGPUA
     allocatorCreateInfo.instance         = context.vulkanInstance;
     allocatorCreateInfo.pVulkanFunctions = &vulkanFunctions;
 
-    VulkanResult result                  = vmaCreateAllocator(&allocatorCreateInfo, &pOutGpuAllocator->vmaAllocator);
+    // descriptor buffers are bound through their device address
+    if (context.descriptorBufferSupported)
+    {
+        allocatorCreateInfo.flags |= VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    }
+
+    VulkanResult result = vmaCreateAllocator(&allocatorCreateInfo, &pOutGpuAllocator->vmaAllocator);
 
     if (result.hasError())
     {
@@ -0,0 +1,291 @@
+#include "vk_bindless_heap.h"
+#include "vk_descriptors.h"
+
+#include "debug/profiler.h"
+
+#include <algorithm>
+
+namespace dusk
+{
+Array<uint32_t, 4> VkGfxBindlessHeap::s_reservedDescriptors = {};
+uint32_t           VkGfxBindlessHeap::s_reservedResources   = 0u;
+
+void VkGfxBindlessHeap::init(const VulkanContext& ctx, uint32_t capacity, uint32_t reservedCount)
+{
+    DASSERT(reservedCount <= capacity, "reserved slots exceed heap capacity");
+
+    m_device        = ctx.device;
+    m_capacity      = capacity;
+    m_reservedCount = reservedCount;
+    m_nextSlot      = reservedCount;
+
+    m_generations.assign(reservedCount, 0u);
+    m_allocated.assign(reservedCount, true);
+}
+
+void VkGfxBindlessHeap::cleanup()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_generations.clear();
+    m_allocated.clear();
+    m_freeSlots.clear();
+    m_retiredSlots.clear();
+
+    m_pendingWrites.clear();
+    m_pendingLookup.clear();
+    m_imageInfos.clear();
+    m_bufferInfos.clear();
+    m_writes.clear();
+
+    m_nextSlot       = m_reservedCount;
+    m_allocatedCount = 0u;
+}
+
+BindlessHandle VkGfxBindlessHeap::allocate()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint32_t                    index = ~0u;
+    if (!m_freeSlots.empty())
+    {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else if (m_nextSlot < m_capacity)
+    {
+        index = m_nextSlot++;
+        m_generations.push_back(0u);
+        m_allocated.push_back(false);
+    }
+    else
+    {
+        DUSK_ERROR("Bindless heap is full, capacity {}", m_capacity);
+        return {};
+    }
+
+    m_allocated[index] = true;
+    ++m_allocatedCount;
+
+    return { index, m_generations[index] };
+}
+
+void VkGfxBindlessHeap::release(BindlessHandle handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (handle.isNull() || handle.index < m_reservedCount || handle.index >= m_nextSlot
+        || !m_allocated[handle.index] || m_generations[handle.index] != handle.generation)
+    {
+        DUSK_WARN("Releasing invalid bindless handle {}:{}", handle.index, handle.generation);
+        return;
+    }
+
+    // stale handles stop validating right away, slot is reused later
+    m_allocated[handle.index] = false;
+    ++m_generations[handle.index];
+    --m_allocatedCount;
+
+    m_retiredSlots.push_back({ handle.index, m_frameCounter + MAX_FRAMES_IN_FLIGHT });
+}
+
+bool VkGfxBindlessHeap::isValid(BindlessHandle handle) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (handle.isNull() || handle.index >= m_nextSlot) return false;
+
+    return m_allocated[handle.index] && m_generations[handle.index] == handle.generation;
+}
+
+BindlessHandle VkGfxBindlessHeap::getHandle(uint32_t index) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (index >= m_nextSlot) return {};
+
+    return { index, m_generations[index] };
+}
+
+void VkGfxBindlessHeap::writeImage(
+    const VkGfxDescriptorSet&    set,
+    uint32_t                     binding,
+    uint32_t                     index,
+    const VkDescriptorImageInfo& imageInfo)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_imageInfos.push_back(imageInfo);
+    queueWrite(set, binding, index, static_cast<uint32_t>(m_imageInfos.size() - 1), true);
+}
+
+void VkGfxBindlessHeap::writeBuffer(
+    const VkGfxDescriptorSet&     set,
+    uint32_t                      binding,
+    uint32_t                      index,
+    const VkDescriptorBufferInfo& bufferInfo)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_bufferInfos.push_back(bufferInfo);
+    queueWrite(set, binding, index, static_cast<uint32_t>(m_bufferInfos.size() - 1), false);
+}
+
+void VkGfxBindlessHeap::queueWrite(
+    const VkGfxDescriptorSet& set,
+    uint32_t                  binding,
+    uint32_t                  index,
+    uint32_t                  infoIndex,
+    bool                      isImage)
+{
+    DASSERT(set.setLayout.bindingsMap.has(binding), "Layout doesn't contain specified binding");
+    DASSERT(index < set.setLayout.bindingsMap[binding].descriptorCount, "Descriptor index is out of binding range");
+
+    size_t key = 0u;
+    hashCombine(key, set.set, binding, index);
+
+    // element is written once per flush, latest write wins
+    if (m_pendingLookup.has(key))
+    {
+        m_pendingWrites[m_pendingLookup[key]].infoIndex = infoIndex;
+        return;
+    }
+
+    PendingWrite write {};
+    write.set       = set.set;
+    write.type      = set.setLayout.bindingsMap[binding].descriptorType;
+    write.binding   = binding;
+    write.index     = index;
+    write.infoIndex = infoIndex;
+    write.isImage   = isImage;
+
+    m_pendingLookup.emplace(key, static_cast<uint32_t>(m_pendingWrites.size()));
+    m_pendingWrites.push_back(write);
+}
+
+void VkGfxBindlessHeap::flush()
+{
+    DUSK_PROFILE_FUNCTION;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_pendingWrites.empty()) return;
+
+    // info arrays are complete now, so their addresses are stable
+    m_writes.clear();
+    for (const auto& pending : m_pendingWrites)
+    {
+        VkWriteDescriptorSet write { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+        write.dstSet          = pending.set;
+        write.dstBinding      = pending.binding;
+        write.dstArrayElement = pending.index;
+        write.descriptorCount = 1u;
+        write.descriptorType  = pending.type;
+        write.pImageInfo      = pending.isImage ? &m_imageInfos[pending.infoIndex] : nullptr;
+        write.pBufferInfo     = pending.isImage ? nullptr : &m_bufferInfos[pending.infoIndex];
+
+        m_writes.push_back(write);
+    }
+
+    vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(m_writes.size()), m_writes.data(), 0, nullptr);
+
+    m_pendingWrites.clear();
+    m_pendingLookup.clear();
+    m_imageInfos.clear();
+    m_bufferInfos.clear();
+}
+
+void VkGfxBindlessHeap::beginFrame()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ++m_frameCounter;
+
+    auto it = std::remove_if(
+        m_retiredSlots.begin(),
+        m_retiredSlots.end(),
+        [&](const RetiredSlot& slot)
+        {
+            if (slot.releaseFrame > m_frameCounter) return false;
+
+            m_freeSlots.push_back(slot.index);
+            return true;
+        });
+
+    m_retiredSlots.erase(it, m_retiredSlots.end());
+}
+
+uint32_t VkGfxBindlessHeap::getDescriptorCountLimit(
+    const VulkanContext& ctx,
+    VkDescriptorType     type,
+    uint32_t             requestedCount)
+{
+    VkPhysicalDeviceVulkan12Properties vk12Properties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES };
+    VkPhysicalDeviceProperties2        properties2    = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, &vk12Properties };
+
+    vkGetPhysicalDeviceProperties2(ctx.physicalDevice, &properties2);
+
+    uint32_t typeIndex = ~0u;
+    uint32_t typeLimit = vk12Properties.maxPerStageUpdateAfterBindResources;
+    switch (type)
+    {
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+            typeIndex = 0u;
+            typeLimit = std::min(
+                vk12Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+                vk12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+            break;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+            typeIndex = 1u;
+            typeLimit = std::min(
+                vk12Properties.maxDescriptorSetUpdateAfterBindStorageImages,
+                vk12Properties.maxPerStageDescriptorUpdateAfterBindStorageImages);
+            break;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+            typeIndex = 2u;
+            typeLimit = std::min(
+                vk12Properties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                vk12Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers);
+            break;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+            typeIndex = 3u;
+            typeLimit = std::min(
+                vk12Properties.maxDescriptorSetUpdateAfterBindUniformBuffers,
+                vk12Properties.maxPerStageDescriptorUpdateAfterBindUniformBuffers);
+            break;
+        default:
+            break;
+    }
+
+    // limits are totals of a pipeline layout, so bindless arrays reserved
+    // earlier take their part of them
+    uint32_t resourcesLimit = vk12Properties.maxPerStageUpdateAfterBindResources;
+    uint32_t limit          = resourcesLimit - std::min(s_reservedResources, resourcesLimit);
+    if (typeIndex != ~0u)
+    {
+        limit = std::min(limit, typeLimit - std::min(s_reservedDescriptors[typeIndex], typeLimit));
+    }
+
+    if (requestedCount > limit)
+    {
+        DUSK_WARN("Requested {} bindless descriptors, device supports {}", requestedCount, limit);
+    }
+
+    uint32_t count = std::min(requestedCount, limit);
+
+    s_reservedResources += count;
+    if (typeIndex != ~0u)
+    {
+        s_reservedDescriptors[typeIndex] += count;
+    }
+
+    return count;
+}
+
+void VkGfxBindlessHeap::resetDescriptorReservations()
+{
+    s_reservedDescriptors = {};
+    s_reservedResources   = 0u;
+}
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "dusk.h"
+#include "vk.h"
+#include "vk_types.h"
+
+#include <mutex>
+
+namespace dusk
+{
+struct VkGfxDescriptorSet;
+
+/**
+ * @brief Handle of a slot in a bindless heap. Generation of a slot changes every
+ * time it is released so stale handles can be detected.
+ */
+struct BindlessHandle
+{
+    uint32_t index      = ~0u;
+    uint32_t generation = 0u;
+
+    bool     isNull() const { return index == ~0u; }
+};
+
+/**
+ * @brief Manages slots of bindless descriptor arrays. Released slots go to a
+ * free list once frames in flight can no longer access them. Descriptor writes
+ * are queued and applied together with a single vkUpdateDescriptorSets call.
+ */
+class VkGfxBindlessHeap
+{
+public:
+    VkGfxBindlessHeap()  = default;
+    ~VkGfxBindlessHeap() = default;
+
+    CLASS_UNCOPYABLE(VkGfxBindlessHeap);
+
+    /**
+     * @brief Initialize the heap
+     * @param ctx vulkan context
+     * @param capacity total slots of the heap
+     * @param reservedCount slots at the start which are never handed out
+     */
+    void init(const VulkanContext& ctx, uint32_t capacity, uint32_t reservedCount = 0u);
+
+    /**
+     * @brief Drop all slots and pending writes
+     */
+    void cleanup();
+
+    /**
+     * @brief Allocate a slot, released slots are reused first
+     * @return handle of the slot, null handle if heap is full
+     */
+    BindlessHandle allocate();
+
+    /**
+     * @brief Release a slot. Slot is reused after all frames in flight have finished.
+     * @param handle of the slot
+     */
+    void release(BindlessHandle handle);
+
+    /**
+     * @brief Check whether handle still refers to a live slot
+     * @param handle of the slot
+     * @return true if slot is allocated with the same generation
+     */
+    bool isValid(BindlessHandle handle) const;
+
+    /**
+     * @brief Get handle of an allocated slot
+     * @param index of the slot
+     * @return handle with current generation of the slot
+     */
+    BindlessHandle getHandle(uint32_t index) const;
+
+    /**
+     * @brief Queue an image descriptor write. A later write to the same element
+     * replaces the queued one.
+     * @param set to be updated
+     * @param binding in the set
+     * @param index of the array element
+     * @param imageInfo for the descriptor
+     */
+    void writeImage(
+        const VkGfxDescriptorSet&    set,
+        uint32_t                     binding,
+        uint32_t                     index,
+        const VkDescriptorImageInfo& imageInfo);
+
+    /**
+     * @brief Queue a buffer descriptor write. A later write to the same element
+     * replaces the queued one.
+     * @param set to be updated
+     * @param binding in the set
+     * @param index of the array element
+     * @param bufferInfo for the descriptor
+     */
+    void writeBuffer(
+        const VkGfxDescriptorSet&     set,
+        uint32_t                      binding,
+        uint32_t                      index,
+        const VkDescriptorBufferInfo& bufferInfo);
+
+    /**
+     * @brief Apply all queued writes with a single descriptor update
+     */
+    void flush();
+
+    /**
+     * @brief Advance the frame counter of the heap and recycle released slots
+     * which are no longer used by any frame in flight. Should be called once per frame.
+     */
+    void beginFrame();
+
+    uint32_t getCapacity() const { return m_capacity; }
+    uint32_t getAllocatedCount() const { return m_allocatedCount; }
+
+    /**
+     * @brief Get count of descriptors of a type which can be used in a single
+     * update after bind set. Returned count stays reserved, as arrays of all the
+     * sets can be bound to one stage and share the per stage limits.
+     * @param ctx vulkan context
+     * @param type of the descriptors
+     * @param requestedCount wanted count of descriptors
+     * @return requested count clamped to the device limits left after reservations
+     */
+    static uint32_t getDescriptorCountLimit(
+        const VulkanContext& ctx,
+        VkDescriptorType     type,
+        uint32_t             requestedCount);
+
+    /**
+     * @brief Forget descriptor counts reserved by getDescriptorCountLimit
+     */
+    static void resetDescriptorReservations();
+
+private:
+    struct PendingWrite
+    {
+        VkDescriptorSet  set;
+        VkDescriptorType type;
+        uint32_t         binding;
+        uint32_t         index;
+        uint32_t         infoIndex;
+        bool             isImage;
+    };
+
+    struct RetiredSlot
+    {
+        uint32_t index;
+        uint64_t releaseFrame;
+    };
+
+    void queueWrite(
+        const VkGfxDescriptorSet& set,
+        uint32_t                  binding,
+        uint32_t                  index,
+        uint32_t                  infoIndex,
+        bool                      isImage);
+
+private:
+    mutable std::mutex                   m_mutex;
+
+    VkDevice                             m_device         = VK_NULL_HANDLE;
+    uint32_t                             m_capacity       = 0u;
+    uint32_t                             m_reservedCount  = 0u;
+    uint32_t                             m_nextSlot       = 0u;
+    uint32_t                             m_allocatedCount = 0u;
+    uint64_t                             m_frameCounter   = 0u;
+
+    DynamicArray<uint32_t>               m_generations    = {};
+    DynamicArray<bool>                   m_allocated      = {};
+    DynamicArray<uint32_t>               m_freeSlots      = {};
+    DynamicArray<RetiredSlot>            m_retiredSlots   = {};
+
+    DynamicArray<PendingWrite>           m_pendingWrites  = {};
+    HashMap<size_t, uint32_t>            m_pendingLookup  = {};
+    DynamicArray<VkDescriptorImageInfo>  m_imageInfos     = {};
+    DynamicArray<VkDescriptorBufferInfo> m_bufferInfos    = {};
+    DynamicArray<VkWriteDescriptorSet>   m_writes         = {};
+
+private:
+    // reserved sampled images, storage images, storage buffers and uniform buffers
+    static Array<uint32_t, 4> s_reservedDescriptors;
+    static uint32_t           s_reservedResources;
+};
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "vk_descriptor_buffer.h"
+#include "vk_descriptors.h"
+#include "vk_allocator.h"
+
+namespace dusk
+{
+Error VkGfxDescriptorBuffer::init(
+    const VulkanContext&            ctx,
+    VkGfxDescriptorSetLayout&       layout,
+    uint32_t                        setCount,
+    const std::string&              name)
+{
+    DASSERT(ctx.descriptorBufferSupported, "descriptor buffers are not supported by the device");
+    DASSERT(layout.forDescriptorBuffer, "layout is not compatible with descriptor buffers");
+
+    m_device    = ctx.device;
+    m_allocator = ctx.gpuAllocator;
+    m_setCount  = setCount;
+
+    // sets are placed back to back, each starting at an aligned offset
+    const VkDeviceSize alignment = ctx.descriptorBufferProperties.descriptorBufferOffsetAlignment;
+    vkGetDescriptorSetLayoutSizeEXT(m_device, layout.layout, &m_setSize);
+    m_setSize = (m_setSize + alignment - 1) & ~(alignment - 1);
+
+    m_usage   = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    for (auto& key : layout.bindingsMap.keys())
+    {
+        const VkDescriptorSetLayoutBinding& layoutBinding = layout.bindingsMap[key];
+
+        BindingInfo                         bindingInfo {};
+        bindingInfo.type           = layoutBinding.descriptorType;
+        bindingInfo.descriptorSize = getDescriptorSize(ctx, layoutBinding.descriptorType);
+        vkGetDescriptorSetLayoutBindingOffsetEXT(m_device, layout.layout, key, &bindingInfo.offset);
+
+        m_bindings.emplace(key, bindingInfo);
+
+        // samplers are part of combined image sampler descriptors
+        if (layoutBinding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER
+            || layoutBinding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+        {
+            m_usage |= VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
+        }
+    }
+
+    // whole buffer is addressable by shaders only if it fits the device ranges
+    const VkPhysicalDeviceDescriptorBufferPropertiesEXT& props = ctx.descriptorBufferProperties;
+    if (m_setSize * setCount > props.maxResourceDescriptorBufferRange
+        || ((m_usage & VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT) && m_setSize * setCount > props.maxSamplerDescriptorBufferRange))
+    {
+        DUSK_WARN("Descriptor buffer {} of {} bytes exceeds device descriptor buffer range", name, m_setSize * setCount);
+        m_bindings.clear();
+        return Error::NotSupported;
+    }
+
+    VkBufferCreateInfo bufferInfo { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    bufferInfo.size        = m_setSize * setCount;
+    bufferInfo.usage       = m_usage;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VulkanResult result    = vulkan::allocateGPUBuffer(
+        m_allocator,
+        bufferInfo,
+        VMA_MEMORY_USAGE_AUTO,
+        VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        &m_buffer);
+
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to allocate descriptor buffer {}. {}", name, result.toString());
+        return result.getErrorId();
+    }
+
+    VkBufferDeviceAddressInfo addressInfo { VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO };
+    addressInfo.buffer = m_buffer.buffer;
+    m_address          = vkGetBufferDeviceAddress(m_device, &addressInfo);
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        m_device,
+        VK_OBJECT_TYPE_BUFFER,
+        (uint64_t)m_buffer.buffer,
+        name.c_str());
+#endif // VK_RENDERER_DEBUG
+
+    DUSK_INFO("Descriptor buffer {} created with {} sets of {} bytes", name, setCount, m_setSize);
+
+    return Error::Ok;
+}
+
+void VkGfxDescriptorBuffer::cleanup()
+{
+    if (m_buffer.buffer != VK_NULL_HANDLE)
+    {
+        vulkan::freeGPUBuffer(m_allocator, &m_buffer);
+    }
+
+    m_buffer  = {};
+    m_address = 0u;
+    m_bindings.clear();
+}
+
+void VkGfxDescriptorBuffer::writeImage(
+    uint32_t                     setIndex,
+    uint32_t                     binding,
+    uint32_t                     arrayIndex,
+    const VkDescriptorImageInfo& imageInfo)
+{
+    DASSERT(m_bindings.has(binding), "binding doesn't exist in the layout");
+
+    VkDescriptorGetInfoEXT getInfo { VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT };
+    getInfo.type = m_bindings[binding].type;
+
+    switch (getInfo.type)
+    {
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: getInfo.data.pCombinedImageSampler = &imageInfo; break;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:          getInfo.data.pSampledImage = &imageInfo; break;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:          getInfo.data.pStorageImage = &imageInfo; break;
+        case VK_DESCRIPTOR_TYPE_SAMPLER:                getInfo.data.pSampler = &imageInfo.sampler; break;
+        default:
+            DUSK_ERROR("Descriptor type {} is not an image type", (uint32_t)getInfo.type);
+            return;
+    }
+
+    writeDescriptor(setIndex, binding, arrayIndex, getInfo);
+}
+
+void VkGfxDescriptorBuffer::writeBuffer(
+    uint32_t        setIndex,
+    uint32_t        binding,
+    uint32_t        arrayIndex,
+    VkDeviceAddress address,
+    VkDeviceSize    range)
+{
+    DASSERT(m_bindings.has(binding), "binding doesn't exist in the layout");
+
+    VkDescriptorAddressInfoEXT addressInfo { VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT };
+    addressInfo.address = address;
+    addressInfo.range   = range;
+
+    VkDescriptorGetInfoEXT getInfo { VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT };
+    getInfo.type = m_bindings[binding].type;
+
+    switch (getInfo.type)
+    {
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER: getInfo.data.pUniformBuffer = &addressInfo; break;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: getInfo.data.pStorageBuffer = &addressInfo; break;
+        default:
+            DUSK_ERROR("Descriptor type {} is not a buffer type", (uint32_t)getInfo.type);
+            return;
+    }
+
+    writeDescriptor(setIndex, binding, arrayIndex, getInfo);
+}
+
+void VkGfxDescriptorBuffer::writeDescriptor(
+    uint32_t                      setIndex,
+    uint32_t                      binding,
+    uint32_t                      arrayIndex,
+    const VkDescriptorGetInfoEXT& getInfo)
+{
+    DASSERT(setIndex < m_setCount, "set index is out of bounds");
+
+    const BindingInfo& bindingInfo = m_bindings[binding];
+    VkDeviceSize       offset      = setIndex * m_setSize + bindingInfo.offset + arrayIndex * bindingInfo.descriptorSize;
+
+    DASSERT(offset + bindingInfo.descriptorSize <= m_buffer.sizeInBytes, "descriptor write is out of bounds");
+
+    vkGetDescriptorEXT(
+        m_device,
+        &getInfo,
+        bindingInfo.descriptorSize,
+        static_cast<uint8_t*>(m_buffer.mappedMemory) + offset);
+
+    if (!(m_buffer.memoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        vmaFlushAllocation(m_allocator->vmaAllocator, m_buffer.allocation, offset, bindingInfo.descriptorSize);
+    }
+}
+
+void VkGfxDescriptorBuffer::bindBuffer(VkCommandBuffer cmdBuffer) const
+{
+    VkDescriptorBufferBindingInfoEXT bindingInfo { VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT };
+    bindingInfo.address = m_address;
+    bindingInfo.usage   = m_usage;
+
+    vkCmdBindDescriptorBuffersEXT(cmdBuffer, 1, &bindingInfo);
+}
+
+void VkGfxDescriptorBuffer::bindSet(
+    VkCommandBuffer     cmdBuffer,
+    VkPipelineBindPoint bindPoint,
+    VkPipelineLayout    pipelineLayout,
+    uint32_t            firstSet,
+    uint32_t            setIndex) const
+{
+    DASSERT(setIndex < m_setCount, "set index is out of bounds");
+
+    uint32_t     bufferIndex = 0u;
+    VkDeviceSize offset      = setIndex * m_setSize;
+
+    vkCmdSetDescriptorBufferOffsetsEXT(
+        cmdBuffer,
+        bindPoint,
+        pipelineLayout,
+        firstSet,
+        1,
+        &bufferIndex,
+        &offset);
+}
+
+size_t VkGfxDescriptorBuffer::getDescriptorSize(const VulkanContext& ctx, VkDescriptorType type)
+{
+    const VkPhysicalDeviceDescriptorBufferPropertiesEXT& props = ctx.descriptorBufferProperties;
+
+    switch (type)
+    {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:                return props.samplerDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: return props.combinedImageSamplerDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:          return props.sampledImageDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:          return props.storageImageDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:         return props.uniformBufferDescriptorSize;
+        case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:         return props.storageBufferDescriptorSize;
+        default:                                        break;
+    }
+
+    DUSK_ERROR("Descriptor type {} is not supported in descriptor buffers", (uint32_t)type);
+    return 0u;
+}
+} // namespace dusk
\ No newline at end of file
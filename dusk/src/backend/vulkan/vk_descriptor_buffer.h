@@ -0,0 +1,130 @@
+#pragma once
+
+#include "dusk.h"
+#include "vk.h"
+#include "vk_types.h"
+
+namespace dusk
+{
+struct VkGfxDescriptorSetLayout;
+
+/**
+ * @brief Descriptor sets stored in a host visible buffer (VK_EXT_descriptor_buffer).
+ * Descriptors are written straight into the mapped memory and sets are selected
+ * with offsets into the buffer, so no pools, set allocations or descriptor updates
+ * are needed. Holds one or more sets of a single layout.
+ */
+class VkGfxDescriptorBuffer
+{
+public:
+    VkGfxDescriptorBuffer()  = default;
+    ~VkGfxDescriptorBuffer() = default;
+
+    CLASS_UNCOPYABLE(VkGfxDescriptorBuffer);
+
+    /**
+     * @brief Allocate descriptor buffer for sets of the layout
+     * @param ctx vulkan context with descriptor buffer support
+     * @param layout created with descriptor buffer compatibility
+     * @param setCount number of sets stored in the buffer
+     * @param name for debugging
+     * @return Error::Ok if successful
+     */
+    Error init(
+        const VulkanContext&            ctx,
+        VkGfxDescriptorSetLayout&       layout,
+        uint32_t                        setCount,
+        const std::string&              name);
+
+    /**
+     * @brief Free the descriptor buffer
+     */
+    void cleanup();
+
+    /**
+     * @brief Write an image descriptor into the buffer. Descriptor is visible to
+     * the GPU for submissions recorded afterwards.
+     * @param setIndex of the set in the buffer
+     * @param binding in the set
+     * @param arrayIndex of the element
+     * @param imageInfo for the descriptor
+     */
+    void writeImage(
+        uint32_t                     setIndex,
+        uint32_t                     binding,
+        uint32_t                     arrayIndex,
+        const VkDescriptorImageInfo& imageInfo);
+
+    /**
+     * @brief Write a uniform or storage buffer descriptor into the buffer
+     * @param setIndex of the set in the buffer
+     * @param binding in the set
+     * @param arrayIndex of the element
+     * @param address of the buffer range
+     * @param range size of the buffer range
+     */
+    void writeBuffer(
+        uint32_t        setIndex,
+        uint32_t        binding,
+        uint32_t        arrayIndex,
+        VkDeviceAddress address,
+        VkDeviceSize    range);
+
+    /**
+     * @brief Bind the descriptor buffer, only needed once per command buffer
+     * unless another descriptor buffer gets bound
+     * @param cmdBuffer being recorded
+     */
+    void bindBuffer(VkCommandBuffer cmdBuffer) const;
+
+    /**
+     * @brief Point a set of the pipeline layout to a set stored in the buffer
+     * @param cmdBuffer being recorded
+     * @param bindPoint of the pipeline
+     * @param pipelineLayout created with the buffer layout
+     * @param firstSet set number in the pipeline layout
+     * @param setIndex of the set in the buffer
+     */
+    void bindSet(
+        VkCommandBuffer     cmdBuffer,
+        VkPipelineBindPoint bindPoint,
+        VkPipelineLayout    pipelineLayout,
+        uint32_t            firstSet,
+        uint32_t            setIndex) const;
+
+    bool isValid() const { return m_buffer.buffer != VK_NULL_HANDLE; }
+
+    /**
+     * @brief Get size of a descriptor of the type inside descriptor buffers
+     * @param ctx vulkan context
+     * @param type of the descriptor
+     * @return size in bytes
+     */
+    static size_t getDescriptorSize(const VulkanContext& ctx, VkDescriptorType type);
+
+private:
+    struct BindingInfo
+    {
+        VkDescriptorType type;
+        VkDeviceSize     offset;
+        size_t           descriptorSize;
+    };
+
+    void writeDescriptor(
+        uint32_t                      setIndex,
+        uint32_t                      binding,
+        uint32_t                      arrayIndex,
+        const VkDescriptorGetInfoEXT& getInfo);
+
+private:
+    VkDevice                       m_device    = VK_NULL_HANDLE;
+    VulkanGPUAllocator*            m_allocator = nullptr;
+    VulkanGfxBuffer                m_buffer    = {};
+    VkDeviceAddress                m_address   = 0u;
+    VkBufferUsageFlags             m_usage     = 0u;
+
+    VkDeviceSize                   m_setSize   = 0u;
+    uint32_t                       m_setCount  = 0u;
+    HashMap<uint32_t, BindingInfo> m_bindings  = {};
+};
+} // namespace dusk
\ No newline at end of file
@@ -39,6 +39,12 @@ VkGfxDescriptorSetLayout::Builder& VkGfxDescriptorSetLayout::Builder::setDebugNa
     return *this;
 }
 
+VkGfxDescriptorSetLayout::Builder& VkGfxDescriptorSetLayout::Builder::setDescriptorBufferCompatible()
+{
+    forDescriptorBuffer = true;
+    return *this;
+}
+
 Unique<VkGfxDescriptorSetLayout> VkGfxDescriptorSetLayout::Builder::build()
 {
     uint32_t                                   bindingsCount = bindingsMap.size();
@@ -69,8 +75,20 @@ Unique<VkGfxDescriptorSetLayout> VkGfxDescriptorSetLayout::Builder::build()
         descriptorSetLayoutInfo.pNext = &bindingFlagsInfo;
     }
 
-    auto         gfxSetLayout = createUnique<VkGfxDescriptorSetLayout>(device, bindingsMap);
-    VulkanResult result       = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutInfo, nullptr, &gfxSetLayout->layout);
+    // descriptor buffers can't be combined with update after bind pools
+    if (forDescriptorBuffer)
+    {
+        for (auto& flags : setBindingFlags)
+        {
+            flags &= ~VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+        }
+        descriptorSetLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+    }
+
+    auto gfxSetLayout                 = createUnique<VkGfxDescriptorSetLayout>(device, bindingsMap);
+    gfxSetLayout->forDescriptorBuffer = forDescriptorBuffer;
+
+    VulkanResult result               = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutInfo, nullptr, &gfxSetLayout->layout);
 
     if (result.hasError())
     {
@@ -78,6 +96,19 @@ Unique<VkGfxDescriptorSetLayout> VkGfxDescriptorSetLayout::Builder::build()
         return nullptr;
     }
 
+    hashCombine(gfxSetLayout->hash, descriptorSetLayoutInfo.flags);
+    for (uint32_t index = 0u; index < bindingsCount; ++index)
+    {
+        const VkDescriptorSetLayoutBinding& binding = setLayoutBindings[index];
+        hashCombine(
+            gfxSetLayout->hash,
+            binding.binding,
+            binding.descriptorType,
+            binding.descriptorCount,
+            binding.stageFlags,
+            setBindingFlags[index]);
+    }
+
 #ifdef VK_RENDERER_DEBUG
     vkdebug::setObjectName(
         device,
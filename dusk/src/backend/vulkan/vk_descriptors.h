@@ -10,10 +10,11 @@ struct VkGfxDescriptorSetLayout
 {
     struct Builder
     {
-        VkDevice                                        device       = VK_NULL_HANDLE;
-        HashMap<uint32_t, VkDescriptorSetLayoutBinding> bindingsMap  = {};
-        HashMap<uint32_t, VkDescriptorBindingFlags>     bindingFlags = {};
-        std::string                                     debugName    = {};
+        VkDevice                                        device              = VK_NULL_HANDLE;
+        HashMap<uint32_t, VkDescriptorSetLayoutBinding> bindingsMap         = {};
+        HashMap<uint32_t, VkDescriptorBindingFlags>     bindingFlags        = {};
+        std::string                                     debugName           = {};
+        bool                                            forDescriptorBuffer = false;
 
         Builder(const VulkanContext& ctx) :
             device(ctx.device)
@@ -43,6 +44,14 @@ struct VkGfxDescriptorSetLayout
          */
         Builder& setDebugName(const std::string& name);
 
+        /**
+         * @brief Create the layout for descriptors written into a descriptor buffer
+         * instead of sets allocated from a pool. Bindless bindings are only partially
+         * bound as update after bind is implied by descriptor buffers.
+         * @return Builder
+         */
+        Builder& setDescriptorBufferCompatible();
+
         /**
          * @brief create the descriptor set layout
          * @param ctx containing vulkan related information
@@ -55,6 +64,12 @@ struct VkGfxDescriptorSetLayout
     VkDescriptorSetLayout                           layout      = VK_NULL_HANDLE;
     HashMap<uint32_t, VkDescriptorSetLayoutBinding> bindingsMap = {};
 
+    // hash of the layout contents, equal for compatible layouts even across recreation
+    size_t                                          hash        = 0u;
+
+    // layout can only be used with descriptor buffers
+    bool                                            forDescriptorBuffer = false;
+
     VkGfxDescriptorSetLayout()                                  = delete;
     explicit VkGfxDescriptorSetLayout(VkDevice device, HashMap<uint32_t, VkDescriptorSetLayoutBinding> bindings) :
         device(device), bindingsMap(bindings)
@@ -5,6 +5,8 @@
 #define VMA_IMPLEMENTATION
 #include <vk_mem_alloc.h>
 
+#include <algorithm>
+
 namespace dusk
 {
 VulkanContext VkGfxDevice::s_sharedVkContext = VulkanContext {};
@@ -68,6 +70,15 @@ Error VkGfxDevice::initGfxDevice()
     }
     VkGfxDevice::s_sharedVkContext.gpuAllocator = &m_gpuAllocator;
 
+    // pipeline cache persisted next to the build artifacts
+    std::filesystem::path buildPath = STRING(DUSK_BUILD_PATH);
+    err                             = m_pipelineCache.init(s_sharedVkContext, buildPath / "pipeline_cache.bin");
+    if (err != Error::Ok)
+    {
+        return err;
+    }
+    VkGfxDevice::s_sharedVkContext.pipelineCache = &m_pipelineCache;
+
     return Error::Ok;
 }
 
@@ -77,6 +88,9 @@ void VkGfxDevice::cleanupGfxDevice()
 
     vulkan::destroyGPUAllocator(&m_gpuAllocator);
 
+    m_pipelineCache.cleanup();
+    VkGfxDevice::s_sharedVkContext.pipelineCache = nullptr;
+
     destroyDevice();
     destroyInstance();
 
@@ -216,6 +230,16 @@ Error VkGfxDevice::createDevice()
         uint32_t                         transferQueueIndex;
         uint32_t                         presentQueueIndex;
 
+        // optional features, chained only when supported
+        VkPhysicalDevicePresentIdFeaturesKHR   presentIdFeatures   = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR, &presentWaitFeatures };
+        VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR, nullptr };
+        bool                                   supportsPresentWait = false;
+
+        // descriptor buffer features, chained only when supported
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT   descriptorBufferFeatures   = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT, nullptr };
+        VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptorBufferProperties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT, nullptr };
+        bool                                          supportsDescriptorBuffer   = false;
+
         // device is eligible for use
         bool isSupported = false;
     };
@@ -429,6 +453,70 @@ Error VkGfxDevice::createDevice()
         pDeviceInfo->deviceFeaturesVk12.runtimeDescriptorArray                        = VK_TRUE;
         pDeviceInfo->deviceFeaturesVk12.descriptorBindingPartiallyBound               = VK_TRUE;
 
+        // optional: format-less storage writes are used by compute mip generation,
+        // blit based generation is used as fallback when not available
+        pDeviceInfo->deviceFeatures2.features.shaderStorageImageWriteWithoutFormat = deviceFeatures.shaderStorageImageWriteWithoutFormat;
+
+        // optional: primitive id in fragment shaders is used by the visibility buffer,
+        // g-buffer pass is used as fallback when not available
+        pDeviceInfo->deviceFeatures2.features.geometryShader = deviceFeatures.geometryShader;
+
+        // optional: two channel storage images are used for the motion vectors of the
+        // visibility buffer, g-buffer pass is used as fallback when not available
+        pDeviceInfo->deviceFeatures2.features.shaderStorageImageExtendedFormats = deviceFeatures.shaderStorageImageExtendedFormats;
+
+        // optional: present id and present wait are used by low latency frame pacing
+        if (availableExtensionsSet.has(hash(VK_KHR_PRESENT_ID_EXTENSION_NAME))
+            && availableExtensionsSet.has(hash(VK_KHR_PRESENT_WAIT_EXTENSION_NAME)))
+        {
+            VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR };
+            VkPhysicalDevicePresentIdFeaturesKHR   presentIdFeatures   = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR, &presentWaitFeatures };
+            VkPhysicalDeviceFeatures2              presentFeatures2    = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, &presentIdFeatures };
+
+            vkGetPhysicalDeviceFeatures2(physicalDevice, &presentFeatures2);
+
+            if (presentIdFeatures.presentId && presentWaitFeatures.presentWait)
+            {
+                pDeviceInfo->presentIdFeatures.presentId     = VK_TRUE;
+                pDeviceInfo->presentWaitFeatures.presentWait = VK_TRUE;
+                pDeviceInfo->deviceFeaturesVk13.pNext        = &pDeviceInfo->presentIdFeatures;
+
+                pDeviceInfo->activeDeviceExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+                pDeviceInfo->activeDeviceExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+
+                pDeviceInfo->supportsPresentWait = true;
+            }
+        }
+
+        // optional: descriptor buffers are used by passes which only need bindless textures,
+        // classic descriptor sets are used as fallback when not available
+        if (availableExtensionsSet.has(hash(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME))
+            && deviceFeaturesVk12.bufferDeviceAddress)
+        {
+            VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeatures = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT };
+            VkPhysicalDeviceFeatures2                   descriptorFeatures2      = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, &descriptorBufferFeatures };
+
+            vkGetPhysicalDeviceFeatures2(physicalDevice, &descriptorFeatures2);
+
+            if (descriptorBufferFeatures.descriptorBuffer)
+            {
+                VkPhysicalDeviceProperties2 descriptorProperties2 = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, &pDeviceInfo->descriptorBufferProperties };
+                vkGetPhysicalDeviceProperties2(physicalDevice, &descriptorProperties2);
+
+                pDeviceInfo->descriptorBufferProperties.pNext          = nullptr;
+                pDeviceInfo->deviceFeaturesVk12.bufferDeviceAddress    = VK_TRUE;
+                pDeviceInfo->descriptorBufferFeatures.descriptorBuffer = VK_TRUE;
+
+                // prepend to the optional features chain
+                pDeviceInfo->descriptorBufferFeatures.pNext = pDeviceInfo->deviceFeaturesVk13.pNext;
+                pDeviceInfo->deviceFeaturesVk13.pNext       = &pDeviceInfo->descriptorBufferFeatures;
+
+                pDeviceInfo->activeDeviceExtensions.push_back(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+
+                pDeviceInfo->supportsDescriptorBuffer = true;
+            }
+        }
+
         // device has all the expected features
         pDeviceInfo->isSupported = true;
     }
@@ -608,6 +696,27 @@ Error VkGfxDevice::createDevice()
         (uint64_t)m_transferCommandPool,
         "transfer_cmd_pool");
 
+#endif
+
+    poolInfo                  = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    poolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = pSelectedDeviceInfo->computeQueueIndex;
+
+    result                    = vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_computeCommandPool);
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to create compute command pools {}", result.toString());
+        return result.getErrorId();
+    }
+    DUSK_INFO("Command pool created with compute queue");
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        m_device,
+        VK_OBJECT_TYPE_COMMAND_POOL,
+        (uint64_t)m_computeCommandPool,
+        "compute_cmd_pool");
+
 #endif
 
     // setup tracy profiling ctx
@@ -626,6 +735,7 @@ Error VkGfxDevice::createDevice()
     s_sharedVkContext.surface                  = m_surface;
     s_sharedVkContext.commandPool              = m_commandPool;
     s_sharedVkContext.transferCommandPool      = m_transferCommandPool;
+    s_sharedVkContext.computeCommandPool       = m_computeCommandPool;
 
     s_sharedVkContext.physicalDeviceProperties = pSelectedDeviceInfo->deviceProperties;
     s_sharedVkContext.physicalDeviceFeatures   = pSelectedDeviceInfo->deviceFeatures2.features;
@@ -642,6 +752,12 @@ Error VkGfxDevice::createDevice()
     s_sharedVkContext.transferQueue            = m_transferQueue;
     s_sharedVkContext.transferQueue            = m_transferQueue;
 
+    s_sharedVkContext.presentWaitSupported     = pSelectedDeviceInfo->supportsPresentWait;
+
+    // descriptor buffer path for bindless textures
+    s_sharedVkContext.descriptorBufferSupported  = pSelectedDeviceInfo->supportsDescriptorBuffer;
+    s_sharedVkContext.descriptorBufferProperties = pSelectedDeviceInfo->descriptorBufferProperties;
+
     return Error::Ok;
 }
 
@@ -664,6 +780,7 @@ void VkGfxDevice::destroyDevice()
         vkDestroyCommandPool(m_device, m_commandPool, nullptr);
 
     vkDestroyCommandPool(m_device, m_transferCommandPool, nullptr);
+    vkDestroyCommandPool(m_device, m_computeCommandPool, nullptr);
 
 #ifdef DUSK_ENABLE_PROFILING
     TracyVkDestroy(s_gpuProfilerCtx);
@@ -801,6 +918,28 @@ VulkanResult VkGfxDevice::createBuffer(const GfxBufferParams& params, VulkanGfxB
     bufferCreateInfo.usage       = vulkan::getBufferUsageFlagBits(params.usage);
     bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+    // buffers written on transfer queue while being read on graphics/compute
+    // queues skip ownership transfers with concurrent sharing
+    uint32_t queueFamilyIndices[3];
+    if (params.usage & GfxBufferUsageFlags::SharedQueueAccess)
+    {
+        uint32_t familyCount = 0u;
+        for (uint32_t familyIndex : { s_sharedVkContext.graphicsQueueFamilyIndex, s_sharedVkContext.computeQueueFamilyIndex, s_sharedVkContext.transferQueueFamilyIndex })
+        {
+            if (std::find(queueFamilyIndices, queueFamilyIndices + familyCount, familyIndex) == queueFamilyIndices + familyCount)
+            {
+                queueFamilyIndices[familyCount++] = familyIndex;
+            }
+        }
+
+        if (familyCount > 1)
+        {
+            bufferCreateInfo.sharingMode           = VK_SHARING_MODE_CONCURRENT;
+            bufferCreateInfo.queueFamilyIndexCount = familyCount;
+            bufferCreateInfo.pQueueFamilyIndices   = queueFamilyIndices;
+        }
+    }
+
     // allocation
     VulkanResult result = vulkan::allocateGPUBuffer(&m_gpuAllocator, bufferCreateInfo, VMA_MEMORY_USAGE_AUTO, vulkan::getVmaAllocationCreateFlagBits(params.memoryType), pOutBuffer);
 
@@ -865,6 +1004,23 @@ void VkGfxDevice::flushBufferOffset(VulkanGfxBuffer* buffer, uint32_t offset, si
     vulkan::flushCPUMemory(&m_gpuAllocator, { buffer->allocation }, { offset }, { size });
 }
 
+void VkGfxDevice::flushBufferRanges(
+    const DynamicArray<VulkanGfxBuffer*>& buffers,
+    const DynamicArray<VkDeviceSize>&     offsets,
+    const DynamicArray<VkDeviceSize>&     sizes)
+{
+    DynamicArray<VmaAllocation> allocations;
+    allocations.reserve(buffers.size());
+
+    for (VulkanGfxBuffer* buffer : buffers)
+    {
+        allocations.push_back(buffer->allocation);
+    }
+
+    // all the ranges are flushed with a single vkFlushMappedMemoryRanges
+    vulkan::flushCPUMemory(&m_gpuAllocator, allocations, offsets, sizes);
+}
+
 void VkGfxDevice::writeToBuffer(VulkanGfxBuffer* buffer, void* hostBlock, VkDeviceSize offset, VkDeviceSize size)
 {
     vulkan::writeToAllocation(&m_gpuAllocator, hostBlock, buffer->allocation, offset, size);
@@ -997,8 +1153,14 @@ VulkanResult VkGfxDevice::createImageView(
     uint32_t           mipLevelCount,
     uint32_t           baseLayer,
     uint32_t           layersCount,
-    VkImageView*       pImageView) const
+    VkImageView*       pImageView,
+    VkImageUsageFlags  viewUsage) const
 {
+    // restrict view usage when image was created with usages which are
+    // not supported by the view format (e.g. storage on srgb images)
+    VkImageViewUsageCreateInfo usageInfo { VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO };
+    usageInfo.usage = viewUsage;
+
     VkImageViewCreateInfo viewInfo {};
     viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image                           = img->vkImage;
@@ -1010,6 +1172,9 @@ VulkanResult VkGfxDevice::createImageView(
     viewInfo.subresourceRange.baseArrayLayer = baseLayer;
     viewInfo.subresourceRange.layerCount     = layersCount;
 
+    if (viewUsage != 0)
+        viewInfo.pNext = &usageInfo;
+
     VulkanResult result                      = vkCreateImageView(m_device, &viewInfo, nullptr, pImageView);
 
     if (result.hasError())
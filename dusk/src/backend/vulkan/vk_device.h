@@ -4,6 +4,7 @@
 #include "vk.h"
 #include "vk_types.h"
 #include "vk_allocator.h"
+#include "vk_pipeline_cache.h"
 #include "renderer/gfx_buffer.h"
 #include "platform/glfw_vulkan_window.h"
 #include "debug/tracy.h"
@@ -57,6 +58,10 @@ public:
         VulkanGfxBuffer* buffer,
         uint32_t,
         size_t size);
+    void flushBufferRanges(
+        const DynamicArray<VulkanGfxBuffer*>& buffers,
+        const DynamicArray<VkDeviceSize>&     offsets,
+        const DynamicArray<VkDeviceSize>&     sizes);
     void writeToBuffer(
         VulkanGfxBuffer* buffer,
         void*            hostBlock,
@@ -92,13 +97,15 @@ public:
         uint32_t           mipLevelCount,
         uint32_t           baseLayer,
         uint32_t           layersCount,
-        VkImageView*       pImageView) const;
+        VkImageView*       pImageView,
+        VkImageUsageFlags  viewUsage = 0) const;
     void                  freeImageView(VkImageView* pImageView) const;
     VulkanResult          createImageSampler(VulkanSampler* sampler) const;
     void                  freeImageSampler(VulkanSampler* sampler) const;
 
     static VulkanContext& getSharedVulkanContext() { return s_sharedVkContext; }
     VulkanGPUAllocator*   getGPUAllocator() { return &m_gpuAllocator; }
+    VkGfxPipelineCache*   getPipelineCache() { return &m_pipelineCache; }
 
 #ifdef VK_RENDERER_DEBUG
     static VKAPI_ATTR VkBool32 VKAPI_CALL vulkanDebugMessengerCallback(
@@ -120,9 +127,11 @@ private:
     VkDevice           m_device                = VK_NULL_HANDLE;
     VkCommandPool      m_commandPool           = VK_NULL_HANDLE;
     VkCommandPool      m_transferCommandPool   = VK_NULL_HANDLE;
+    VkCommandPool      m_computeCommandPool    = VK_NULL_HANDLE;
     VkSurfaceKHR       m_surface               = VK_NULL_HANDLE;
 
     VulkanGPUAllocator m_gpuAllocator          = {};
+    VkGfxPipelineCache m_pipelineCache;
 
     HashSet<size_t>    m_instanceExtensionsSet = {};
     HashSet<size_t>    m_layersSet             = {};
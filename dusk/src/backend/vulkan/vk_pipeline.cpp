@@ -1,5 +1,7 @@
 #include "vk_pipeline.h"
 
+#include <string_view>
+
 namespace dusk
 {
 bool createShaderModule(VkDevice device, const DynamicArray<char>& shaderCode, VkShaderModule* pShaderModule)
@@ -19,6 +21,11 @@ bool createShaderModule(VkDevice device, const DynamicArray<char>& shaderCode, V
     return true;
 }
 
+static size_t hashShaderCode(const DynamicArray<char>& shaderCode)
+{
+    return std::hash<std::string_view> {}(std::string_view(shaderCode.data(), shaderCode.size()));
+}
+
 VkGfxRenderPipeline::Builder::Builder(VulkanContext& vkContext) :
     m_context(vkContext)
 {
@@ -50,7 +57,8 @@ VkGfxRenderPipeline::Builder& VkGfxRenderPipeline::Builder::setSubPassIndex(uint
 
 VkGfxRenderPipeline::Builder& VkGfxRenderPipeline::Builder::setPipelineLayout(VkGfxPipelineLayout& pipelineLayout)
 {
-    m_renderConfig.pipelineLayout = pipelineLayout.m_pipelineLayout;
+    m_renderConfig.pipelineLayout     = pipelineLayout.m_pipelineLayout;
+    m_renderConfig.pipelineLayoutHash = pipelineLayout.getHash();
     return *this;
 }
 
@@ -96,18 +104,36 @@ VkGfxRenderPipeline::Builder& VkGfxRenderPipeline::Builder::removeVertexInputSta
     return *this;
 }
 
+VkGfxRenderPipeline::Builder& VkGfxRenderPipeline::Builder::setVertexFormat(VertexFormat format)
+{
+    m_renderConfig.vertexFormat = format;
+    return *this;
+}
+
 VkGfxRenderPipeline::Builder& VkGfxRenderPipeline::Builder::setViewMask(int mask)
 {
     m_renderConfig.viewMask = mask;
     return *this;
 }
 
+VkGfxRenderPipeline::Builder& VkGfxRenderPipeline::Builder::setDepthFormat(VkFormat format)
+{
+    m_renderConfig.depthFormat = format;
+    return *this;
+}
+
 VkGfxRenderPipeline::Builder& VkGfxRenderPipeline::Builder::setDebugName(const std::string& name)
 {
     m_renderConfig.debugName = name;
     return *this;
 }
 
+VkGfxRenderPipeline::Builder& VkGfxRenderPipeline::Builder::setDescriptorBufferUsage(bool state)
+{
+    m_renderConfig.useDescriptorBuffer = state;
+    return *this;
+}
+
 Unique<VkGfxRenderPipeline> VkGfxRenderPipeline::Builder::build()
 {
     DASSERT(m_renderConfig.pipelineLayout != VK_NULL_HANDLE, "pipeline layout is required for rendering");
@@ -125,6 +151,27 @@ Unique<VkGfxRenderPipeline> VkGfxRenderPipeline::Builder::build()
 VkGfxRenderPipeline::VkGfxRenderPipeline(VulkanContext& vkContext, VkGfxRenderPipelineConfig& renderConfig) :
     m_device(vkContext.device)
 {
+    // Add missing default dynamic states
+    if (renderConfig.dynamicStates.size() == 0)
+    {
+        renderConfig.dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+        renderConfig.dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
+    }
+
+    // identical pipeline was already created, reuse it without touching the shaders
+    VkGfxPipelineCache* pipelineCache = vkContext.pipelineCache;
+    size_t              stateHash     = computeStateHash(renderConfig);
+
+    if (pipelineCache)
+    {
+        m_pipeline = pipelineCache->findPipeline(stateHash);
+        if (m_pipeline != VK_NULL_HANDLE)
+        {
+            m_isLibraryPipeline = true;
+            return;
+        }
+    }
+
     // viewport and scissor state
     VkViewport viewport;
     viewport.x        = 0.0f;
@@ -165,13 +212,6 @@ VkGfxRenderPipeline::VkGfxRenderPipeline(VulkanContext& vkContext, VkGfxRenderPi
     inputAssemblyInfo.topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     inputAssemblyInfo.primitiveRestartEnable = VK_FALSE;
 
-    // Add missing default dynamic states
-    if (renderConfig.dynamicStates.size() == 0)
-    {
-        renderConfig.dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
-        renderConfig.dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
-    }
-
     VkPipelineDynamicStateCreateInfo dynamicStatesInfo {};
     dynamicStatesInfo.sType             = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
     dynamicStatesInfo.dynamicStateCount = static_cast<uint32_t>(renderConfig.dynamicStates.size());
@@ -192,11 +232,26 @@ VkGfxRenderPipeline::VkGfxRenderPipeline(VulkanContext& vkContext, VkGfxRenderPi
         (uint64_t)m_vertexShaderModule,
         "Vertex shader");
 
+    // vertex shader decodes packed vertices when the constant is set
+    VkBool32                 packedVertices = renderConfig.vertexFormat == VertexFormat::Packed ? VK_TRUE : VK_FALSE;
+
+    VkSpecializationMapEntry vertexSpecEntry {};
+    vertexSpecEntry.constantID = 0;
+    vertexSpecEntry.offset     = 0;
+    vertexSpecEntry.size       = sizeof(VkBool32);
+
+    VkSpecializationInfo vertexSpecInfo {};
+    vertexSpecInfo.mapEntryCount = 1;
+    vertexSpecInfo.pMapEntries   = &vertexSpecEntry;
+    vertexSpecInfo.dataSize      = sizeof(VkBool32);
+    vertexSpecInfo.pData         = &packedVertices;
+
     VkPipelineShaderStageCreateInfo vertShaderStageInfo {};
-    vertShaderStageInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage  = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = m_vertexShaderModule;
-    vertShaderStageInfo.pName  = "main";
+    vertShaderStageInfo.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertShaderStageInfo.stage               = VK_SHADER_STAGE_VERTEX_BIT;
+    vertShaderStageInfo.module              = m_vertexShaderModule;
+    vertShaderStageInfo.pName               = "main";
+    vertShaderStageInfo.pSpecializationInfo = &vertexSpecInfo;
 
     moduleResult               = createShaderModule(
         m_device,
@@ -225,8 +280,8 @@ VkGfxRenderPipeline::VkGfxRenderPipeline(VulkanContext& vkContext, VkGfxRenderPi
     };
 
     // vertex attributes info
-    auto bindingDescriptions   = vulkan::getVertexBindingDescription();
-    auto attributeDescriptions = vulkan::getVertexAtrributeDescription();
+    auto bindingDescriptions   = vulkan::getVertexBindingDescription(renderConfig.vertexFormat);
+    auto attributeDescriptions = vulkan::getVertexAtrributeDescription(renderConfig.vertexFormat);
 
     // input state info
     VkPipelineVertexInputStateCreateInfo vertexInputInfo {};
@@ -286,6 +341,11 @@ VkGfxRenderPipeline::VkGfxRenderPipeline(VulkanContext& vkContext, VkGfxRenderPi
     pipelineInfo.pDynamicState       = &dynamicStatesInfo;
     pipelineInfo.pVertexInputState   = nullptr;
 
+    if (renderConfig.useDescriptorBuffer)
+    {
+        pipelineInfo.flags |= VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+    }
+
     if (!renderConfig.noInputState)
     {
         pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -299,19 +359,21 @@ VkGfxRenderPipeline::VkGfxRenderPipeline(VulkanContext& vkContext, VkGfxRenderPi
     VkPipelineRenderingCreateInfo renderingCreateInfo { VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO };
     renderingCreateInfo.colorAttachmentCount    = static_cast<size_t>(renderConfig.colorAttachmentFormats.size());
     renderingCreateInfo.pColorAttachmentFormats = renderConfig.colorAttachmentFormats.data();
-    renderingCreateInfo.depthAttachmentFormat   = VK_FORMAT_D32_SFLOAT_S8_UINT;
+    renderingCreateInfo.depthAttachmentFormat   = renderConfig.depthFormat;
     renderingCreateInfo.viewMask                = renderConfig.viewMask;
 
     pipelineInfo.pNext                          = &renderingCreateInfo;
 
     // create pipeline
-    VulkanResult result = vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline);
+    VkPipelineCache vkPipelineCache = pipelineCache ? pipelineCache->get() : VK_NULL_HANDLE;
+    VulkanResult    result          = vkCreateGraphicsPipelines(m_device, vkPipelineCache, 1, &pipelineInfo, nullptr, &m_pipeline);
 
     // TODO: need better error handling
     if (result.hasError())
     {
         DUSK_ERROR("Unable to create graphics pipeline {}", result.toString());
         m_pipeline = VK_NULL_HANDLE;
+        return;
     }
 
 #ifdef VK_RENDERER_DEBUG
@@ -321,6 +383,12 @@ VkGfxRenderPipeline::VkGfxRenderPipeline(VulkanContext& vkContext, VkGfxRenderPi
         (uint64_t)m_pipeline,
         renderConfig.debugName.c_str());
 #endif // VK_RENDERER_DEBUG
+
+    if (pipelineCache)
+    {
+        m_pipeline          = pipelineCache->addPipeline(stateHash, m_pipeline);
+        m_isLibraryPipeline = true;
+    }
 }
 
 VkGfxRenderPipeline::~VkGfxRenderPipeline()
@@ -335,7 +403,8 @@ VkGfxRenderPipeline::~VkGfxRenderPipeline()
         vkDestroyShaderModule(m_device, m_fragmentShaderModule, nullptr);
     }
 
-    if (m_pipeline != VK_NULL_HANDLE)
+    // library pipelines are destroyed along with the device
+    if (m_pipeline != VK_NULL_HANDLE && !m_isLibraryPipeline)
     {
         vkDestroyPipeline(m_device, m_pipeline, nullptr);
     }
@@ -346,6 +415,52 @@ void VkGfxRenderPipeline::bind(VkCommandBuffer commandBuffer) const
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
 }
 
+size_t VkGfxRenderPipeline::computeStateHash(const VkGfxRenderPipelineConfig& renderConfig)
+{
+    // debug name is left out on purpose, it doesn't affect the pipeline
+    size_t stateHash = 0u;
+    hashCombine(
+        stateHash,
+        hashShaderCode(renderConfig.vertexShaderCode),
+        hashShaderCode(renderConfig.fragmentShaderCode),
+        renderConfig.pipelineLayoutHash,
+        renderConfig.subpassIndex,
+        renderConfig.cullMode,
+        renderConfig.noInputState,
+        renderConfig.vertexFormat,
+        renderConfig.enableDepthTest,
+        renderConfig.enableDepthWrites,
+        renderConfig.viewMask,
+        renderConfig.depthFormat,
+        renderConfig.useDescriptorBuffer);
+
+    for (VkDynamicState state : renderConfig.dynamicStates)
+    {
+        hashCombine(stateHash, state);
+    }
+
+    for (VkFormat format : renderConfig.colorAttachmentFormats)
+    {
+        hashCombine(stateHash, format);
+    }
+
+    for (const VkPipelineColorBlendAttachmentState& blend : renderConfig.colorBlendAttachment)
+    {
+        hashCombine(
+            stateHash,
+            blend.blendEnable,
+            blend.srcColorBlendFactor,
+            blend.dstColorBlendFactor,
+            blend.colorBlendOp,
+            blend.srcAlphaBlendFactor,
+            blend.dstAlphaBlendFactor,
+            blend.alphaBlendOp,
+            blend.colorWriteMask);
+    }
+
+    return stateHash;
+}
+
 //======================Compute Pipeline================================
 
 VkGfxComputePipeline::Builder::Builder(VulkanContext& vkContext) :
@@ -361,7 +476,8 @@ VkGfxComputePipeline::Builder& VkGfxComputePipeline::Builder::setComputeShaderCo
 
 VkGfxComputePipeline::Builder& VkGfxComputePipeline::Builder::setPipelineLayout(VkGfxPipelineLayout& pipelineLayout)
 {
-    m_computeConfig.pipelineLayout = pipelineLayout.get();
+    m_computeConfig.pipelineLayout     = pipelineLayout.get();
+    m_computeConfig.pipelineLayoutHash = pipelineLayout.getHash();
     return *this;
 }
 
@@ -371,6 +487,12 @@ VkGfxComputePipeline::Builder& VkGfxComputePipeline::Builder::setDebugName(const
     return *this;
 }
 
+VkGfxComputePipeline::Builder& VkGfxComputePipeline::Builder::setDescriptorBufferUsage(bool state)
+{
+    m_computeConfig.useDescriptorBuffer = state;
+    return *this;
+}
+
 Unique<VkGfxComputePipeline> VkGfxComputePipeline::Builder::build()
 {
     DASSERT(m_computeConfig.pipelineLayout != VK_NULL_HANDLE, "pipeline layout is required for compute pipeline");
@@ -388,6 +510,19 @@ Unique<VkGfxComputePipeline> VkGfxComputePipeline::Builder::build()
 VkGfxComputePipeline::VkGfxComputePipeline(VulkanContext& vkContext, VkGfxComputePipelineConfig& computeConfig) :
     m_device(vkContext.device)
 {
+    VkGfxPipelineCache* pipelineCache = vkContext.pipelineCache;
+    size_t              stateHash     = computeStateHash(computeConfig);
+
+    if (pipelineCache)
+    {
+        m_pipeline = pipelineCache->findPipeline(stateHash);
+        if (m_pipeline != VK_NULL_HANDLE)
+        {
+            m_isLibraryPipeline = true;
+            return;
+        }
+    }
+
     bool moduleResult = createShaderModule(
         m_device,
         computeConfig.computeShaderCode,
@@ -410,9 +545,14 @@ VkGfxComputePipeline::VkGfxComputePipeline(VulkanContext& vkContext, VkGfxComput
     pipelineInfo.layout = computeConfig.pipelineLayout;
     pipelineInfo.stage  = computeShaderStageInfo;
 
+    if (computeConfig.useDescriptorBuffer)
+    {
+        pipelineInfo.flags |= VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+    }
+
     VulkanResult result = vkCreateComputePipelines(
         m_device,
-        VK_NULL_HANDLE,
+        pipelineCache ? pipelineCache->get() : VK_NULL_HANDLE,
         1,
         &pipelineInfo,
         nullptr,
@@ -422,6 +562,7 @@ VkGfxComputePipeline::VkGfxComputePipeline(VulkanContext& vkContext, VkGfxComput
     {
         DUSK_ERROR("Unable to create graphics pipeline {}", result.toString());
         m_pipeline = VK_NULL_HANDLE;
+        return;
     }
 
 #ifdef VK_RENDERER_DEBUG
@@ -431,6 +572,12 @@ VkGfxComputePipeline::VkGfxComputePipeline(VulkanContext& vkContext, VkGfxComput
         (uint64_t)m_pipeline,
         computeConfig.debugName.c_str());
 #endif // VK_RENDERER_DEBUG
+
+    if (pipelineCache)
+    {
+        m_pipeline          = pipelineCache->addPipeline(stateHash, m_pipeline);
+        m_isLibraryPipeline = true;
+    }
 }
 
 VkGfxComputePipeline::~VkGfxComputePipeline()
@@ -440,7 +587,8 @@ VkGfxComputePipeline::~VkGfxComputePipeline()
         vkDestroyShaderModule(m_device, m_computeShaderModule, nullptr);
     }
 
-    if (m_pipeline != VK_NULL_HANDLE)
+    // library pipelines are destroyed along with the device
+    if (m_pipeline != VK_NULL_HANDLE && !m_isLibraryPipeline)
     {
         vkDestroyPipeline(m_device, m_pipeline, nullptr);
     }
@@ -451,4 +599,16 @@ void VkGfxComputePipeline::bind(VkCommandBuffer commandBuffer) const
     vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
 }
 
+size_t VkGfxComputePipeline::computeStateHash(const VkGfxComputePipelineConfig& computeConfig)
+{
+    size_t stateHash = 0u;
+    hashCombine(
+        stateHash,
+        hashShaderCode(computeConfig.computeShaderCode),
+        computeConfig.pipelineLayoutHash,
+        computeConfig.useDescriptorBuffer);
+
+    return stateHash;
+}
+
 } // namespace dusk
\ No newline at end of file
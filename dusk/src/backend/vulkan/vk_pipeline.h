@@ -4,6 +4,7 @@
 #include "vk.h"
 #include "vk_types.h"
 #include "vk_pipeline_layout.h"
+#include "vk_pipeline_cache.h"
 
 namespace dusk
 {
@@ -22,18 +23,24 @@ struct VkGfxRenderPipelineConfig
 
     DynamicArray<VkFormat>                            colorAttachmentFormats;
 
-    VkRenderPass                                      renderPass        = VK_NULL_HANDLE;
-    uint32_t                                          subpassIndex      = 0u;
+    VkRenderPass                                      renderPass         = VK_NULL_HANDLE;
+    uint32_t                                          subpassIndex       = 0u;
 
-    VkPipelineLayout                                  pipelineLayout    = VK_NULL_HANDLE;
+    VkPipelineLayout                                  pipelineLayout     = VK_NULL_HANDLE;
+    size_t                                            pipelineLayoutHash = 0u;
 
-    VkCullModeFlagBits                                cullMode          = VK_CULL_MODE_NONE;
-    bool                                              noInputState      = false;
-    bool                                              enableDepthTest   = true;
-    bool                                              enableDepthWrites = true;
-    int                                               viewMask          = 0;
+    VkCullModeFlagBits                                cullMode           = VK_CULL_MODE_NONE;
+    bool                                              noInputState       = false;
+    VertexFormat                                      vertexFormat       = VertexFormat::Full;
+    bool                                              enableDepthTest    = true;
+    bool                                              enableDepthWrites  = true;
+    int                                               viewMask           = 0;
+    VkFormat                                          depthFormat        = VK_FORMAT_D32_SFLOAT_S8_UINT;
 
-    std::string                                       debugName         = "";
+    std::string                                       debugName          = "";
+
+    // descriptor sets are read from descriptor buffers
+    bool                                              useDescriptorBuffer = false;
 };
 
 bool createShaderModule(
@@ -59,9 +66,31 @@ public:
         Builder& setDepthTest(bool state);
         Builder& setDepthWrite(bool state);
         Builder& removeVertexInputState();
+
+        /**
+         * @brief Set layout of the vertex input. Vertex shader receives the format
+         * as bool specialization constant 0 which is true for packed vertices.
+         * @param format of the vertices
+         * @return builder reference
+         */
+        Builder& setVertexFormat(VertexFormat format);
         Builder& setViewMask(int mask);
+
+        /**
+         * @brief Set format of the depth attachment the pipeline renders into
+         * @param format of the depth attachment
+         * @return builder reference
+         */
+        Builder& setDepthFormat(VkFormat format);
         Builder& setDebugName(const std::string& name);
 
+        /**
+         * @brief Create pipeline for descriptor sets stored in descriptor buffers
+         * @param state true if pipeline layout uses descriptor buffer layouts
+         * @return builder reference
+         */
+        Builder& setDescriptorBufferUsage(bool state);
+
         /**
          * @brief build VkGfxPipeline object with given config
          * @return unique pointer to pipeline object
@@ -83,9 +112,17 @@ public:
     void       bind(VkCommandBuffer commandBuffer) const;
     VkPipeline get() const { return m_pipeline; }
 
+    /**
+     * @brief Compute hash of the full pipeline state used as the pipeline library key
+     * @param renderConfig of the pipeline
+     * @return state hash
+     */
+    static size_t computeStateHash(const VkGfxRenderPipelineConfig& renderConfig);
+
 private:
     VkDevice       m_device               = VK_NULL_HANDLE;
     VkPipeline     m_pipeline             = VK_NULL_HANDLE;
+    bool           m_isLibraryPipeline    = false;
 
     VkShaderModule m_vertexShaderModule   = VK_NULL_HANDLE;
     VkShaderModule m_fragmentShaderModule = VK_NULL_HANDLE;
@@ -94,8 +131,12 @@ private:
 struct VkGfxComputePipelineConfig
 {
     DynamicArray<char> computeShaderCode; // TODO: avoid copying buffer
-    VkPipelineLayout   pipelineLayout = VK_NULL_HANDLE;
-    std::string        debugName      = "";
+    VkPipelineLayout   pipelineLayout     = VK_NULL_HANDLE;
+    size_t             pipelineLayoutHash = 0u;
+    std::string        debugName          = "";
+
+    // descriptor sets are read from descriptor buffers
+    bool               useDescriptorBuffer = false;
 };
 
 class VkGfxComputePipeline
@@ -110,6 +151,13 @@ public:
         Builder& setPipelineLayout(VkGfxPipelineLayout& pipelineLayout);
         Builder& setDebugName(const std::string& name);
 
+        /**
+         * @brief Create pipeline for descriptor sets stored in descriptor buffers
+         * @param state true if pipeline layout uses descriptor buffer layouts
+         * @return builder reference
+         */
+        Builder& setDescriptorBufferUsage(bool state);
+
         /**
          * @brief build VkGfxPipeline object with given compute config
          * @return unique pointer to pipeline object
@@ -131,9 +179,17 @@ public:
     void       bind(VkCommandBuffer commandBuffer) const;
     VkPipeline get() const { return m_pipeline; }
 
+    /**
+     * @brief Compute hash of the full pipeline state used as the pipeline library key
+     * @param computeConfig of the pipeline
+     * @return state hash
+     */
+    static size_t computeStateHash(const VkGfxComputePipelineConfig& computeConfig);
+
 private:
     VkDevice       m_device              = VK_NULL_HANDLE;
     VkPipeline     m_pipeline            = VK_NULL_HANDLE;
+    bool           m_isLibraryPipeline   = false;
 
     VkShaderModule m_computeShaderModule = VK_NULL_HANDLE;
 };
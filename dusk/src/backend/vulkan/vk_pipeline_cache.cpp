@@ -0,0 +1,193 @@
+#include "vk_pipeline_cache.h"
+
+#include "platform/file_system.h"
+#include "debug/profiler.h"
+
+#include <cstring>
+#include <string_view>
+
+namespace dusk
+{
+Error VkGfxPipelineCache::init(const VulkanContext& vkContext, const std::filesystem::path& filePath)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    m_device           = vkContext.device;
+    m_deviceProperties = vkContext.physicalDeviceProperties;
+    m_filePath         = filePath;
+
+    DynamicArray<char> fileData;
+    std::error_code    ec;
+    if (std::filesystem::exists(m_filePath, ec))
+    {
+        fileData = FileSystem::readFileBinary(m_filePath);
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+
+    if (fileData.size() >= sizeof(VkGfxPipelineCacheFileHeader))
+    {
+        VkGfxPipelineCacheFileHeader header {};
+        std::memcpy(&header, fileData.data(), sizeof(header));
+
+        const char* blob     = fileData.data() + sizeof(header);
+        size_t      blobSize = fileData.size() - sizeof(header);
+
+        if (isHeaderValid(header)
+            && header.dataSize == blobSize
+            && header.dataHash == std::hash<std::string_view> {}(std::string_view(blob, blobSize)))
+        {
+            cacheInfo.initialDataSize = blobSize;
+            cacheInfo.pInitialData    = blob;
+
+            DUSK_INFO("Loaded pipeline cache {} ({} bytes)", m_filePath.generic_string(), blobSize);
+        }
+        else
+        {
+            DUSK_WARN("Discarding pipeline cache {}, it is stale or corrupted", m_filePath.generic_string());
+        }
+    }
+
+    VulkanResult result = vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_pipelineCache);
+
+    // driver can still reject the blob, start with an empty cache in that case
+    if (result.hasError() && cacheInfo.initialDataSize > 0)
+    {
+        DUSK_WARN("Driver rejected pipeline cache data {}", result.toString());
+
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData    = nullptr;
+        result                    = vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_pipelineCache);
+    }
+
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to create pipeline cache {}", result.toString());
+        return Error::InitializationFailed;
+    }
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        m_device,
+        VK_OBJECT_TYPE_PIPELINE_CACHE,
+        (uint64_t)m_pipelineCache,
+        "pipeline_cache");
+#endif // VK_RENDERER_DEBUG
+
+    return Error::Ok;
+}
+
+void VkGfxPipelineCache::cleanup()
+{
+    if (m_pipelineCache == VK_NULL_HANDLE) return;
+
+    save();
+
+    {
+        std::lock_guard<std::mutex> lock(m_libraryMutex);
+
+        for (VkPipeline pipeline : m_pipelines.values())
+        {
+            vkDestroyPipeline(m_device, pipeline, nullptr);
+        }
+        m_pipelines.clear();
+    }
+
+    vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+    m_pipelineCache = VK_NULL_HANDLE;
+}
+
+bool VkGfxPipelineCache::save() const
+{
+    DUSK_PROFILE_FUNCTION;
+
+    size_t       dataSize = 0u;
+    VulkanResult result   = vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, nullptr);
+    if (result.hasError() || dataSize == 0u)
+    {
+        return false;
+    }
+
+    DynamicArray<char> fileData(sizeof(VkGfxPipelineCacheFileHeader) + dataSize);
+    char*              blob = fileData.data() + sizeof(VkGfxPipelineCacheFileHeader);
+
+    result                  = vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, blob);
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to read pipeline cache data {}", result.toString());
+        return false;
+    }
+
+    VkGfxPipelineCacheFileHeader header {};
+    fillHeader(header);
+    header.dataSize = dataSize;
+    header.dataHash = std::hash<std::string_view> {}(std::string_view(blob, dataSize));
+
+    std::memcpy(fileData.data(), &header, sizeof(header));
+
+    // write next to the cache and swap, a crash mid write never leaves a partial cache
+    std::filesystem::path tempPath = m_filePath;
+    tempPath += ".tmp";
+
+    if (!FileSystem::writeFileBinary(tempPath, fileData.data(), sizeof(header) + dataSize))
+    {
+        DUSK_ERROR("Unable to write pipeline cache {}", tempPath.generic_string());
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, m_filePath, ec);
+    if (ec)
+    {
+        DUSK_ERROR("Unable to replace pipeline cache {}. {}", m_filePath.generic_string(), ec.message());
+        return false;
+    }
+
+    DUSK_INFO("Saved pipeline cache {} ({} bytes)", m_filePath.generic_string(), dataSize);
+    return true;
+}
+
+VkPipeline VkGfxPipelineCache::findPipeline(size_t stateHash)
+{
+    std::lock_guard<std::mutex> lock(m_libraryMutex);
+
+    if (m_pipelines.has(stateHash)) return m_pipelines[stateHash];
+
+    return VK_NULL_HANDLE;
+}
+
+VkPipeline VkGfxPipelineCache::addPipeline(size_t stateHash, VkPipeline pipeline)
+{
+    std::lock_guard<std::mutex> lock(m_libraryMutex);
+
+    if (m_pipelines.has(stateHash))
+    {
+        vkDestroyPipeline(m_device, pipeline, nullptr);
+        return m_pipelines[stateHash];
+    }
+
+    m_pipelines.emplace(stateHash, pipeline);
+    return pipeline;
+}
+
+bool VkGfxPipelineCache::isHeaderValid(const VkGfxPipelineCacheFileHeader& header) const
+{
+    VkGfxPipelineCacheFileHeader deviceHeader {};
+    fillHeader(deviceHeader);
+
+    return header.magic == deviceHeader.magic
+        && header.version == deviceHeader.version
+        && header.vendorID == deviceHeader.vendorID
+        && header.deviceID == deviceHeader.deviceID
+        && header.driverVersion == deviceHeader.driverVersion
+        && std::memcmp(header.pipelineCacheUUID, deviceHeader.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void VkGfxPipelineCache::fillHeader(VkGfxPipelineCacheFileHeader& header) const
+{
+    header.vendorID      = m_deviceProperties.vendorID;
+    header.deviceID      = m_deviceProperties.deviceID;
+    header.driverVersion = m_deviceProperties.driverVersion;
+    std::memcpy(header.pipelineCacheUUID, m_deviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+}
+} // namespace dusk
\ No newline at end of file
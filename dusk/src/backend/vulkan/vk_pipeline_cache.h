@@ -0,0 +1,94 @@
+#pragma once
+
+#include "dusk.h"
+#include "vk.h"
+#include "vk_types.h"
+
+#include <filesystem>
+#include <mutex>
+
+namespace dusk
+{
+constexpr uint32_t PIPELINE_CACHE_MAGIC   = 0x43504B44u; // "DKPC"
+constexpr uint32_t PIPELINE_CACHE_VERSION = 1u;
+
+// Header written in front of the driver cache blob. Blob is discarded when it was
+// produced by another device or driver, or when its contents are corrupted.
+struct VkGfxPipelineCacheFileHeader
+{
+    uint32_t magic                           = PIPELINE_CACHE_MAGIC;
+    uint32_t version                         = PIPELINE_CACHE_VERSION;
+    uint32_t vendorID                        = 0u;
+    uint32_t deviceID                        = 0u;
+    uint32_t driverVersion                   = 0u;
+    uint8_t  pipelineCacheUUID[VK_UUID_SIZE] = {};
+    uint64_t dataSize                        = 0u;
+    uint64_t dataHash                        = 0u;
+};
+
+/**
+ * @brief Process wide pipeline cache persisted on disk along with a library of
+ * created pipelines keyed by hash of their full state. Pipelines in the library
+ * are owned by it and live until the device is destroyed, so identical pipelines
+ * are shared and pipelines survive recreation of render graph resources.
+ */
+class VkGfxPipelineCache
+{
+public:
+    VkGfxPipelineCache()  = default;
+    ~VkGfxPipelineCache() = default;
+
+    CLASS_UNCOPYABLE(VkGfxPipelineCache);
+
+    /**
+     * @brief Create the vulkan pipeline cache seeded with data from the cache file
+     * if it is valid for the current device
+     * @param vkContext with the logical device and physical device properties
+     * @param filePath of the cache file
+     * @return Error::Ok if successful
+     */
+    Error init(const VulkanContext& vkContext, const std::filesystem::path& filePath);
+
+    /**
+     * @brief Save the cache to disk and destroy all library pipelines
+     */
+    void cleanup();
+
+    /**
+     * @brief Write current cache data to the cache file
+     * @return true if successful
+     */
+    bool save() const;
+
+    /**
+     * @brief Find pipeline in the library
+     * @param stateHash of the pipeline
+     * @return pipeline handle, VK_NULL_HANDLE if it doesn't exist
+     */
+    VkPipeline findPipeline(size_t stateHash);
+
+    /**
+     * @brief Add pipeline to the library. Library takes the ownership of the pipeline.
+     * @param stateHash of the pipeline
+     * @param pipeline handle
+     * @return pipeline registered for the hash, existing one is returned and the given
+     * one is destroyed if another thread added the same state first
+     */
+    VkPipeline addPipeline(size_t stateHash, VkPipeline pipeline);
+
+    VkPipelineCache get() const { return m_pipelineCache; }
+
+private:
+    bool isHeaderValid(const VkGfxPipelineCacheFileHeader& header) const;
+    void fillHeader(VkGfxPipelineCacheFileHeader& header) const;
+
+private:
+    VkDevice                    m_device           = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties  m_deviceProperties = {};
+    VkPipelineCache             m_pipelineCache    = VK_NULL_HANDLE;
+    std::filesystem::path       m_filePath         = {};
+
+    std::mutex                  m_libraryMutex;
+    HashMap<size_t, VkPipeline> m_pipelines        = {};
+};
+} // namespace dusk
\ No newline at end of file
@@ -12,12 +12,14 @@ VkGfxPipelineLayout::Builder& VkGfxPipelineLayout::Builder::addPushConstantRange
     DASSERT(!m_layoutConfig.pushConstantRangesMap.has(offset), "push constant offset already exists");
 
     m_layoutConfig.pushConstantRangesMap.emplace(offset, VkPushConstantRange { flags, offset, size });
+    hashCombine(m_layoutConfig.hash, flags, offset, size);
     return *this;
 }
 
-VkGfxPipelineLayout::Builder& VkGfxPipelineLayout::Builder::addDescriptorSetLayout(VkDescriptorSetLayout layout)
+VkGfxPipelineLayout::Builder& VkGfxPipelineLayout::Builder::addDescriptorSetLayout(const VkGfxDescriptorSetLayout& layout)
 {
-    m_layoutConfig.descriptorSetLayouts.push_back(layout);
+    m_layoutConfig.descriptorSetLayouts.push_back(layout.layout);
+    hashCombine(m_layoutConfig.hash, layout.hash);
     return *this;
 }
 
@@ -36,6 +38,7 @@ Unique<VkGfxPipelineLayout> VkGfxPipelineLayout::Builder::build() const
 VkGfxPipelineLayout::VkGfxPipelineLayout(const VulkanContext& vkContext, const VkGfxPipelineLayoutConfig& layoutConfig)
 {
     m_device = vkContext.device;
+    m_hash   = layoutConfig.hash;
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -3,6 +3,7 @@
 #include "dusk.h"
 #include "vk.h"
 #include "vk_types.h"
+#include "vk_descriptors.h"
 
 namespace dusk
 {
@@ -10,6 +11,9 @@ struct VkGfxPipelineLayoutConfig
 {
     HashMap<uint32_t, VkPushConstantRange> pushConstantRangesMap;
     DynamicArray<VkDescriptorSetLayout>    descriptorSetLayouts;
+
+    // hash of push constant ranges and set layout contents
+    size_t                                 hash = 0u;
 };
 
 class VkGfxPipelineLayout
@@ -26,7 +30,7 @@ public:
         CLASS_UNCOPYABLE(VkGfxPipelineLayout::Builder);
 
         Builder&                    addPushConstantRange(VkShaderStageFlags flags, uint32_t offset, uint32_t size);
-        Builder&                    addDescriptorSetLayout(VkDescriptorSetLayout layout);
+        Builder&                    addDescriptorSetLayout(const VkGfxDescriptorSetLayout& layout);
 
         Unique<VkGfxPipelineLayout> build() const;
 
@@ -44,8 +48,16 @@ public:
     VkPipelineLayout get() const { return m_pipelineLayout; }
     bool             isValid() const { return m_pipelineLayout != VK_NULL_HANDLE; }
 
+    /**
+     * @brief Get hash of the layout contents. Layouts with equal hash are compatible
+     * even if they are created again.
+     * @return content hash
+     */
+    size_t           getHash() const { return m_hash; }
+
 private:
     VkDevice         m_device         = VK_NULL_HANDLE;
     VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    size_t           m_hash           = 0u;
 };
 } // namespace dusk
\ No newline at end of file
@@ -9,9 +9,13 @@
 #define VOLK_IMPLEMENTATION
 #include <volk.h>
 #include <thread>
+#include <algorithm>
 
 namespace dusk
 {
+// upper bound of a low latency wait, a present stuck for longer shouldn't stall input
+constexpr uint64_t LOW_LATENCY_PRESENT_TIMEOUT_NS = 100'000'000u;
+
 VulkanRenderer::VulkanRenderer(GLFWVulkanWindow& window) :
     m_window(window)
 {
@@ -60,18 +64,25 @@ CommandBufferPools VulkanRenderer::beginFrame()
     // reset pools before use. Acquiring image is guarded by a fence so it is a good place to reset pools.
     vulkan::resetCmdBufferPool(&m_graphicCommandBufferPools[m_currentFrameIndex]);
     vulkan::resetCmdBufferPool(&m_computeCommandBufferPools[m_currentFrameIndex]);
+    vulkan::resetCmdBufferPool(&m_transferCommandBufferPools[m_currentFrameIndex]);
 
     if (result.vkResult == VK_ERROR_OUT_OF_DATE_KHR)
     {
         recreateSwapChain();
-        recreateCommandBuffers();
-        return { nullptr, nullptr };
+        return { nullptr, nullptr, nullptr };
     }
 
     if (result.hasError() && result.vkResult != VK_SUBOPTIMAL_KHR)
     {
         DUSK_ERROR("beginFrame Failed to acquire swap chain image! {}", result.toString());
-        return { nullptr, nullptr };
+        return { nullptr, nullptr, nullptr };
+    }
+
+    // every frame slot has waited on its fence since the recreation, so presents
+    // queued on the retired swapchain are behind us
+    if (m_swapChain->hasOldSwapChain() && ++m_framesSinceSwapChainRecreation > MAX_FRAMES_IN_FLIGHT)
+    {
+        m_swapChain->destroyOldSwapChain();
     }
 
     // collect stats from N - MAX_FRAMES_IN_FLIGHT frames ago, as those should have finished GPU execution by now
@@ -79,7 +90,11 @@ CommandBufferPools VulkanRenderer::beginFrame()
 
     m_isFrameStarted = true;
 
-    return { &m_graphicCommandBufferPools[m_currentFrameIndex], &m_computeCommandBufferPools[m_currentFrameIndex] };
+    return {
+        &m_graphicCommandBufferPools[m_currentFrameIndex],
+        &m_computeCommandBufferPools[m_currentFrameIndex],
+        &m_transferCommandBufferPools[m_currentFrameIndex]
+    };
 }
 
 Error VulkanRenderer::endFrame(DynamicArray<VulkanSubmitBatch>& batches)
@@ -92,10 +107,9 @@ Error VulkanRenderer::endFrame(DynamicArray<VulkanSubmitBatch>& batches)
 
     if (result.vkResult == VK_ERROR_OUT_OF_DATE_KHR || result.vkResult == VK_SUBOPTIMAL_KHR || m_window.isResized())
     {
-        DUSK_INFO("recreating swap chain and frame buffers");
+        DUSK_INFO("recreating swap chain");
         m_window.resetResizedState();
         recreateSwapChain();
-        recreateCommandBuffers();
     }
     else if (result.hasError())
     {
@@ -104,7 +118,18 @@ Error VulkanRenderer::endFrame(DynamicArray<VulkanSubmitBatch>& batches)
     }
 
     m_isFrameStarted    = false;
-    m_currentFrameIndex = (m_currentFrameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
+    m_currentFrameIndex = (m_currentFrameIndex + 1) % m_framesInFlight;
+
+    if (m_requestedFramesInFlight != m_framesInFlight)
+    {
+        // slots are reused from the start so every frame in flight has to finish
+        m_swapChain->waitForInFlightFrames();
+
+        DUSK_INFO("frames in flight changed from {} to {}", m_framesInFlight, m_requestedFramesInFlight);
+
+        m_framesInFlight    = m_requestedFramesInFlight;
+        m_currentFrameIndex = 0u;
+    }
 
     return Error::Ok;
 }
@@ -115,6 +140,27 @@ void VulkanRenderer::deviceWaitIdle()
     vkDeviceWaitIdle(context.device);
 }
 
+void VulkanRenderer::setFramesInFlight(uint32_t count)
+{
+    m_requestedFramesInFlight = std::clamp(count, 1u, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT));
+}
+
+void VulkanRenderer::waitBeforeInputSampling()
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!m_lowLatencyMode) return;
+
+    if (m_swapChain->supportsPresentWait())
+    {
+        m_swapChain->waitForLastPresent(LOW_LATENCY_PRESENT_TIMEOUT_NS);
+        return;
+    }
+
+    uint32_t previousFrameIndex = (m_currentFrameIndex + m_framesInFlight - 1u) % m_framesInFlight;
+    m_swapChain->waitForFrame(previousFrameIndex);
+}
+
 float VulkanRenderer::getAspectRatio() const
 {
     auto extent = m_swapChain->getCurrentExtent();
@@ -123,6 +169,8 @@ float VulkanRenderer::getAspectRatio() const
 
 Error VulkanRenderer::recreateSwapChain()
 {
+    DUSK_PROFILE_FUNCTION;
+
     auto&      context      = VkGfxDevice::getSharedVulkanContext();
     VkExtent2D windowExtent = m_window.getFramebufferExtent();
 
@@ -132,7 +180,12 @@ Error VulkanRenderer::recreateSwapChain()
         m_window.waitEvents();
     }
 
-    vkDeviceWaitIdle(context.device);
+    // only frames submitted through the swapchain have to drain. Other queues keep
+    // working and command buffers, pipelines and render targets stay untouched.
+    if (m_swapChain != nullptr)
+    {
+        m_swapChain->waitForInFlightFrames();
+    }
 
     VkGfxSwapChainParams params {};
     params.windowWidth                  = windowExtent.width;
@@ -144,7 +197,10 @@ Error VulkanRenderer::recreateSwapChain()
         oldSwapChain = std::move(m_swapChain);
     }
 
-    m_swapChain = createUnique<VkGfxSwapChain>();
+    // retired swapchains chain up while resizing continuously and are released
+    // together once the frames settle
+    m_swapChain                      = createUnique<VkGfxSwapChain>();
+    m_framesSinceSwapChainRecreation = 0u;
 
     return m_swapChain->create(context, params, oldSwapChain);
 }
@@ -155,6 +211,7 @@ Error VulkanRenderer::createCommandBuffers()
 
     m_graphicCommandBufferPools.resize(MAX_FRAMES_IN_FLIGHT);
     m_computeCommandBufferPools.resize(MAX_FRAMES_IN_FLIGHT);
+    m_transferCommandBufferPools.resize(MAX_FRAMES_IN_FLIGHT);
 
     for (uint32_t i = 0u; i < MAX_FRAMES_IN_FLIGHT; ++i)
     {
@@ -169,6 +226,12 @@ Error VulkanRenderer::createCommandBuffers()
             context.computeQueueFamilyIndex,
             8u, // starting with 8 command buffers
             &m_computeCommandBufferPools[i]);
+
+        vulkan::createCmdBufferPool(
+            context.device,
+            context.transferQueueFamilyIndex,
+            2u, // transfer passes are few
+            &m_transferCommandBufferPools[i]);
     }
 
     Error err = createSecondaryCmdPoolsAndBuffers();
@@ -185,22 +248,15 @@ void VulkanRenderer::freeCommandBuffers()
     {
         vulkan::destroyCmdBufferPool(&m_graphicCommandBufferPools[i]);
         vulkan::destroyCmdBufferPool(&m_computeCommandBufferPools[i]);
+        vulkan::destroyCmdBufferPool(&m_transferCommandBufferPools[i]);
     }
     m_graphicCommandBufferPools.clear();
     m_computeCommandBufferPools.clear();
+    m_transferCommandBufferPools.clear();
 
     freeSecondaryCmdPoolsAndBuffers();
 }
 
-Error VulkanRenderer::recreateCommandBuffers()
-{
-    DUSK_INFO("Recreating command buffers");
-
-    freeCommandBuffers();
-
-    return createCommandBuffers();
-}
-
 Error VulkanRenderer::createSecondaryCmdPoolsAndBuffers()
 {
     auto&          context    = VkGfxDevice::getSharedVulkanContext();
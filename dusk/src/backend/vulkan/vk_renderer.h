@@ -15,6 +15,7 @@ struct CommandBufferPools
 {
     VulkanCmdBufferPool* graphicsPool;
     VulkanCmdBufferPool* computePool;
+    VulkanCmdBufferPool* transferPool;
 };
 
 class VulkanRenderer final : public Renderer
@@ -31,6 +32,29 @@ public:
 
     void                           deviceWaitIdle();
 
+    /**
+     * @brief Request count of frames which can be recorded ahead of the GPU.
+     * Change is applied at the end of the current frame.
+     * @param count of frames in flight, clamped to [1, MAX_FRAMES_IN_FLIGHT]
+     */
+    void                           setFramesInFlight(uint32_t count);
+    uint32_t                       getFramesInFlight() const { return m_framesInFlight; }
+
+    /**
+     * @brief Enable waiting for the previous frame before input is sampled,
+     * trading throughput for input to photon latency
+     * @param enable
+     */
+    void                           setLowLatencyMode(bool enable) { m_lowLatencyMode = enable; }
+    bool                           isLowLatencyMode() const { return m_lowLatencyMode; }
+
+    /**
+     * @brief Block the CPU until the previous frame is presented when low latency
+     * mode is enabled. Falls back to waiting for GPU completion of the previous
+     * frame when present wait is not supported.
+     */
+    void                           waitBeforeInputSampling();
+
     VkGfxSwapChain&                getSwapChain() const { return *m_swapChain; }
 
     uint32_t                       getCurrentFrameIndex() const { return m_currentFrameIndex; }
@@ -45,25 +69,30 @@ private:
 
     Error createCommandBuffers();
     void  freeCommandBuffers();
-    Error recreateCommandBuffers();
 
     Error createSecondaryCmdPoolsAndBuffers();
     void  resetSecondaryCmdBuffers(uint32_t frameIdx);
     void  freeSecondaryCmdPoolsAndBuffers();
 
 private:
-    Unique<VkGfxSwapChain>                      m_swapChain = nullptr;
+    Unique<VkGfxSwapChain>                      m_swapChain                      = nullptr;
     GLFWVulkanWindow&                           m_window;
 
-    DynamicArray<VkCommandPool>                 m_secondaryCmdPools         = {};
+    DynamicArray<VkCommandPool>                 m_secondaryCmdPools              = {};
+
+    DynamicArray<DynamicArray<VkCommandBuffer>> m_secondaryCmdBuffers            = {}; // TODO: currently 1 buff per frame per secondary pool
 
-    DynamicArray<DynamicArray<VkCommandBuffer>> m_secondaryCmdBuffers       = {}; // TODO: currently 1 buff per frame per secondary pool
+    DynamicArray<VulkanCmdBufferPool>           m_graphicCommandBufferPools      = {};
+    DynamicArray<VulkanCmdBufferPool>           m_computeCommandBufferPools      = {};
+    DynamicArray<VulkanCmdBufferPool>           m_transferCommandBufferPools     = {};
 
-    DynamicArray<VulkanCmdBufferPool>           m_graphicCommandBufferPools = {};
-    DynamicArray<VulkanCmdBufferPool>           m_computeCommandBufferPools = {};
+    bool                                        m_isFrameStarted                 = false;
+    uint32_t                                    m_currentImageIndex              = 0u;
+    uint32_t                                    m_currentFrameIndex              = 0u;
+    uint32_t                                    m_framesSinceSwapChainRecreation = 0u;
 
-    bool                                        m_isFrameStarted            = false;
-    uint32_t                                    m_currentImageIndex         = 0u;
-    uint32_t                                    m_currentFrameIndex         = 0u;
+    uint32_t                                    m_framesInFlight                 = DEFAULT_FRAMES_IN_FLIGHT;
+    uint32_t                                    m_requestedFramesInFlight        = DEFAULT_FRAMES_IN_FLIGHT;
+    bool                                        m_lowLatencyMode                 = false;
 };
 } // namespace dusk
\ No newline at end of file
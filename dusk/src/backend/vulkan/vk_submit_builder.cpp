@@ -0,0 +1,97 @@
+#include "vk_submit_builder.h"
+
+#include "debug/profiler.h"
+
+namespace dusk
+{
+void VkGfxSubmitBuilder::reset()
+{
+    m_submits.clear();
+    m_waitInfos.clear();
+    m_cmdBuffers.clear();
+    m_signalInfos.clear();
+    m_submitInfos.clear();
+}
+
+void VkGfxSubmitBuilder::beginSubmit()
+{
+    SubmitRange range {};
+    range.firstWait      = static_cast<uint32_t>(m_waitInfos.size());
+    range.firstCmdBuffer = static_cast<uint32_t>(m_cmdBuffers.size());
+    range.firstSignal    = static_cast<uint32_t>(m_signalInfos.size());
+
+    m_submits.push_back(range);
+}
+
+void VkGfxSubmitBuilder::addCommandBuffer(VkCommandBuffer cmdBuffer)
+{
+    DASSERT(!m_submits.empty(), "beginSubmit is required before adding command buffers");
+
+    VkCommandBufferSubmitInfo cmdBufferInfo { VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
+    cmdBufferInfo.commandBuffer = cmdBuffer;
+
+    m_cmdBuffers.push_back(cmdBufferInfo);
+    ++m_submits.back().cmdBufferCount;
+}
+
+void VkGfxSubmitBuilder::addWait(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags2 stageMask)
+{
+    DASSERT(!m_submits.empty(), "beginSubmit is required before adding waits");
+
+    VkSemaphoreSubmitInfo waitInfo { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
+    waitInfo.semaphore = semaphore;
+    waitInfo.value     = value;
+    waitInfo.stageMask = stageMask;
+
+    m_waitInfos.push_back(waitInfo);
+    ++m_submits.back().waitCount;
+}
+
+void VkGfxSubmitBuilder::addSignal(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags2 stageMask)
+{
+    DASSERT(!m_submits.empty(), "beginSubmit is required before adding signals");
+
+    VkSemaphoreSubmitInfo signalInfo { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
+    signalInfo.semaphore = semaphore;
+    signalInfo.value     = value;
+    signalInfo.stageMask = stageMask;
+
+    m_signalInfos.push_back(signalInfo);
+    ++m_submits.back().signalCount;
+}
+
+bool VkGfxSubmitBuilder::canAppend(bool hasWait) const
+{
+    // waits apply to every command buffer of a submission and signals happen after
+    // all of them, so only unsynchronized neighbours can share a submission
+    return !m_submits.empty() && !hasWait && m_submits.back().signalCount == 0u;
+}
+
+VulkanResult VkGfxSubmitBuilder::submit(VkQueue queue, VkFence fence)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    // pointers are resolved at the end as scratch arrays can grow while building
+    m_submitInfos.clear();
+    for (const auto& range : m_submits)
+    {
+        VkSubmitInfo2 submitInfo            = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
+        submitInfo.waitSemaphoreInfoCount   = range.waitCount;
+        submitInfo.pWaitSemaphoreInfos      = m_waitInfos.data() + range.firstWait;
+        submitInfo.commandBufferInfoCount   = range.cmdBufferCount;
+        submitInfo.pCommandBufferInfos      = m_cmdBuffers.data() + range.firstCmdBuffer;
+        submitInfo.signalSemaphoreInfoCount = range.signalCount;
+        submitInfo.pSignalSemaphoreInfos    = m_signalInfos.data() + range.firstSignal;
+
+        m_submitInfos.push_back(submitInfo);
+    }
+
+    if (m_submitInfos.empty() && fence == VK_NULL_HANDLE) return VulkanResult();
+
+    return vkQueueSubmit2(
+        queue,
+        static_cast<uint32_t>(m_submitInfos.size()),
+        m_submitInfos.data(),
+        fence);
+}
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "dusk.h"
+#include "vk.h"
+#include "vk_types.h"
+
+namespace dusk
+{
+/**
+ * @brief Collects submissions of a queue for a frame and submits all of them with
+ * a single vkQueueSubmit2 call. Scratch arrays are kept across frames so building
+ * submissions doesn't allocate in steady state.
+ */
+class VkGfxSubmitBuilder
+{
+public:
+    VkGfxSubmitBuilder()  = default;
+    ~VkGfxSubmitBuilder() = default;
+
+    CLASS_UNCOPYABLE(VkGfxSubmitBuilder);
+
+    /**
+     * @brief Clear recorded submissions, allocated capacity is retained
+     */
+    void reset();
+
+    /**
+     * @brief Start a new submission. Submissions are executed in the order they
+     * are added.
+     */
+    void beginSubmit();
+
+    /**
+     * @brief Add command buffer to the current submission
+     * @param cmdBuffer recorded command buffer
+     */
+    void addCommandBuffer(VkCommandBuffer cmdBuffer);
+
+    /**
+     * @brief Add semaphore wait to the current submission
+     * @param semaphore to wait on
+     * @param value of the timeline semaphore, ignored for binary semaphores
+     * @param stageMask stages which wait for the semaphore
+     */
+    void addWait(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags2 stageMask);
+
+    /**
+     * @brief Add semaphore signal to the current submission
+     * @param semaphore to signal
+     * @param value of the timeline semaphore, ignored for binary semaphores
+     * @param stageMask stages which have to complete before the signal
+     */
+    void addSignal(VkSemaphore semaphore, uint64_t value, VkPipelineStageFlags2 stageMask);
+
+    /**
+     * @brief Check whether a command buffer can be appended to the current
+     * submission without changing its synchronization
+     * @param hasWait whether the command buffer needs a semaphore wait
+     * @return true if the current submission can be reused
+     */
+    bool canAppend(bool hasWait) const;
+
+    /**
+     * @brief Submit all recorded submissions to the queue
+     * @param queue to submit to
+     * @param fence signaled when all the submissions complete, can be null
+     * @return result of the submission
+     */
+    VulkanResult submit(VkQueue queue, VkFence fence);
+
+    bool         isEmpty() const { return m_submits.empty(); }
+
+private:
+    struct SubmitRange
+    {
+        uint32_t firstWait      = 0u;
+        uint32_t waitCount      = 0u;
+        uint32_t firstCmdBuffer = 0u;
+        uint32_t cmdBufferCount = 0u;
+        uint32_t firstSignal    = 0u;
+        uint32_t signalCount    = 0u;
+    };
+
+private:
+    DynamicArray<SubmitRange>               m_submits     = {};
+    DynamicArray<VkSemaphoreSubmitInfo>     m_waitInfos   = {};
+    DynamicArray<VkCommandBufferSubmitInfo> m_cmdBuffers  = {};
+    DynamicArray<VkSemaphoreSubmitInfo>     m_signalInfos = {};
+    DynamicArray<VkSubmitInfo2>             m_submitInfos = {};
+};
+} // namespace dusk
\ No newline at end of file
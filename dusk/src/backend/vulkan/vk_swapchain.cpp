@@ -15,12 +15,15 @@ Error VkGfxSwapChain::create(VulkanContext& vkContext, VkGfxSwapChainParams& par
 
     m_graphicsQueueFamilyIndex = vkContext.graphicsQueueFamilyIndex;
     m_computeQueueFamilyIndex  = vkContext.computeQueueFamilyIndex;
+    m_transferQueueFamilyIndex = vkContext.transferQueueFamilyIndex;
 
     m_graphicsQueue            = vkContext.graphicsQueue;
     m_presentQueue             = vkContext.presentQueue;
     m_computeQueue             = vkContext.computeQueue;
     m_transferQueue            = vkContext.transferQueue;
 
+    m_presentWaitSupported     = vkContext.presentWaitSupported;
+
     m_oldSwapChain             = oldSwapChain;
 
     Error err                  = createSwapChain(params);
@@ -36,10 +39,7 @@ void VkGfxSwapChain::destroy()
 {
     destroyImageViews();
 
-    if (m_oldSwapChain)
-    {
-        m_oldSwapChain->destroy();
-    }
+    destroyOldSwapChain();
 
     // TODO: handle double destroy of swapchain,
     // can trigger after failed image view creation
@@ -56,21 +56,86 @@ VulkanResult VkGfxSwapChain::acquireNextImage(uint32_t frameIndex, uint32_t* ima
             m_device, 1, &m_inFlightFences[frameIndex], VK_TRUE, UINT64_MAX);
     }
 
+    VulkanResult result = vkAcquireNextImageKHR(m_device, m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[frameIndex], VK_NULL_HANDLE, imageIndex);
+
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to acquire swapchain image {}", result.toString());
+    }
+
+    // fence is reset only when this frame is going to be submitted, so draining
+    // frames on recreation never waits on a fence nobody will signal
+    if (result.vkResult == VK_SUCCESS || result.vkResult == VK_SUBOPTIMAL_KHR)
     {
         DUSK_PROFILE_SECTION("reset_fence");
         vkResetFences(m_device, 1, &m_inFlightFences[frameIndex]);
     }
 
-    VulkanResult result = vkAcquireNextImageKHR(m_device, m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[frameIndex], VK_NULL_HANDLE, imageIndex);
+    return result;
+}
 
-    if (result.hasError())
+void VkGfxSwapChain::waitForInFlightFrames() const
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (m_inFlightFences.empty()) return;
+
+    vkWaitForFences(
+        m_device,
+        static_cast<uint32_t>(m_inFlightFences.size()),
+        m_inFlightFences.data(),
+        VK_TRUE,
+        UINT64_MAX);
+}
+
+void VkGfxSwapChain::waitForFrame(uint32_t frameIndex) const
+{
+    DUSK_PROFILE_FUNCTION;
+
+    vkWaitForFences(
+        m_device, 1, &m_inFlightFences[frameIndex], VK_TRUE, UINT64_MAX);
+}
+
+VulkanResult VkGfxSwapChain::waitForLastPresent(uint64_t timeoutNs) const
+{
+    DUSK_PROFILE_FUNCTION;
+
+    // present ids start over with every swapchain
+    if (!m_presentWaitSupported || m_presentId == 0u) return VulkanResult();
+
+    VulkanResult result = vkWaitForPresentKHR(m_device, m_swapChain, m_presentId, timeoutNs);
+
+    // timeout only shortens the wait, out of date is handled by the next acquire
+    if (result.hasError() && result.vkResult != VK_TIMEOUT && result.vkResult != VK_ERROR_OUT_OF_DATE_KHR)
     {
-        DUSK_ERROR("Unable to acquire swapchain image {}", result.toString());
+        DUSK_ERROR("Failed to wait for present {}", result.toString());
     }
 
     return result;
 }
 
+void VkGfxSwapChain::destroyOldSwapChain()
+{
+    if (m_oldSwapChain)
+    {
+        m_oldSwapChain->destroy();
+        m_oldSwapChain = nullptr;
+    }
+}
+
+VkGfxSubmitBuilder& VkGfxSwapChain::getSubmitBuilder(uint32_t queueFamilyIndex)
+{
+    // families shared with other queues are submitted through those queues
+    if (queueFamilyIndex == m_transferQueueFamilyIndex
+        && m_transferQueueFamilyIndex != m_graphicsQueueFamilyIndex
+        && m_transferQueueFamilyIndex != m_computeQueueFamilyIndex)
+    {
+        return m_transferSubmits;
+    }
+
+    return queueFamilyIndex == m_computeQueueFamilyIndex ? m_computeSubmits : m_graphicsSubmits;
+}
+
 VulkanResult VkGfxSwapChain::submitCommandBuffers(
     DynamicArray<VulkanSubmitBatch>& batches,
     uint32_t                         frameIndex,
@@ -78,103 +143,113 @@ VulkanResult VkGfxSwapChain::submitCommandBuffers(
 {
     DUSK_PROFILE_FUNCTION;
 
-    uint32_t    submtiCount          = static_cast<uint32_t>(batches.size());
+    uint32_t    submitCount          = static_cast<uint32_t>(batches.size());
 
     uint32_t    batchTimelineCounter = 0u;
     VkSemaphore timelineSemaphore    = m_submitSemaphores[frameIndex];
 
+    // transfer queue signals its own timeline as its batches are not ordered
+    // with the batches of other queues
+    VkSemaphore transferSemaphore = m_transferSemaphores[frameIndex];
+
     // DUSK_DEBUG("Submitting for frame={}, image={}", frameIndex, imageIndex);
 
     {
         DUSK_PROFILE_SECTION("batch_submits");
 
-        for (uint32_t batchIndex = 0u; batchIndex < submtiCount; ++batchIndex)
-        {
-            auto&                                   batch = batches[batchIndex];
+        m_graphicsSubmits.reset();
+        m_computeSubmits.reset();
+        m_transferSubmits.reset();
 
-            DynamicArray<VkSemaphoreSubmitInfo>     waitSemaphoreSubmitInfos;
-            DynamicArray<VkSemaphoreSubmitInfo>     signalSemaphoreSubmitInfos;
-            DynamicArray<VkCommandBufferSubmitInfo> commandBufferSubmitInfos;
+        for (uint32_t batchIndex = 0u; batchIndex < submitCount; ++batchIndex)
+        {
+            auto&               batch         = batches[batchIndex];
+            bool                isLastBatch   = batchIndex == submitCount - 1;
 
-            waitSemaphoreSubmitInfos.reserve(2u);
-            signalSemaphoreSubmitInfos.reserve(2u);
-            commandBufferSubmitInfos.reserve(2u);
+            VkGfxSubmitBuilder& submitBuilder = getSubmitBuilder(batch.targetQueueFamily);
 
-            VkQueue queue = m_graphicsQueue;
+            // DUSK_DEBUG("[{}] batch {}: global={}, wait={}, signal={}", batch.targetQueueFamily, batchIndex, m_globalTimelineCounter, batch.semaphoreWaitValue, batch.semaphoreSignalValue);
 
-            if (batch.targetQueueFamily == m_computeQueueFamilyIndex)
+            // batches without any synchronization in between share a submission
+            bool hasWait = batch.semaphoreWaitValue > 0 || batch.transferWaitValue > 0 || isLastBatch;
+            if (!submitBuilder.canAppend(hasWait))
             {
-                queue = m_computeQueue;
+                submitBuilder.beginSubmit();
             }
 
-            // DUSK_DEBUG("[{}] Submitting batch {}: present={}", batch.targetQueueFamily, batchIndex, batch.isPresentBatch);
-            // DUSK_DEBUG("[{}] batch {}: global={}, wait={}, signal={}", batch.targetQueueFamily, batchIndex, m_globalTimelineCounter, batch.semaphoreWaitValue, batch.semaphoreSignalValue);
-
             if (batch.semaphoreWaitValue > 0)
             {
-                VkSemaphoreSubmitInfo waitInfo { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
-                waitInfo.semaphore = timelineSemaphore;
-                waitInfo.value     = m_globalTimelineCounter + batch.semaphoreWaitValue;
-                waitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-                waitSemaphoreSubmitInfos.push_back(waitInfo);
+                submitBuilder.addWait(
+                    timelineSemaphore,
+                    m_globalTimelineCounter + batch.semaphoreWaitValue,
+                    VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
             }
 
-            if (batch.semaphoreSignalValue > 0)
+            if (batch.transferWaitValue > 0)
             {
-                VkSemaphoreSubmitInfo signalInfo { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
-                signalInfo.semaphore = timelineSemaphore;
-                signalInfo.value     = m_globalTimelineCounter + batch.semaphoreSignalValue;
-                signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-
-                batchTimelineCounter = std::max(batchTimelineCounter, batch.semaphoreSignalValue);
-
-                signalSemaphoreSubmitInfos.push_back(signalInfo);
+                submitBuilder.addWait(
+                    transferSemaphore,
+                    m_globalTimelineCounter + batch.transferWaitValue,
+                    VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
             }
 
-            VkFence frameFence = VK_NULL_HANDLE;
-            if (batchIndex == submtiCount - 1)
+            if (isLastBatch)
             {
                 // wait on acquire image
-                VkSemaphoreSubmitInfo waitInfo { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
-                waitInfo.semaphore = m_imageAvailableSemaphores[frameIndex];
-                waitInfo.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-                waitSemaphoreSubmitInfos.push_back(waitInfo);
+                submitBuilder.addWait(
+                    m_imageAvailableSemaphores[frameIndex],
+                    0u,
+                    VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+            }
 
-                // add a signal for presentation queue
-                VkSemaphoreSubmitInfo presentSignalInfo { VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO };
-                presentSignalInfo.semaphore = m_renderFinishedSemaphores[frameIndex];
-                presentSignalInfo.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+            submitBuilder.addCommandBuffer(batch.recordedBuffer);
 
-                signalSemaphoreSubmitInfos.push_back(presentSignalInfo);
+            if (batch.semaphoreSignalValue > 0)
+            {
+                submitBuilder.addSignal(
+                    batch.isTransferBatch ? transferSemaphore : timelineSemaphore,
+                    m_globalTimelineCounter + batch.semaphoreSignalValue,
+                    VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT);
 
-                frameFence = m_inFlightFences[frameIndex];
+                batchTimelineCounter = std::max(batchTimelineCounter, batch.semaphoreSignalValue);
             }
 
-            VkCommandBufferSubmitInfo cmdBufferInfo { VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO };
-            cmdBufferInfo.commandBuffer = batch.recordedBuffer;
+            if (isLastBatch)
+            {
+                // add a signal for presentation queue
+                submitBuilder.addSignal(
+                    m_renderFinishedSemaphores[frameIndex],
+                    0u,
+                    VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT);
+            }
+        }
 
-            commandBufferSubmitInfos.push_back(cmdBufferInfo);
+        // Cross queue dependencies are expressed with timeline values, so a wait
+        // may be submitted before its signal. Frame fence goes with the queue
+        // which received the last batch as that batch completes the frame.
+        bool         lastOnCompute = submitCount > 0 && batches[submitCount - 1].targetQueueFamily == m_computeQueueFamilyIndex;
+        VkFence      frameFence    = m_inFlightFences[frameIndex];
 
-            VkSubmitInfo2 submitInfo            = { VK_STRUCTURE_TYPE_SUBMIT_INFO_2 };
-            submitInfo.waitSemaphoreInfoCount   = waitSemaphoreSubmitInfos.size();
-            submitInfo.pWaitSemaphoreInfos      = waitSemaphoreSubmitInfos.data();
-            submitInfo.commandBufferInfoCount   = commandBufferSubmitInfos.size();
-            submitInfo.pCommandBufferInfos      = commandBufferSubmitInfos.data();
-            submitInfo.signalSemaphoreInfoCount = signalSemaphoreSubmitInfos.size();
-            submitInfo.pSignalSemaphoreInfos    = signalSemaphoreSubmitInfos.data();
+        // transfer batches never complete the frame, their consumers wait on them
+        VulkanResult result        = m_transferSubmits.submit(m_transferQueue, VK_NULL_HANDLE);
+        if (result.hasError())
+        {
+            DUSK_ERROR("Failed to submit batches to transfer queue: {}", result.toString());
+            return result;
+        }
 
-            // submit to corresponding queue
-            VulkanResult result = vkQueueSubmit2(
-                queue,
-                1u,
-                &submitInfo,
-                frameFence);
+        result = m_computeSubmits.submit(m_computeQueue, lastOnCompute ? frameFence : VK_NULL_HANDLE);
+        if (result.hasError())
+        {
+            DUSK_ERROR("Failed to submit batches to compute queue: {}", result.toString());
+            return result;
+        }
 
-            if (result.hasError())
-            {
-                DUSK_ERROR("Failed to submit batch to queue family {}: {}", batch.targetQueueFamily, result.toString());
-                return result;
-            }
+        result = m_graphicsSubmits.submit(m_graphicsQueue, lastOnCompute ? VK_NULL_HANDLE : frameFence);
+        if (result.hasError())
+        {
+            DUSK_ERROR("Failed to submit batches to graphics queue: {}", result.toString());
+            return result;
         }
     }
 
@@ -197,9 +272,22 @@ VulkanResult VkGfxSwapChain::submitCommandBuffers(
 
         presentInfo.pImageIndices           = &imageIndex;
 
+        // tag presents so that frame pacing can wait for them
+        VkPresentIdKHR presentIdInfo = { VK_STRUCTURE_TYPE_PRESENT_ID_KHR };
+        uint64_t       presentId     = m_presentId + 1u;
+        if (m_presentWaitSupported)
+        {
+            presentIdInfo.swapchainCount = 1u;
+            presentIdInfo.pPresentIds    = &presentId;
+            presentInfo.pNext            = &presentIdInfo;
+        }
+
         // present image
         result = vkQueuePresentKHR(m_presentQueue, &presentInfo);
 
+        // id is consumed even if present reports an error
+        if (m_presentWaitSupported) m_presentId = presentId;
+
         if (result.hasError())
         {
             DUSK_ERROR("Failed to present image {}", result.toString());
@@ -388,6 +476,7 @@ Error VkGfxSwapChain::createSyncObjects()
     m_imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     m_renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     m_submitSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
+    m_transferSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
     m_inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
 
     VkSemaphoreCreateInfo semaphoreInfo {};
@@ -430,6 +519,13 @@ Error VkGfxSwapChain::createSyncObjects()
             return result.getErrorId();
         }
 
+        result = vkCreateSemaphore(m_device, &submiSemaphoreCreateInfo, nullptr, &m_transferSemaphores[i]);
+        if (result.hasError())
+        {
+            DUSK_ERROR("Unable to create transfer timeline semaphores {}", result.toString());
+            return result.getErrorId();
+        }
+
         result = vkCreateFence(m_device, &fenceInfo, nullptr, &m_inFlightFences[i]);
         if (result.hasError())
         {
@@ -448,11 +544,13 @@ void VkGfxSwapChain::destroySyncObjects()
         vkDestroySemaphore(m_device, m_imageAvailableSemaphores[i], nullptr);
         vkDestroySemaphore(m_device, m_renderFinishedSemaphores[i], nullptr);
         vkDestroySemaphore(m_device, m_submitSemaphores[i], nullptr);
+        vkDestroySemaphore(m_device, m_transferSemaphores[i], nullptr);
         vkDestroyFence(m_device, m_inFlightFences[i], nullptr);
     }
     m_imageAvailableSemaphores.clear();
     m_renderFinishedSemaphores.clear();
     m_submitSemaphores.clear();
+    m_transferSemaphores.clear();
     m_inFlightFences.clear();
 }
 
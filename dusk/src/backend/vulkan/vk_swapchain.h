@@ -3,6 +3,7 @@
 #include "dusk.h"
 #include "vk.h"
 #include "vk_types.h"
+#include "vk_submit_builder.h"
 
 namespace dusk
 {
@@ -24,6 +25,35 @@ public:
         uint32_t                         frameIndex,
         uint32_t                         imageIndex);
 
+    /**
+     * @brief Wait for fences of all the frames submitted through this swapchain
+     */
+    void waitForInFlightFrames() const;
+
+    /**
+     * @brief Wait for the fence of a frame slot
+     * @param frameIndex of the frame slot
+     */
+    void waitForFrame(uint32_t frameIndex) const;
+
+    /**
+     * @brief Wait until the last queued image of this swapchain is presented.
+     * Returns immediately when present wait is not supported.
+     * @param timeoutNs maximum wait in nanoseconds
+     * @return result of the wait, VK_TIMEOUT if image was not presented in time
+     */
+    VulkanResult waitForLastPresent(uint64_t timeoutNs) const;
+
+    bool         supportsPresentWait() const { return m_presentWaitSupported; }
+
+    /**
+     * @brief Destroy the swapchain retired by this one. Presents queued on the
+     * retired swapchain should have finished before calling.
+     */
+    void destroyOldSwapChain();
+
+    bool hasOldSwapChain() const { return m_oldSwapChain != nullptr; }
+
     VkSwapchainKHR getVkSwapChain() const { return m_swapChain; }
     uint32_t       getImagesCount() const { return m_imagesCount; }
     VkExtent2D     getCurrentExtent() const { return m_currentExtent; }
@@ -46,6 +76,9 @@ private:
     VkExtent2D         getSwapExtent(uint32_t width, uint32_t height) const;
     VkFormat           findDepthFormat();
 
+    // builder of the queue which executes batches of the given family
+    VkGfxSubmitBuilder& getSubmitBuilder(uint32_t queueFamilyIndex);
+
 private:
     VkPhysicalDevice          m_physicalDevice           = VK_NULL_HANDLE;
     VkDevice                  m_device                   = VK_NULL_HANDLE;
@@ -65,17 +98,27 @@ private:
 
     uint32_t                  m_globalTimelineCounter    = 0u;
 
+    bool                      m_presentWaitSupported     = false;
+    uint64_t                  m_presentId                = 0u;
+
     DynamicArray<VkSemaphore> m_imageAvailableSemaphores = {};
     DynamicArray<VkSemaphore> m_renderFinishedSemaphores = {};
     DynamicArray<VkSemaphore> m_submitSemaphores         = {};
+    DynamicArray<VkSemaphore> m_transferSemaphores       = {};
     DynamicArray<VkFence>     m_inFlightFences           = {};
 
     uint32_t                  m_graphicsQueueFamilyIndex = 0u;
     uint32_t                  m_computeQueueFamilyIndex  = 0u;
+    uint32_t                  m_transferQueueFamilyIndex = 0u;
 
     VkQueue                   m_graphicsQueue            = VK_NULL_HANDLE;
     VkQueue                   m_presentQueue             = VK_NULL_HANDLE;
     VkQueue                   m_computeQueue             = VK_NULL_HANDLE;
     VkQueue                   m_transferQueue            = VK_NULL_HANDLE;
+
+    // per queue submissions of a frame, reused across frames
+    VkGfxSubmitBuilder        m_graphicsSubmits;
+    VkGfxSubmitBuilder        m_computeSubmits;
+    VkGfxSubmitBuilder        m_transferSubmits;
 };
 } // namespace dusk
\ No newline at end of file
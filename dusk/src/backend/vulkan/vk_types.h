@@ -5,6 +5,8 @@
 
 namespace dusk
 {
+class VkGfxPipelineCache;
+
 // TODO:: check if synchronization is required for vmaAllocation access
 struct VulkanGPUAllocator
 {
@@ -47,7 +49,9 @@ struct VulkanSubmitBatch
     uint32_t        targetQueueFamily;
     uint32_t        semaphoreWaitValue;
     uint32_t        semaphoreSignalValue;
-    bool            isPresentBatch = false; // for sync with presentation engine
+    bool            isPresentBatch    = false; // for sync with presentation engine
+    bool            isTransferBatch   = false; // signals transfer timeline instead of the frame timeline
+    uint32_t        transferWaitValue = 0u;    // transfer timeline value to wait on before execution
 };
 
 struct VulkanContext
@@ -59,6 +63,7 @@ struct VulkanContext
 
     VkCommandPool              commandPool;
     VkCommandPool              transferCommandPool;
+    VkCommandPool              computeCommandPool;
 
     VkPhysicalDeviceProperties physicalDeviceProperties;
     VkPhysicalDeviceFeatures   physicalDeviceFeatures;
@@ -74,6 +79,14 @@ struct VulkanContext
     VkQueue                    transferQueue;
 
     VulkanGPUAllocator*        gpuAllocator;
+    VkGfxPipelineCache*        pipelineCache;
+
+    // VK_KHR_present_id and VK_KHR_present_wait are enabled
+    bool                       presentWaitSupported;
+
+    // VK_EXT_descriptor_buffer and buffer device address are enabled
+    bool                                       descriptorBufferSupported;
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptorBufferProperties;
 };
 
 struct VulkanSampler
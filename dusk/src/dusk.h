@@ -11,7 +11,10 @@
 
 #include <glm/glm.hpp>
 
-#define MAX_FRAMES_IN_FLIGHT 2
+// per frame resources are allocated for MAX_FRAMES_IN_FLIGHT frames, count of
+// frames actually in flight is a runtime setting of the renderer
+#define MAX_FRAMES_IN_FLIGHT     3
+#define DEFAULT_FRAMES_IN_FLIGHT 2
 
 #ifdef DDEBUG // Dusk Debug
 #    define ENABLE_ASSERT
@@ -11,6 +11,7 @@
 #include "scene/scene.h"
 #include "scene/transform_system.h"
 #include "scene/components/camera.h"
+#include "scene/components/lights.h"
 
 #include "events/event.h"
 #include "events/app_event.h"
@@ -18,18 +19,56 @@
 #include "backend/vulkan/vk_device.h"
 #include "backend/vulkan/vk_renderer.h"
 #include "backend/vulkan/vk_descriptors.h"
+#include "backend/vulkan/vk_bindless_heap.h"
 
 #include "renderer/material.h"
 #include "renderer/texture.h"
 #include "renderer/texture_db.h"
+#include "renderer/staging_ring.h"
 #include "renderer/environment.h"
 #include "renderer/systems/lights_system.h"
 #include "renderer/render_graph.h"
 #include "renderer/passes/render_passes.h"
 #include "renderer/geometry/frustum.h"
 
+#include <thread>
+#include <algorithm>
+
 namespace dusk
 {
+// length of the sub-pixel jitter sequence of temporal upscaling
+static constexpr uint32_t TAA_JITTER_SAMPLES = 16u;
+
+// radical inverse of the index in the given base
+static float halton(uint32_t index, uint32_t base)
+{
+    float result   = 0.f;
+    float fraction = 1.f;
+
+    while (index > 0u)
+    {
+        fraction /= static_cast<float>(base);
+        result   += fraction * static_cast<float>(index % base);
+        index    /= base;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Get the jitter of a frame from the 2-3 halton sequence
+ * @param frame counter of the frame
+ * @param renderExtent drawn region of the jittered render targets
+ * @return offset within a render pixel in normalized device coordinates
+ */
+static glm::vec2 getJitterOffset(uint64_t frame, VkExtent2D renderExtent)
+{
+    uint32_t  sampleIdx   = static_cast<uint32_t>(frame % TAA_JITTER_SAMPLES) + 1u;
+    glm::vec2 pixelOffset = { halton(sampleIdx, 2u) - 0.5f, halton(sampleIdx, 3u) - 0.5f };
+
+    return 2.f * pixelOffset / glm::vec2(renderExtent.width, renderExtent.height);
+}
+
 Engine* Engine::s_instance = nullptr;
 
 Engine::Engine(const Engine::Config& config) :
@@ -77,6 +116,21 @@ bool Engine::start(Shared<Application> app)
         return false;
     }
 
+    m_renderer->setFramesInFlight(m_config.framesInFlight);
+    m_renderer->setLowLatencyMode(m_config.lowLatencyMode);
+    m_targetFrameTime   = m_config.targetFrameTime;
+    m_tiledLighting     = m_config.tiledLighting;
+    m_visibilityBuffer  = m_config.visibilityBuffer;
+    m_compactGBuffer    = m_config.compactGBuffer;
+    m_temporalUpscaling = m_config.temporalUpscaling;
+    m_renderScale       = std::clamp(m_config.renderScale, MIN_RENDER_SCALE, 1.f);
+    m_dynamicResolution = m_config.dynamicResolution;
+    m_autoExposure      = m_config.autoExposure;
+
+    // dynamic resolution starts at the highest quality within its bounds
+    m_resolutionController.init(m_config.resolutionControl);
+    if (m_dynamicResolution) setRenderScale(m_resolutionController.getSettings().renderScale);
+
     m_transformSystem = createUnique<TransformSystem>();
     if (!m_transformSystem->init(MAX_RENDERABLES_COUNT))
     {
@@ -115,8 +169,10 @@ bool Engine::start(Shared<Application> app)
     }
 
     m_environment = createUnique<Environment>(*m_textureDB);
-    // if (!m_environment->initHW(*m_globalDescriptorSetLayout, m_renderer->getMaxFramesCount()))
-    if (!m_environment->init(*m_globalDescriptorSetLayout))
+
+    // dynamic sky retires its maps only after all frames in flight stopped reading them
+    bool envStarted = m_config.dynamicSky ? m_environment->initHW(*m_globalDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT) : m_environment->init(*m_globalDescriptorSetLayout);
+    if (!envStarted)
     {
         DUSK_ERROR("Unable to init environment");
         return false;
@@ -135,6 +191,11 @@ void Engine::run()
     {
         DUSK_PROFILE_FRAME;
 
+        limitFrameRate(m_lastFrameTime);
+
+        // in low latency mode CPU sleeps here so that input is sampled as late as possible
+        m_renderer->waitBeforeInputSampling();
+
         TimePoint newTime = Time::now();
         m_deltaTime       = newTime - m_lastFrameTime;
         m_lastFrameTime   = newTime;
@@ -152,6 +213,29 @@ void Engine::run()
 
 void Engine::stop() { m_running = false; }
 
+void Engine::limitFrameRate(TimePoint frameStartTime)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (m_targetFrameTime.count() <= 0.f) return;
+
+    // OS sleep is coarse, last stretch before the target is spent yielding
+    constexpr auto spinThreshold = std::chrono::milliseconds(2);
+    TimePoint      targetTime    = frameStartTime + std::chrono::duration_cast<Time::duration>(m_targetFrameTime);
+
+    for (auto remaining = targetTime - Time::now(); remaining > Time::duration::zero(); remaining = targetTime - Time::now())
+    {
+        if (remaining > spinThreshold)
+        {
+            std::this_thread::sleep_for(remaining - spinThreshold);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
 void Engine::shutdown()
 {
     m_renderer->deviceWaitIdle();
@@ -175,6 +259,8 @@ void Engine::shutdown()
     m_textureDB->cleanup();
     m_textureDB = nullptr;
 
+    VkGfxBindlessHeap::resetDescriptorReservations();
+
     m_renderer->cleanup();
     m_gfxDevice->cleanupGfxDevice();
 
@@ -193,11 +279,36 @@ void Engine::onUpdate(TimeStep dt)
     if (auto commandBufferPools = m_renderer->beginFrame();
         commandBufferPools.graphicsPool != nullptr && commandBufferPools.computePool != nullptr)
     {
+        ++m_frameCounter;
+        releasePendingGeometry();
+        releasePendingTextures();
+
         m_statsRecorder->beginFrame();
 
         m_statsRecorder->recordCpuFrameTime(m_deltaTime);
 
-        auto      extent = m_renderer->getSwapChain().getCurrentExtent();
+        // quality follows the smoothed gpu time of the frames which already finished
+        if (m_dynamicResolution && m_resolutionController.update(m_statsRecorder->getAggregateStats().emaGpuTimeNs))
+        {
+            applyResolutionSettings(m_resolutionController.getSettings());
+        }
+
+        auto       extent       = m_renderer->getSwapChain().getCurrentExtent();
+        VkExtent2D renderExtent = getScaledRenderExtent(extent);
+
+        // swapchain was recreated, targets follow lazily on the first frame at new size
+        if (extent.width != m_rgResources.outputExtent.width || extent.height != m_rgResources.outputExtent.height)
+        {
+            resizeRenderTargets(extent, renderExtent);
+        }
+        else
+        {
+            // targets are allocated at output size, render scale only shrinks the drawn region
+            m_rgResources.renderExtent = renderExtent;
+        }
+
+        // previous submission of this frame index has finished
+        m_textureDB->applyDescriptorBufferWrites(currentFrameIndex);
 
         FrameData frameData {
             currentFrameIndex,
@@ -209,16 +320,19 @@ void Engine::onUpdate(TimeStep dt)
             &m_frameRenderables[currentFrameIndex],
             m_globalDescriptorSet->set,
             m_textureDB->getTexturesDescriptorSet().set,
-            m_lightsSystem->getLightsDescriptorSet().set,
-            m_materialsDescriptorSet->set,
+            m_textureDB->getStorageTexturesDescriptorSet().set,
+            m_lightsSystem->getLightsDescriptorSet(currentFrameIndex).set,
+            m_materialsDescriptorSets[currentFrameIndex]->set,
             m_meshDataDescriptorSet->set,
-            m_renderableDescriptorSets[currentFrameIndex]->set
+            m_renderableDescriptorSet->set
         };
 
         if (m_currentScene)
         {
             DUSK_PROFILE_SECTION("scene_updates");
 
+            m_frameUploadArena.beginFrame(currentFrameIndex);
+
             m_currentScene->onUpdate(dt);
 
             m_transformSystem->updateDirtyMatrices();
@@ -227,15 +341,30 @@ void Engine::onUpdate(TimeStep dt)
 
             CameraComponent& camera = m_currentScene->getMainCamera();
             camera.setAspectRatio(m_renderer->getAspectRatio());
+            camera.setJitter(m_temporalUpscaling ? getJitterOffset(m_frameCounter, renderExtent) : glm::vec2 { 0.f });
 
-            Frustum cameraFrustum = extractFrustumFromMatrix(
-                camera.projectionMatrix * camera.viewMatrix);
+            // culling uses the unjittered projection
+            glm::mat4 viewProjection = camera.projectionMatrix * camera.viewMatrix;
+            Frustum   cameraFrustum  = extractFrustumFromMatrix(viewProjection);
+
+            // first frame has no previous view, reprojection falls back to the current one
+            if (!m_hasPrevViewProjection)
+            {
+                m_prevViewProjection    = viewProjection;
+                m_hasPrevViewProjection = true;
+            }
 
             GlobalUbo ubo {};
-            ubo.view              = camera.viewMatrix;
-            ubo.prjoection        = camera.projectionMatrix;
-            ubo.inverseView       = glm::inverse(camera.viewMatrix);
-            ubo.inverseProjection = camera.inverseProjectionMatrix;
+            ubo.view               = camera.viewMatrix;
+            ubo.prjoection         = camera.jitteredProjectionMatrix;
+            ubo.inverseView        = glm::inverse(camera.viewMatrix);
+            ubo.inverseProjection  = camera.inverseJitteredProjectionMatrix;
+            ubo.viewProjection     = viewProjection;
+            ubo.prevViewProjection = m_prevViewProjection;
+            ubo.jitter             = glm::vec4(camera.jitter, 0.f, 0.f);
+            ubo.textureLodBias     = m_textureLodBias + (m_temporalUpscaling ? glm::log2(m_renderScale) : 0.f); // upscaled frames keep the texture detail of the output
+
+            m_prevViewProjection   = viewProjection;
 
             ubo.frustumPlanes[0]  = cameraFrustum.left.toVec4();
             ubo.frustumPlanes[1]  = cameraFrustum.right.toVec4();
@@ -244,37 +373,41 @@ void Engine::onUpdate(TimeStep dt)
             ubo.frustumPlanes[4]  = cameraFrustum.near.toVec4();
             ubo.frustumPlanes[5]  = cameraFrustum.far.toVec4();
 
-            m_lightsSystem->updateLights(*m_currentScene, ubo);
-
-            m_globalUbos.writeAndFlushAtIndex(currentFrameIndex, &ubo, sizeof(GlobalUbo));
-
-            // write all renderables data
-            m_modelMatrixBuffers[currentFrameIndex].writeAndFlush(
-                0,
-                m_frameRenderables[currentFrameIndex].modelMatrices.data(),
-                m_frameRenderables[currentFrameIndex].modelMatrices.size() * sizeof(glm::mat4));
-            m_normalMatrixBuffers[currentFrameIndex].writeAndFlush(
-                0,
-                m_frameRenderables[currentFrameIndex].normalMatrices.data(),
-                m_frameRenderables[currentFrameIndex].normalMatrices.size() * sizeof(glm::mat4));
-            m_boundingBoxBuffers[currentFrameIndex].writeAndFlush(
-                0,
-                m_frameRenderables[currentFrameIndex].boundingBoxes.data(),
-                m_frameRenderables[currentFrameIndex].boundingBoxes.size() * sizeof(GfxBoundingBoxData));
-            m_meshIdsBuffers[currentFrameIndex].writeAndFlush(
-                0,
-                m_frameRenderables[currentFrameIndex].meshIds.data(),
-                m_frameRenderables[currentFrameIndex].meshIds.size() * sizeof(uint32_t));
-            m_materialIdsBuffers[currentFrameIndex].writeAndFlush(
-                0,
-                m_frameRenderables[currentFrameIndex].materialIds.data(),
-                m_frameRenderables[currentFrameIndex].materialIds.size() * sizeof(uint32_t));
-
-            updateMaterialsBuffer(m_currentScene->getMaterials());
+            m_lightsSystem->updateLights(*m_currentScene, ubo, m_frameUploadArena, currentFrameIndex);
+
+            memcpy(m_frameUploadArena.getReservedBlock(currentFrameIndex).data, &ubo, sizeof(GlobalUbo));
+
+            // write all renderables data in place, passes bind the set with their offsets
+            GfxRenderables&                    renderables = m_frameRenderables[currentFrameIndex];
+            std::array<GfxUploadAllocation, 6> renderablesUploads {
+                m_frameUploadArena.upload(renderables.modelMatrices.data(), renderables.modelMatrices.size() * sizeof(glm::mat4)),
+                m_frameUploadArena.upload(renderables.normalMatrices.data(), renderables.normalMatrices.size() * sizeof(glm::mat4)),
+                m_frameUploadArena.upload(renderables.boundingBoxes.data(), renderables.boundingBoxes.size() * sizeof(GfxBoundingBoxData)),
+                m_frameUploadArena.upload(renderables.meshIds.data(), renderables.meshIds.size() * sizeof(uint32_t)),
+                m_frameUploadArena.upload(renderables.materialIds.data(), renderables.materialIds.size() * sizeof(uint32_t)),
+                m_frameUploadArena.upload(renderables.prevModelMatrices.data(), renderables.prevModelMatrices.size() * sizeof(glm::mat4))
+            };
+
+            for (uint32_t bindingIndex = 0u; bindingIndex < renderablesUploads.size(); ++bindingIndex)
+            {
+                DASSERT(renderablesUploads[bindingIndex].isValid(), "upload arena is too small for renderables");
+                renderables.bufferOffsets[bindingIndex] = static_cast<uint32_t>(renderablesUploads[bindingIndex].offset);
+            }
+
+            updateMaterialsBuffer(*m_currentScene, currentFrameIndex);
+
+            // single flush for all the host writes of the frame
+            m_frameUploadArena.flush();
         }
 
+        // slices of the sky maps rebuilt in this frame
+        m_environment->update();
+
         auto batches = renderFrame(frameData);
-        
+
+        // copies are recorded in the frame command buffers by now
+        m_transferScheduler.clear();
+
         m_statsRecorder->recordGpuMemoryUsage(m_gfxDevice->getGPUAllocator());
 
         m_renderer->endFrame(batches);
@@ -286,6 +419,8 @@ void Engine::onUpdate(TimeStep dt)
         m_frameRenderables[currentFrameIndex].boundingBoxes.clear();
         m_frameRenderables[currentFrameIndex].meshIds.clear();
         m_frameRenderables[currentFrameIndex].materialIds.clear();
+        m_frameRenderables[currentFrameIndex].prevModelMatrices.clear();
+        m_frameRenderables[currentFrameIndex].staticFlags.clear();
     }
 }
 
@@ -296,6 +431,12 @@ void Engine::onEvent(Event& ev)
     dispatcher.dispatch<KeyPressedEvent>(
         [this](KeyPressedEvent& ev)
         {
+            if (ev.getKeyCode() == Key::F5)
+            {
+                setAutoExposureEnabled(!m_autoExposure);
+                DUSK_INFO("Auto exposure {}", m_autoExposure ? "enabled" : "disabled");
+            }
+
             if (ev.getKeyCode() == Key::F6)
             {
                 m_dumpFrameRenderGraph = true;
@@ -306,6 +447,37 @@ void Engine::onEvent(Event& ev)
                 m_statsRecorder->dumpGpuFrameTimeHistory("gpu_frame_history.txt", MAX_FRAMES_IN_FLIGHT * 2);
             }
 
+            if (ev.getKeyCode() == Key::F8)
+            {
+                m_tiledLighting = !m_tiledLighting;
+                DUSK_INFO("Switched to {} lighting path", m_tiledLighting ? "tiled compute" : "clustered fragment");
+            }
+
+            if (ev.getKeyCode() == Key::F9)
+            {
+                m_visibilityBuffer = !m_visibilityBuffer;
+                DUSK_INFO("Switched to {} geometry path", m_visibilityBuffer ? "visibility buffer" : "g-buffer");
+            }
+
+            if (ev.getKeyCode() == Key::F10)
+            {
+                m_compactGBuffer = !m_compactGBuffer;
+                DUSK_INFO("Switched to {} g-buffer layout", m_compactGBuffer ? "compact" : "full");
+            }
+
+            if (ev.getKeyCode() == Key::F11)
+            {
+                setTemporalUpscalingEnabled(!m_temporalUpscaling);
+                DUSK_INFO("Temporal upscaling {}", m_temporalUpscaling ? "enabled" : "disabled");
+            }
+
+            // F12 is left to the RenderDoc capture key
+            if (ev.getKeyCode() == Key::F3)
+            {
+                setDynamicResolutionEnabled(!m_dynamicResolution);
+                DUSK_INFO("Dynamic resolution {}", m_dynamicResolution ? "enabled" : "disabled");
+            }
+
             return false;
         });
 
@@ -358,6 +530,13 @@ void Engine::loadScene(Scene* scene)
     m_currentScene = scene;
     registerMaterials(scene->getMaterials());
 
+    // buffers may hold materials of a previous scene
+    for (auto& pendingIds : m_pendingMaterialIds)
+    {
+        pendingIds.clear();
+    }
+    scene->markAllMaterialsDirty();
+
     {
         DUSK_PROFILE_SECTION("mesh_data_buffer_update");
         // TODO: do something about public m_sceneMeshes access
@@ -378,6 +557,45 @@ void Engine::loadScene(Scene* scene)
     }
 
     m_lightsSystem->registerAllLights(*scene);
+
+    // meshes with too many triangles fall back to the g-buffer path
+    m_visibilityIdsFit = fitsVisibilityIds(scene->m_sceneMeshes);
+}
+
+void Engine::unloadScene(Scene* scene)
+{
+    if (m_currentScene == scene)
+    {
+        m_currentScene = nullptr;
+
+        for (auto& pendingIds : m_pendingMaterialIds)
+        {
+            pendingIds.clear();
+        }
+    }
+
+    // scene can be destroyed right after, ranges are reused once frames in flight finish
+    for (GfxGeometryAllocation* allocation : { &scene->m_geometryAllocation, &scene->m_packedGeometryAllocation })
+    {
+        if (allocation->vertexCount > 0 || allocation->indexCount > 0)
+        {
+            releaseVertexAndIndexBuffers(*allocation);
+        }
+
+        *allocation = { .format = allocation->format };
+    }
+
+    // each texture slot of a material holds a texture reference
+    for (const Material& material : scene->getMaterials())
+    {
+        for (int32_t textureId : { material.albedoTexId, material.normalTexId, material.metallicRoughnessTexId, material.aoTexId, material.emissiveTexId })
+        {
+            if (textureId > 0)
+            {
+                m_textureDB->releaseTexture(static_cast<uint32_t>(textureId));
+            }
+        }
+    }
 }
 
 DynamicArray<VulkanSubmitBatch> Engine::renderFrame(FrameData& frameData)
@@ -397,35 +615,112 @@ DynamicArray<VulkanSubmitBatch> Engine::renderFrame(FrameData& frameData)
         .name    = "dir_shadow_map",
         .texture = m_textureDB->getTexture(m_rgResources.dirShadowMapsTextureId)
     };
+    RGImageResource localShadowStaticAtlas = {
+        .name             = "local_shadow_static_atlas",
+        .texture          = m_textureDB->getTexture(m_rgResources.localShadowStaticAtlasTextureId),
+        .preserveContents = true
+    };
+    RGImageResource localShadowAtlas = {
+        .name    = "local_shadow_atlas",
+        .texture = m_textureDB->getTexture(m_rgResources.localShadowAtlasTextureId)
+    };
     RGImageResource gbuffDepth = {
-        .name    = "gbuff_depth",
-        .texture = m_textureDB->getTexture(m_rgResources.gbuffDepthTextureId)
+        .name       = "gbuff_depth",
+        .texture    = m_textureDB->getTexture(m_rgResources.gbuffDepthTextureId),
+        .renderArea = m_rgResources.renderExtent
     };
     RGImageResource gbuffAlbedo = {
-        .name    = "gbuff_albedo",
-        .texture = m_textureDB->getTexture(m_rgResources.gbuffRenderTextureIds[0])
+        .name       = "gbuff_albedo",
+        .texture    = m_textureDB->getTexture(m_rgResources.gbuffRenderTextureIds[0]),
+        .renderArea = m_rgResources.renderExtent
     };
     RGImageResource gbuffNormal = {
-        .name    = "gbuff_normal",
-        .texture = m_textureDB->getTexture(m_rgResources.gbuffRenderTextureIds[1])
+        .name       = "gbuff_normal",
+        .texture    = m_textureDB->getTexture(m_rgResources.gbuffRenderTextureIds[1]),
+        .renderArea = m_rgResources.renderExtent
     };
     RGImageResource gbuffAoMR = {
-        .name    = "gbuff_ao_metallic_roughness",
-        .texture = m_textureDB->getTexture(m_rgResources.gbuffRenderTextureIds[2])
+        .name       = "gbuff_ao_metallic_roughness",
+        .texture    = m_textureDB->getTexture(m_rgResources.gbuffRenderTextureIds[2]),
+        .renderArea = m_rgResources.renderExtent
     };
     RGImageResource gbuffEmissive = {
-        .name    = "gbuff_emissive",
-        .texture = m_textureDB->getTexture(m_rgResources.gbuffRenderTextureIds[3])
+        .name       = "gbuff_emissive",
+        .texture    = m_textureDB->getTexture(m_rgResources.gbuffRenderTextureIds[3]),
+        .renderArea = m_rgResources.renderExtent
+    };
+    RGImageResource gbuffCompactNormal = {
+        .name       = "gbuff_compact_normal",
+        .texture    = m_textureDB->getTexture(m_rgResources.gbuffCompactNormalTextureId),
+        .renderArea = m_rgResources.renderExtent
+    };
+    RGImageResource gbuffVelocity = {
+        .name       = "gbuff_velocity",
+        .texture    = m_textureDB->getTexture(m_rgResources.velocityTextureId),
+        .renderArea = m_rgResources.renderExtent
+    };
+    RGImageResource visibilityIds = {
+        .name       = "visibility_ids",
+        .texture    = m_textureDB->getTexture(m_rgResources.visibilityTextureId),
+        .renderArea = m_rgResources.renderExtent
     };
     RGImageResource lightingOutput = {
-        .name    = "lighting_output",
-        .texture = m_textureDB->getTexture(m_rgResources.lightingRenderTextureId)
+        .name       = "lighting_output",
+        .texture    = m_textureDB->getTexture(m_rgResources.lightingRenderTextureId),
+        .renderArea = m_rgResources.renderExtent
+    };
+    RGImageResource taaHistories[] = {
+        { .name             = "taa_history_0",
+          .texture          = m_textureDB->getTexture(m_rgResources.taaHistoryTextureIds[0]),
+          .preserveContents = true },
+        { .name             = "taa_history_1",
+          .texture          = m_textureDB->getTexture(m_rgResources.taaHistoryTextureIds[1]),
+          .preserveContents = true }
+    };
+    RGImageResource exposureHistogram = {
+        .name             = "exposure_histogram",
+        .texture          = m_textureDB->getTexture(m_rgResources.exposureHistogramTextureId),
+        .preserveContents = true
+    };
+    RGImageResource exposure = {
+        .name             = "exposure",
+        .texture          = m_textureDB->getTexture(m_rgResources.exposureTextureId),
+        .preserveContents = true
     };
     RGImageResource toneMappedOutput = {
         .name    = "tonemap_output",
         .texture = m_textureDB->getTexture(m_rgResources.toneMappedRenderTextureId)
     };
 
+    // maps of the dynamic sky, lighting reads the active slot while the other one
+    // is rebuilt. Contents of a retired slot are discarded, so its first write on
+    // compute queue doesn't acquire it from graphics queue.
+    bool            dynamicSky                         = m_environment->isDynamicSky();
+    RGImageResource envSkyMaps[IBL_SLOT_COUNT]         = {};
+    RGImageResource envIrradianceMaps[IBL_SLOT_COUNT]  = {};
+    RGImageResource envPrefilteredMaps[IBL_SLOT_COUNT] = {};
+
+    for (uint32_t slot = 0u; dynamicSky && slot < IBL_SLOT_COUNT; ++slot)
+    {
+        envSkyMaps[slot] = {
+            .name             = std::format("env_sky_{}", slot),
+            .texture          = m_textureDB->getTexture(m_environment->getSkyTextureId(slot)),
+            .preserveContents = true
+        };
+        envIrradianceMaps[slot] = {
+            .name             = std::format("env_irradiance_{}", slot),
+            .texture          = m_textureDB->getTexture(m_environment->getSkyIrradianceTextureId(slot)),
+            .preserveContents = true
+        };
+        envPrefilteredMaps[slot] = {
+            .name             = std::format("env_prefiltered_{}", slot),
+            .texture          = m_textureDB->getTexture(m_environment->getSkyPrefilteredTextureId(slot)),
+            .preserveContents = true
+        };
+    }
+
+    uint32_t activeEnvSlot = m_environment->getActiveSlot();
+
     RGBufferResource indirectDrawCommandsBuffer = {
         .name   = "indirect_draw_commands_buffer",
         .buffer = &m_rgResources.frameIndirectDrawCommandsBuffers[frameData.frameIndex]
@@ -435,6 +730,29 @@ DynamicArray<VulkanSubmitBatch> Engine::renderFrame(FrameData& frameData)
         .buffer = &m_rgResources.frameIndirectDrawCountBuffers[frameData.frameIndex]
     };
 
+    RGBufferResource lightClustersBuffer = {
+        .name   = "light_clusters_buffer",
+        .buffer = &m_rgResources.frameLightClustersBuffers[frameData.frameIndex]
+    };
+    RGBufferResource clusterLightIndicesBuffer = {
+        .name   = "cluster_light_indices_buffer",
+        .buffer = &m_rgResources.frameClusterLightIndicesBuffers[frameData.frameIndex]
+    };
+
+    RGBufferResource materialsBuffer = {
+        .name   = "materials_buffer",
+        .buffer = &m_materialsBuffers[frameData.frameIndex]
+    };
+
+    // streaming uploads run on the transfer queue, only their consumers wait for them
+    uint32_t materialsBufferVer = 0u;
+    if (m_transferScheduler.hasUploads())
+    {
+        auto uploadPassId  = renderGraph.addPass("upload_pass", RGQueueFamilyType::Transfer, recordTransferUploadCmds);
+
+        materialsBufferVer = renderGraph.addWriteResource(uploadPassId, materialsBuffer);
+    }
+
     auto     cullPassId                 = renderGraph.addPass("cull_lod_pass", RGQueueFamilyType::Compute, dispatchIndirectDrawCompute);
     uint32_t indirectBufferVersion      = renderGraph.addWriteResource(cullPassId, indirectDrawCommandsBuffer);
     uint32_t indirectCountBufferVersion = renderGraph.addWriteResource(cullPassId, indirectDrawCountBuffer);
@@ -442,6 +760,42 @@ DynamicArray<VulkanSubmitBatch> Engine::renderFrame(FrameData& frameData)
     renderGraph.addReadResource(cullPassId, indirectDrawCountBuffer);
     renderGraph.markAsCompute(cullPassId);
 
+    // geometry passes are waiting on culling, it runs ahead of other async compute work
+    renderGraph.setPassPriority(cullPassId, RGPassPriority::High);
+
+    // bin point and spot lights into view space clusters for the fragment lighting
+    // and visibility material passes, tiled compute path culls the lights on its own
+    bool     useVisibilityBuffer        = m_visibilityBuffer && m_visibilityIdsFit && m_rgResources.visibilityMaterialPipeline != nullptr;
+    bool     useTiledLighting           = m_tiledLighting && !useVisibilityBuffer;
+    uint32_t lightClustersVersion       = 0u;
+    uint32_t clusterLightIndicesVersion = 0u;
+
+    if (!useTiledLighting)
+    {
+        auto clustersPassId        = renderGraph.addPass("light_clusters_pass", RGQueueFamilyType::Compute, dispatchLightClustersCompute);
+        lightClustersVersion       = renderGraph.addWriteResource(clustersPassId, lightClustersBuffer);
+        clusterLightIndicesVersion = renderGraph.addWriteResource(clustersPassId, clusterLightIndicesBuffer);
+
+        renderGraph.markAsCompute(clustersPassId);
+    }
+
+    // slices of the sky maps are rebuilt on async compute, lighting waits on them
+    // only in the frame which publishes the rebuilt slot
+    if (!m_environment->getFrameUpdateSlices().empty())
+    {
+        auto     envUpdatePassId = renderGraph.addPass("env_maps_update_pass", RGQueueFamilyType::Compute, dispatchEnvMapsUpdateCompute);
+        uint32_t updateSlot      = m_environment->getUpdateSlot();
+
+        // every map is written, so readers of a published slot acquire all of them
+        renderGraph.addWriteResource(envUpdatePassId, envSkyMaps[updateSlot]);
+        renderGraph.addWriteResource(envUpdatePassId, envIrradianceMaps[updateSlot]);
+        renderGraph.addWriteResource(envUpdatePassId, envPrefilteredMaps[updateSlot]);
+        renderGraph.markAsCompute(envUpdatePassId);
+
+        // nothing in the frame waits on it until the slot is published
+        renderGraph.setPassPriority(envUpdatePassId, RGPassPriority::Low);
+    }
+
     // create shadow pass
     uint32_t dirLightsCount  = m_lightsSystem->getDirectionalLightsCount();
     uint32_t dirShadowMapVer = 0u;
@@ -451,45 +805,197 @@ DynamicArray<VulkanSubmitBatch> Engine::renderFrame(FrameData& frameData)
         auto shadowPassId = renderGraph.addPass("dir_shadow_pass", RGQueueFamilyType::Graphics, recordShadow2DMapsCmds);
 
         dirShadowMapVer   = renderGraph.addDepthResource(shadowPassId, dirShadowMap);
+
+        // all cascades are rendered with a single multiview pass
+        renderGraph.setMulitView(shadowPassId, DIR_SHADOW_CASCADES_VIEW_MASK, DIR_SHADOW_CASCADES_COUNT);
+    }
+
+    // create point and spot light shadow passes, static casters are only redrawn
+    // in the cached atlas when their tiles are stale
+    uint32_t localShadowStaticAtlasVer = 0u;
+    uint32_t localShadowAtlasVer       = 0u;
+
+    if (m_lightsSystem->getStaleLocalShadowViewsCount() > 0u)
+    {
+        auto staticShadowPassId   = renderGraph.addPass("local_shadow_static_pass", RGQueueFamilyType::Graphics, recordLocalShadowStaticCmds);
+
+        localShadowStaticAtlasVer = renderGraph.addDepthResource(staticShadowPassId, localShadowStaticAtlas);
+    }
+
+    if (!m_lightsSystem->getLocalShadowRenderViews().empty())
+    {
+        auto localShadowPassId = renderGraph.addPass("local_shadow_pass", RGQueueFamilyType::Graphics, recordLocalShadowCmds);
+
+        renderGraph.addReadResource(localShadowPassId, localShadowStaticAtlas, localShadowStaticAtlasVer);
+
+        localShadowAtlasVer    = renderGraph.addDepthResource(localShadowPassId, localShadowAtlas);
+    }
+
+    // create geometry and lighting passes, visibility buffer replaces the g-buffer
+    // and the lighting pass with a single material resolve in compute
+    uint32_t gbuffDepthVer  = 0u;
+    uint32_t lightOutputVer = 0u;
+    uint32_t velocityVer    = 0u;
+
+    if (useVisibilityBuffer)
+    {
+        auto visibilityPassId = renderGraph.addPass("visibility_pass", RGQueueFamilyType::Graphics, recordVisibilityCmds);
+
+        gbuffDepthVer         = renderGraph.addDepthResource(visibilityPassId, gbuffDepth);
+
+        renderGraph.addReadResource(visibilityPassId, indirectDrawCommandsBuffer, indirectBufferVersion);
+        renderGraph.addReadResource(visibilityPassId, indirectDrawCountBuffer, indirectCountBufferVersion);
+
+        uint32_t visibilityIdsVer = renderGraph.addWriteResource(visibilityPassId, visibilityIds);
+
+        // dispatched on the graphics queue like the tiled lighting path
+        auto materialPassId = renderGraph.addPass("visibility_material_pass", RGQueueFamilyType::Graphics, dispatchVisibilityMaterialCompute);
+        renderGraph.markAsCompute(materialPassId);
+
+        renderGraph.addReadResource(materialPassId, visibilityIds, visibilityIdsVer);
+        renderGraph.addReadResource(materialPassId, lightClustersBuffer, lightClustersVersion);
+        renderGraph.addReadResource(materialPassId, clusterLightIndicesBuffer, clusterLightIndicesVersion);
+        renderGraph.addReadResource(materialPassId, dirShadowMap, dirShadowMapVer);
+        renderGraph.addReadResource(materialPassId, localShadowAtlas, localShadowAtlasVer);
+        renderGraph.addReadResource(materialPassId, materialsBuffer, materialsBufferVer);
+
+        if (dynamicSky)
+        {
+            renderGraph.addReadResource(materialPassId, envIrradianceMaps[activeEnvSlot]);
+            renderGraph.addReadResource(materialPassId, envPrefilteredMaps[activeEnvSlot]);
+        }
+
+        lightOutputVer = renderGraph.addWriteResource(materialPassId, lightingOutput);
+        velocityVer    = renderGraph.addWriteResource(materialPassId, gbuffVelocity);
     }
+    else
+    {
+        // create g-buffer pass, compact layout stores octahedral normals in a two
+        // channel target and packs emissive with the material parameters
+        bool             compactGBuffer    = m_compactGBuffer;
+        RGImageResource& gbuffNormalTarget = compactGBuffer ? gbuffCompactNormal : gbuffNormal;
 
-    // create g-buffer pass
-    auto     gbuffPassId   = renderGraph.addPass("gbuffer_pass", RGQueueFamilyType::Graphics, recordGBufferCmds);
+        auto gbuffPassId = renderGraph.addPass("gbuffer_pass", RGQueueFamilyType::Graphics, recordGBufferCmds);
 
-    uint32_t gbuffDepthVer = renderGraph.addDepthResource(gbuffPassId, gbuffDepth);
+        gbuffDepthVer    = renderGraph.addDepthResource(gbuffPassId, gbuffDepth);
 
-    renderGraph.addReadResource(gbuffPassId, indirectDrawCommandsBuffer, indirectBufferVersion);
-    renderGraph.addReadResource(gbuffPassId, indirectDrawCountBuffer, indirectCountBufferVersion);
+        renderGraph.addReadResource(gbuffPassId, indirectDrawCommandsBuffer, indirectBufferVersion);
+        renderGraph.addReadResource(gbuffPassId, indirectDrawCountBuffer, indirectCountBufferVersion);
+        renderGraph.addReadResource(gbuffPassId, materialsBuffer, materialsBufferVer);
 
-    uint32_t gbuffAlbedoVer   = renderGraph.addWriteResource(gbuffPassId, gbuffAlbedo);
-    uint32_t gbuffNormalVer   = renderGraph.addWriteResource(gbuffPassId, gbuffNormal);
-    uint32_t gbuffAoMRVer     = renderGraph.addWriteResource(gbuffPassId, gbuffAoMR);
-    uint32_t gbuffEmissiveVer = renderGraph.addWriteResource(gbuffPassId, gbuffEmissive);
+        uint32_t gbuffAlbedoVer   = renderGraph.addWriteResource(gbuffPassId, gbuffAlbedo);
+        uint32_t gbuffNormalVer   = renderGraph.addWriteResource(gbuffPassId, gbuffNormalTarget);
+        uint32_t gbuffAoMRVer     = renderGraph.addWriteResource(gbuffPassId, gbuffAoMR);
+        uint32_t gbuffEmissiveVer = 0u;
 
-    // create lighting pass
-    auto lightPassId = renderGraph.addPass("lighting_pass", RGQueueFamilyType::Graphics, recordLightingCmds);
-    renderGraph.addReadResource(lightPassId, gbuffAlbedo, gbuffAlbedoVer);
-    renderGraph.addReadResource(lightPassId, gbuffNormal, gbuffNormalVer);
-    renderGraph.addReadResource(lightPassId, gbuffAoMR, gbuffAoMRVer);
-    renderGraph.addReadResource(lightPassId, gbuffEmissive, gbuffEmissiveVer);
-    renderGraph.addReadResource(lightPassId, gbuffDepth, gbuffDepthVer);
-    renderGraph.addReadResource(lightPassId, dirShadowMap, dirShadowMapVer);
+        // attachments follow the fragment outputs, velocity comes before emissive
+        velocityVer = renderGraph.addWriteResource(gbuffPassId, gbuffVelocity);
 
-    uint32_t lightOutputVer = renderGraph.addWriteResource(lightPassId, lightingOutput);
+        if (!compactGBuffer)
+        {
+            gbuffEmissiveVer = renderGraph.addWriteResource(gbuffPassId, gbuffEmissive);
+        }
+
+        // create lighting pass, tiled path dispatches on the graphics queue so g-buffer
+        // targets don't change queue ownership
+        uint32_t lightPassId = 0u;
+        if (useTiledLighting)
+        {
+            lightPassId = renderGraph.addPass("tiled_lighting_pass", RGQueueFamilyType::Graphics, dispatchTiledLightingCompute);
+            renderGraph.markAsCompute(lightPassId);
+        }
+        else
+        {
+            lightPassId = renderGraph.addPass("lighting_pass", RGQueueFamilyType::Graphics, recordLightingCmds);
+            renderGraph.addReadResource(lightPassId, lightClustersBuffer, lightClustersVersion);
+            renderGraph.addReadResource(lightPassId, clusterLightIndicesBuffer, clusterLightIndicesVersion);
+        }
+
+        renderGraph.addReadResource(lightPassId, gbuffAlbedo, gbuffAlbedoVer);
+        renderGraph.addReadResource(lightPassId, gbuffNormalTarget, gbuffNormalVer);
+        renderGraph.addReadResource(lightPassId, gbuffAoMR, gbuffAoMRVer);
+        renderGraph.addReadResource(lightPassId, gbuffDepth, gbuffDepthVer);
+        renderGraph.addReadResource(lightPassId, dirShadowMap, dirShadowMapVer);
+        renderGraph.addReadResource(lightPassId, localShadowAtlas, localShadowAtlasVer);
+        renderGraph.addReadResource(lightPassId, materialsBuffer, materialsBufferVer);
+
+        if (!compactGBuffer)
+        {
+            renderGraph.addReadResource(lightPassId, gbuffEmissive, gbuffEmissiveVer);
+        }
+
+        if (dynamicSky)
+        {
+            renderGraph.addReadResource(lightPassId, envIrradianceMaps[activeEnvSlot]);
+            renderGraph.addReadResource(lightPassId, envPrefilteredMaps[activeEnvSlot]);
+        }
+
+        lightOutputVer = renderGraph.addWriteResource(lightPassId, lightingOutput);
+    }
 
     // create skybox pass
     auto skyPassId = renderGraph.addPass("skybox_pass", RGQueueFamilyType::Graphics, recordSkyBoxCmds);
 
-    renderGraph.addDepthResource(skyPassId, gbuffDepth, gbuffDepthVer);
+    uint32_t skyDepthVer = renderGraph.addDepthResource(skyPassId, gbuffDepth, gbuffDepthVer);
 
     renderGraph.addReadResource(skyPassId, lightingOutput, lightOutputVer);
 
+    if (dynamicSky)
+    {
+        renderGraph.addReadResource(skyPassId, envSkyMaps[activeEnvSlot]);
+    }
+
     uint32_t skyOutputVer = renderGraph.addWriteResource(skyPassId, lightingOutput);
 
+    // create temporal upscaling pass, jittered lighting output is resolved with the
+    // reprojected history of the previous frame into the output resolution
+    RGImageResource* toneMapInput    = &lightingOutput;
+    uint32_t         toneMapInputVer = skyOutputVer;
+
+    if (m_temporalUpscaling)
+    {
+        m_rgResources.taaHistoryIdx ^= 1u;
+
+        RGImageResource& taaOutput  = taaHistories[m_rgResources.taaHistoryIdx];
+        RGImageResource& taaHistory = taaHistories[m_rgResources.taaHistoryIdx ^ 1u];
+
+        // dispatched on the graphics queue like the tiled lighting path
+        auto taaPassId = renderGraph.addPass("taa_pass", RGQueueFamilyType::Graphics, dispatchTemporalUpscaleCompute);
+        renderGraph.markAsCompute(taaPassId);
+
+        renderGraph.addReadResource(taaPassId, lightingOutput, skyOutputVer);
+        renderGraph.addReadResource(taaPassId, gbuffDepth, skyDepthVer);
+        renderGraph.addReadResource(taaPassId, gbuffVelocity, velocityVer);
+        renderGraph.addReadResource(taaPassId, taaHistory);
+
+        toneMapInput    = &taaOutput;
+        toneMapInputVer = renderGraph.addWriteResource(taaPassId, taaOutput);
+    }
+
+    // create auto exposure pass, histogram of the lighting output is reduced to
+    // an adapted exposure which stays on the gpu for the tonemap pass
+    uint32_t exposureVer = 0u;
+
+    if (m_autoExposure)
+    {
+        auto exposurePassId = renderGraph.addPass("auto_exposure_pass", RGQueueFamilyType::Graphics, dispatchAutoExposureCompute);
+        renderGraph.markAsCompute(exposurePassId);
+
+        renderGraph.addReadResource(exposurePassId, lightingOutput, skyOutputVer);
+        renderGraph.addWriteResource(exposurePassId, exposureHistogram);
+
+        exposureVer = renderGraph.addWriteResource(exposurePassId, exposure);
+    }
+
     // create tonemapping pass
     auto tonemapPassId = renderGraph.addPass("tonemap_pass", RGQueueFamilyType::Graphics, recordTonemapCmds);
 
-    renderGraph.addReadResource(tonemapPassId, lightingOutput, skyOutputVer);
+    renderGraph.addReadResource(tonemapPassId, *toneMapInput, toneMapInputVer);
+
+    if (m_autoExposure)
+    {
+        renderGraph.addReadResource(tonemapPassId, exposure, exposureVer);
+    }
 
     uint32_t tonemapOutputVer = renderGraph.addWriteResource(tonemapPassId, toneMappedOutput);
 
@@ -499,6 +1005,20 @@ DynamicArray<VulkanSubmitBatch> Engine::renderFrame(FrameData& frameData)
     renderGraph.addWriteResource(presentPassId, swapImage);
     renderGraph.markAsFinal(presentPassId);
 
+    // readbacks copy the buffers after their writers of this frame
+    DynamicArray<RGBufferResource> readbackSources = {};
+    if (m_transferScheduler.hasReadbacks())
+    {
+        auto readbackPassId = renderGraph.addPass("readback_pass", RGQueueFamilyType::Transfer, recordTransferReadbackCmds);
+
+        readbackSources.reserve(m_transferScheduler.getReadbackSources().size());
+        for (GfxBuffer* sourceBuffer : m_transferScheduler.getReadbackSources())
+        {
+            auto& source = readbackSources.emplace_back(RGBufferResource { .name = "readback_source", .buffer = sourceBuffer });
+            renderGraph.addReadResource(readbackPassId, source);
+        }
+    }
+
     // execute render graph
     auto batches = renderGraph.execute(frameData);
 
@@ -515,9 +1035,16 @@ bool Engine::setupGlobals()
 {
     VulkanContext ctx = VkGfxDevice::getSharedVulkanContext();
 
-    // setup 256mb vertex buffer * 128mb index buffer
+    // setup 256mb vertex buffer * 128mb index buffer for full vertices and
+    // 128mb * 64mb for packed vertices. Packed buffers are only placeholders
+    // for the bindings when packed vertices are disabled. All are filled on
+    // transfer queue while being read by graphics and compute queues.
+    // Visibility buffer material pass reads them as storage buffers.
+    VkDeviceSize packedVertexBufferSize = m_config.packedVertices ? 128 * 1024 * 1024 : 64 * 1024;
+    VkDeviceSize packedIndexBufferSize  = m_config.packedVertices ? 64 * 1024 * 1024 : 64 * 1024;
+
     m_vertexBuffer.init(
-        GfxBufferUsageFlags::VertexBuffer | GfxBufferUsageFlags::TransferTarget,
+        GfxBufferUsageFlags::VertexBuffer | GfxBufferUsageFlags::StorageBuffer | GfxBufferUsageFlags::TransferTarget | GfxBufferUsageFlags::SharedQueueAccess,
         256 * 1024 * 1024,
         GfxBufferMemoryTypeFlags::DedicatedDeviceMemory,
         "global_vertex_buffer");
@@ -525,13 +1052,37 @@ bool Engine::setupGlobals()
     CHECK_AND_RETURN_FALSE(!m_vertexBuffer.isAllocated());
 
     m_indexBuffer.init(
-        GfxBufferUsageFlags::IndexBuffer | GfxBufferUsageFlags::TransferTarget,
+        GfxBufferUsageFlags::IndexBuffer | GfxBufferUsageFlags::StorageBuffer | GfxBufferUsageFlags::TransferTarget | GfxBufferUsageFlags::SharedQueueAccess,
         128 * 1024 * 1024,
         GfxBufferMemoryTypeFlags::DedicatedDeviceMemory,
         "global_index_buffer");
 
     CHECK_AND_RETURN_FALSE(!m_indexBuffer.isAllocated())
 
+    m_packedVertexBuffer.init(
+        GfxBufferUsageFlags::VertexBuffer | GfxBufferUsageFlags::StorageBuffer | GfxBufferUsageFlags::TransferTarget | GfxBufferUsageFlags::SharedQueueAccess,
+        packedVertexBufferSize,
+        GfxBufferMemoryTypeFlags::DedicatedDeviceMemory,
+        "global_packed_vertex_buffer");
+
+    CHECK_AND_RETURN_FALSE(!m_packedVertexBuffer.isAllocated());
+
+    m_packedIndexBuffer.init(
+        GfxBufferUsageFlags::IndexBuffer | GfxBufferUsageFlags::StorageBuffer | GfxBufferUsageFlags::TransferTarget | GfxBufferUsageFlags::SharedQueueAccess,
+        packedIndexBufferSize,
+        GfxBufferMemoryTypeFlags::DedicatedDeviceMemory,
+        "global_packed_index_buffer");
+
+    CHECK_AND_RETURN_FALSE(!m_packedIndexBuffer.isAllocated())
+
+    m_vertexAllocator.init(m_vertexBuffer.getSizeInBytes() / sizeof(Vertex));
+    m_indexAllocator.init(m_indexBuffer.getSizeInBytes() / sizeof(uint32_t));
+    m_packedVertexAllocator.init(m_packedVertexBuffer.getSizeInBytes() / sizeof(PackedVertex));
+    m_packedIndexAllocator.init(m_packedIndexBuffer.getSizeInBytes() / sizeof(uint16_t));
+
+    m_stagingRing = createUnique<StagingRing>();
+    CHECK_AND_RETURN_FALSE(!m_stagingRing->init());
+
     // create global descriptor pool
     m_globalDescriptorPool = VkGfxDescriptorPool::Builder(ctx)
                                  .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, MAX_FRAMES_IN_FLIGHT)
@@ -547,13 +1098,16 @@ bool Engine::setupGlobals()
                                       .build();
     CHECK_AND_RETURN_FALSE(!m_globalDescriptorSetLayout);
 
-    GfxBuffer::createHostWriteBuffer(
-        GfxBufferUsageFlags::UniformBuffer,
-        sizeof(GlobalUbo),
-        MAX_FRAMES_IN_FLIGHT,
-        "global_uniform_buffer",
-        &m_globalUbos);
-    CHECK_AND_RETURN_FALSE(!m_globalUbos.isAllocated());
+    // global ubo lives in the reserved block of every frame, renderables arrays are
+    // allocated after it and each of them can be padded up to the offset alignment.
+    // Modified materials are staged in the arena as well, all of them after a scene load.
+    const auto& limits          = ctx.physicalDeviceProperties.limits;
+    size_t      uploadAlignment = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+    size_t      renderablesSize = (3 * sizeof(glm::mat4) + sizeof(GfxBoundingBoxData) + 2 * sizeof(uint32_t)) * MAX_RENDERABLES_COUNT;
+    size_t      materialsSize   = getAlignment(sizeof(Material), uploadAlignment) * MAX_MATERIALS_COUNT;
+    size_t      frameUploadSize = sizeof(GlobalUbo) + renderablesSize + materialsSize + 7 * uploadAlignment;
+
+    CHECK_AND_RETURN_FALSE(!m_frameUploadArena.init(frameUploadSize, sizeof(GlobalUbo), "frame_upload_arena"));
 
     m_globalDescriptorSet = m_globalDescriptorPool->allocateDescriptorSet(*m_globalDescriptorSetLayout, "global_desc_set");
     CHECK_AND_RETURN_FALSE(!m_globalDescriptorSet);
@@ -563,7 +1117,7 @@ bool Engine::setupGlobals()
 
     for (uint32_t frameIndex = 0u; frameIndex < MAX_FRAMES_IN_FLIGHT; ++frameIndex)
     {
-        buffersInfo.push_back(m_globalUbos.getDescriptorInfoAtIndex(frameIndex));
+        buffersInfo.push_back(m_frameUploadArena.getDescriptorInfo(m_frameUploadArena.getReservedBlock(frameIndex)));
     }
     m_globalDescriptorSet->configureBuffer(
         0,
@@ -574,29 +1128,39 @@ bool Engine::setupGlobals()
     m_globalDescriptorSet->applyConfiguration();
 
     // create descriptor pool and layout for materials
+    m_materialsCapacity      = VkGfxBindlessHeap::getDescriptorCountLimit(ctx, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_MATERIALS_COUNT);
+
     m_materialDescriptorPool = VkGfxDescriptorPool::Builder(ctx)
-                                   .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, MAX_MATERIALS_COUNT) // TODO: make count configurable
+                                   .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_materialsCapacity * MAX_FRAMES_IN_FLIGHT)
                                    .setDebugName("material_desc_pool")
-                                   .build(1, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+                                   .build(MAX_FRAMES_IN_FLIGHT, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
     CHECK_AND_RETURN_FALSE(!m_materialDescriptorPool);
 
     m_materialDescriptorSetLayout = VkGfxDescriptorSetLayout::Builder(ctx)
-                                        .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT, MAX_MATERIALS_COUNT, true) // TODO: make count configurable
+                                        .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT, m_materialsCapacity, true)
                                         .setDebugName("material_desc_set_layout")
                                         .build();
     CHECK_AND_RETURN_FALSE(!m_materialDescriptorSetLayout);
 
-    // create storage buffer of storing materials;
-    GfxBuffer::createHostWriteBuffer(
-        GfxBufferUsageFlags::StorageBuffer,
-        sizeof(Material),
-        MAX_MATERIALS_COUNT,
-        "material_buffer",
-        &m_materialsBuffer);
-    CHECK_AND_RETURN_FALSE(!m_materialsBuffer.isAllocated());
-
-    m_materialsDescriptorSet = m_materialDescriptorPool->allocateDescriptorSet(*m_materialDescriptorSetLayout, "material_desc_set");
-    CHECK_AND_RETURN_FALSE(!m_materialsDescriptorSet);
+    // create storage buffers of storing materials, modified materials are
+    // staged in the frame upload arena and copied by the upload pass of the
+    // frame into its own buffer
+    m_materialsBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    m_materialsDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    m_pendingMaterialIds.resize(MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t frameIdx = 0u; frameIdx < MAX_FRAMES_IN_FLIGHT; ++frameIdx)
+    {
+        GfxBuffer::createDeviceLocalBuffer(
+            GfxBufferUsageFlags::StorageBuffer | GfxBufferUsageFlags::TransferTarget | GfxBufferUsageFlags::SharedQueueAccess,
+            sizeof(Material),
+            m_materialsCapacity,
+            "material_buffer",
+            &m_materialsBuffers[frameIdx]);
+        CHECK_AND_RETURN_FALSE(!m_materialsBuffers[frameIdx].isAllocated());
+
+        m_materialsDescriptorSets[frameIdx] = m_materialDescriptorPool->allocateDescriptorSet(*m_materialDescriptorSetLayout, "material_desc_set");
+        CHECK_AND_RETURN_FALSE(!m_materialsDescriptorSets[frameIdx]);
+    }
 
     // mesh info resources
     m_meshDataDescriptorPool = VkGfxDescriptorPool::Builder(ctx)
@@ -612,6 +1176,10 @@ bool Engine::setupGlobals()
                                             VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
                                             1,
                                             true)
+                                        .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 1) // vertices
+                                        .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 1) // indices
+                                        .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 1) // packed vertices
+                                        .addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 1) // packed indices
                                         .setDebugName("mesh_data_desc_set_layout")
                                         .build();
     CHECK_AND_RETURN_FALSE(!m_meshDataDescriptorSetLayout);
@@ -628,55 +1196,63 @@ bool Engine::setupGlobals()
     m_meshDataDescriptorSet = m_meshDataDescriptorPool->allocateDescriptorSet(*m_meshDataDescriptorSetLayout, "mesh_data_desc_set");
     CHECK_AND_RETURN_FALSE(!m_meshDataDescriptorSet);
 
+    // global geometry buffers never move, they are bound once
+    VkDescriptorBufferInfo geometryBuffersInfo[] = {
+        m_vertexBuffer.getDescriptorInfo(),
+        m_indexBuffer.getDescriptorInfo(),
+        m_packedVertexBuffer.getDescriptorInfo(),
+        m_packedIndexBuffer.getDescriptorInfo()
+    };
+
+    for (uint32_t bufferIdx = 0u; bufferIdx < std::size(geometryBuffersInfo); ++bufferIdx)
+    {
+        m_meshDataDescriptorSet->configureBuffer(bufferIdx + 1u, 0, 1, &geometryBuffersInfo[bufferIdx]);
+    }
+    m_meshDataDescriptorSet->applyConfiguration();
+
     // renderables resources
     m_renderableDescriptorPool = VkGfxDescriptorPool::Builder(ctx)
-                                     .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 * MAX_FRAMES_IN_FLIGHT)
+                                     .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, RENDERABLE_BUFFERS_COUNT)
                                      .setDebugName("renderables_desc_pool")
-                                     .build(MAX_FRAMES_IN_FLIGHT, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+                                     .build(1);
     CHECK_AND_RETURN_FALSE(!m_renderableDescriptorPool);
 
     m_renderableDescriptorSetLayout = VkGfxDescriptorSetLayout::Builder(ctx)
                                           .addBinding(
                                               0, // model matrices binding
-                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
                                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
-                                              1,
-                                              true)
+                                              1)
                                           .addBinding(
                                               1, // normal matrices binding
-                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
                                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
-                                              1,
-                                              true)
+                                              1)
                                           .addBinding(
                                               2, // bounding boxes binding
-                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
                                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
-                                              1,
-                                              true)
+                                              1)
                                           .addBinding(
                                               3, // mesh ids binding
-                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
                                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
-                                              1,
-                                              true)
+                                              1)
                                           .addBinding(
                                               4, // material ids binding
-                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
+                                              VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+                                              1)
+                                          .addBinding(
+                                              5, // previous model matrices binding
+                                              VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC,
                                               VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
-                                              1,
-                                              true)
+                                              1)
                                           .setDebugName("renderables_desc_set_layout")
                                           .build();
     CHECK_AND_RETURN_FALSE(!m_renderableDescriptorSetLayout);
 
     m_frameRenderables.resize(MAX_FRAMES_IN_FLIGHT);
-    m_modelMatrixBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    m_normalMatrixBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    m_boundingBoxBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    m_meshIdsBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    m_materialIdsBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-    m_renderableDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
     for (uint32_t frameIdx = 0u; frameIdx < MAX_FRAMES_IN_FLIGHT; ++frameIdx)
     {
         m_frameRenderables[frameIdx].modelMatrices.reserve(MAX_RENDERABLES_COUNT);
@@ -684,69 +1260,60 @@ bool Engine::setupGlobals()
         m_frameRenderables[frameIdx].boundingBoxes.reserve(MAX_RENDERABLES_COUNT);
         m_frameRenderables[frameIdx].meshIds.reserve(MAX_RENDERABLES_COUNT);
         m_frameRenderables[frameIdx].materialIds.reserve(MAX_RENDERABLES_COUNT);
+        m_frameRenderables[frameIdx].prevModelMatrices.reserve(MAX_RENDERABLES_COUNT);
+    }
 
-        GfxBuffer::createHostWriteBuffer(
-            GfxBufferUsageFlags::StorageBuffer,
-            sizeof(glm::mat4),
-            MAX_RENDERABLES_COUNT,
-            "model_matrix_buffer",
-            &m_modelMatrixBuffers[frameIdx]);
-
-        GfxBuffer::createHostWriteBuffer(
-            GfxBufferUsageFlags::StorageBuffer,
-            sizeof(glm::mat4),
-            MAX_RENDERABLES_COUNT,
-            "normal_matrix_buffer",
-            &m_normalMatrixBuffers[frameIdx]);
-
-        GfxBuffer::createHostWriteBuffer(
-            GfxBufferUsageFlags::StorageBuffer,
-            sizeof(GfxBoundingBoxData),
-            MAX_RENDERABLES_COUNT,
-            "bounding_box_buffer",
-            &m_boundingBoxBuffers[frameIdx]);
+    // written once with ranges covering the arrays at their max size, ranges
+    // allocated in the upload arena every frame are selected with dynamic offsets
+    m_renderableDescriptorSet = m_renderableDescriptorPool->allocateDescriptorSet(
+        *m_renderableDescriptorSetLayout,
+        "renderables_desc_set");
+    CHECK_AND_RETURN_FALSE(!m_renderableDescriptorSet);
+
+    Array<size_t, RENDERABLE_BUFFERS_COUNT> renderableBufferSizes = {
+        sizeof(glm::mat4),
+        sizeof(glm::mat4),
+        sizeof(GfxBoundingBoxData),
+        sizeof(uint32_t),
+        sizeof(uint32_t),
+        sizeof(glm::mat4)
+    };
 
-        GfxBuffer::createHostWriteBuffer(
-            GfxBufferUsageFlags::StorageBuffer,
-            sizeof(uint32_t),
-            MAX_RENDERABLES_COUNT,
-            "mesh_id_buffer",
-            &m_meshIdsBuffers[frameIdx]);
+    Array<VkDescriptorBufferInfo, RENDERABLE_BUFFERS_COUNT> renderableBuffersInfo;
+    for (uint32_t bindingIndex = 0u; bindingIndex < RENDERABLE_BUFFERS_COUNT; ++bindingIndex)
+    {
+        GfxUploadAllocation maxRange        = { .size = renderableBufferSizes[bindingIndex] * MAX_RENDERABLES_COUNT };
+        renderableBuffersInfo[bindingIndex] = m_frameUploadArena.getDescriptorInfo(maxRange);
+    }
 
-        GfxBuffer::createHostWriteBuffer(
-            GfxBufferUsageFlags::StorageBuffer,
-            sizeof(uint32_t),
-            MAX_RENDERABLES_COUNT,
-            "material_id_buffer",
-            &m_materialIdsBuffers[frameIdx]);
-
-        m_renderableDescriptorSets[frameIdx] = m_renderableDescriptorPool->allocateDescriptorSet(
-            *m_renderableDescriptorSetLayout,
-            "renderables_desc_set");
-
-        DynamicArray<VkDescriptorBufferInfo> renderableBuffersInfo;
-        renderableBuffersInfo.push_back(m_modelMatrixBuffers[frameIdx].getDescriptorInfo());
-        renderableBuffersInfo.push_back(m_normalMatrixBuffers[frameIdx].getDescriptorInfo());
-        renderableBuffersInfo.push_back(m_boundingBoxBuffers[frameIdx].getDescriptorInfo());
-        renderableBuffersInfo.push_back(m_meshIdsBuffers[frameIdx].getDescriptorInfo());
-        renderableBuffersInfo.push_back(m_materialIdsBuffers[frameIdx].getDescriptorInfo());
-
-        m_renderableDescriptorSets[frameIdx]->configureBuffer(
-            0,
-            0,
-            renderableBuffersInfo.size(),
-            renderableBuffersInfo.data());
+    m_renderableDescriptorSet->configureBuffer(
+        0,
+        0,
+        renderableBuffersInfo.size(),
+        renderableBuffersInfo.data());
 
-        m_renderableDescriptorSets[frameIdx]->applyConfiguration();
-    }
+    m_renderableDescriptorSet->applyConfiguration();
 
     return true;
 }
 
 void Engine::cleanupGlobals()
 {
+    m_stagingRing->cleanup();
+    m_stagingRing = nullptr;
+
+    m_pendingGeometryReleases.clear();
+
+    for (auto& pending : m_pendingTextureReleases)
+    {
+        pending.texture.cleanup();
+    }
+    m_pendingTextureReleases.clear();
+
     m_vertexBuffer.cleanup();
     m_indexBuffer.cleanup();
+    m_packedVertexBuffer.cleanup();
+    m_packedIndexBuffer.cleanup();
 
     m_globalDescriptorPool->resetPool();
     m_globalDescriptorSetLayout = nullptr;
@@ -764,17 +1331,13 @@ void Engine::cleanupGlobals()
     m_renderableDescriptorSetLayout = nullptr;
     m_renderableDescriptorPool      = nullptr;
 
-    for (uint32_t frameIdx = 0u; frameIdx < MAX_FRAMES_IN_FLIGHT; ++frameIdx)
+    m_frameUploadArena.cleanup();
+
+    for (auto& buffer : m_materialsBuffers)
     {
-        m_modelMatrixBuffers[frameIdx].cleanup();
-        m_normalMatrixBuffers[frameIdx].cleanup();
-        m_boundingBoxBuffers[frameIdx].cleanup();
-        m_meshIdsBuffers[frameIdx].cleanup();
-        m_materialIdsBuffers[frameIdx].cleanup();
+        buffer.cleanup();
     }
-
-    m_globalUbos.cleanup();
-    m_materialsBuffer.cleanup();
+    m_pendingMaterialIds.clear();
     m_meshDataBuffer.cleanup();
 
     releaseRenderGraphResources();
@@ -782,40 +1345,112 @@ void Engine::cleanupGlobals()
 
 void Engine::registerMaterials(DynamicArray<Material>& materials)
 {
+    if (materials.size() > m_materialsCapacity)
+    {
+        DUSK_ERROR("Scene has {} materials, only {} are supported", materials.size(), m_materialsCapacity);
+        return;
+    }
+
     DynamicArray<VkDescriptorBufferInfo> matInfo;
     matInfo.reserve(materials.size());
 
-    for (uint32_t matIndex = 0u; matIndex < materials.size(); ++matIndex)
+    for (uint32_t frameIdx = 0u; frameIdx < MAX_FRAMES_IN_FLIGHT; ++frameIdx)
     {
-        matInfo.push_back(m_materialsBuffer.getDescriptorInfoAtIndex(matIndex));
-    }
+        matInfo.clear();
+        for (uint32_t matIndex = 0u; matIndex < materials.size(); ++matIndex)
+        {
+            matInfo.push_back(m_materialsBuffers[frameIdx].getDescriptorInfoAtIndex(matIndex));
+        }
 
-    m_materialsDescriptorSet->configureBuffer(
-        0,
-        0,
-        materials.size(),
-        matInfo.data());
+        m_materialsDescriptorSets[frameIdx]->configureBuffer(
+            0,
+            0,
+            materials.size(),
+            matInfo.data());
 
-    m_materialsDescriptorSet->applyConfiguration();
+        m_materialsDescriptorSets[frameIdx]->applyConfiguration();
+    }
 }
 
-void Engine::updateMaterialsBuffer(DynamicArray<Material>& materials)
+void Engine::updateMaterialsBuffer(Scene& scene, uint32_t frameIndex)
 {
     DUSK_PROFILE_FUNCTION;
 
-    for (uint32_t index = 0u; index < materials.size(); ++index)
+    DynamicArray<Material>& materials = scene.getMaterials();
+    if (materials.size() > m_materialsCapacity) return;
+
+    // every copy gets the modified materials when its frame is recorded next
+    const DynamicArray<uint32_t>& modifiedIds = scene.getDirtyMaterials();
+    if (!modifiedIds.empty())
+    {
+        for (auto& pendingIds : m_pendingMaterialIds)
+        {
+            pendingIds.insert(pendingIds.end(), modifiedIds.begin(), modifiedIds.end());
+            std::sort(pendingIds.begin(), pendingIds.end());
+            pendingIds.erase(std::unique(pendingIds.begin(), pendingIds.end()), pendingIds.end());
+        }
+
+        scene.clearDirtyMaterials();
+    }
+
+    DynamicArray<uint32_t>& dirtyIds = m_pendingMaterialIds[frameIndex];
+    if (dirtyIds.empty()) return;
+
+    // contiguous ids are packed with the buffer stride in the frame upload arena
+    // and copied in one batch by the upload pass of the render graph
+    GfxBuffer&   materialsBuffer = m_materialsBuffers[frameIndex];
+    const size_t stride          = materialsBuffer.instanceAlignmentSize;
+
+    for (uint32_t batchStart = 0u; batchStart < dirtyIds.size();)
     {
-        DASSERT(materials[index].id != -1);
-        m_materialsBuffer.writeAndFlushAtIndex(materials[index].id, &materials[index], sizeof(Material));
+        uint32_t batchEnd = batchStart + 1u;
+        while (batchEnd < dirtyIds.size() && dirtyIds[batchEnd] == dirtyIds[batchEnd - 1] + 1u)
+        {
+            ++batchEnd;
+        }
+
+        size_t              batchSize  = (batchEnd - batchStart) * stride;
+        GfxUploadAllocation allocation = m_frameUploadArena.allocate(batchSize);
+        if (!allocation.isValid())
+        {
+            // remaining materials stay pending and are uploaded when the frame comes again
+            DUSK_ERROR("Unable to upload {} modified materials", dirtyIds.size() - batchStart);
+            dirtyIds.erase(dirtyIds.begin(), dirtyIds.begin() + batchStart);
+            return;
+        }
+
+        memset(allocation.data, 0, batchSize);
+        for (uint32_t index = batchStart; index < batchEnd; ++index)
+        {
+            DASSERT(materials[dirtyIds[index]].id != -1);
+            memcpy((char*)allocation.data + (index - batchStart) * stride, &materials[dirtyIds[index]], sizeof(Material));
+        }
+
+        m_transferScheduler.queueUpload(
+            m_frameUploadArena.getVkBuffer(),
+            allocation.offset,
+            materialsBuffer,
+            dirtyIds[batchStart] * stride,
+            batchSize);
+
+        batchStart = batchEnd;
     }
+
+    dirtyIds.clear();
 }
 
 void Engine::prepareRenderGraphResources()
 {
     DUSK_PROFILE_FUNCTION;
 
-    auto& ctx    = VkGfxDevice::getSharedVulkanContext();
-    auto  extent = m_renderer->getSwapChain().getCurrentExtent();
+    auto& ctx                  = VkGfxDevice::getSharedVulkanContext();
+    auto  outputExtent         = m_renderer->getSwapChain().getCurrentExtent();
+    m_rgResources.renderExtent = getScaledRenderExtent(outputExtent);
+    m_rgResources.outputExtent = outputExtent;
+
+    // render targets are allocated at output size and drawn in the render extent,
+    // so render scale changes don't reallocate them
+    auto extent = outputExtent;
 
     // Indirect draw resources
     m_rgResources.indirectDrawDescriptorPool = VkGfxDescriptorPool::Builder(ctx)
@@ -837,7 +1472,7 @@ void Engine::prepareRenderGraphResources()
     {
         m_rgResources.frameIndirectDrawCommandsBuffers[frameIdx].init(
             GfxBufferUsageFlags::StorageBuffer | GfxBufferUsageFlags::IndirectBuffer | GfxBufferUsageFlags::TransferTarget,
-            sizeof(GfxIndexedIndirectDrawCommand) * MAX_RENDERABLES_COUNT * 2, // doubled because first half buffer for gbuffer pass, second half for shadow pass
+            sizeof(GfxIndexedIndirectDrawCommand) * MAX_RENDERABLES_COUNT * INDIRECT_DRAW_REGIONS_COUNT,
             GfxBufferMemoryTypeFlags::DedicatedDeviceMemory,
             std::format("indirect_draw_buffer_{}", std::to_string(frameIdx)));
 
@@ -873,6 +1508,62 @@ void Engine::prepareRenderGraphResources()
         m_rgResources.indirectDrawDescriptorSet[frameIdx]->applyConfiguration();
     }
 
+    // light clusters resources, written by the clusters compute pass and read
+    // by the lighting pass
+    m_rgResources.lightClustersDescriptorPool = VkGfxDescriptorPool::Builder(ctx)
+                                                    .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * MAX_FRAMES_IN_FLIGHT)
+                                                    .setDebugName("light_clusters_desc_pool")
+                                                    .build(MAX_FRAMES_IN_FLIGHT, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+
+    m_rgResources.lightClustersDescriptorSetLayout = VkGfxDescriptorSetLayout::Builder(ctx)
+                                                         .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 1, true)
+                                                         .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 1, true)
+                                                         .setDebugName("light_clusters_desc_set_layout")
+                                                         .build();
+
+    m_rgResources.frameLightClustersBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    m_rgResources.frameClusterLightIndicesBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    m_rgResources.lightClustersDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+
+    for (uint32_t frameIdx = 0u; frameIdx < MAX_FRAMES_IN_FLIGHT; ++frameIdx)
+    {
+        // count of point and spot lights per cluster
+        m_rgResources.frameLightClustersBuffers[frameIdx].init(
+            GfxBufferUsageFlags::StorageBuffer,
+            sizeof(glm::uvec2) * CLUSTER_COUNT,
+            GfxBufferMemoryTypeFlags::DedicatedDeviceMemory,
+            std::format("light_clusters_buffer_{}", std::to_string(frameIdx)));
+
+        m_rgResources.frameClusterLightIndicesBuffers[frameIdx].init(
+            GfxBufferUsageFlags::StorageBuffer,
+            sizeof(uint32_t) * CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER,
+            GfxBufferMemoryTypeFlags::DedicatedDeviceMemory,
+            std::format("cluster_light_indices_buffer_{}", std::to_string(frameIdx)));
+
+        m_rgResources.lightClustersDescriptorSets[frameIdx] = m_rgResources.lightClustersDescriptorPool->allocateDescriptorSet(
+            *m_rgResources.lightClustersDescriptorSetLayout, "light_clusters_desc_set");
+
+        DynamicArray<VkDescriptorBufferInfo> clustersBufferInfo;
+        clustersBufferInfo.push_back(m_rgResources.frameLightClustersBuffers[frameIdx].getDescriptorInfo());
+
+        DynamicArray<VkDescriptorBufferInfo> indicesBufferInfo;
+        indicesBufferInfo.push_back(m_rgResources.frameClusterLightIndicesBuffers[frameIdx].getDescriptorInfo());
+
+        m_rgResources.lightClustersDescriptorSets[frameIdx]->configureBuffer(
+            0,
+            0,
+            clustersBufferInfo.size(),
+            clustersBufferInfo.data());
+
+        m_rgResources.lightClustersDescriptorSets[frameIdx]->configureBuffer(
+            1,
+            0,
+            indicesBufferInfo.size(),
+            indicesBufferInfo.data());
+
+        m_rgResources.lightClustersDescriptorSets[frameIdx]->applyConfiguration();
+    }
+
     // g-buffer resources
     // Allocate g-buffer render targets
     m_rgResources.gbuffRenderTextureIds.push_back(m_textureDB->createColorTexture(
@@ -905,13 +1596,32 @@ void Engine::prepareRenderGraphResources()
         extent.height,
         VK_FORMAT_D32_SFLOAT_S8_UINT);
 
+    // motion vectors are rendered by the g-buffer pass and stored by the visibility
+    // material pass, two channel storage images need the extended formats
+    if (ctx.physicalDeviceFeatures.shaderStorageImageExtendedFormats)
+    {
+        m_rgResources.velocityTextureId = m_textureDB->createStorageTexture(
+            "gbuffer_pass_velocity",
+            extent.width,
+            extent.height,
+            VK_FORMAT_R16G16_SFLOAT);
+    }
+    else
+    {
+        m_rgResources.velocityTextureId = m_textureDB->createColorTexture(
+            "gbuffer_pass_velocity",
+            extent.width,
+            extent.height,
+            VK_FORMAT_R16G16_SFLOAT);
+    }
+
     // create g-buff pipeline layout
     m_rgResources.gbuffPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
                                             .addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(DrawData))
-                                            .addDescriptorSetLayout(m_globalDescriptorSetLayout->layout)
-                                            .addDescriptorSetLayout(m_materialDescriptorSetLayout->layout)
-                                            .addDescriptorSetLayout(m_renderableDescriptorSetLayout->layout)
-                                            .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout().layout)
+                                            .addDescriptorSetLayout(*m_globalDescriptorSetLayout)
+                                            .addDescriptorSetLayout(*m_materialDescriptorSetLayout)
+                                            .addDescriptorSetLayout(*m_renderableDescriptorSetLayout)
+                                            .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout())
                                             .build();
 
 #ifdef VK_RENDERER_DEBUG
@@ -938,6 +1648,7 @@ void Engine::prepareRenderGraphResources()
                                       .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM)     // albedo
                                       .addColorAttachmentFormat(VK_FORMAT_R16G16B16A16_UNORM) // normal
                                       .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM)     // ao-roughness-metallic
+                                      .addColorAttachmentFormat(VK_FORMAT_R16G16_SFLOAT)      // velocity
                                       .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM)     // emissive color
                                       .setDebugName("gbuff_pipeline")
                                       .build();
@@ -950,16 +1661,188 @@ void Engine::prepareRenderGraphResources()
         "gbuff_pipeline");
 #endif // VK_RENDERER_DEBUG
 
+    // same shaders specialized for meshes with packed vertices
+    m_rgResources.gbuffPackedPipeline = VkGfxRenderPipeline::Builder(ctx)
+                                            .setVertexShaderCode(vertShaderCode)
+                                            .setFragmentShaderCode(fragShaderCode)
+                                            .setPipelineLayout(*m_rgResources.gbuffPipelineLayout)
+                                            .setVertexFormat(VertexFormat::Packed)
+                                            .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM)     // albedo
+                                            .addColorAttachmentFormat(VK_FORMAT_R16G16B16A16_UNORM) // normal
+                                            .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM)     // ao-roughness-metallic
+                                            .addColorAttachmentFormat(VK_FORMAT_R16G16_SFLOAT)      // velocity
+                                            .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM)     // emissive color
+                                            .setDebugName("gbuff_packed_pipeline")
+                                            .build();
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_rgResources.gbuffPackedPipeline->get(),
+        "gbuff_packed_pipeline");
+#endif // VK_RENDERER_DEBUG
+
+    // compact g-buffer layout reuses the albedo and material targets, normals
+    // are stored octahedral encoded in their own two channel target
+    m_rgResources.gbuffCompactNormalTextureId = m_textureDB->createColorTexture(
+        "gbuffer_pass_compact_normal",
+        extent.width,
+        extent.height,
+        VK_FORMAT_R16G16_UNORM);
+
+    m_rgResources.gbuffCompactPipeline = VkGfxRenderPipeline::Builder(ctx)
+                                             .setVertexShaderCode(vertShaderCode)
+                                             .setFragmentShaderCode(fragShaderCode)
+                                             .setPipelineLayout(*m_rgResources.gbuffPipelineLayout)
+                                             .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM) // albedo-metallic
+                                             .addColorAttachmentFormat(VK_FORMAT_R16G16_UNORM)   // octahedral normal
+                                             .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM) // roughness-ao-flags-emissive
+                                             .addColorAttachmentFormat(VK_FORMAT_R16G16_SFLOAT)  // velocity
+                                             .setDebugName("gbuff_compact_pipeline")
+                                             .build();
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_rgResources.gbuffCompactPipeline->get(),
+        "gbuff_compact_pipeline");
+#endif // VK_RENDERER_DEBUG
+
+    m_rgResources.gbuffCompactPackedPipeline = VkGfxRenderPipeline::Builder(ctx)
+                                                   .setVertexShaderCode(vertShaderCode)
+                                                   .setFragmentShaderCode(fragShaderCode)
+                                                   .setPipelineLayout(*m_rgResources.gbuffPipelineLayout)
+                                                   .setVertexFormat(VertexFormat::Packed)
+                                                   .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM) // albedo-metallic
+                                                   .addColorAttachmentFormat(VK_FORMAT_R16G16_UNORM)   // octahedral normal
+                                                   .addColorAttachmentFormat(VK_FORMAT_R8G8B8A8_UNORM) // roughness-ao-flags-emissive
+                                                   .addColorAttachmentFormat(VK_FORMAT_R16G16_SFLOAT)  // velocity
+                                                   .setDebugName("gbuff_compact_packed_pipeline")
+                                                   .build();
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_rgResources.gbuffCompactPackedPipeline->get(),
+        "gbuff_compact_packed_pipeline");
+#endif // VK_RENDERER_DEBUG
+
+    // temporal upscaling pass, resolved color of a frame is the history of the next one
+    for (uint32_t historyIdx = 0u; historyIdx < m_rgResources.taaHistoryTextureIds.size(); ++historyIdx)
+    {
+        m_rgResources.taaHistoryTextureIds[historyIdx] = m_textureDB->createStorageTexture(
+            std::format("taa_pass_history_{}", historyIdx),
+            outputExtent.width,
+            outputExtent.height,
+            VK_FORMAT_R16G16B16A16_SFLOAT);
+    }
+
+    m_rgResources.taaPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
+                                          .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(TemporalUpscalePushConstant))
+                                          .addDescriptorSetLayout(*m_globalDescriptorSetLayout)
+                                          .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout())
+                                          .addDescriptorSetLayout(m_textureDB->getStorageTexturesDescriptorSetLayout())
+                                          .build();
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+        (uint64_t)m_rgResources.taaPipelineLayout->get(),
+        "taa_pipeline_layout");
+#endif // VK_RENDERER_DEBUG
+
+    auto taaShaderCode        = FileSystem::readFileBinary(shaderPath / "taa.comp.spv");
+
+    m_rgResources.taaPipeline = VkGfxComputePipeline::Builder(ctx)
+                                    .setComputeShaderCode(taaShaderCode)
+                                    .setPipelineLayout(*m_rgResources.taaPipelineLayout)
+                                    .setDebugName("taa_pipeline")
+                                    .build();
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_rgResources.taaPipeline->get(),
+        "taa_pipeline");
+#endif // VK_RENDERER_DEBUG
+
+    // auto exposure pass, histogram bins and the adapted exposure persist across frames
+    m_rgResources.exposureHistogramTextureId = m_textureDB->createStorageTexture(
+        "auto_exposure_pass_histogram",
+        EXPOSURE_HISTOGRAM_BINS,
+        1,
+        VK_FORMAT_R32_UINT);
+
+    m_rgResources.exposureTextureId = m_textureDB->createStorageTexture(
+        "auto_exposure_pass_exposure",
+        1,
+        1,
+        VK_FORMAT_R32_SFLOAT);
+
+    m_rgResources.autoExposureReset          = true;
+
+    m_rgResources.autoExposurePipelineLayout = VkGfxPipelineLayout::Builder(ctx)
+                                                   .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(AutoExposurePushConstant))
+                                                   .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout())
+                                                   .addDescriptorSetLayout(m_textureDB->getStorageTexturesDescriptorSetLayout())
+                                                   .build();
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+        (uint64_t)m_rgResources.autoExposurePipelineLayout->get(),
+        "auto_exposure_pipeline_layout");
+#endif // VK_RENDERER_DEBUG
+
+    auto histogramShaderCode                 = FileSystem::readFileBinary(shaderPath / "luminance_histogram.comp.spv");
+    auto exposureShaderCode                  = FileSystem::readFileBinary(shaderPath / "exposure.comp.spv");
+
+    m_rgResources.luminanceHistogramPipeline = VkGfxComputePipeline::Builder(ctx)
+                                                   .setComputeShaderCode(histogramShaderCode)
+                                                   .setPipelineLayout(*m_rgResources.autoExposurePipelineLayout)
+                                                   .setDebugName("luminance_histogram_pipeline")
+                                                   .build();
+
+    m_rgResources.exposurePipeline = VkGfxComputePipeline::Builder(ctx)
+                                         .setComputeShaderCode(exposureShaderCode)
+                                         .setPipelineLayout(*m_rgResources.autoExposurePipelineLayout)
+                                         .setDebugName("exposure_pipeline")
+                                         .build();
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_rgResources.luminanceHistogramPipeline->get(),
+        "luminance_histogram_pipeline");
+
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_rgResources.exposurePipeline->get(),
+        "exposure_pipeline");
+#endif // VK_RENDERER_DEBUG
+
     // tonemapping pass
     m_rgResources.toneMappedRenderTextureId = m_textureDB->createColorTexture(
         "tonemap_pass_color",
-        extent.width,
-        extent.height,
+        outputExtent.width,
+        outputExtent.height,
         VK_FORMAT_B8G8R8A8_SRGB);
 
+    // tonemap and presentation passes only sample textures, so they can read them from the descriptor buffer
+    const bool                useTextureDescriptorBuffer = m_textureDB->isDescriptorBufferEnabled();
+    VkGfxDescriptorSetLayout& texturePassLayout          = useTextureDescriptorBuffer
+                                                               ? m_textureDB->getTexturesDescriptorBufferLayout()
+                                                               : m_textureDB->getTexturesDescriptorSetLayout();
+
     m_rgResources.toneMapPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
                                               .addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(ToneMapPushConstant))
-                                              .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout().layout)
+                                              .addDescriptorSetLayout(texturePassLayout)
                                               .build();
 
 #ifdef VK_RENDERER_DEBUG
@@ -979,13 +1862,14 @@ void Engine::prepareRenderGraphResources()
                                         .setPipelineLayout(*m_rgResources.toneMapPipelineLayout)
                                         .addColorAttachmentFormat(VK_FORMAT_B8G8R8A8_SRGB)
                                         .removeVertexInputState()
+                                        .setDescriptorBufferUsage(useTextureDescriptorBuffer)
                                         .setDebugName("tonemap_pipeline")
                                         .build();
 
     // presentation pass
     m_rgResources.presentPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
                                               .addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(PresentationPushConstant))
-                                              .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout().layout)
+                                              .addDescriptorSetLayout(texturePassLayout)
                                               .build();
 
 #ifdef VK_RENDERER_DEBUG
@@ -1006,6 +1890,7 @@ void Engine::prepareRenderGraphResources()
                                         .setPipelineLayout(*m_rgResources.presentPipelineLayout)
                                         .addColorAttachmentFormat(VK_FORMAT_B8G8R8A8_SRGB)
                                         .removeVertexInputState()
+                                        .setDescriptorBufferUsage(useTextureDescriptorBuffer)
                                         .setDebugName("present_pipeline")
                                         .build();
 
@@ -1018,7 +1903,8 @@ void Engine::prepareRenderGraphResources()
 #endif // VK_RENDERER_DEBUG
 
     // lighting pass
-    m_rgResources.lightingRenderTextureId = m_textureDB->createColorTexture(
+    // storage usage lets the tiled compute path write the same target
+    m_rgResources.lightingRenderTextureId = m_textureDB->createStorageTexture(
         "light_pass_color",
         extent.width,
         extent.height,
@@ -1026,9 +1912,10 @@ void Engine::prepareRenderGraphResources()
 
     m_rgResources.lightingPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
                                                .addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(LightingPushConstant))
-                                               .addDescriptorSetLayout(m_globalDescriptorSetLayout->layout)
-                                               .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout().layout)
-                                               .addDescriptorSetLayout(m_lightsSystem->getLightsDescriptorSetLayout().layout)
+                                               .addDescriptorSetLayout(*m_globalDescriptorSetLayout)
+                                               .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout())
+                                               .addDescriptorSetLayout(m_lightsSystem->getLightsDescriptorSetLayout())
+                                               .addDescriptorSetLayout(*m_rgResources.lightClustersDescriptorSetLayout)
                                                .build();
 
 #ifdef VK_RENDERER_DEBUG
@@ -1059,6 +1946,144 @@ void Engine::prepareRenderGraphResources()
         "lighting_pipeline");
 #endif // VK_RENDERER_DEBUG
 
+    // tiled compute lighting pass
+    m_rgResources.tiledLightingPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
+                                                    .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(LightingPushConstant))
+                                                    .addDescriptorSetLayout(*m_globalDescriptorSetLayout)
+                                                    .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout())
+                                                    .addDescriptorSetLayout(m_lightsSystem->getLightsDescriptorSetLayout())
+                                                    .addDescriptorSetLayout(m_textureDB->getStorageTexturesDescriptorSetLayout())
+                                                    .build();
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+        (uint64_t)m_rgResources.tiledLightingPipelineLayout->get(),
+        "tiled_lighting_pipeline_layout");
+#endif // VK_RENDERER_DEBUG
+
+    auto tiledLightingShader            = FileSystem::readFileBinary(shaderPath / "lighting_tiled.comp.spv");
+
+    m_rgResources.tiledLightingPipeline = VkGfxComputePipeline::Builder(ctx)
+                                              .setComputeShaderCode(tiledLightingShader)
+                                              .setPipelineLayout(*m_rgResources.tiledLightingPipelineLayout)
+                                              .setDebugName("tiled_lighting_pipeline")
+                                              .build();
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_rgResources.tiledLightingPipeline->get(),
+        "tiled_lighting_pipeline");
+#endif // VK_RENDERER_DEBUG
+
+    // visibility buffer pass, triangle and instance ids resolved by the material compute pass
+    m_rgResources.visibilityTextureId = m_textureDB->createColorTexture(
+        "visibility_pass_ids",
+        extent.width,
+        extent.height,
+        VK_FORMAT_R32_UINT);
+
+    // material pass binds eight sets, primitive ids need the geometry shader feature
+    // and motion vectors are stored to a two channel image
+    bool visibilitySupported = ctx.physicalDeviceProperties.limits.maxBoundDescriptorSets >= 8u
+                               && ctx.physicalDeviceFeatures.geometryShader
+                               && ctx.physicalDeviceFeatures.shaderStorageImageExtendedFormats;
+
+    if (!visibilitySupported)
+    {
+        DUSK_WARN("Visibility buffer is not supported by the device, g-buffer pass will be used");
+    }
+    else
+    {
+        m_rgResources.visibilityPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
+                                                     .addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(VisibilityPushConstant))
+                                                     .addDescriptorSetLayout(*m_globalDescriptorSetLayout)
+                                                     .addDescriptorSetLayout(*m_renderableDescriptorSetLayout)
+                                                     .build();
+
+#ifdef VK_RENDERER_DEBUG
+        vkdebug::setObjectName(
+            ctx.device,
+            VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+            (uint64_t)m_rgResources.visibilityPipelineLayout->get(),
+            "visibility_pipeline_layout");
+#endif // VK_RENDERER_DEBUG
+
+        auto visibilityVertShaderCode    = FileSystem::readFileBinary(shaderPath / "visibility.vert.spv");
+
+        auto visibilityFragShaderCode    = FileSystem::readFileBinary(shaderPath / "visibility.frag.spv");
+
+        m_rgResources.visibilityPipeline = VkGfxRenderPipeline::Builder(ctx)
+                                               .setVertexShaderCode(visibilityVertShaderCode)
+                                               .setFragmentShaderCode(visibilityFragShaderCode)
+                                               .setPipelineLayout(*m_rgResources.visibilityPipelineLayout)
+                                               .addColorAttachmentFormat(VK_FORMAT_R32_UINT)
+                                               .setDebugName("visibility_pipeline")
+                                               .build();
+
+#ifdef VK_RENDERER_DEBUG
+        vkdebug::setObjectName(
+            ctx.device,
+            VK_OBJECT_TYPE_PIPELINE,
+            (uint64_t)m_rgResources.visibilityPipeline->get(),
+            "visibility_pipeline");
+#endif // VK_RENDERER_DEBUG
+
+        m_rgResources.visibilityPackedPipeline = VkGfxRenderPipeline::Builder(ctx)
+                                                     .setVertexShaderCode(visibilityVertShaderCode)
+                                                     .setFragmentShaderCode(visibilityFragShaderCode)
+                                                     .setPipelineLayout(*m_rgResources.visibilityPipelineLayout)
+                                                     .setVertexFormat(VertexFormat::Packed)
+                                                     .addColorAttachmentFormat(VK_FORMAT_R32_UINT)
+                                                     .setDebugName("visibility_packed_pipeline")
+                                                     .build();
+
+#ifdef VK_RENDERER_DEBUG
+        vkdebug::setObjectName(
+            ctx.device,
+            VK_OBJECT_TYPE_PIPELINE,
+            (uint64_t)m_rgResources.visibilityPackedPipeline->get(),
+            "visibility_packed_pipeline");
+#endif // VK_RENDERER_DEBUG
+
+        m_rgResources.visibilityMaterialPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
+                                                             .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VisibilityMaterialPushConstant))
+                                                             .addDescriptorSetLayout(*m_globalDescriptorSetLayout)
+                                                             .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout())
+                                                             .addDescriptorSetLayout(m_lightsSystem->getLightsDescriptorSetLayout())
+                                                             .addDescriptorSetLayout(*m_rgResources.lightClustersDescriptorSetLayout)
+                                                             .addDescriptorSetLayout(*m_materialDescriptorSetLayout)
+                                                             .addDescriptorSetLayout(*m_renderableDescriptorSetLayout)
+                                                             .addDescriptorSetLayout(*m_meshDataDescriptorSetLayout)
+                                                             .addDescriptorSetLayout(m_textureDB->getStorageTexturesDescriptorSetLayout())
+                                                             .build();
+
+#ifdef VK_RENDERER_DEBUG
+        vkdebug::setObjectName(
+            ctx.device,
+            VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+            (uint64_t)m_rgResources.visibilityMaterialPipelineLayout->get(),
+            "visibility_material_pipeline_layout");
+#endif // VK_RENDERER_DEBUG
+
+        auto visibilityMaterialShader            = FileSystem::readFileBinary(shaderPath / "visibility_material.comp.spv");
+
+        m_rgResources.visibilityMaterialPipeline = VkGfxComputePipeline::Builder(ctx)
+                                                       .setComputeShaderCode(visibilityMaterialShader)
+                                                       .setPipelineLayout(*m_rgResources.visibilityMaterialPipelineLayout)
+                                                       .setDebugName("visibility_material_pipeline")
+                                                       .build();
+#ifdef VK_RENDERER_DEBUG
+        vkdebug::setObjectName(
+            ctx.device,
+            VK_OBJECT_TYPE_PIPELINE,
+            (uint64_t)m_rgResources.visibilityMaterialPipeline->get(),
+            "visibility_material_pipeline");
+#endif // VK_RENDERER_DEBUG
+    }
+
     // brdf lut pipeline
     /*m_rgResources.brdfLUTextureId = m_textureDB->createStorageTexture(
         "brdf_lut_tex",
@@ -1089,7 +2114,7 @@ void Engine::prepareRenderGraphResources()
 
     m_rgResources.brdfLUTPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
                                               .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(BRDFLUTPushConstant))
-                                              .addDescriptorSetLayout(m_textureDB->getStorageTexturesDescriptorSetLayout().layout)
+                                              .addDescriptorSetLayout(m_textureDB->getStorageTexturesDescriptorSetLayout())
                                               .build();
 
 #ifdef VK_RENDERER_DEBUG
@@ -1115,18 +2140,16 @@ void Engine::prepareRenderGraphResources()
         "brdf_lut_pipeline");
 #endif // VK_RENDERER_DEBUG
 
-    // shadow pass for directional and spot lights
-    /*m_rgResources.dirShadowMapsTextureId = m_textureDB->createDepthTextureArray(
-        "dir_shadow_maps",
-        extent.width,
-        extent.height,
-        4,
-        VK_FORMAT_D32_SFLOAT_S8_UINT);*/
-    m_rgResources.dirShadowMapsTextureId = m_textureDB->createDepthTexture(
+    // shadow maps never use stencil, so they skip the stencil plane
+    VkFormat shadowDepthFormat = VK_FORMAT_D32_SFLOAT;
+
+    // shadow pass for directional light, a layer per cascade
+    m_rgResources.dirShadowMapsTextureId = m_textureDB->createDepthTextureArray(
         "dir_shadow_maps",
-        extent.width,
-        extent.height,
-        VK_FORMAT_D32_SFLOAT_S8_UINT);
+        DIR_SHADOW_MAP_RESOLUTION,
+        DIR_SHADOW_MAP_RESOLUTION,
+        DIR_SHADOW_CASCADES_COUNT,
+        shadowDepthFormat);
 
     VkSampler shadowSampler;
     samplerInfo                         = {};
@@ -1148,8 +2171,8 @@ void Engine::prepareRenderGraphResources()
     m_textureDB->updateTextureSampler(m_rgResources.dirShadowMapsTextureId, shadowSampler);
 
     m_rgResources.shadow2DMapPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
-                                                  .addDescriptorSetLayout(m_renderableDescriptorSetLayout->layout)
-                                                  .addDescriptorSetLayout(m_lightsSystem->getLightsDescriptorSetLayout().layout)
+                                                  .addDescriptorSetLayout(*m_renderableDescriptorSetLayout)
+                                                  .addDescriptorSetLayout(m_lightsSystem->getLightsDescriptorSetLayout())
                                                   .build();
 
 #ifdef VK_RENDERER_DEBUG
@@ -1168,17 +2191,103 @@ void Engine::prepareRenderGraphResources()
                                             .setVertexShaderCode(shadowMapVertShaderCode)
                                             .setFragmentShaderCode(shadowMapFragShaderCode)
                                             .setPipelineLayout(*m_rgResources.shadow2DMapPipelineLayout)
-                                            .setViewMask(0)
+                                            .setViewMask(DIR_SHADOW_CASCADES_VIEW_MASK)
+                                            .setDepthFormat(shadowDepthFormat)
                                             .setDebugName("shadow_2d_map_pipeline")
                                             .build();
 
+    m_rgResources.shadow2DMapPackedPipeline = VkGfxRenderPipeline::Builder(ctx)
+                                                  .setVertexShaderCode(shadowMapVertShaderCode)
+                                                  .setFragmentShaderCode(shadowMapFragShaderCode)
+                                                  .setPipelineLayout(*m_rgResources.shadow2DMapPipelineLayout)
+                                                  .setVertexFormat(VertexFormat::Packed)
+                                                  .setViewMask(DIR_SHADOW_CASCADES_VIEW_MASK)
+                                                  .setDepthFormat(shadowDepthFormat)
+                                                  .setDebugName("shadow_2d_map_packed_pipeline")
+                                                  .build();
+
+    // shadow atlas for point and spot lights, static casters are cached in a
+    // separate atlas which is restored into the live one before dynamic casters
+    m_rgResources.localShadowAtlasTextureId = m_textureDB->createDepthTexture(
+        "local_shadow_atlas",
+        LOCAL_SHADOW_ATLAS_RESOLUTION,
+        LOCAL_SHADOW_ATLAS_RESOLUTION,
+        shadowDepthFormat);
+
+    m_rgResources.localShadowStaticAtlasTextureId = m_textureDB->createDepthTexture(
+        "local_shadow_static_atlas",
+        LOCAL_SHADOW_ATLAS_RESOLUTION,
+        LOCAL_SHADOW_ATLAS_RESOLUTION,
+        shadowDepthFormat);
+
+    VkSampler localShadowSampler;
+    vkCreateSampler(ctx.device, &samplerInfo, nullptr, &localShadowSampler);
+    m_textureDB->updateTextureSampler(m_rgResources.localShadowAtlasTextureId, localShadowSampler);
+
+    m_rgResources.localShadowPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
+                                                  .addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(LocalShadowPushConstant))
+                                                  .addDescriptorSetLayout(*m_renderableDescriptorSetLayout)
+                                                  .addDescriptorSetLayout(m_lightsSystem->getLightsDescriptorSetLayout())
+                                                  .addDescriptorSetLayout(m_textureDB->getTexturesDescriptorSetLayout())
+                                                  .build();
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+        (uint64_t)m_rgResources.localShadowPipelineLayout->get(),
+        "local_shadow_pipeline_layout");
+#endif // VK_RENDERER_DEBUG
+
+    auto localShadowVertShaderCode    = FileSystem::readFileBinary(shaderPath / "local_shadows.vert.spv");
+    auto fullscreenVertShaderCode     = FileSystem::readFileBinary(shaderPath / "triangle.vert.spv");
+    auto atlasRestoreFragShaderCode   = FileSystem::readFileBinary(shaderPath / "shadow_atlas_restore.frag.spv");
+
+    m_rgResources.localShadowPipeline = VkGfxRenderPipeline::Builder(ctx)
+                                            .setVertexShaderCode(localShadowVertShaderCode)
+                                            .setFragmentShaderCode(shadowMapFragShaderCode)
+                                            .setPipelineLayout(*m_rgResources.localShadowPipelineLayout)
+                                            .setDepthFormat(shadowDepthFormat)
+                                            .setDebugName("local_shadow_pipeline")
+                                            .build();
+
+    m_rgResources.localShadowPackedPipeline = VkGfxRenderPipeline::Builder(ctx)
+                                                  .setVertexShaderCode(localShadowVertShaderCode)
+                                                  .setFragmentShaderCode(shadowMapFragShaderCode)
+                                                  .setPipelineLayout(*m_rgResources.localShadowPipelineLayout)
+                                                  .setVertexFormat(VertexFormat::Packed)
+                                                  .setDepthFormat(shadowDepthFormat)
+                                                  .setDebugName("local_shadow_packed_pipeline")
+                                                  .build();
+
+    m_rgResources.localShadowRestorePipeline = VkGfxRenderPipeline::Builder(ctx)
+                                                   .setVertexShaderCode(fullscreenVertShaderCode)
+                                                   .setFragmentShaderCode(atlasRestoreFragShaderCode)
+                                                   .setPipelineLayout(*m_rgResources.localShadowPipelineLayout)
+                                                   .removeVertexInputState()
+                                                   .setDepthFormat(shadowDepthFormat)
+                                                   .setDebugName("local_shadow_restore_pipeline")
+                                                   .build();
+
+    // casters are culled on the host per shadow view, draws are written every frame
+    m_rgResources.frameLocalShadowDrawsBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t frameIdx = 0u; frameIdx < MAX_FRAMES_IN_FLIGHT; ++frameIdx)
+    {
+        GfxBuffer::createHostWriteBuffer(
+            GfxBufferUsageFlags::IndirectBuffer,
+            sizeof(GfxIndexedIndirectDrawCommand) * MAX_LOCAL_SHADOW_DRAWS,
+            1,
+            std::format("local_shadow_draws_buffer_{}", std::to_string(frameIdx)),
+            &m_rgResources.frameLocalShadowDrawsBuffers[frameIdx]);
+    }
+
     // cull & lod compute pipeline
     m_rgResources.cullLodPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
                                               .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullLodPushConstant))
-                                              .addDescriptorSetLayout(m_globalDescriptorSetLayout->layout)
-                                              .addDescriptorSetLayout(m_meshDataDescriptorSetLayout->layout)
-                                              .addDescriptorSetLayout(m_renderableDescriptorSetLayout->layout)
-                                              .addDescriptorSetLayout(m_rgResources.indirectDrawDescriptorSetLayout->layout)
+                                              .addDescriptorSetLayout(*m_globalDescriptorSetLayout)
+                                              .addDescriptorSetLayout(*m_meshDataDescriptorSetLayout)
+                                              .addDescriptorSetLayout(*m_renderableDescriptorSetLayout)
+                                              .addDescriptorSetLayout(*m_rgResources.indirectDrawDescriptorSetLayout)
                                               .build();
 
 #ifdef VK_RENDERER_DEBUG
@@ -1203,6 +2312,37 @@ void Engine::prepareRenderGraphResources()
         (uint64_t)m_rgResources.cullLodPipeline->get(),
         "cull_lod_pipeline");
 #endif // VK_RENDERER_DEBUG
+
+    // light clusters compute pipeline
+    m_rgResources.lightClustersPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
+                                                    .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(LightClustersPushConstant))
+                                                    .addDescriptorSetLayout(*m_globalDescriptorSetLayout)
+                                                    .addDescriptorSetLayout(m_lightsSystem->getLightsDescriptorSetLayout())
+                                                    .addDescriptorSetLayout(*m_rgResources.lightClustersDescriptorSetLayout)
+                                                    .build();
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+        (uint64_t)m_rgResources.lightClustersPipelineLayout->get(),
+        "light_clusters_pipeline_layout");
+#endif // VK_RENDERER_DEBUG
+
+    auto lightClustersShader            = FileSystem::readFileBinary(shaderPath / "light_clusters.comp.spv");
+
+    m_rgResources.lightClustersPipeline = VkGfxComputePipeline::Builder(ctx)
+                                              .setComputeShaderCode(lightClustersShader)
+                                              .setPipelineLayout(*m_rgResources.lightClustersPipelineLayout)
+                                              .setDebugName("light_clusters_pipeline")
+                                              .build();
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_rgResources.lightClustersPipeline->get(),
+        "light_clusters_pipeline");
+#endif // VK_RENDERER_DEBUG
 }
 
 void Engine::releaseRenderGraphResources()
@@ -1214,29 +2354,68 @@ void Engine::releaseRenderGraphResources()
         buffer.cleanup();
 
     m_rgResources.indirectDrawDescriptorPool->resetPool();
-    m_rgResources.indirectDrawDescriptorSetLayout = nullptr;
-    m_rgResources.indirectDrawDescriptorPool      = nullptr;
+    m_rgResources.indirectDrawDescriptorSetLayout  = nullptr;
+    m_rgResources.indirectDrawDescriptorPool       = nullptr;
+
+    m_rgResources.gbuffPipeline                    = nullptr;
+    m_rgResources.gbuffPackedPipeline              = nullptr;
+    m_rgResources.gbuffPipelineLayout              = nullptr;
+    m_rgResources.gbuffCompactPipeline             = nullptr;
+    m_rgResources.gbuffCompactPackedPipeline       = nullptr;
+
+    m_rgResources.visibilityPipeline               = nullptr;
+    m_rgResources.visibilityPackedPipeline         = nullptr;
+    m_rgResources.visibilityPipelineLayout         = nullptr;
+    m_rgResources.visibilityMaterialPipeline       = nullptr;
+    m_rgResources.visibilityMaterialPipelineLayout = nullptr;
+
+    m_rgResources.taaPipeline                      = nullptr;
+    m_rgResources.taaPipelineLayout                = nullptr;
 
-    m_rgResources.gbuffPipeline                   = nullptr;
-    m_rgResources.gbuffPipelineLayout             = nullptr;
+    m_rgResources.luminanceHistogramPipeline       = nullptr;
+    m_rgResources.exposurePipeline                 = nullptr;
+    m_rgResources.autoExposurePipelineLayout       = nullptr;
 
-    m_rgResources.toneMapPipeline                 = nullptr;
-    m_rgResources.toneMapPipelineLayout           = nullptr;
+    m_rgResources.toneMapPipeline                  = nullptr;
+    m_rgResources.toneMapPipelineLayout            = nullptr;
 
-    m_rgResources.presentPipeline                 = nullptr;
-    m_rgResources.presentPipelineLayout           = nullptr;
+    m_rgResources.presentPipeline                  = nullptr;
+    m_rgResources.presentPipelineLayout            = nullptr;
 
-    m_rgResources.lightingPipeline                = nullptr;
-    m_rgResources.lightingPipelineLayout          = nullptr;
+    m_rgResources.lightingPipeline                 = nullptr;
+    m_rgResources.lightingPipelineLayout           = nullptr;
+    m_rgResources.tiledLightingPipeline            = nullptr;
+    m_rgResources.tiledLightingPipelineLayout      = nullptr;
 
-    m_rgResources.brdfLUTPipeline                 = nullptr;
-    m_rgResources.brdfLUTPipelineLayout           = nullptr;
+    m_rgResources.brdfLUTPipeline                  = nullptr;
+    m_rgResources.brdfLUTPipelineLayout            = nullptr;
 
-    m_rgResources.shadow2DMapPipeline             = nullptr;
-    m_rgResources.shadow2DMapPipelineLayout       = nullptr;
+    m_rgResources.shadow2DMapPipeline              = nullptr;
+    m_rgResources.shadow2DMapPackedPipeline        = nullptr;
+    m_rgResources.shadow2DMapPipelineLayout        = nullptr;
+
+    m_rgResources.localShadowPipeline              = nullptr;
+    m_rgResources.localShadowPackedPipeline        = nullptr;
+    m_rgResources.localShadowRestorePipeline       = nullptr;
+    m_rgResources.localShadowPipelineLayout        = nullptr;
+
+    for (auto& buffer : m_rgResources.frameLocalShadowDrawsBuffers)
+        buffer.cleanup();
 
     m_rgResources.cullLodPipeline                 = nullptr;
     m_rgResources.cullLodPipelineLayout           = nullptr;
+
+    for (auto& buffer : m_rgResources.frameLightClustersBuffers)
+        buffer.cleanup();
+
+    for (auto& buffer : m_rgResources.frameClusterLightIndicesBuffers)
+        buffer.cleanup();
+
+    m_rgResources.lightClustersDescriptorPool->resetPool();
+    m_rgResources.lightClustersDescriptorSetLayout = nullptr;
+    m_rgResources.lightClustersDescriptorPool      = nullptr;
+    m_rgResources.lightClustersPipeline            = nullptr;
+    m_rgResources.lightClustersPipelineLayout      = nullptr;
 }
 
 void Engine::executeBRDFLUTcomputePipeline()
@@ -1312,88 +2491,239 @@ void Engine::executeBRDFLUTcomputePipeline()
     vkFreeCommandBuffers(ctx.device, ctx.commandPool, 1, &commandBuffer);
 }
 
-size_t Engine::copyToVertexBuffer(const GfxBuffer& srcVertexBuffer, size_t size)
+bool Engine::uploadVertexAndIndexBuffers(
+    const Vertex*          vertices,
+    size_t                 totalVertices,
+    const uint32_t*        indices,
+    size_t                 totalIndices,
+    GfxGeometryAllocation* outAllocation)
+{
+    return uploadGeometry(VertexFormat::Full, vertices, totalVertices, indices, totalIndices, outAllocation);
+}
+
+bool Engine::uploadVertexAndIndexBuffers(
+    const PackedVertex*    vertices,
+    size_t                 totalVertices,
+    const uint16_t*        indices,
+    size_t                 totalIndices,
+    GfxGeometryAllocation* outAllocation)
 {
-    size_t startOffset = m_availableVertexOffset;
+    return uploadGeometry(VertexFormat::Packed, vertices, totalVertices, indices, totalIndices, outAllocation);
+}
 
-    m_gfxDevice->copyBuffer(
-        srcVertexBuffer.vkBuffer,
-        0,
-        m_vertexBuffer.vkBuffer,
-        m_availableVertexOffset * sizeof(Vertex),
-        size);
+bool Engine::uploadGeometry(
+    VertexFormat           format,
+    const void*            vertices,
+    size_t                 totalVertices,
+    const void*            indices,
+    size_t                 totalIndices,
+    GfxGeometryAllocation* outAllocation)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    bool            isPacked        = format == VertexFormat::Packed;
+    GfxBuffer&      vertexBuffer    = getVertexBuffer(format);
+    GfxBuffer&      indexBuffer     = getIndexBuffer(format);
+    RangeAllocator& vertexAllocator = isPacked ? m_packedVertexAllocator : m_vertexAllocator;
+    RangeAllocator& indexAllocator  = isPacked ? m_packedIndexAllocator : m_indexAllocator;
+    size_t          vertexSize      = isPacked ? sizeof(PackedVertex) : sizeof(Vertex);
+    size_t          indexSize       = isPacked ? sizeof(uint16_t) : sizeof(uint32_t);
+
+    size_t          vertexOffset    = 0u;
+    size_t          firstIndex      = 0u;
+
+    if (!vertexAllocator.allocate(totalVertices, &vertexOffset))
+    {
+        DUSK_ERROR("Not enough space in global vertex buffer for {} vertices", totalVertices);
+        return false;
+    }
 
-    m_availableVertexOffset += size / sizeof(Vertex);
+    if (!indexAllocator.allocate(totalIndices, &firstIndex))
+    {
+        DUSK_ERROR("Not enough space in global index buffer for {} indices", totalIndices);
+        vertexAllocator.free(vertexOffset, totalVertices);
+        return false;
+    }
 
-    return startOffset;
+    outAllocation->format       = format;
+    outAllocation->vertexOffset = static_cast<int32_t>(vertexOffset);
+    outAllocation->vertexCount  = static_cast<uint32_t>(totalVertices);
+    outAllocation->firstIndex   = static_cast<uint32_t>(firstIndex);
+    outAllocation->indexCount   = static_cast<uint32_t>(totalIndices);
+
+    // data is streamed in chunks, so host memory is never duplicated for the whole scene
+    Error err = m_stagingRing->upload(
+        vertices,
+        totalVertices * vertexSize,
+        vertexBuffer,
+        vertexOffset * vertexSize);
+
+    if (err == Error::Ok)
+    {
+        err = m_stagingRing->upload(
+            indices,
+            totalIndices * indexSize,
+            indexBuffer,
+            firstIndex * indexSize);
+    }
+
+    m_stagingRing->flush();
+
+    if (err != Error::Ok)
+    {
+        DUSK_ERROR("Unable to upload vertex and index data");
+        vertexAllocator.free(vertexOffset, totalVertices);
+        indexAllocator.free(firstIndex, totalIndices);
+        return false;
+    }
+
+    return true;
 }
 
-size_t Engine::copyToIndexBuffer(const GfxBuffer& srcIndexBuffer, size_t size)
+void Engine::releaseVertexAndIndexBuffers(const GfxGeometryAllocation& allocation)
 {
-    size_t startOffset = m_availableIndexOffset;
+    // ranges might still be referenced by frames in flight
+    m_pendingGeometryReleases.push_back({ allocation, m_frameCounter + MAX_FRAMES_IN_FLIGHT });
+}
 
-    m_gfxDevice->copyBuffer(
-        srcIndexBuffer.vkBuffer,
-        0,
-        m_indexBuffer.vkBuffer,
-        m_availableIndexOffset * sizeof(uint32_t),
-        size);
+void Engine::resizeRenderTargets(VkExtent2D outputExtent, VkExtent2D renderExtent)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    DUSK_INFO(
+        "Resizing render targets to {}x{}, render extent {}x{}",
+        outputExtent.width,
+        outputExtent.height,
+        renderExtent.width,
+        renderExtent.height);
+
+    // targets drawn at render scale are allocated at output size as well
+    DynamicArray<uint32_t> textureIds = m_rgResources.gbuffRenderTextureIds;
+    textureIds.push_back(m_rgResources.gbuffDepthTextureId);
+    textureIds.push_back(m_rgResources.gbuffCompactNormalTextureId);
+    textureIds.push_back(m_rgResources.velocityTextureId);
+    textureIds.push_back(m_rgResources.visibilityTextureId);
+    textureIds.push_back(m_rgResources.lightingRenderTextureId);
+    textureIds.push_back(m_rgResources.toneMappedRenderTextureId);
+    textureIds.insert(textureIds.end(), m_rgResources.taaHistoryTextureIds.begin(), m_rgResources.taaHistoryTextureIds.end());
+
+    // frames which used the previous images were drained by swapchain recreation,
+    // they are still released through the frame counter like any other resource
+    for (uint32_t textureId : textureIds)
+    {
+        GfxTexture oldTexture {};
+        if (m_textureDB->resizeRenderTexture(textureId, outputExtent.width, outputExtent.height, &oldTexture))
+        {
+            m_pendingTextureReleases.push_back({ oldTexture, m_frameCounter + MAX_FRAMES_IN_FLIGHT });
+        }
+    }
 
-    m_availableIndexOffset += size / sizeof(uint32_t);
+    m_rgResources.renderExtent = renderExtent;
+    m_rgResources.outputExtent = outputExtent;
 
-    return startOffset;
+    // history of the previous size can't be reprojected
+    m_rgResources.taaResetHistory = true;
 }
 
-// TODO:: implement with chunks if needed
-void Engine::uploadVertexAndIndexBuffers(
-    DynamicArray<Vertex>&   vertices,
-    DynamicArray<uint32_t>& indices,
-    int*                    outVertexOffset,
-    uint32_t*               outfirstIndex)
+VkExtent2D Engine::getScaledRenderExtent(VkExtent2D outputExtent) const
 {
-    *outVertexOffset        = static_cast<int>(m_availableVertexOffset);
-    *outfirstIndex          = static_cast<uint32_t>(m_availableIndexOffset);
+    return {
+        std::max(1u, static_cast<uint32_t>(static_cast<float>(outputExtent.width) * m_renderScale)),
+        std::max(1u, static_cast<uint32_t>(static_cast<float>(outputExtent.height) * m_renderScale))
+    };
+}
 
-    auto      totalVertices = vertices.size();
-    auto      totalIndices  = indices.size();
+void Engine::setTemporalUpscalingEnabled(bool enabled)
+{
+    m_temporalUpscaling = enabled;
 
-    GfxBuffer stagingBuffer;
-    size_t    stagingBufferSize = vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t);
-    GfxBuffer::createHostWriteBuffer(
-        GfxBufferUsageFlags::TransferSource,
-        stagingBufferSize,
-        1,
-        "staging_vertex_index_buffer",
-        &stagingBuffer);
+    // history was not written while disabled
+    m_rgResources.taaResetHistory = true;
+}
 
-    // upload vertex buffer
-    stagingBuffer.writeAndFlush(0, (void*)vertices.data(), totalVertices * sizeof(Vertex));
+void Engine::setRenderScale(float scale)
+{
+    m_renderScale = std::clamp(scale, MIN_RENDER_SCALE, 1.f);
+}
 
-    m_gfxDevice->copyBuffer(
-        stagingBuffer.vkBuffer,
-        0,
-        m_vertexBuffer.vkBuffer,
-        m_availableVertexOffset * sizeof(Vertex),
-        totalVertices * sizeof(Vertex));
+void Engine::setDynamicResolutionEnabled(bool enabled)
+{
+    m_dynamicResolution = enabled;
 
-    m_availableVertexOffset += totalVertices;
+    if (enabled)
+    {
+        m_resolutionController.init(m_resolutionController.getConfig());
+        applyResolutionSettings(m_resolutionController.getSettings());
+    }
+    else
+    {
+        applyResolutionSettings({ .renderScale = m_renderScale });
+    }
+}
 
-    // upload index buffer
-    stagingBuffer.writeAndFlush(
-        totalVertices * sizeof(Vertex),
-        (void*)indices.data(),
-        totalIndices * sizeof(uint32_t));
+void Engine::setAutoExposureEnabled(bool enabled)
+{
+    m_autoExposure = enabled;
 
-    m_gfxDevice->copyBuffer(
-        stagingBuffer.vkBuffer,
-        totalVertices * sizeof(Vertex),
-        m_indexBuffer.vkBuffer,
-        m_availableIndexOffset * sizeof(uint32_t),
-        totalIndices * sizeof(uint32_t));
+    // exposure of a disabled period would adapt slowly from a stale value
+    m_rgResources.autoExposureReset = true;
+}
 
-    m_availableIndexOffset += totalIndices;
+void Engine::applyResolutionSettings(const ResolutionSettings& settings)
+{
+    DUSK_INFO(
+        "Resolution settings changed to render scale {:.2f}, shadow scale {:.2f}, texture lod bias {:.1f}",
+        settings.renderScale,
+        settings.shadowScale,
+        settings.textureLodBias);
+
+    // render extent follows on the next frame
+    setRenderScale(settings.renderScale);
+    m_lightsSystem->setShadowResolutionScale(settings.shadowScale);
+    m_textureLodBias = settings.textureLodBias;
+}
 
-    stagingBuffer.cleanup();
+void Engine::releasePendingTextures()
+{
+    for (size_t index = 0u; index < m_pendingTextureReleases.size();)
+    {
+        auto& pending = m_pendingTextureReleases[index];
+
+        if (pending.releaseFrame > m_frameCounter)
+        {
+            ++index;
+            continue;
+        }
+
+        pending.texture.cleanup();
+
+        m_pendingTextureReleases[index] = m_pendingTextureReleases.back();
+        m_pendingTextureReleases.pop_back();
+    }
+}
+
+void Engine::releasePendingGeometry()
+{
+    for (size_t index = 0u; index < m_pendingGeometryReleases.size();)
+    {
+        const auto& pending = m_pendingGeometryReleases[index];
+
+        if (pending.releaseFrame > m_frameCounter)
+        {
+            ++index;
+            continue;
+        }
+
+        bool            isPacked        = pending.allocation.format == VertexFormat::Packed;
+        RangeAllocator& vertexAllocator = isPacked ? m_packedVertexAllocator : m_vertexAllocator;
+        RangeAllocator& indexAllocator  = isPacked ? m_packedIndexAllocator : m_indexAllocator;
+
+        vertexAllocator.free(pending.allocation.vertexOffset, pending.allocation.vertexCount);
+        indexAllocator.free(pending.allocation.firstIndex, pending.allocation.indexCount);
+
+        m_pendingGeometryReleases[index] = m_pendingGeometryReleases.back();
+        m_pendingGeometryReleases.pop_back();
+    }
 }
 
 } // namespace dusk
\ No newline at end of file
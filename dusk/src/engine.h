@@ -7,6 +7,11 @@
 #include "renderer/frame_data.h"
 #include "renderer/gfx_types.h"
 #include "renderer/vertex.h"
+#include "renderer/texture.h"
+#include "renderer/range_allocator.h"
+#include "renderer/upload_arena.h"
+#include "renderer/transfer_scheduler.h"
+#include "renderer/resolution_controller.h"
 
 #include "backend/vulkan/vk_descriptors.h"
 #include "backend/vulkan/vk_pipeline.h"
@@ -30,15 +35,26 @@ class VulkanRenderer;
 class VkGfxDevice;
 class StatsRecorder;
 class TransformSystem;
+class StagingRing;
 
 struct Material;
 struct VkGfxDescriptorPool;
 struct VkGfxDescriptorSetLayout;
 struct VkGfxDescriptorSet;
 
-static constexpr uint32_t MAX_MATERIALS_COUNT   = 1000;
+// requested size of the bindless material array, clamped to update after bind limits of the device
+static constexpr uint32_t MAX_MATERIALS_COUNT   = 16384;
 static constexpr uint32_t MAX_RENDERABLES_COUNT = 10000;
 
+// regions of the frame indirect draw buffer, each holds MAX_RENDERABLES_COUNT commands
+static constexpr uint32_t GBUFFER_DRAWS_REGION        = 0;
+static constexpr uint32_t SHADOW_DRAWS_REGION         = 1;
+static constexpr uint32_t GBUFFER_PACKED_DRAWS_REGION = 2;
+static constexpr uint32_t INDIRECT_DRAW_REGIONS_COUNT = 3;
+
+// lowest resolution of the render targets relative to the swapchain
+static constexpr float MIN_RENDER_SCALE = 0.5f;
+
 struct DrawData
 {
     uint32_t cameraBufferIdx;
@@ -51,6 +67,12 @@ struct DrawData
 
 struct RenderGraphResources
 {
+    // region of the size dependent render targets which is drawn, scaled down from
+    // the output extent when rendering at a lower resolution. Targets themselves
+    // are allocated at the output extent.
+    VkExtent2D                               renderExtent                     = {};
+    VkExtent2D                               outputExtent                     = {};
+
     DynamicArray<GfxBuffer>                  frameIndirectDrawCommandsBuffers = {};
     DynamicArray<GfxBuffer>                  frameIndirectDrawCountBuffers    = {};
     Unique<VkGfxDescriptorPool>              indirectDrawDescriptorPool       = nullptr;
@@ -60,14 +82,30 @@ struct RenderGraphResources
     DynamicArray<uint32_t>                   gbuffRenderTextureIds            = {};
     uint32_t                                 gbuffDepthTextureId              = {};
     Unique<VkGfxRenderPipeline>              gbuffPipeline                    = nullptr;
+    Unique<VkGfxRenderPipeline>              gbuffPackedPipeline              = nullptr;
     Unique<VkGfxPipelineLayout>              gbuffPipelineLayout              = nullptr;
 
+    uint32_t                                 gbuffCompactNormalTextureId      = {};
+    Unique<VkGfxRenderPipeline>              gbuffCompactPipeline             = nullptr;
+    Unique<VkGfxRenderPipeline>              gbuffCompactPackedPipeline       = nullptr;
+
+    uint32_t                                 velocityTextureId                = {};
+
+    uint32_t                                 visibilityTextureId              = {};
+    Unique<VkGfxRenderPipeline>              visibilityPipeline               = nullptr;
+    Unique<VkGfxRenderPipeline>              visibilityPackedPipeline         = nullptr;
+    Unique<VkGfxPipelineLayout>              visibilityPipelineLayout         = nullptr;
+    Unique<VkGfxComputePipeline>             visibilityMaterialPipeline       = nullptr;
+    Unique<VkGfxPipelineLayout>              visibilityMaterialPipelineLayout = nullptr;
+
     Unique<VkGfxRenderPipeline>              presentPipeline                  = nullptr;
     Unique<VkGfxPipelineLayout>              presentPipelineLayout            = nullptr;
 
     uint32_t                                 lightingRenderTextureId          = {};
     Unique<VkGfxRenderPipeline>              lightingPipeline                 = nullptr;
     Unique<VkGfxPipelineLayout>              lightingPipelineLayout           = nullptr;
+    Unique<VkGfxComputePipeline>             tiledLightingPipeline            = nullptr;
+    Unique<VkGfxPipelineLayout>              tiledLightingPipelineLayout      = nullptr;
 
     uint32_t                                 brdfLUTextureId                  = {};
     Unique<VkGfxComputePipeline>             brdfLUTPipeline                  = nullptr;
@@ -75,12 +113,42 @@ struct RenderGraphResources
     bool                                     brdfLUTGenerated                 = false;
 
     Unique<VkGfxRenderPipeline>              shadow2DMapPipeline              = nullptr;
+    Unique<VkGfxRenderPipeline>              shadow2DMapPackedPipeline        = nullptr;
     Unique<VkGfxPipelineLayout>              shadow2DMapPipelineLayout        = nullptr;
     uint32_t                                 dirShadowMapsTextureId           = {};
 
+    uint32_t                                 localShadowAtlasTextureId        = {};
+    uint32_t                                 localShadowStaticAtlasTextureId  = {};
+    Unique<VkGfxRenderPipeline>              localShadowPipeline              = nullptr;
+    Unique<VkGfxRenderPipeline>              localShadowPackedPipeline        = nullptr;
+    Unique<VkGfxRenderPipeline>              localShadowRestorePipeline       = nullptr;
+    Unique<VkGfxPipelineLayout>              localShadowPipelineLayout        = nullptr;
+    DynamicArray<GfxBuffer>                  frameLocalShadowDrawsBuffers     = {};
+
     Unique<VkGfxComputePipeline>             cullLodPipeline                  = nullptr;
     Unique<VkGfxPipelineLayout>              cullLodPipelineLayout            = nullptr;
 
+    DynamicArray<GfxBuffer>                  frameLightClustersBuffers        = {};
+    DynamicArray<GfxBuffer>                  frameClusterLightIndicesBuffers  = {};
+    Unique<VkGfxDescriptorPool>              lightClustersDescriptorPool      = nullptr;
+    Unique<VkGfxDescriptorSetLayout>         lightClustersDescriptorSetLayout = nullptr;
+    DynamicArray<Unique<VkGfxDescriptorSet>> lightClustersDescriptorSets      = {};
+    Unique<VkGfxComputePipeline>             lightClustersPipeline            = nullptr;
+    Unique<VkGfxPipelineLayout>              lightClustersPipelineLayout      = nullptr;
+
+    Array<uint32_t, 2>                       taaHistoryTextureIds             = {};
+    uint32_t                                 taaHistoryIdx                    = 0u;
+    bool                                     taaResetHistory                  = true;
+    Unique<VkGfxComputePipeline>             taaPipeline                      = nullptr;
+    Unique<VkGfxPipelineLayout>              taaPipelineLayout                = nullptr;
+
+    uint32_t                                 exposureHistogramTextureId       = {};
+    uint32_t                                 exposureTextureId                = {};
+    bool                                     autoExposureReset                = true;
+    Unique<VkGfxComputePipeline>             luminanceHistogramPipeline       = nullptr;
+    Unique<VkGfxComputePipeline>             exposurePipeline                 = nullptr;
+    Unique<VkGfxPipelineLayout>              autoExposurePipelineLayout       = nullptr;
+
     uint32_t                                 toneMappedRenderTextureId        = {};
     Unique<VkGfxRenderPipeline>              toneMapPipeline                  = nullptr;
     Unique<VkGfxPipelineLayout>              toneMapPipelineLayout            = nullptr;
@@ -96,12 +164,48 @@ class Engine final
 public:
     struct Config
     {
-        RenderAPI::API renderAPI;
+        RenderAPI::API               renderAPI;
+
+        // frame pacing
+        uint32_t                     framesInFlight;
+        bool                         lowLatencyMode;
+        TimeStep                     targetFrameTime; // zero disables the frame limiter
+
+        // lighting path
+        bool                         tiledLighting;    // compute tiles instead of fragment pass with clusters
+        bool                         visibilityBuffer; // triangle ids and compute material pass instead of g-buffer
+        bool                         compactGBuffer;   // three packed g-buffer targets instead of four
+        bool                         packedVertices;   // small meshes use compressed vertices with 16 bit indices
+
+        // render resolution
+        bool                         temporalUpscaling; // jittered frames resolved with reprojected history
+        float                        renderScale;       // scale of the render targets relative to the swapchain
+        bool                         dynamicResolution; // render scale, shadows and texture detail follow the gpu time
+        ResolutionController::Config resolutionControl; // target gpu time and bounds of the dynamic resolution
+
+        // post processing
+        bool                         autoExposure; // exposure adapts to the luminance histogram of the frame
 
-        static Config  defaultConfig()
+        // environment
+        bool                         dynamicSky; // hosek-wilkie sky, image based lighting is rebuilt over several frames
+
+        static Config                defaultConfig()
         {
-            auto config      = Config {};
-            config.renderAPI = RenderAPI::API::VULKAN;
+            auto config              = Config {};
+            config.renderAPI         = RenderAPI::API::VULKAN;
+            config.framesInFlight    = DEFAULT_FRAMES_IN_FLIGHT;
+            config.lowLatencyMode    = false;
+            config.targetFrameTime   = TimeStep(0.f);
+            config.tiledLighting     = false;
+            config.visibilityBuffer  = false;
+            config.compactGBuffer    = false;
+            config.packedVertices    = true;
+            config.temporalUpscaling = false;
+            config.renderScale       = 1.f;
+            config.dynamicResolution = false;
+            config.resolutionControl = ResolutionController::Config::defaultConfig();
+            config.autoExposure      = false;
+            config.dynamicSky        = false;
             return config;
         }
     };
@@ -119,6 +223,7 @@ public:
     void                            onUpdate(TimeStep dt);
     void                            onEvent(Event& ev);
     void                            loadScene(Scene* scene);
+    void                            unloadScene(Scene* scene);
     DynamicArray<VulkanSubmitBatch> renderFrame(FrameData& frameData);
 
     static Engine&                  get() { return *s_instance; }
@@ -133,15 +238,130 @@ public:
 
     void                            registerMaterials(DynamicArray<Material>& materials);
 
-    void                            updateMaterialsBuffer(DynamicArray<Material>& materials);
-    void                            uploadVertexAndIndexBuffers(
-                                   DynamicArray<Vertex>&   vertices,
-                                   DynamicArray<uint32_t>& indices,
-                                   int*                    outVertexOffset,
-                                   uint32_t*               firstIndex);
+    /**
+     * @brief Stage materials modified since the last upload of the frame copy in
+     * the frame upload arena and queue their copies into the device local materials
+     * buffer of the frame on the transfer queue. Contiguous ids are copied in a
+     * single batch.
+     * @param scene owning the materials
+     * @param frameIndex of the frame being recorded
+     */
+    void updateMaterialsBuffer(Scene& scene, uint32_t frameIndex);
+
+    /**
+     * @brief Allocate ranges in the global vertex and index buffers and stream
+     * the data into them through the staging ring on the transfer queue.
+     * @param vertices to upload
+     * @param totalVertices count of vertices
+     * @param indices to upload
+     * @param totalIndices count of indices
+     * @param outAllocation allocated ranges of the global buffers
+     * @return true if upload was successful
+     */
+    bool uploadVertexAndIndexBuffers(
+        const Vertex*          vertices,
+        size_t                 totalVertices,
+        const uint32_t*        indices,
+        size_t                 totalIndices,
+        GfxGeometryAllocation* outAllocation);
+
+    /**
+     * @brief Allocate ranges in the global packed vertex and uint16 index buffers
+     * and stream the data into them through the staging ring on the transfer queue.
+     * @param vertices to upload
+     * @param totalVertices count of vertices
+     * @param indices to upload
+     * @param totalIndices count of indices
+     * @param outAllocation allocated ranges of the global buffers
+     * @return true if upload was successful
+     */
+    bool uploadVertexAndIndexBuffers(
+        const PackedVertex*    vertices,
+        size_t                 totalVertices,
+        const uint16_t*        indices,
+        size_t                 totalIndices,
+        GfxGeometryAllocation* outAllocation);
+
+    /**
+     * @brief Release ranges of the global vertex and index buffers. Ranges are
+     * reused only after all the frames in flight have finished.
+     * @param allocation to release
+     */
+    void releaseVertexAndIndexBuffers(const GfxGeometryAllocation& allocation);
 
     TimeStep              getFrameDelta() const { return m_deltaTime; };
 
+    /**
+     * @brief Set minimum duration of a frame, main loop sleeps for the rest of it
+     * @param frameTime target duration, zero disables the limiter
+     */
+    void                  setTargetFrameTime(TimeStep frameTime) { m_targetFrameTime = frameTime; }
+    TimeStep              getTargetFrameTime() const { return m_targetFrameTime; }
+
+    /**
+     * @brief Select the tiled compute lighting path instead of the fragment
+     * lighting pass with light clusters, takes effect from the next frame
+     * @param enabled true to use the tiled compute path
+     */
+    void                  setTiledLightingEnabled(bool enabled) { m_tiledLighting = enabled; }
+    bool                  isTiledLightingEnabled() const { return m_tiledLighting; }
+
+    /**
+     * @brief Select the visibility buffer path, geometry pass writes triangle ids
+     * and a compute pass evaluates materials and lighting. Falls back to the
+     * g-buffer path when the device can't run it, takes effect from the next frame
+     * @param enabled true to use the visibility buffer
+     */
+    void                  setVisibilityBufferEnabled(bool enabled) { m_visibilityBuffer = enabled; }
+    bool                  isVisibilityBufferEnabled() const { return m_visibilityBuffer; }
+
+    /**
+     * @brief Select the compact g-buffer layout with octahedral normals and
+     * emissive packed with the material parameters, takes effect from the next frame
+     * @param enabled true to use the compact layout
+     */
+    void                  setCompactGBufferEnabled(bool enabled) { m_compactGBuffer = enabled; }
+    bool                  isCompactGBufferEnabled() const { return m_compactGBuffer; }
+
+    /**
+     * @brief Check if meshes with less than 64k vertices are imported with the
+     * compressed vertex format. Fixed at start as global buffers are sized by it.
+     */
+    bool                  isPackedVerticesEnabled() const { return m_config.packedVertices; }
+
+    /**
+     * @brief Resolve jittered frames with reprojected history in a temporal
+     * upscaling pass before tone mapping, takes effect from the next frame
+     * @param enabled true to use temporal upscaling
+     */
+    void                  setTemporalUpscalingEnabled(bool enabled);
+    bool                  isTemporalUpscalingEnabled() const { return m_temporalUpscaling; }
+
+    /**
+     * @brief Set resolution of the g-buffer, lighting and skybox targets relative
+     * to the swapchain, drawn region of the targets follows on the next frame
+     * @param scale clamped to [MIN_RENDER_SCALE, 1]
+     */
+    void                  setRenderScale(float scale);
+    float                 getRenderScale() const { return m_renderScale; }
+
+    /**
+     * @brief Let the resolution controller adjust render scale, shadow resolution
+     * and texture detail to hold the target gpu frame time. Disabling keeps the
+     * render scale and restores full shadow resolution and texture detail.
+     * @param enabled true to use dynamic resolution
+     */
+    void                  setDynamicResolutionEnabled(bool enabled);
+    bool                  isDynamicResolutionEnabled() const { return m_dynamicResolution; }
+
+    /**
+     * @brief Adapt exposure of the tonemap pass to the luminance histogram of the
+     * lighting output on the gpu, takes effect from the next frame
+     * @param enabled true to use auto exposure
+     */
+    void                  setAutoExposureEnabled(bool enabled);
+    bool                  isAutoExposureEnabled() const { return m_autoExposure; }
+
     void                  prepareRenderGraphResources();
     void                  releaseRenderGraphResources();
     RenderGraphResources& getRenderGraphResources() { return m_rgResources; };
@@ -151,34 +371,92 @@ public:
     tf::Executor&         getTfExecutor() { return m_tfExecutor; }
 
     /**
-     * @brief Returns a non-const reference to the global vertex buffer.
-     * @return A reference to the global vertex buffer.
+     * @brief Get scheduler of the buffer copies recorded by transfer queue passes
+     * of the current frame
      */
-    GfxBuffer& getVertexBuffer() { return m_vertexBuffer; };
+    TransferScheduler&    getTransferScheduler() { return m_transferScheduler; }
 
     /**
-     * @brief Copies src vertex data buffer to the engine's vertex buffer.
-     * @param A reference to the source vertex buffer containing vertex data to be copied.
-     * @param Size in bytes of the data to be copied from the source buffer.
-     * @return Vertex buffer offset where the data has been copied. This is not byte offset.
+     * @brief Returns a non-const reference to the global vertex buffer.
+     * @param format of the vertices stored in the buffer
+     * @return A reference to the global vertex buffer.
      */
-    size_t copyToVertexBuffer(const GfxBuffer& srcVertexBuffer, size_t size);
+    GfxBuffer& getVertexBuffer(VertexFormat format = VertexFormat::Full)
+    {
+        return format == VertexFormat::Packed ? m_packedVertexBuffer : m_vertexBuffer;
+    };
 
     /**
      * @brief Returns a non-const reference to the global index buffer.
+     * @param format of the vertices referenced by the buffer
      * @return A reference to the global index buffer.
      */
-    GfxBuffer& getIndexBuffer() { return m_indexBuffer; };
+    GfxBuffer& getIndexBuffer(VertexFormat format = VertexFormat::Full)
+    {
+        return format == VertexFormat::Packed ? m_packedIndexBuffer : m_indexBuffer;
+    };
+
+    void   executeBRDFLUTcomputePipeline();
+
+private:
+    struct PendingGeometryRelease
+    {
+        GfxGeometryAllocation allocation;
+        uint64_t              releaseFrame;
+    };
+
+    struct PendingTextureRelease
+    {
+        GfxTexture texture;
+        uint64_t   releaseFrame;
+    };
+
+    /**
+     * @brief Allocate and upload geometry ranges of given vertex format
+     * @return true if upload was successful
+     */
+    bool uploadGeometry(
+        VertexFormat           format,
+        const void*            vertices,
+        size_t                 totalVertices,
+        const void*            indices,
+        size_t                 totalIndices,
+        GfxGeometryAllocation* outAllocation);
 
     /**
-     * @brief Copies src index data buffer to the engine's index buffer.
-     * @param A reference to the source index buffer containing index data to be copied.
-     * @param Size in bytes of the data to be copied from the source buffer.
-     * @return Base index within the index buffer where the data has been copied. This is not byte offset.
+     * @brief Sleep until target frame time has passed since the start of the frame
+     * @param frameStartTime time point at which the frame started
      */
-    size_t copyToIndexBuffer(const GfxBuffer& srcIndexbuffer, size_t size);
+    void limitFrameRate(TimePoint frameStartTime);
 
-    void   executeBRDFLUTcomputePipeline();
+    /**
+     * @brief Free geometry ranges which are no longer used by any frame in flight
+     */
+    void releasePendingGeometry();
+
+    /**
+     * @brief Reallocate render targets whose size follows the swapchain. Previous
+     * images are freed once frames in flight have finished.
+     * @param outputExtent new size of the targets
+     * @param renderExtent new region of the targets drawn at render scale
+     */
+    void resizeRenderTargets(VkExtent2D outputExtent, VkExtent2D renderExtent);
+
+    /**
+     * @brief Get size of the region drawn at render scale for the given output size
+     */
+    VkExtent2D getScaledRenderExtent(VkExtent2D outputExtent) const;
+
+    /**
+     * @brief Apply quality settings picked by the resolution controller
+     * @param settings to apply
+     */
+    void applyResolutionSettings(const ResolutionSettings& settings);
+
+    /**
+     * @brief Free render target images which are no longer used by any frame in flight
+     */
+    void releasePendingTextures();
 
 private:
     Config                                   m_config;
@@ -193,6 +471,7 @@ private:
     Unique<LightsSystem>                     m_lightsSystem         = nullptr;
     Unique<StatsRecorder>                    m_statsRecorder        = nullptr;
     Unique<TransformSystem>                  m_transformSystem      = nullptr;
+    ResolutionController                     m_resolutionController = {};
 
     Unique<TextureDB>                        m_textureDB            = nullptr;
 
@@ -201,29 +480,53 @@ private:
     bool                                     m_running              = false;
     bool                                     m_paused               = false;
     bool                                     m_dumpFrameRenderGraph = false;
+    bool                                     m_tiledLighting        = false;
+    bool                                     m_visibilityBuffer     = false;
+    bool                                     m_visibilityIdsFit     = true; // scene meshes fit in the visibility ids
+    bool                                     m_compactGBuffer       = false;
+    bool                                     m_temporalUpscaling    = false;
+    float                                    m_renderScale          = 1.f;
+    bool                                     m_dynamicResolution    = false;
+    bool                                     m_autoExposure         = false;
+    float                                    m_textureLodBias       = 0.f;
 
     Scene*                                   m_currentScene         = nullptr;
 
     TimePoint                                m_lastFrameTime        = {};
     TimeStep                                 m_deltaTime            = {};
+    TimeStep                                 m_targetFrameTime      = {};
 
     GfxBuffer                                m_vertexBuffer;
     GfxBuffer                                m_indexBuffer;
+    GfxBuffer                                m_packedVertexBuffer;
+    GfxBuffer                                m_packedIndexBuffer;
+
+    RangeAllocator                           m_vertexAllocator;
+    RangeAllocator                           m_indexAllocator;
+    RangeAllocator                           m_packedVertexAllocator;
+    RangeAllocator                           m_packedIndexAllocator;
+    Unique<StagingRing>                      m_stagingRing               = nullptr;
 
-    size_t                                   m_availableVertexOffset     = 0u;
-    size_t                                   m_availableIndexOffset      = 0u;
+    DynamicArray<PendingGeometryRelease>     m_pendingGeometryReleases   = {};
+    DynamicArray<PendingTextureRelease>      m_pendingTextureReleases    = {};
+    uint64_t                                 m_frameCounter              = 0u;
+
+    glm::mat4                                m_prevViewProjection        = glm::mat4 { 1.f };
+    bool                                     m_hasPrevViewProjection     = false;
 
     Unique<VkGfxDescriptorPool>              m_globalDescriptorPool      = nullptr;
     Unique<VkGfxDescriptorSetLayout>         m_globalDescriptorSetLayout = nullptr;
 
-    GfxBuffer                                m_globalUbos;
     Unique<VkGfxDescriptorSet>               m_globalDescriptorSet         = nullptr;
 
     Unique<VkGfxDescriptorPool>              m_materialDescriptorPool      = nullptr;
     Unique<VkGfxDescriptorSetLayout>         m_materialDescriptorSetLayout = nullptr;
 
-    GfxBuffer                                m_materialsBuffer;
-    Unique<VkGfxDescriptorSet>               m_materialsDescriptorSet      = nullptr;
+    // copy per frame in flight, uploads never overwrite materials read by older frames
+    DynamicArray<GfxBuffer>                  m_materialsBuffers            = {};
+    uint32_t                                 m_materialsCapacity           = 0u;
+    DynamicArray<Unique<VkGfxDescriptorSet>> m_materialsDescriptorSets     = {};
+    DynamicArray<DynamicArray<uint32_t>>     m_pendingMaterialIds          = {}; // modified ids missing in each copy
 
     Unique<VkGfxDescriptorPool>              m_meshDataDescriptorPool      = nullptr;
     Unique<VkGfxDescriptorSetLayout>         m_meshDataDescriptorSetLayout = nullptr;
@@ -232,15 +535,14 @@ private:
     Unique<VkGfxDescriptorSet>               m_meshDataDescriptorSet         = nullptr;
 
     DynamicArray<GfxRenderables>             m_frameRenderables              = {};
-    DynamicArray<GfxBuffer>                  m_modelMatrixBuffers            = {};
-    DynamicArray<GfxBuffer>                  m_normalMatrixBuffers           = {};
-    DynamicArray<GfxBuffer>                  m_boundingBoxBuffers            = {};
-    DynamicArray<GfxBuffer>                  m_meshIdsBuffers                = {};
-    DynamicArray<GfxBuffer>                  m_materialIdsBuffers            = {};
+
+    // per frame host data: global ubo in the reserved block followed by renderables
+    UploadArena                              m_frameUploadArena;
+    TransferScheduler                        m_transferScheduler;
 
     Unique<VkGfxDescriptorPool>              m_renderableDescriptorPool      = nullptr;
     Unique<VkGfxDescriptorSetLayout>         m_renderableDescriptorSetLayout = nullptr;
-    DynamicArray<Unique<VkGfxDescriptorSet>> m_renderableDescriptorSets      = {};
+    Unique<VkGfxDescriptorSet>               m_renderableDescriptorSet       = nullptr;
 
     RenderGraphResources                     m_rgResources;
 
@@ -4,6 +4,8 @@
 #include "renderer/render_graph.h"
 #include "backend/vulkan/vk_device.h"
 
+#include "utils/hash.h"
+
 namespace dusk
 {
 
@@ -99,6 +101,19 @@ void StatsRecorder::retrieveQueryStats()
             passStats.startTimeNs   = startTimeNs;
             passStats.endTimeNs     = endTimeNs;
             passStats.gpuTimeNs     = TimeStepNs(passTimeNs);
+
+            // results of pending queries are not reliable for the cost model
+            if (result != VK_SUCCESS || endTimeNs < startTimeNs) continue;
+
+            size_t passKey = hash(passStats.passName.c_str());
+            if (m_passCostsNs.has(passKey))
+            {
+                m_passCostsNs[passKey] = EMA_ALPHA * passTimeNs + (1.f - EMA_ALPHA) * m_passCostsNs[passKey];
+            }
+            else
+            {
+                m_passCostsNs.emplace(passKey, static_cast<float>(passTimeNs));
+            }
         }
     }
 }
@@ -255,6 +270,14 @@ FrameStats StatsRecorder::getThirdLastFrameStats() const
     return m_frameStatsHistory[(m_frameCounter + MAX_FRAMES_HISTORY - MAX_FRAMES_IN_FLIGHT) % MAX_FRAMES_HISTORY];
 }
 
+float StatsRecorder::getPassCostNs(const std::string& passName)
+{
+    size_t passKey = hash(passName.c_str());
+    if (!m_passCostsNs.has(passKey)) return DEFAULT_PASS_COST_NS;
+
+    return m_passCostsNs[passKey];
+}
+
 void StatsRecorder::dumpGpuFrameTimeHistory(const char* path, uint32_t prevFramesCount) const
 {
     if (prevFramesCount > MAX_FRAMES_HISTORY)
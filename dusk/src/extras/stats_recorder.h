@@ -11,6 +11,7 @@ namespace dusk
 static constexpr uint32_t MAX_FRAMES_HISTORY    = 100;
 static constexpr uint32_t MAX_QUERIES_PER_FRAME = 2 + MAX_RENDER_GRAPH_PASSES * 2; // 2 queries for frame begin/end + 2 queries per pass (begin/end)
 static constexpr float    EMA_ALPHA             = 0.05f;                           // Smoothing factor for Exponential Moving Average
+static constexpr float    DEFAULT_PASS_COST_NS  = 100000.f;                        // Cost estimate of a pass without recorded stats
 
 struct PassStats
 {
@@ -141,6 +142,13 @@ public:
      */
     FrameStats getThirdLastFrameStats() const;
 
+    /**
+     * @brief Get smoothed GPU time of a render graph pass over previous frames
+     * @param name of the pass
+     * @return estimated time in nanoseconds, default estimate when pass has no stats yet
+     */
+    float getPassCostNs(const std::string& passName);
+
     /**
      * @brief Dump last frames gpu timestamps for passes to a file
      * @param path of the output file
@@ -167,6 +175,9 @@ private:
     // Aggregate stats based on history buffer
     AggregateStats m_aggregateStats = {};
 
+    // EMA of GPU time for each pass keyed by hash of the pass name
+    HashMap<size_t, float> m_passCostsNs = {};
+
 private:
     static StatsRecorder* s_instance;
 };
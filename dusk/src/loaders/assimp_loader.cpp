@@ -13,10 +13,32 @@
 
 #include <glm/gtx/matrix_decompose.hpp>
 #include <assimp/pbrmaterial.h>
+#include <assimp/DefaultIOSystem.h>
 
 namespace dusk
 {
 
+namespace
+{
+/**
+ * @brief Default assimp file system which records every opened file. These
+ * are the buffers and the scene file which cooked scene depends on.
+ */
+class RecordingIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+    Assimp::IOStream* Open(const char* file, const char* mode) override
+    {
+        Assimp::IOStream* stream = Assimp::DefaultIOSystem::Open(file, mode);
+        if (stream) openedFiles.push_back(file);
+
+        return stream;
+    }
+
+    DynamicArray<std::filesystem::path> openedFiles = {};
+};
+} // namespace
+
 AssimpLoader::AssimpLoader()
 {
 }
@@ -25,17 +47,22 @@ AssimpLoader::~AssimpLoader()
 {
 }
 
-Unique<Scene> AssimpLoader::readScene(const std::filesystem::path& filePath)
+Unique<Scene> AssimpLoader::readScene(const std::filesystem::path& filePath, const std::filesystem::path& cookedPath)
 {
     DUSK_PROFILE_FUNCTION;
 
-    m_sceneDir = filePath.parent_path();
+    m_sceneDir    = filePath.parent_path();
+    m_sceneWriter = cookedPath.empty() ? nullptr : createUnique<DSceneWriter>();
 
     if (filePath.extension() == ".gltf")
         m_isGltf = true;
 
     const aiScene* assimpScene;
 
+    // importer hands the io system back when its handler is reset
+    auto           ioSystem = createUnique<RecordingIOSystem>();
+    m_importer.SetIOHandler(ioSystem.get());
+
     {
         DUSK_PROFILE_SECTION("read_scene_file");
 
@@ -48,46 +75,80 @@ Unique<Scene> AssimpLoader::readScene(const std::filesystem::path& filePath)
         if (!assimpScene || assimpScene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !assimpScene->mRootNode)
         {
             DUSK_ERROR("Unable to read scene file. {}", m_importer.GetErrorString());
+            m_importer.SetIOHandler(nullptr);
             m_sceneDir = "";
             return nullptr;
         }
     }
 
-    return parseScene(assimpScene);
+    if (m_sceneWriter)
+    {
+        for (const auto& openedFile : ioSystem->openedFiles)
+        {
+            m_sceneWriter->addDependency(std::filesystem::proximate(openedFile, m_sceneDir));
+        }
+    }
+    m_importer.SetIOHandler(nullptr);
+
+    auto newScene = parseScene(assimpScene);
+
+    if (newScene && m_sceneWriter)
+    {
+        DUSK_PROFILE_SECTION("write_cooked_scene");
+
+        if (!m_sceneWriter->write(cookedPath))
+        {
+            DUSK_WARN("Unable to cook scene {}", filePath.generic_string());
+        }
+    }
+    m_sceneWriter = nullptr;
+
+    return newScene;
 }
 
 Unique<Scene> AssimpLoader::parseScene(const aiScene* assimpScene)
 {
     DUSK_PROFILE_FUNCTION;
 
-    auto newScene      = createUnique<Scene>(assimpScene->mName.C_Str());
-
-    int  totalVertices = 0;
-    int  totalIndices  = 0;
-    for (uint32_t meshIndex = 0u; meshIndex < assimpScene->mNumMeshes; ++meshIndex)
-    {
-        totalVertices += assimpScene->mMeshes[meshIndex]->mNumVertices;
-        totalIndices += assimpScene->mMeshes[meshIndex]->mNumFaces * 3; // Assumption, face is triangular
-    }
-
-    m_tempVertices.reserve(totalVertices);
-    m_tempIndices.reserve(totalIndices);
-    newScene->m_sceneMeshes.reserve(assimpScene->mNumMeshes);
+    auto newScene = createUnique<Scene>(assimpScene->mName.C_Str());
 
     m_tempVertices.clear();
     m_tempIndices.clear();
+    m_tempPackedVertices.clear();
+    m_tempPackedIndices.clear();
+
+    // first pass places every mesh in the shared buffers, so meshes can be
+    // converted independently of each other
+    computeMeshOffsets(*newScene, assimpScene);
+
+    tf::Taskflow taskflow;
 
     if (assimpScene->mNumMeshes > 0)
     {
-        parseMeshes(*newScene, assimpScene);
+        taskflow.for_each_index(
+            0u,
+            assimpScene->mNumMeshes,
+            1u,
+            [&](uint32_t meshIndex)
+            {
+                parseMesh(assimpScene->mMeshes[meshIndex], newScene->m_sceneMeshes[meshIndex]);
+            });
     }
 
     if (assimpScene->HasMaterials())
     {
         newScene->initMaterialCache(assimpScene->mNumMaterials);
-        parseMaterials(*newScene, assimpScene);
+        taskflow.emplace(
+            [&]()
+            {
+                parseMaterials(*newScene, assimpScene);
+            });
     }
 
+    auto importFuture = Engine::get().getTfExecutor().run(taskflow);
+
+    // node traversal modifies registry and transform storage, so it runs on the
+    // calling thread while meshes and materials are parsed by the workers
     if (assimpScene->mRootNode)
     {
         auto rootId                       = traverseSceneNodes(*newScene, assimpScene->mRootNode, assimpScene, newScene->getRootId());
@@ -101,27 +162,70 @@ Unique<Scene> AssimpLoader::parseScene(const aiScene* assimpScene)
         {
             storage->recomputeWorld(handle);
         }
+
+        if (m_sceneWriter)
+        {
+            m_sceneWriter->setTransforms(*storage, rootuint32_t);
+        }
+    }
+
+    {
+        DUSK_PROFILE_SECTION("wait_mesh_material_import");
+        importFuture.wait();
+    }
+
+    if (m_sceneWriter)
+    {
+        // mesh offsets are still relative to temp buffers here
+        m_sceneWriter->setName(assimpScene->mName.C_Str());
+        m_sceneWriter->setGeometry(m_tempVertices, m_tempIndices, m_tempPackedVertices, m_tempPackedIndices, newScene->m_sceneMeshes);
     }
 
     // TODO: uploading temp mesh data to GPU here currently. Need a better place for this
-    auto&    engine           = Engine::get();
-    int      baseVertexOffset = 0;
-    uint32_t baseFirstIndex   = 0;
-    engine.uploadVertexAndIndexBuffers(
-        m_tempVertices,
-        m_tempIndices,
-        &baseVertexOffset,
-        &baseFirstIndex);
+    auto&                  engine           = Engine::get();
+    GfxGeometryAllocation& allocation       = newScene->m_geometryAllocation;
+    GfxGeometryAllocation& packedAllocation = newScene->m_packedGeometryAllocation;
+    if (!engine.uploadVertexAndIndexBuffers(
+            m_tempVertices.data(),
+            m_tempVertices.size(),
+            m_tempIndices.data(),
+            m_tempIndices.size(),
+            &allocation))
+    {
+        DUSK_ERROR("Unable to upload geometry of the scene");
+        return nullptr;
+    }
+
+    if (!engine.uploadVertexAndIndexBuffers(
+            m_tempPackedVertices.data(),
+            m_tempPackedVertices.size(),
+            m_tempPackedIndices.data(),
+            m_tempPackedIndices.size(),
+            &packedAllocation))
+    {
+        DUSK_ERROR("Unable to upload geometry of the scene");
+
+        // ranges of the full geometry are already allocated
+        if (allocation.vertexCount > 0 || allocation.indexCount > 0)
+        {
+            engine.releaseVertexAndIndexBuffers(allocation);
+        }
+
+        return nullptr;
+    }
 
     for (uint32_t meshIndex = 0u; meshIndex < assimpScene->mNumMeshes; ++meshIndex)
     {
-        GfxMeshData& meshData = newScene->m_sceneMeshes[meshIndex];
-        meshData.firstIndex   = baseFirstIndex + meshData.firstIndex;
-        meshData.vertexOffset = baseVertexOffset + meshData.vertexOffset;
+        GfxMeshData&                 meshData       = newScene->m_sceneMeshes[meshIndex];
+        const GfxGeometryAllocation& meshAllocation = meshData.vertexFormat == VertexFormat::Packed ? packedAllocation : allocation;
+        meshData.firstIndex                         = meshAllocation.firstIndex + meshData.firstIndex;
+        meshData.vertexOffset                       = meshAllocation.vertexOffset + meshData.vertexOffset;
     }
 
     m_tempVertices.clear();
     m_tempIndices.clear();
+    m_tempPackedVertices.clear();
+    m_tempPackedIndices.clear();
 
     return newScene;
 }
@@ -136,9 +240,11 @@ EntityId AssimpLoader::traverseSceneNodes(Scene& scene, const aiNode* node, cons
 
     gameObject->setName(node->mName.C_Str());
 
+    RenderableComponent* renderable = nullptr;
     if (node->mNumMeshes > 0)
     {
-        auto& renderable = gameObject->addComponent<RenderableComponent>();
+        renderable           = &gameObject->addComponent<RenderableComponent>();
+        renderable->isStatic = true; // imported scene geometry is not expected to move
 
         // calculate AABB for the whole mesh model
         auto modelAABB = AABB {};
@@ -148,8 +254,8 @@ EntityId AssimpLoader::traverseSceneNodes(Scene& scene, const aiNode* node, cons
         for (uint32_t index = 0u; index < node->mNumMeshes; ++index)
         {
             uint32_t sceneMeshIndex = node->mMeshes[index];
-            renderable.meshes.push_back(sceneMeshIndex);
-            renderable.materials.push_back(aiScene->mMeshes[sceneMeshIndex]->mMaterialIndex);
+            renderable->meshes.push_back(sceneMeshIndex);
+            renderable->materials.push_back(aiScene->mMeshes[sceneMeshIndex]->mMaterialIndex);
 
             aiVector3D meshMin = aiScene->mMeshes[sceneMeshIndex]->mAABB.mMin;
             aiVector3D meshMax = aiScene->mMeshes[sceneMeshIndex]->mAABB.mMax;
@@ -159,7 +265,16 @@ EntityId AssimpLoader::traverseSceneNodes(Scene& scene, const aiNode* node, cons
         }
 
         // object space model AABB
-        renderable.objectAABB = modelAABB;
+        renderable->objectAABB = modelAABB;
+    }
+
+    if (m_sceneWriter)
+    {
+        // nodes are visited in DFS order which matches transform allocation
+        if (renderable)
+            m_sceneWriter->addNode(node->mName.C_Str(), renderable->meshes, renderable->materials, renderable->objectAABB);
+        else
+            m_sceneWriter->addNode(node->mName.C_Str(), {}, {}, AABB {});
     }
 
     // attach object to the scene
@@ -221,81 +336,122 @@ EntityId AssimpLoader::traverseSceneNodes(Scene& scene, const aiNode* node, cons
     return gameObjectId;
 }
 
-void AssimpLoader::parseMeshes(Scene& scene, const aiScene* aiScene)
+void AssimpLoader::computeMeshOffsets(Scene& scene, const aiScene* aiScene)
 {
     DUSK_PROFILE_FUNCTION;
 
+    scene.m_sceneMeshes.resize(aiScene->mNumMeshes);
+
+    uint32_t totalVertices       = 0u;
+    uint32_t totalIndices        = 0u;
+    uint32_t totalPackedVertices = 0u;
+    uint32_t totalPackedIndices  = 0u;
+    bool     packedVertices      = Engine::get().isPackedVerticesEnabled();
+
     for (uint32_t meshIndex = 0u; meshIndex < aiScene->mNumMeshes; ++meshIndex)
     {
-        DynamicArray<Vertex>   vertices {};
-        DynamicArray<uint32_t> indices {};
+        const aiMesh* mesh     = aiScene->mMeshes[meshIndex];
+        GfxMeshData&  meshData = scene.m_sceneMeshes[meshIndex];
+        meshData.indexCount    = mesh->mNumFaces * 3; // Assumption, face is triangular
 
-        aiMesh*                mesh = aiScene->mMeshes[meshIndex];
+        // meshes small enough for uint16 indices are stored packed
+        if (packedVertices && PackedVertex::canPack(mesh->mNumVertices))
+        {
+            glm::vec3 boundsMin   = glm::vec3(mesh->mAABB.mMin.x, mesh->mAABB.mMin.y, mesh->mAABB.mMin.z);
+            glm::vec3 boundsMax   = glm::vec3(mesh->mAABB.mMax.x, mesh->mAABB.mMax.y, mesh->mAABB.mMax.z);
 
-        vertices.reserve(mesh->mNumVertices);
-        indices.reserve(mesh->mNumFaces * 3); // Assumption, face is triangular
+            // flat meshes still need a non zero scale to quantize against
+            glm::vec3 extent      = glm::max(boundsMax - boundsMin, glm::vec3(std::numeric_limits<float>::epsilon()));
 
-        uint32_t indexCount   = 0u;
-        uint32_t firstIndex   = m_tempIndices.size();
-        int32_t  vertexOffset = m_tempVertices.size();
+            meshData.vertexFormat = VertexFormat::Packed;
+            meshData.quantOffset  = glm::vec4(boundsMin, 0.f);
+            meshData.quantScale   = glm::vec4(extent, 1.f);
+            meshData.firstIndex   = totalPackedIndices;
+            meshData.vertexOffset = static_cast<int32_t>(totalPackedVertices);
 
-        for (uint32_t vertexIndex = 0u; vertexIndex < mesh->mNumVertices; ++vertexIndex)
+            totalPackedVertices += mesh->mNumVertices;
+            totalPackedIndices += meshData.indexCount;
+        }
+        else
         {
-            Vertex v;
+            meshData.vertexFormat = VertexFormat::Full;
+            meshData.firstIndex   = totalIndices;
+            meshData.vertexOffset = static_cast<int32_t>(totalVertices);
 
-            v.position = glm::vec3(mesh->mVertices[vertexIndex].x, mesh->mVertices[vertexIndex].y, mesh->mVertices[vertexIndex].z);
+            totalVertices += mesh->mNumVertices;
+            totalIndices += meshData.indexCount;
+        }
+    }
 
-            if (mesh->HasNormals())
-            {
-                v.normal = glm::vec3(mesh->mNormals[vertexIndex].x, mesh->mNormals[vertexIndex].y, mesh->mNormals[vertexIndex].z);
-            }
-            else
-            {
-                DUSK_ERROR("Missing normals in assimp file");
-            }
+    m_tempVertices.resize(totalVertices);
+    m_tempIndices.resize(totalIndices);
+    m_tempPackedVertices.resize(totalPackedVertices);
+    m_tempPackedIndices.resize(totalPackedIndices);
+}
 
-            if (mesh->HasTangentsAndBitangents())
-            {
-                v.tangent      = glm::vec3(mesh->mTangents[vertexIndex].x, mesh->mTangents[vertexIndex].y, mesh->mTangents[vertexIndex].z);
+void AssimpLoader::parseMesh(const aiMesh* mesh, const GfxMeshData& meshData)
+{
+    DUSK_PROFILE_FUNCTION;
 
-                auto bitangent = glm::vec3(mesh->mBitangents[vertexIndex].x, mesh->mBitangents[vertexIndex].y, mesh->mBitangents[vertexIndex].z);
+    bool isPacked = meshData.vertexFormat == VertexFormat::Packed;
 
-                // flip if not right handed
-                if (glm::dot(glm::cross(v.normal, v.tangent), bitangent) < 0.0f)
-                    v.tangent *= -1.0f; // Flip tangent
-            }
-            else
-            {
-                DUSK_ERROR("Missing tangents and bitangents in assimp file");
-            }
+    if (!mesh->HasNormals())
+    {
+        DUSK_ERROR("Missing normals in assimp file for mesh {}", mesh->mName.C_Str());
+    }
 
-            if (mesh->HasTextureCoords(0))
-            {
-                v.uv = glm::vec2(mesh->mTextureCoords[0][vertexIndex].x, 1.f - mesh->mTextureCoords[0][vertexIndex].y);
-            }
+    if (!mesh->HasTangentsAndBitangents())
+    {
+        DUSK_ERROR("Missing tangents and bitangents in assimp file for mesh {}", mesh->mName.C_Str());
+    }
 
-            vertices.push_back(v);
-            m_tempVertices.push_back(v);
+    for (uint32_t vertexIndex = 0u; vertexIndex < mesh->mNumVertices; ++vertexIndex)
+    {
+        Vertex v;
+
+        v.position = glm::vec3(mesh->mVertices[vertexIndex].x, mesh->mVertices[vertexIndex].y, mesh->mVertices[vertexIndex].z);
+
+        if (mesh->HasNormals())
+        {
+            v.normal = glm::vec3(mesh->mNormals[vertexIndex].x, mesh->mNormals[vertexIndex].y, mesh->mNormals[vertexIndex].z);
         }
 
-        for (uint32_t faceIndex = 0u; faceIndex < mesh->mNumFaces; ++faceIndex)
+        if (mesh->HasTangentsAndBitangents())
         {
-            DASSERT(mesh->mFaces[faceIndex].mNumIndices == 3, "Face is not triangular");
-            for (uint32_t vertexIndex = 0u; vertexIndex < 3; ++vertexIndex)
-            {
-                uint32_t index = mesh->mFaces[faceIndex].mIndices[vertexIndex];
-                indices.push_back(index);
-                m_tempIndices.push_back(index);
+            v.tangent      = glm::vec3(mesh->mTangents[vertexIndex].x, mesh->mTangents[vertexIndex].y, mesh->mTangents[vertexIndex].z);
 
-                indexCount++;
-            }
+            auto bitangent = glm::vec3(mesh->mBitangents[vertexIndex].x, mesh->mBitangents[vertexIndex].y, mesh->mBitangents[vertexIndex].z);
+
+            // flip if not right handed
+            if (glm::dot(glm::cross(v.normal, v.tangent), bitangent) < 0.0f)
+                v.tangent *= -1.0f; // Flip tangent
         }
 
-        scene.m_sceneMeshes.push_back({
-            .indexCount   = indexCount,
-            .firstIndex   = firstIndex,
-            .vertexOffset = vertexOffset,
-        });
+        if (mesh->HasTextureCoords(0))
+        {
+            v.uv = glm::vec2(mesh->mTextureCoords[0][vertexIndex].x, 1.f - mesh->mTextureCoords[0][vertexIndex].y);
+        }
+
+        if (isPacked)
+            m_tempPackedVertices[meshData.vertexOffset + vertexIndex] = PackedVertex::pack(v, glm::vec3(meshData.quantOffset), glm::vec3(meshData.quantScale));
+        else
+            m_tempVertices[meshData.vertexOffset + vertexIndex] = v;
+    }
+
+    for (uint32_t faceIndex = 0u; faceIndex < mesh->mNumFaces; ++faceIndex)
+    {
+        const aiFace& face = mesh->mFaces[faceIndex];
+        DASSERT(face.mNumIndices == 3, "Face is not triangular");
+
+        for (uint32_t corner = 0u; corner < 3u; ++corner)
+        {
+            uint32_t index = meshData.firstIndex + faceIndex * 3 + corner;
+
+            if (isPacked)
+                m_tempPackedIndices[index] = static_cast<uint16_t>(face.mIndices[corner]);
+            else
+                m_tempIndices[index] = face.mIndices[corner];
+        }
     }
 }
 
@@ -332,12 +488,12 @@ std::filesystem::path AssimpLoader::getGltfMRTexturePath(aiMaterial* mat)
     return std::filesystem::path(path.C_Str());
 }
 
-int32_t AssimpLoader::read2DTexture(std::filesystem::path texPath, PixelFormat format) const
+int32_t AssimpLoader::read2DTexture(std::filesystem::path texPath, PixelFormat format, float alphaCutoff) const
 {
     if (!texPath.empty())
     {
         auto texturePath = (m_sceneDir / texPath).make_preferred().string();
-        return TextureDB::cache()->createTextureAsync(texturePath, TextureType::Texture2D, format);
+        return TextureDB::cache()->createTextureAsync(texturePath, TextureType::Texture2D, format, alphaCutoff);
     }
 
     return -1;
@@ -352,6 +508,9 @@ void AssimpLoader::parseMaterials(Scene& scene, const aiScene* aiScene)
         aiMaterial*           aiMat = aiScene->mMaterials[matIndex];
         Material              newMaterial;
 
+        // source paths are kept for cooking as texture ids are only valid at runtime
+        std::filesystem::path texturePaths[static_cast<uint32_t>(DSceneTextureSlot::Count)];
+
         std::filesystem::path baseColorTexturePath = "";
 
         /// textures indices
@@ -379,9 +538,19 @@ void AssimpLoader::parseMaterials(Scene& scene, const aiScene* aiScene)
             }
         }
 
+        // only masked materials are alpha tested
+        aiString alphaMode;
+        if (aiMat->Get(AI_MATKEY_GLTF_ALPHAMODE, alphaMode) == aiReturn_SUCCESS && std::string(alphaMode.C_Str()) == "MASK")
+        {
+            newMaterial.alphaCutoff = 0.5f;
+            aiMat->Get(AI_MATKEY_GLTF_ALPHACUTOFF, newMaterial.alphaCutoff);
+        }
+
         if (!baseColorTexturePath.empty())
         {
-            albedoTexId = read2DTexture(baseColorTexturePath, PixelFormat::R8G8B8A8_srgb);
+            albedoTexId = read2DTexture(baseColorTexturePath, PixelFormat::R8G8B8A8_srgb, newMaterial.alphaCutoff);
+
+            texturePaths[static_cast<uint32_t>(DSceneTextureSlot::Albedo)] = baseColorTexturePath;
         }
         else
         {
@@ -405,6 +574,8 @@ void AssimpLoader::parseMaterials(Scene& scene, const aiScene* aiScene)
         {
             newMaterial.normalTexId = read2DTexture(normalTexPath, PixelFormat::R8G8B8A8_unorm);
 
+            texturePaths[static_cast<uint32_t>(DSceneTextureSlot::Normal)] = normalTexPath;
+
             aiMat->Get("normalScale", 0, 0, newMaterial.normalScale);
         }
 
@@ -414,6 +585,8 @@ void AssimpLoader::parseMaterials(Scene& scene, const aiScene* aiScene)
         if (!mrTexPath.empty())
         {
             newMaterial.metallicRoughnessTexId = read2DTexture(mrTexPath, PixelFormat::R8G8B8A8_unorm);
+
+            texturePaths[static_cast<uint32_t>(DSceneTextureSlot::MetallicRoughness)] = mrTexPath;
         }
         else
         {
@@ -429,6 +602,8 @@ void AssimpLoader::parseMaterials(Scene& scene, const aiScene* aiScene)
         if (!aoTexPath.empty())
         {
             newMaterial.aoTexId = read2DTexture(aoTexPath, PixelFormat::R8G8B8A8_unorm);
+
+            texturePaths[static_cast<uint32_t>(DSceneTextureSlot::AmbientOcclusion)] = aoTexPath;
         }
 
         aiMat->Get(AI_MATKEY_REFLECTIVITY, newMaterial.aoStrength);
@@ -440,6 +615,8 @@ void AssimpLoader::parseMaterials(Scene& scene, const aiScene* aiScene)
         {
             newMaterial.emissiveTexId = read2DTexture(emissiveTexPath, PixelFormat::R8G8B8A8_srgb);
 
+            texturePaths[static_cast<uint32_t>(DSceneTextureSlot::Emissive)] = emissiveTexPath;
+
             aiMat->Get("emissiveIntensity", 0, 0, newMaterial.emissiveIntensity);
 
             if (aiMat->Get(AI_MATKEY_COLOR_EMISSIVE, newMaterial.emissiveColor) != AI_SUCCESS)
@@ -448,6 +625,11 @@ void AssimpLoader::parseMaterials(Scene& scene, const aiScene* aiScene)
             }
         }
 
+        if (m_sceneWriter)
+        {
+            m_sceneWriter->addMaterial(newMaterial, texturePaths);
+        }
+
         scene.addMaterial(newMaterial);
     }
 }
@@ -4,6 +4,8 @@
 #include "scene/entity.h"
 #include "renderer/image.h"
 #include "renderer/vertex.h"
+#include "renderer/gfx_types.h"
+#include "dscene_loader.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -21,11 +23,18 @@ public:
     AssimpLoader();
     ~AssimpLoader();
 
-    Unique<Scene> readScene(const std::filesystem::path& filePath);
+    /**
+     * @brief Import a scene file through assimp
+     * @param filePath of the scene
+     * @param cookedPath if not empty, imported scene is also written as a cooked scene at this path
+     * @return unique pointer to the scene object
+     */
+    Unique<Scene> readScene(const std::filesystem::path& filePath, const std::filesystem::path& cookedPath = {});
 
 private:
     Unique<Scene>         parseScene(const aiScene* scene);
-    void                  parseMeshes(Scene& scene, const aiScene* aiScene);
+    void                  computeMeshOffsets(Scene& scene, const aiScene* aiScene);
+    void                  parseMesh(const aiMesh* mesh, const GfxMeshData& meshData);
     void                  parseMaterials(Scene& scene, const aiScene* aiScene);
 
     EntityId              traverseSceneNodes(Scene& scene, const aiNode* node, const aiScene* aiScene, EntityId parentId);
@@ -33,16 +42,20 @@ private:
     std::filesystem::path getGltfTexturePath(aiMaterial* mat);
     std::filesystem::path getTexturePath(aiMaterial* mat, aiTextureType type);
     std::filesystem::path getGltfMRTexturePath(aiMaterial* mat);
-    int32_t               read2DTexture(std::filesystem::path texPath, PixelFormat format) const;
+    int32_t               read2DTexture(std::filesystem::path texPath, PixelFormat format, float alphaCutoff = 0.f) const;
 
 private:
-    Assimp::Importer       m_importer     = {};
+    Assimp::Importer           m_importer           = {};
 
-    std::filesystem::path  m_sceneDir     = "";
+    std::filesystem::path      m_sceneDir           = "";
 
-    bool                   m_isGltf       = false;
+    bool                       m_isGltf             = false;
 
-    DynamicArray<Vertex>   m_tempVertices = {};
-    DynamicArray<uint32_t> m_tempIndices  = {};
+    DynamicArray<Vertex>       m_tempVertices       = {};
+    DynamicArray<uint32_t>     m_tempIndices        = {};
+    DynamicArray<PackedVertex> m_tempPackedVertices = {};
+    DynamicArray<uint16_t>     m_tempPackedIndices  = {};
+
+    Unique<DSceneWriter>       m_sceneWriter        = nullptr;
 };
 } // namespace dusk
\ No newline at end of file
@@ -0,0 +1,596 @@
+#include "dscene_loader.h"
+
+#include "engine.h"
+#include "debug/profiler.h"
+#include "platform/file_system.h"
+
+#include "scene/scene.h"
+#include "scene/transform_system.h"
+#include "scene/components/renderable.h"
+
+#include "renderer/texture_db.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace dusk
+{
+
+namespace
+{
+constexpr uint32_t sectionIndex(DSceneSection section)
+{
+    return static_cast<uint32_t>(section);
+}
+
+size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Typed read only view of a section inside the mapped file
+ */
+template <typename T>
+struct SectionView
+{
+    const T* data  = nullptr;
+    size_t   count = 0u;
+
+    const T& operator[](size_t index) const { return data[index]; }
+};
+
+template <typename T>
+bool getSection(const MappedFile& file, const DSceneHeader& header, DSceneSection section, SectionView<T>* outView)
+{
+    const DSceneSectionInfo& info = header.sections[sectionIndex(section)];
+
+    if (info.offset % DSCENE_ALIGNMENT != 0 || info.size % sizeof(T) != 0 || info.offset > file.size() || info.size > file.size() - info.offset)
+    {
+        return false;
+    }
+
+    outView->data  = reinterpret_cast<const T*>(file.data() + info.offset);
+    outView->count = info.size / sizeof(T);
+
+    return true;
+}
+
+/**
+ * @brief Read and validate header of the mapped file
+ */
+bool readHeader(const MappedFile& file, const std::filesystem::path& filePath, DSceneHeader* outHeader)
+{
+    if (file.size() < sizeof(DSceneHeader))
+    {
+        DUSK_ERROR("Invalid cooked scene file {}", filePath.generic_string());
+        return false;
+    }
+
+    std::memcpy(outHeader, file.data(), sizeof(DSceneHeader));
+
+    if (outHeader->magic != DSCENE_MAGIC)
+    {
+        DUSK_ERROR("Invalid cooked scene file {}", filePath.generic_string());
+        return false;
+    }
+
+    if (outHeader->version != DSCENE_VERSION
+        || outHeader->vertexSize != sizeof(Vertex)
+        || outHeader->packedVertexSize != sizeof(PackedVertex)
+        || outHeader->meshSize != sizeof(GfxMeshData)
+        || outHeader->materialSize != sizeof(Material))
+    {
+        DUSK_WARN("Cooked scene {} was written by a different engine version", filePath.generic_string());
+        return false;
+    }
+
+    return true;
+}
+
+std::string getString(const SectionView<char>& strings, const DSceneString& str)
+{
+    if (static_cast<size_t>(str.offset) + str.length > strings.count) return "";
+
+    return std::string(strings.data + str.offset, str.length);
+}
+
+const PixelFormat s_textureSlotFormats[] = {
+    PixelFormat::R8G8B8A8_srgb,  // albedo
+    PixelFormat::R8G8B8A8_unorm, // normal
+    PixelFormat::R8G8B8A8_unorm, // metallic roughness
+    PixelFormat::R8G8B8A8_unorm, // ambient occlusion
+    PixelFormat::R8G8B8A8_srgb,  // emissive
+};
+static_assert(std::size(s_textureSlotFormats) == static_cast<size_t>(DSceneTextureSlot::Count));
+} // namespace
+
+void DSceneWriter::setName(const std::string& name)
+{
+    m_name = addString(name);
+}
+
+void DSceneWriter::setGeometry(
+    const DynamicArray<Vertex>&       vertices,
+    const DynamicArray<uint32_t>&     indices,
+    const DynamicArray<PackedVertex>& packedVertices,
+    const DynamicArray<uint16_t>&     packedIndices,
+    const DynamicArray<GfxMeshData>&  meshes)
+{
+    m_vertices       = vertices;
+    m_indices        = indices;
+    m_packedVertices = packedVertices;
+    m_packedIndices  = packedIndices;
+    m_meshes         = meshes;
+}
+
+void DSceneWriter::addMaterial(
+    const Material&              material,
+    const std::filesystem::path* texturePaths)
+{
+    DSceneMaterial cookedMaterial {};
+    cookedMaterial.material = material;
+
+    for (uint32_t slot = 0u; slot < static_cast<uint32_t>(DSceneTextureSlot::Count); ++slot)
+    {
+        if (!texturePaths[slot].empty())
+        {
+            cookedMaterial.texturePaths[slot] = addString(texturePaths[slot].generic_string());
+            addDependency(texturePaths[slot]);
+        }
+    }
+
+    m_materials.push_back(cookedMaterial);
+}
+
+void DSceneWriter::addDependency(const std::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> stringsLock(m_stringsMutex);
+
+    std::string                 dependency = path.generic_string();
+    if (std::find(m_dependencies.begin(), m_dependencies.end(), dependency) == m_dependencies.end())
+    {
+        m_dependencies.push_back(dependency);
+    }
+}
+
+void DSceneWriter::addNode(
+    const std::string&            name,
+    const DynamicArray<uint32_t>& meshes,
+    const DynamicArray<uint32_t>& materials,
+    const AABB&                   objectAABB)
+{
+    DASSERT(meshes.size() == materials.size());
+
+    DSceneNode node {};
+    node.name      = addString(name);
+    node.firstMesh = static_cast<uint32_t>(m_nodeMeshes.size());
+    node.meshCount = static_cast<uint32_t>(meshes.size());
+
+    for (uint32_t index = 0u; index < meshes.size(); ++index)
+    {
+        m_nodeMeshes.push_back({ meshes[index], materials[index] });
+    }
+
+    m_nodes.push_back(node);
+    m_boundingBoxes.push_back(objectAABB);
+}
+
+void DSceneWriter::setTransforms(const TransformStorage& storage, uint32_t baseHandle)
+{
+    uint32_t nodeCount = static_cast<uint32_t>(m_nodes.size());
+    DASSERT(baseHandle + nodeCount <= storage.count);
+
+    m_parents.resize(nodeCount);
+    m_subtreeEnds.resize(nodeCount);
+    m_translations.resize(nodeCount);
+    m_rotations.resize(nodeCount);
+    m_scales.resize(nodeCount);
+
+    for (uint32_t index = 0u; index < nodeCount; ++index)
+    {
+        uint32_t handle       = baseHandle + index;
+        uint32_t parentHandle = storage.parent[handle];
+
+        // nodes outside of the cooked range are re-parented to the scene root on load
+        m_parents[index]      = parentHandle >= baseHandle && parentHandle < handle ? parentHandle - baseHandle : DSCENE_NO_PARENT;
+        m_subtreeEnds[index]  = storage.subtreeEnd[handle] - baseHandle;
+        m_translations[index] = storage.translation[handle];
+        m_rotations[index]    = storage.rotation[handle];
+        m_scales[index]       = storage.scale[handle];
+    }
+}
+
+bool DSceneWriter::write(const std::filesystem::path& filePath) const
+{
+    DUSK_PROFILE_FUNCTION;
+
+    DSceneHeader       header {};
+    DynamicArray<char> blob(alignUp(sizeof(DSceneHeader), DSCENE_ALIGNMENT), 0);
+
+    auto               appendSection = [&](DSceneSection section, const void* data, size_t size)
+    {
+        size_t offset = alignUp(blob.size(), DSCENE_ALIGNMENT);
+        blob.resize(offset + size, 0);
+
+        if (size > 0) std::memcpy(blob.data() + offset, data, size);
+
+        header.sections[sectionIndex(section)] = { offset, size };
+    };
+
+    header.name           = m_name;
+    header.packedVertices = Engine::get().isPackedVerticesEnabled() ? 1u : 0u;
+
+    // dependency paths are appended to the strings
+    DynamicArray<char>         strings = m_strings;
+    DynamicArray<DSceneString> dependencies;
+    dependencies.reserve(m_dependencies.size());
+
+    for (const auto& dependency : m_dependencies)
+    {
+        dependencies.push_back({ static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(dependency.size()) });
+        strings.insert(strings.end(), dependency.begin(), dependency.end());
+    }
+
+    appendSection(DSceneSection::Vertices, m_vertices.data(), m_vertices.size() * sizeof(Vertex));
+    appendSection(DSceneSection::Indices, m_indices.data(), m_indices.size() * sizeof(uint32_t));
+    appendSection(DSceneSection::PackedVertices, m_packedVertices.data(), m_packedVertices.size() * sizeof(PackedVertex));
+    appendSection(DSceneSection::PackedIndices, m_packedIndices.data(), m_packedIndices.size() * sizeof(uint16_t));
+    appendSection(DSceneSection::Meshes, m_meshes.data(), m_meshes.size() * sizeof(GfxMeshData));
+    appendSection(DSceneSection::Materials, m_materials.data(), m_materials.size() * sizeof(DSceneMaterial));
+    appendSection(DSceneSection::Nodes, m_nodes.data(), m_nodes.size() * sizeof(DSceneNode));
+    appendSection(DSceneSection::NodeMeshes, m_nodeMeshes.data(), m_nodeMeshes.size() * sizeof(DSceneNodeMesh));
+    appendSection(DSceneSection::Parents, m_parents.data(), m_parents.size() * sizeof(uint32_t));
+    appendSection(DSceneSection::SubtreeEnds, m_subtreeEnds.data(), m_subtreeEnds.size() * sizeof(uint32_t));
+    appendSection(DSceneSection::Translations, m_translations.data(), m_translations.size() * sizeof(glm::vec3));
+    appendSection(DSceneSection::Rotations, m_rotations.data(), m_rotations.size() * sizeof(glm::quat));
+    appendSection(DSceneSection::Scales, m_scales.data(), m_scales.size() * sizeof(glm::vec3));
+    appendSection(DSceneSection::BoundingBoxes, m_boundingBoxes.data(), m_boundingBoxes.size() * sizeof(AABB));
+    appendSection(DSceneSection::Dependencies, dependencies.data(), dependencies.size() * sizeof(DSceneString));
+    appendSection(DSceneSection::Strings, strings.data(), strings.size());
+
+    std::memcpy(blob.data(), &header, sizeof(DSceneHeader));
+
+    // write to a temporary file first, so a failed write never leaves a
+    // partial cooked scene behind
+    std::filesystem::path tempPath = filePath;
+    tempPath += ".tmp";
+
+    if (!FileSystem::writeFileBinary(tempPath, blob.data(), blob.size()))
+    {
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, filePath, ec);
+    if (ec)
+    {
+        DUSK_ERROR("Unable to write cooked scene {}. {}", filePath.generic_string(), ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    DUSK_INFO("Cooked scene written to {} ({} bytes)", filePath.generic_string(), blob.size());
+
+    return true;
+}
+
+DSceneString DSceneWriter::addString(const std::string& str)
+{
+    std::lock_guard<std::mutex> stringsLock(m_stringsMutex);
+
+    DSceneString                entry {};
+    entry.offset = static_cast<uint32_t>(m_strings.size());
+    entry.length = static_cast<uint32_t>(str.size());
+
+    m_strings.insert(m_strings.end(), str.begin(), str.end());
+
+    return entry;
+}
+
+Unique<Scene> DSceneLoader::readScene(const std::filesystem::path& filePath)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    MappedFile file {};
+    if (!file.map(filePath))
+    {
+        return nullptr;
+    }
+
+    DSceneHeader header;
+    if (!readHeader(file, filePath, &header))
+    {
+        return nullptr;
+    }
+
+    SectionView<Vertex>         vertices;
+    SectionView<uint32_t>       indices;
+    SectionView<PackedVertex>   packedVertices;
+    SectionView<uint16_t>       packedIndices;
+    SectionView<GfxMeshData>    meshes;
+    SectionView<DSceneMaterial> materials;
+    SectionView<DSceneNode>     nodes;
+    SectionView<DSceneNodeMesh> nodeMeshes;
+    SectionView<uint32_t>       parents;
+    SectionView<uint32_t>       subtreeEnds;
+    SectionView<glm::vec3>      translations;
+    SectionView<glm::quat>      rotations;
+    SectionView<glm::vec3>      scales;
+    SectionView<AABB>           boundingBoxes;
+    SectionView<char>           strings;
+
+    bool                        validSections = getSection(file, header, DSceneSection::Vertices, &vertices)
+        && getSection(file, header, DSceneSection::Indices, &indices)
+        && getSection(file, header, DSceneSection::PackedVertices, &packedVertices)
+        && getSection(file, header, DSceneSection::PackedIndices, &packedIndices)
+        && getSection(file, header, DSceneSection::Meshes, &meshes)
+        && getSection(file, header, DSceneSection::Materials, &materials)
+        && getSection(file, header, DSceneSection::Nodes, &nodes)
+        && getSection(file, header, DSceneSection::NodeMeshes, &nodeMeshes)
+        && getSection(file, header, DSceneSection::Parents, &parents)
+        && getSection(file, header, DSceneSection::SubtreeEnds, &subtreeEnds)
+        && getSection(file, header, DSceneSection::Translations, &translations)
+        && getSection(file, header, DSceneSection::Rotations, &rotations)
+        && getSection(file, header, DSceneSection::Scales, &scales)
+        && getSection(file, header, DSceneSection::BoundingBoxes, &boundingBoxes)
+        && getSection(file, header, DSceneSection::Strings, &strings);
+
+    size_t nodeCount = nodes.count;
+    validSections    = validSections
+        && parents.count == nodeCount
+        && subtreeEnds.count == nodeCount
+        && translations.count == nodeCount
+        && rotations.count == nodeCount
+        && scales.count == nodeCount
+        && boundingBoxes.count == nodeCount;
+
+    if (!validSections)
+    {
+        DUSK_ERROR("Corrupted cooked scene file {}", filePath.generic_string());
+        return nullptr;
+    }
+
+    // validate references before touching the scene so a bad file can
+    // fall back to the source scene
+    for (size_t meshIndex = 0u; meshIndex < meshes.count; ++meshIndex)
+    {
+        const GfxMeshData& meshData    = meshes[meshIndex];
+        bool               isPacked    = meshData.vertexFormat == VertexFormat::Packed;
+        size_t             indexCount  = isPacked ? packedIndices.count : indices.count;
+        size_t             vertexCount = isPacked ? packedVertices.count : vertices.count;
+
+        bool               validMesh   = meshData.vertexFormat < VertexFormat::Count
+            && static_cast<size_t>(meshData.firstIndex) + meshData.indexCount <= indexCount
+            && meshData.vertexOffset >= 0;
+
+        // every index of the mesh is relative to its vertex offset
+        for (uint32_t index = 0u; validMesh && index < meshData.indexCount; ++index)
+        {
+            size_t indexPos = static_cast<size_t>(meshData.firstIndex) + index;
+            size_t vertex   = isPacked ? packedIndices[indexPos] : indices[indexPos];
+            validMesh       = static_cast<size_t>(meshData.vertexOffset) + vertex < vertexCount;
+        }
+
+        if (!validMesh)
+        {
+            DUSK_ERROR("Corrupted mesh data in cooked scene file {}", filePath.generic_string());
+            return nullptr;
+        }
+    }
+
+    for (size_t index = 0u; index < nodeCount; ++index)
+    {
+        const DSceneNode& node = nodes[index];
+        bool validNode         = static_cast<size_t>(node.firstMesh) + node.meshCount <= nodeMeshes.count
+            && (parents[index] == DSCENE_NO_PARENT || parents[index] < index)
+            && subtreeEnds[index] >= index && subtreeEnds[index] < nodeCount;
+
+        for (uint32_t meshIndex = 0u; validNode && meshIndex < node.meshCount; ++meshIndex)
+        {
+            const DSceneNodeMesh& nodeMesh = nodeMeshes[node.firstMesh + meshIndex];
+            validNode                      = nodeMesh.mesh < meshes.count && nodeMesh.material < materials.count;
+        }
+
+        if (!validNode)
+        {
+            DUSK_ERROR("Corrupted node data in cooked scene file {}", filePath.generic_string());
+            return nullptr;
+        }
+    }
+
+    auto newScene = createUnique<Scene>(getString(strings, header.name));
+
+    // meshes
+    newScene->m_sceneMeshes.assign(meshes.data, meshes.data + meshes.count);
+
+    // materials
+    std::filesystem::path sceneDir     = filePath.parent_path();
+    int32_t               defaultTexId = TextureDB::cache()->getDefaultTexture2D().id;
+
+    newScene->initMaterialCache(static_cast<uint32_t>(materials.count));
+    for (size_t matIndex = 0u; matIndex < materials.count; ++matIndex)
+    {
+        const DSceneMaterial& cookedMaterial = materials[matIndex];
+        Material              newMaterial    = cookedMaterial.material;
+
+        int32_t*              texIds[]       = {
+            &newMaterial.albedoTexId,
+            &newMaterial.normalTexId,
+            &newMaterial.metallicRoughnessTexId,
+            &newMaterial.aoTexId,
+            &newMaterial.emissiveTexId,
+        };
+
+        for (uint32_t slot = 0u; slot < static_cast<uint32_t>(DSceneTextureSlot::Count); ++slot)
+        {
+            std::string texPath = getString(strings, cookedMaterial.texturePaths[slot]);
+
+            if (!texPath.empty())
+            {
+                auto  texturePath = (sceneDir / texPath).make_preferred().string();
+                float alphaCutoff = slot == static_cast<uint32_t>(DSceneTextureSlot::Albedo) ? newMaterial.alphaCutoff : 0.f;
+                *texIds[slot]     = TextureDB::cache()->createTextureAsync(texturePath, TextureType::Texture2D, s_textureSlotFormats[slot], alphaCutoff);
+            }
+            else if (*texIds[slot] != -1)
+            {
+                // slot was bound to default texture during cooking
+                *texIds[slot] = defaultTexId;
+            }
+        }
+
+        newScene->addMaterial(newMaterial);
+    }
+
+    // nodes
+    auto                   storage = TransformSystem::getStorage();
+    DynamicArray<EntityId> nodeEntities(nodeCount, NULL_ENTITY);
+    uint32_t               baseHandle = storage->count;
+
+    for (size_t index = 0u; index < nodeCount; ++index)
+    {
+        const DSceneNode& node         = nodes[index];
+
+        auto              gameObject   = createUnique<GameObject>();
+        auto              gameObjectId = gameObject->getId();
+        auto              handle       = gameObject->getTransformHandle();
+
+        DASSERT(handle == baseHandle + index, "Transforms are expected to be allocated contiguously");
+
+        gameObject->setName(getString(strings, node.name));
+
+        if (node.meshCount > 0)
+        {
+            auto& renderable    = gameObject->addComponent<RenderableComponent>();
+            renderable.isStatic = true; // imported scene geometry is not expected to move
+            renderable.meshes.reserve(node.meshCount);
+            renderable.materials.reserve(node.meshCount);
+
+            for (uint32_t meshIndex = 0u; meshIndex < node.meshCount; ++meshIndex)
+            {
+                const DSceneNodeMesh& nodeMesh = nodeMeshes[node.firstMesh + meshIndex];
+                renderable.meshes.push_back(nodeMesh.mesh);
+                renderable.materials.push_back(nodeMesh.material);
+            }
+
+            renderable.objectAABB = boundingBoxes[index];
+        }
+
+        EntityId parentId = parents[index] == DSCENE_NO_PARENT ? newScene->getRootId() : nodeEntities[parents[index]];
+        newScene->addGameObject(std::move(gameObject), parentId);
+
+        nodeEntities[index]          = gameObjectId;
+
+        storage->translation[handle] = translations[index];
+        storage->rotation[handle]    = rotations[index];
+        storage->scale[handle]       = scales[index];
+        storage->subtreeEnd[handle]  = baseHandle + subtreeEnds[index];
+        storage->dirtyList[handle]   = 1u;
+
+        storage->recomputeLocal(handle);
+    }
+
+    // parents are always ahead of children in DFS order
+    uint32_t transformsCount = storage->count;
+    for (uint32_t handle = 0u; handle < transformsCount; ++handle)
+    {
+        storage->recomputeWorld(handle);
+    }
+
+    // upload geometry straight from the mapped file
+    auto&                  engine           = Engine::get();
+    GfxGeometryAllocation& allocation       = newScene->m_geometryAllocation;
+    GfxGeometryAllocation& packedAllocation = newScene->m_packedGeometryAllocation;
+    if (!engine.uploadVertexAndIndexBuffers(
+            vertices.data,
+            vertices.count,
+            indices.data,
+            indices.count,
+            &allocation))
+    {
+        DUSK_ERROR("Unable to upload geometry of cooked scene {}", filePath.generic_string());
+        return nullptr;
+    }
+
+    if (!engine.uploadVertexAndIndexBuffers(
+            packedVertices.data,
+            packedVertices.count,
+            packedIndices.data,
+            packedIndices.count,
+            &packedAllocation))
+    {
+        DUSK_ERROR("Unable to upload geometry of cooked scene {}", filePath.generic_string());
+
+        // ranges of the full geometry are already allocated
+        if (allocation.vertexCount > 0 || allocation.indexCount > 0)
+        {
+            engine.releaseVertexAndIndexBuffers(allocation);
+        }
+
+        return nullptr;
+    }
+
+    for (auto& meshData : newScene->m_sceneMeshes)
+    {
+        const GfxGeometryAllocation& meshAllocation = meshData.vertexFormat == VertexFormat::Packed ? packedAllocation : allocation;
+        meshData.firstIndex                         = meshAllocation.firstIndex + meshData.firstIndex;
+        meshData.vertexOffset                       = meshAllocation.vertexOffset + meshData.vertexOffset;
+    }
+
+    DUSK_INFO("Loaded cooked scene {} with {} meshes and {} nodes", filePath.generic_string(), meshes.count, nodeCount);
+
+    return newScene;
+}
+
+std::filesystem::path DSceneLoader::getCookedPath(const std::filesystem::path& sourcePath)
+{
+    std::filesystem::path cookedPath = sourcePath;
+    return cookedPath.replace_extension(DSCENE_EXTENSION);
+}
+
+bool DSceneLoader::isCookedSceneFresh(
+    const std::filesystem::path& cookedPath,
+    const std::filesystem::path& sourcePath)
+{
+    std::error_code ec;
+    if (!std::filesystem::exists(cookedPath, ec)) return false;
+
+    auto cookedTime = std::filesystem::last_write_time(cookedPath, ec);
+    if (ec) return false;
+
+    // source files may be missing when only the cooked scene is shipped
+    auto isModified = [&](const std::filesystem::path& path)
+    {
+        auto sourceTime = std::filesystem::last_write_time(path, ec);
+        return !ec && sourceTime > cookedTime;
+    };
+
+    if (isModified(sourcePath)) return false;
+
+    // buffers and textures read by the import are recorded in the cooked scene
+    MappedFile   file {};
+    DSceneHeader header;
+    if (!file.map(cookedPath) || !readHeader(file, cookedPath, &header)) return false;
+
+    // mesh formats are chosen at import
+    if ((header.packedVertices != 0u) != Engine::get().isPackedVerticesEnabled()) return false;
+
+    SectionView<DSceneString> dependencies;
+    SectionView<char>         strings;
+    if (!getSection(file, header, DSceneSection::Dependencies, &dependencies)
+        || !getSection(file, header, DSceneSection::Strings, &strings))
+    {
+        return false;
+    }
+
+    std::filesystem::path sceneDir = cookedPath.parent_path();
+    for (size_t index = 0u; index < dependencies.count; ++index)
+    {
+        if (isModified(sceneDir / getString(strings, dependencies[index]))) return false;
+    }
+
+    return true;
+}
+
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "dusk.h"
+#include "scene/entity.h"
+#include "renderer/vertex.h"
+#include "renderer/material.h"
+#include "renderer/gfx_types.h"
+#include "renderer/geometry/aabb.h"
+
+#include <glm/gtc/quaternion.hpp>
+#include <filesystem>
+#include <mutex>
+
+// Cooked scene (.dscene) is a flat binary image of an imported scene. All sections
+// are stored exactly as the engine consumes them, so loading is a header validation
+// followed by direct reads from the memory mapped file. Nodes and their transform
+// arrays are stored in DFS order with parent index < child index.
+
+namespace dusk
+{
+class Scene;
+struct TransformStorage;
+
+constexpr uint32_t DSCENE_MAGIC       = 0x4E435344u; // "DSCN"
+constexpr uint32_t DSCENE_VERSION     = 5u;
+constexpr uint32_t DSCENE_ALIGNMENT   = 16u;
+constexpr uint32_t DSCENE_NO_PARENT   = ~0u;
+constexpr char     DSCENE_EXTENSION[] = ".dscene";
+
+enum class DSceneSection : uint32_t
+{
+    Vertices,
+    Indices,
+    PackedVertices,
+    PackedIndices,
+    Meshes,
+    Materials,
+    Nodes,
+    NodeMeshes,
+    Parents,
+    SubtreeEnds,
+    Translations,
+    Rotations,
+    Scales,
+    BoundingBoxes,
+    Dependencies,
+    Strings,
+    Count
+};
+
+// texture slots of a material, their pixel format is implied by the slot
+enum class DSceneTextureSlot : uint32_t
+{
+    Albedo,
+    Normal,
+    MetallicRoughness,
+    AmbientOcclusion,
+    Emissive,
+    Count
+};
+
+struct DSceneSectionInfo
+{
+    uint64_t offset = 0u;
+    uint64_t size   = 0u;
+};
+
+struct DSceneString
+{
+    uint32_t offset = 0u;
+    uint32_t length = 0u;
+};
+
+struct DSceneHeader
+{
+    uint32_t          magic            = DSCENE_MAGIC;
+    uint32_t          version          = DSCENE_VERSION;
+
+    // guards against layout changes of the structs stored as is
+    uint32_t          vertexSize       = sizeof(Vertex);
+    uint32_t          packedVertexSize = sizeof(PackedVertex);
+    uint32_t          meshSize         = sizeof(GfxMeshData);
+    uint32_t          materialSize     = sizeof(Material);
+
+    // meshes were allowed to use the packed vertex format
+    uint32_t          packedVertices   = 0u;
+
+    DSceneString      name             = {};
+    DSceneSectionInfo sections[static_cast<uint32_t>(DSceneSection::Count)];
+};
+
+struct DSceneMaterial
+{
+    Material     material;
+    DSceneString texturePaths[static_cast<uint32_t>(DSceneTextureSlot::Count)];
+};
+
+struct DSceneNode
+{
+    DSceneString name;
+    uint32_t     firstMesh;
+    uint32_t     meshCount;
+};
+
+struct DSceneNodeMesh
+{
+    uint32_t mesh;
+    uint32_t material;
+};
+
+/**
+ * @brief Collects imported scene data and writes it as a cooked scene file.
+ * Materials and nodes can be added from different threads.
+ */
+class DSceneWriter
+{
+public:
+    DSceneWriter()  = default;
+    ~DSceneWriter() = default;
+
+    /**
+     * @brief Set name of the scene
+     * @param name
+     */
+    void setName(const std::string& name);
+
+    /**
+     * @brief Set final geometry of the scene. Mesh offsets should be relative
+     * to the vertex and index arrays of the mesh vertex format.
+     * @param vertices of all full format meshes
+     * @param indices of all full format meshes
+     * @param packedVertices of all packed meshes
+     * @param packedIndices of all packed meshes
+     * @param meshes table
+     */
+    void setGeometry(
+        const DynamicArray<Vertex>&       vertices,
+        const DynamicArray<uint32_t>&     indices,
+        const DynamicArray<PackedVertex>& packedVertices,
+        const DynamicArray<uint16_t>&     packedIndices,
+        const DynamicArray<GfxMeshData>&  meshes);
+
+    /**
+     * @brief Add a material along with source paths of its textures
+     * @param material
+     * @param texturePaths relative to the scene directory, empty for a missing slot
+     */
+    void addMaterial(
+        const Material&              material,
+        const std::filesystem::path* texturePaths);
+
+    /**
+     * @brief Add a node. Nodes should be added in DFS order.
+     * @param name of the node
+     * @param meshes of the node
+     * @param materials of the node meshes
+     * @param objectAABB of the node meshes
+     */
+    void addNode(
+        const std::string&            name,
+        const DynamicArray<uint32_t>& meshes,
+        const DynamicArray<uint32_t>& materials,
+        const AABB&                   objectAABB);
+
+    /**
+     * @brief Add a source file read by the import, cooked scene is stale once
+     * any of them is modified. Texture paths of materials are added already.
+     * @param path relative to the scene directory
+     */
+    void addDependency(const std::filesystem::path& path);
+
+    /**
+     * @brief Capture transforms of all added nodes from the storage
+     * @param storage transform storage
+     * @param baseHandle transform handle of the first added node
+     */
+    void setTransforms(const TransformStorage& storage, uint32_t baseHandle);
+
+    /**
+     * @brief Write cooked scene file
+     * @param filePath of the cooked scene
+     * @return true if successful
+     */
+    bool write(const std::filesystem::path& filePath) const;
+
+private:
+    DSceneString addString(const std::string& str);
+
+private:
+    DSceneString                 m_name           = {};
+
+    DynamicArray<Vertex>         m_vertices       = {};
+    DynamicArray<uint32_t>       m_indices        = {};
+    DynamicArray<PackedVertex>   m_packedVertices = {};
+    DynamicArray<uint16_t>       m_packedIndices  = {};
+    DynamicArray<GfxMeshData>    m_meshes         = {};
+    DynamicArray<DSceneMaterial> m_materials      = {};
+
+    DynamicArray<DSceneNode>     m_nodes          = {};
+    DynamicArray<DSceneNodeMesh> m_nodeMeshes     = {};
+    DynamicArray<uint32_t>       m_parents        = {};
+    DynamicArray<uint32_t>       m_subtreeEnds    = {};
+    DynamicArray<glm::vec3>      m_translations   = {};
+    DynamicArray<glm::quat>      m_rotations      = {};
+    DynamicArray<glm::vec3>      m_scales         = {};
+    DynamicArray<AABB>           m_boundingBoxes  = {};
+
+    std::mutex                   m_stringsMutex;
+    DynamicArray<char>           m_strings        = {};
+    DynamicArray<std::string>    m_dependencies   = {};
+};
+
+class DSceneLoader
+{
+public:
+    DSceneLoader()  = default;
+    ~DSceneLoader() = default;
+
+    /**
+     * @brief Load a cooked scene file
+     * @param filePath of the cooked scene
+     * @return unique pointer to the scene object, nullptr if file is invalid
+     */
+    Unique<Scene> readScene(const std::filesystem::path& filePath);
+
+    /**
+     * @brief Get path of the cooked scene for a source scene file
+     * @param sourcePath of the scene
+     * @return path of the cooked scene
+     */
+    static std::filesystem::path getCookedPath(const std::filesystem::path& sourcePath);
+
+    /**
+     * @brief Check whether cooked scene exists and is newer than the source
+     * and all the files recorded as its dependencies
+     * @param cookedPath of the cooked scene
+     * @param sourcePath of the scene
+     * @return true if cooked scene can be used
+     */
+    static bool isCookedSceneFresh(
+        const std::filesystem::path& cookedPath,
+        const std::filesystem::path& sourcePath);
+};
+} // namespace dusk
\ No newline at end of file
@@ -1,9 +1,17 @@
 #include "file_system.h"
 
 #include "dusk.h"
+#include "platform.h"
 
 #include <fstream>
 
+#ifndef DUSK_PLATFORM_WIN32
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
 namespace dusk
 {
 DynamicArray<char> FileSystem::readFileBinary(const std::filesystem::path& filepath)
@@ -34,4 +42,145 @@ DynamicArray<char> FileSystem::readFileBinary(const std::filesystem::path& filep
     return buffer;
 }
 
+bool FileSystem::writeFileBinary(const std::filesystem::path& filepath, const void* data, size_t size)
+{
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+
+    if (!file)
+    {
+        DUSK_ERROR("Failed to open file {} for writing", filepath.generic_string());
+        return false;
+    }
+
+    file.write(static_cast<const char*>(data), size);
+
+    if (!file)
+    {
+        DUSK_ERROR("Failed to write file {}", filepath.generic_string());
+        return false;
+    }
+
+    return true;
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+#ifdef DUSK_PLATFORM_WIN32
+
+bool MappedFile::map(const std::filesystem::path& filepath)
+{
+    unmap();
+
+    HANDLE file = CreateFileW(
+        filepath.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        DUSK_ERROR("Failed to open file {} for mapping", filepath.generic_string());
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        DUSK_ERROR("Failed to create mapping for file {}", filepath.generic_string());
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        DUSK_ERROR("Failed to map view of file {}", filepath.generic_string());
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle    = file;
+    m_mappingHandle = mapping;
+    m_data          = static_cast<const uint8_t*>(view);
+    m_size          = static_cast<size_t>(fileSize.QuadPart);
+
+    return true;
+}
+
+void MappedFile::unmap()
+{
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mappingHandle) CloseHandle(m_mappingHandle);
+    if (m_fileHandle) CloseHandle(m_fileHandle);
+
+    m_data          = nullptr;
+    m_size          = 0u;
+    m_mappingHandle = nullptr;
+    m_fileHandle    = nullptr;
+}
+
+#else
+
+bool MappedFile::map(const std::filesystem::path& filepath)
+{
+    unmap();
+
+    int fd = open(filepath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        DUSK_ERROR("Failed to open file {} for mapping", filepath.generic_string());
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // mapping keeps its own reference to the file
+    close(fd);
+
+    if (view == MAP_FAILED)
+    {
+        DUSK_ERROR("Failed to map file {}", filepath.generic_string());
+        return false;
+    }
+
+    // whole file is consumed during load, so prefetch it
+    madvise(view, static_cast<size_t>(fileStat.st_size), MADV_WILLNEED);
+
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    return true;
+}
+
+void MappedFile::unmap()
+{
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+
+    m_data = nullptr;
+    m_size = 0u;
+}
+
+#endif
+
 } // namespace dusk
\ No newline at end of file
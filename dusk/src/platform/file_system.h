@@ -7,9 +7,67 @@
 
 namespace dusk
 {
+/**
+ * @brief Read only memory mapped view of a file. Mapping stays valid
+ * till the object is alive or unmap is called.
+ */
+class MappedFile
+{
+public:
+    CLASS_UNCOPYABLE(MappedFile);
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    /**
+     * @brief Map the whole file in memory for reading
+     * @param filepath of the file
+     * @return true if mapping was successful
+     */
+    bool map(const std::filesystem::path& filepath);
+
+    /**
+     * @brief Release the mapping
+     */
+    void unmap();
+
+    /**
+     * @brief Get start of the mapped memory
+     */
+    const uint8_t* data() const { return m_data; };
+
+    /**
+     * @brief Get size of the mapped memory in bytes
+     */
+    size_t size() const { return m_size; };
+
+    /**
+     * @brief Check whether file is currently mapped
+     */
+    bool isMapped() const { return m_data != nullptr; };
+
+private:
+    const uint8_t* m_data   = nullptr;
+    size_t         m_size   = 0u;
+
+#ifdef DUSK_PLATFORM_WIN32
+    void* m_fileHandle    = nullptr;
+    void* m_mappingHandle = nullptr;
+#endif
+};
+
 class FileSystem
 {
 public:
     static DynamicArray<char> readFileBinary(const std::filesystem::path& filepath);
+
+    /**
+     * @brief Write binary data to the file. Existing file will be overwritten.
+     * @param filepath of the file
+     * @param data to write
+     * @param size of the data in bytes
+     * @return true if write was successful
+     */
+    static bool writeFileBinary(const std::filesystem::path& filepath, const void* data, size_t size);
 };
 } // namespace dusk
\ No newline at end of file
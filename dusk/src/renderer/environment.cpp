@@ -24,21 +24,21 @@ bool Environment::init(VkGfxDescriptorSetLayout& globalDescSetLayout)
     std::string       resPath           = basePath + "/textures/skybox/";
 
     const std::string skyboxTexturePath = resPath + "night_01_env.ktx2";
-    m_skyTextureId                      = m_textureDB.createTextureAsync(
+    m_skyTextureIds[0]                  = m_textureDB.createTextureAsync(
         skyboxTexturePath,
         TextureType::Cube,
         PixelFormat::R32G32B32A32_sfloat);
 
     // irradiance cubemap
     const std::string skyboxIrradianceTexturePath = resPath + "night_01_env_irradiance.ktx2";
-    m_skyIrradianceTexId                          = m_textureDB.createTextureAsync(
+    m_skyIrradianceTexIds[0]                      = m_textureDB.createTextureAsync(
         skyboxIrradianceTexturePath,
         TextureType::Cube,
         PixelFormat::R32G32B32A32_sfloat);
 
     // prefiltered cubemap
     const std::string skyboxPrefilteredTexturePath = resPath + "night_01_env_prefiltered.ktx2";
-    m_skyPrefilteredTexId
+    m_skyPrefilteredTexIds[0]
         = m_textureDB.createTextureAsync(
             skyboxPrefilteredTexturePath,
             TextureType::Cube,
@@ -60,7 +60,11 @@ bool Environment::initHW(VkGfxDescriptorSetLayout& globalDescSetLayout, uint32_t
     // Initialize Hosek-Wilkie parameters with default values for day time
     computeHosekWilkieParams(2.0f, 0.1f, DEFAULT_DAY_SUN_DIRECTION);
 
-    setupHWSkyResources(shaderPath, maxFramesCount);
+    setupHWSkyResources(shaderPath);
+    buildUpdateSlices();
+
+    m_dynamicSky     = true;
+    m_maxFramesCount = maxFramesCount;
 
     return true;
 }
@@ -73,7 +77,7 @@ void Environment::computeHosekWilkieParams(float turbidity, float albedo, glm::v
             -1.0f,
             1.0f));
 
-    m_hwParams.sunDirection.xyz = glm::normalize(DEFAULT_DAY_SUN_DIRECTION);
+    m_hwParams.sunDirection.xyz = glm::normalize(sunDirection);
 
     auto* hwSkyState            = arhosek_rgb_skymodelstate_alloc_init(
         turbidity,
@@ -99,118 +103,136 @@ void Environment::computeHosekWilkieParams(float turbidity, float albedo, glm::v
     arhosekskymodelstate_free(hwSkyState);
 }
 
-void Environment::setupHWSkyResources(const std::string& shaderPath, uint32_t maxFramesCount)
+void Environment::setupHWSkyResources(const std::string& shaderPath)
 {
     auto& vkCtx = VkGfxDevice::getSharedVulkanContext();
 
-    // setup textures for Hosek-Wilkie sky model
-    uint32_t numMipLevels = static_cast<uint32_t>(
-                                std::floor(std::log2(
-                                    std::max(
-                                        ENV_RENDER_WIDTH,
-                                        ENV_RENDER_HEIGHT))))
-        + 1;
-
-    m_skyTextureId
-        = m_textureDB.createCubeStorageTexture(
-            "skybox_texture",
+    // setup textures for Hosek-Wilkie sky model, one set for each slot
+    for (uint32_t slot = 0u; slot < IBL_SLOT_COUNT; ++slot)
+    {
+        m_skyTextureIds[slot] = m_textureDB.createCubeStorageTexture(
+            std::format("skybox_texture_{}", slot),
             ENV_RENDER_WIDTH,
             ENV_RENDER_HEIGHT,
-            numMipLevels,
+            ENV_MIP_COUNT,
             VK_FORMAT_R16G16B16A16_SFLOAT);
 
-    m_skyIrradianceTexId = m_textureDB.createCubeStorageTexture(
-        "skybox_irradiance_texture",
-        IRRADIANCE_RENDER_WIDTH,
-        IRRADIANCE_RENDER_HEIGHT,
+        m_skyIrradianceTexIds[slot] = m_textureDB.createCubeStorageTexture(
+            std::format("skybox_irradiance_texture_{}", slot),
+            IRRADIANCE_RENDER_WIDTH,
+            IRRADIANCE_RENDER_HEIGHT,
+            1,
+            VK_FORMAT_R16G16B16A16_SFLOAT);
+
+        m_skyPrefilteredTexIds[slot] = m_textureDB.createCubeStorageTexture(
+            std::format("skybox_prefiltered_texture_{}", slot),
+            PREFILTERED_RENDER_WIDTH,
+            PREFILTERED_RENDER_HEIGHT,
+            PREFILTERED_MIP_COUNT,
+            VK_FORMAT_R16G16B16A16_SFLOAT);
+    }
+
+    // params and SH coefficients are only used while a slot is rebuilt, so slots share them
+    GfxBuffer::createHostWriteBuffer(
+        GfxBufferUsageFlags::StorageBuffer,
+        sizeof(HosekWilkieSkyParams),
         1,
-        VK_FORMAT_R16G16B16A16_SFLOAT);
+        "hw_sky_params_buffer",
+        &m_hwParamsBuffer);
 
-    m_skyPrefilteredTexId = m_textureDB.createCubeStorageTexture(
-        "skybox_prefiltered_texture",
-        PREFILTERED_RENDER_WIDTH,
-        PREFILTERED_RENDER_HEIGHT,
-        5,
-        VK_FORMAT_R16G16B16A16_SFLOAT);
+    GfxBuffer::createDeviceLocalBuffer(
+        GfxBufferUsageFlags::StorageBuffer,
+        sizeof(glm::vec4) * ENV_SH_COEFFICIENT_COUNT,
+        1,
+        "hw_sky_sh_coefficients_buffer",
+        &m_shCoefficientsBuffer);
 
-    // setup descriptors
+    // setup descriptors, every mip is written through its own array view
     m_genCubeDescPool = VkGfxDescriptorPool::Builder(vkCtx)
-                            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3)
-                            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1)
+                            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, IBL_SLOT_COUNT)
+                            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, (ENV_MIP_COUNT + 1 + PREFILTERED_MIP_COUNT) * IBL_SLOT_COUNT)
+                            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * IBL_SLOT_COUNT)
                             .setDebugName("hw_sky_desc_pool")
-                            .build(1);
+                            .build(IBL_SLOT_COUNT);
 
     m_genCubeDescLayout = VkGfxDescriptorSetLayout::Builder(vkCtx)
                               .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 1)
-                              .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 1)
+                              .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, ENV_MIP_COUNT)
                               .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 1)
-                              .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 1)
+                              .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, PREFILTERED_MIP_COUNT)
+                              .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT, 1)
+                              .addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT, 1)
                               .setDebugName("hw_sky_desc_layout")
                               .build();
 
-    m_genCubeDescSet = m_genCubeDescPool->allocateDescriptorSet(*m_genCubeDescLayout, "hw_sky_desc_set");
-
-    GfxBuffer::createHostWriteBuffer(
-        GfxBufferUsageFlags::StorageBuffer,
-        sizeof(HosekWilkieSkyParams),
-        maxFramesCount,
-        "hw_sky_params_buffer",
-        &m_hwParamsBuffer);
-
-    auto bufferInfo = m_hwParamsBuffer.getDescriptorInfo();
-    m_genCubeDescSet->configureBuffer(0, 0, 1, &bufferInfo);
-
-    auto                  tex = m_textureDB.getTexture(m_skyTextureId);
+    auto paramsBufferInfo = m_hwParamsBuffer.getDescriptorInfo();
+    auto shBufferInfo     = m_shCoefficientsBuffer.getDescriptorInfo();
 
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    texDescInfos.imageView   = tex->imageView;
-
-    m_genCubeDescSet->configureImage(
-        1,
-        0,
-        1,
-        &texDescInfos);
-
-    tex                      = m_textureDB.getTexture(m_skyIrradianceTexId);
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    texDescInfos.imageView   = tex->imageView;
-    m_genCubeDescSet->configureImage(
-        2,
-        0,
-        1,
-        &texDescInfos);
-
-    tex                      = m_textureDB.getTexture(m_skyPrefilteredTexId);
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    texDescInfos.imageView   = tex->imageView;
-    m_genCubeDescSet->configureImage(
-        3,
-        0,
-        1,
-        &texDescInfos);
-
-    m_genCubeDescSet->applyConfiguration();
+    for (uint32_t slot = 0u; slot < IBL_SLOT_COUNT; ++slot)
+    {
+        auto* skyTex         = m_textureDB.getTexture(m_skyTextureIds[slot]);
+        auto* irradianceTex  = m_textureDB.getTexture(m_skyIrradianceTexIds[slot]);
+        auto* prefilteredTex = m_textureDB.getTexture(m_skyPrefilteredTexIds[slot]);
+
+        // sets keep pointers to the infos until the configuration is applied
+        Array<VkDescriptorImageInfo, ENV_MIP_COUNT>         skyMipInfos {};
+        Array<VkDescriptorImageInfo, PREFILTERED_MIP_COUNT> prefilteredMipInfos {};
+        VkDescriptorImageInfo                               irradianceInfo {};
+        VkDescriptorImageInfo                               skySamplerInfo {};
+
+        for (uint32_t level = 0u; level < ENV_MIP_COUNT; ++level)
+        {
+            skyMipInfos[level].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            skyMipInfos[level].imageView   = skyTex->perMipArrayImageViews[level];
+        }
+
+        for (uint32_t level = 0u; level < PREFILTERED_MIP_COUNT; ++level)
+        {
+            prefilteredMipInfos[level].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+            prefilteredMipInfos[level].imageView   = prefilteredTex->perMipArrayImageViews[level];
+        }
+
+        irradianceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        irradianceInfo.imageView   = irradianceTex->perMipArrayImageViews[0];
+
+        // sky stays in general layout while the rest of the slot is filtered from it
+        skySamplerInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        skySamplerInfo.imageView   = skyTex->imageView;
+        skySamplerInfo.sampler     = skyTex->sampler;
+
+        m_genCubeDescSets[slot]    = m_genCubeDescPool->allocateDescriptorSet(
+            *m_genCubeDescLayout,
+            std::format("hw_sky_desc_set_{}", slot).c_str());
+
+        m_genCubeDescSets[slot]->configureBuffer(0, 0, 1, &paramsBufferInfo);
+        m_genCubeDescSets[slot]->configureImage(1, 0, ENV_MIP_COUNT, skyMipInfos.data());
+        m_genCubeDescSets[slot]->configureImage(2, 0, 1, &irradianceInfo);
+        m_genCubeDescSets[slot]->configureImage(3, 0, PREFILTERED_MIP_COUNT, prefilteredMipInfos.data());
+        m_genCubeDescSets[slot]->configureImage(4, 0, 1, &skySamplerInfo);
+        m_genCubeDescSets[slot]->configureBuffer(5, 0, 1, &shBufferInfo);
+        m_genCubeDescSets[slot]->applyConfiguration();
+    }
 
-    // setup environment map generation pipeline
-    m_genEnvCubeMapPipelineLayout = VkGfxPipelineLayout::Builder(vkCtx)
-                                        .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(IBLPushConstant))
-                                        .addDescriptorSetLayout(m_genCubeDescLayout->layout)
-                                        .build();
+    // all generation pipelines share the layout
+    m_genEnvMapsPipelineLayout = VkGfxPipelineLayout::Builder(vkCtx)
+                                     .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(IBLPushConstant))
+                                     .addDescriptorSetLayout(*m_genCubeDescLayout)
+                                     .build();
 
 #ifdef VK_RENDERER_DEBUG
     vkdebug::setObjectName(
         vkCtx.device,
         VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-        (uint64_t)m_genEnvCubeMapPipelineLayout->get(),
-        "gen_env_cubemap_pipeline_layout");
+        (uint64_t)m_genEnvMapsPipelineLayout->get(),
+        "gen_env_maps_pipeline_layout");
 #endif // VK_RENDERER_DEBUG
 
+    // setup environment map generation pipeline
     auto genEnvShader       = FileSystem::readFileBinary(shaderPath + "/" + "gen_env_cubemap.comp.spv");
 
     m_genEnvCubeMapPipeline = VkGfxComputePipeline::Builder(vkCtx)
                                   .setComputeShaderCode(genEnvShader)
-                                  .setPipelineLayout(*m_genEnvCubeMapPipelineLayout)
+                                  .setPipelineLayout(*m_genEnvMapsPipelineLayout)
                                   .setDebugName("gen_env_cubemap_pipeline")
                                   .build();
 
@@ -222,26 +244,29 @@ void Environment::setupHWSkyResources(const std::string& shaderPath, uint32_t ma
         "gen_env_cubemap_pipeline");
 #endif // VK_RENDERER_DEBUG
 
-    // setup irradiance map generation pipeline
-    m_genEnvIrradiancePipelineLayout = VkGfxPipelineLayout::Builder(vkCtx)
-                                           .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(IBLPushConstant))
-                                           .addDescriptorSetLayout(m_textureDB.getTexturesDescriptorSetLayout().layout)
-                                           .addDescriptorSetLayout(m_genCubeDescLayout->layout)
-                                           .build();
+    // setup SH projection pipeline
+    auto genEnvSHShader = FileSystem::readFileBinary(shaderPath + "/" + "gen_env_sh.comp.spv");
+
+    m_genEnvSHPipeline  = VkGfxComputePipeline::Builder(vkCtx)
+                             .setComputeShaderCode(genEnvSHShader)
+                             .setPipelineLayout(*m_genEnvMapsPipelineLayout)
+                             .setDebugName("gen_env_sh_pipeline")
+                             .build();
 
 #ifdef VK_RENDERER_DEBUG
     vkdebug::setObjectName(
         vkCtx.device,
-        VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-        (uint64_t)m_genEnvIrradiancePipelineLayout->get(),
-        "gen_env_irrad_cubemap_pipeline_layout");
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_genEnvSHPipeline->get(),
+        "gen_env_sh_pipeline");
 #endif // VK_RENDERER_DEBUG
 
+    // setup irradiance map generation pipeline
     auto genEnvIrradShader     = FileSystem::readFileBinary(shaderPath + "/" + "gen_env_irrad_cubemap.comp.spv");
 
     m_genEnvIrradiancePipeline = VkGfxComputePipeline::Builder(vkCtx)
                                      .setComputeShaderCode(genEnvIrradShader)
-                                     .setPipelineLayout(*m_genEnvIrradiancePipelineLayout)
+                                     .setPipelineLayout(*m_genEnvMapsPipelineLayout)
                                      .setDebugName("gen_env_irrad_cubemap_pipeline")
                                      .build();
 
@@ -254,25 +279,11 @@ void Environment::setupHWSkyResources(const std::string& shaderPath, uint32_t ma
 #endif // VK_RENDERER_DEBUG
 
     // setup prefiltered map generation pipeline
-    m_genEnvPrefilteredPipelineLayout = VkGfxPipelineLayout::Builder(vkCtx)
-                                            .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(IBLPushConstant))
-                                            .addDescriptorSetLayout(m_textureDB.getTexturesDescriptorSetLayout().layout)
-                                            .addDescriptorSetLayout(m_genCubeDescLayout->layout)
-                                            .build();
-
-#ifdef VK_RENDERER_DEBUG
-    vkdebug::setObjectName(
-        vkCtx.device,
-        VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-        (uint64_t)m_genEnvPrefilteredPipelineLayout->get(),
-        "gen_env_prefil_cubemap_pipeline_layout");
-#endif // VK_RENDERER_DEBUG
-
     auto genEnvPrefilterShader  = FileSystem::readFileBinary(shaderPath + "/" + "gen_env_prefil_cubemap.comp.spv");
 
     m_genEnvPrefilteredPipeline = VkGfxComputePipeline::Builder(vkCtx)
                                       .setComputeShaderCode(genEnvPrefilterShader)
-                                      .setPipelineLayout(*m_genEnvPrefilteredPipelineLayout)
+                                      .setPipelineLayout(*m_genEnvMapsPipelineLayout)
                                       .setDebugName("gen_env_prefil_cubemap_pipeline")
                                       .build();
 
@@ -285,18 +296,53 @@ void Environment::setupHWSkyResources(const std::string& shaderPath, uint32_t ma
 #endif // VK_RENDERER_DEBUG
 }
 
+void Environment::buildUpdateSlices()
+{
+    m_updateSlices.clear();
+
+    // sky model is cheap to evaluate, a face takes its whole mip chain
+    for (uint32_t face = 0u; face < 6u; ++face)
+    {
+        m_updateSlices.push_back({ IBLUpdateStage::EnvCubeMap, 0u, face, 1u });
+    }
+
+    // projection reads the small sky mip and irradiance is evaluated from 9 coefficients
+    m_updateSlices.push_back({ IBLUpdateStage::Irradiance, 0u, 0u, 6u });
+
+    // importance sampling dominates the rebuild, large levels go one face at a time
+    for (uint32_t level = 0u; level < PREFILTERED_MIP_COUNT; ++level)
+    {
+        if ((PREFILTERED_RENDER_WIDTH >> level) < IBL_FACE_SLICE_MIN_SIZE)
+        {
+            m_updateSlices.push_back({ IBLUpdateStage::Prefiltered, level, 0u, 6u });
+            continue;
+        }
+
+        for (uint32_t face = 0u; face < 6u; ++face)
+        {
+            m_updateSlices.push_back({ IBLUpdateStage::Prefiltered, level, face, 1u });
+        }
+    }
+}
+
 void Environment::cleanupHWSkyResources()
 {
     m_hwParamsBuffer.cleanup();
+    m_shCoefficientsBuffer.cleanup();
 
-    m_genEnvCubeMapPipeline           = nullptr;
-    m_genEnvCubeMapPipelineLayout     = nullptr;
+    m_genEnvCubeMapPipeline     = nullptr;
+    m_genEnvSHPipeline          = nullptr;
+    m_genEnvIrradiancePipeline  = nullptr;
+    m_genEnvPrefilteredPipeline = nullptr;
+    m_genEnvMapsPipelineLayout  = nullptr;
 
-    m_genEnvIrradiancePipeline        = nullptr;
-    m_genEnvIrradiancePipelineLayout  = nullptr;
+    for (auto& descSet : m_genCubeDescSets)
+    {
+        descSet = nullptr;
+    }
 
-    m_genEnvPrefilteredPipeline       = nullptr;
-    m_genEnvPrefilteredPipelineLayout = nullptr;
+    m_genCubeDescLayout = nullptr;
+    m_genCubeDescPool   = nullptr;
 }
 
 void Environment::initSkyBoxPipeline(
@@ -306,8 +352,8 @@ void Environment::initSkyBoxPipeline(
     auto& ctx                    = VkGfxDevice::getSharedVulkanContext();
     m_skyBoxRenderPipelineLayout = VkGfxPipelineLayout::Builder(ctx)
                                        .addPushConstantRange(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SkyBoxPushConstant))
-                                       .addDescriptorSetLayout(globalDescSetLayout.layout)
-                                       .addDescriptorSetLayout(m_textureDB.getTexturesDescriptorSetLayout().layout)
+                                       .addDescriptorSetLayout(globalDescSetLayout)
+                                       .addDescriptorSetLayout(m_textureDB.getTexturesDescriptorSetLayout())
                                        .build();
 
 #ifdef VK_RENDERER_DEBUG
@@ -354,15 +400,42 @@ void Environment::updateHosekWilkieSkyParams(float turbidity, float albedo, glm:
     computeHosekWilkieParams(turbidity, albedo, sunDirection);
 }
 
-void Environment::update(FrameData& frameData)
+void Environment::update()
 {
-    // Update the Hosek-Wilkie parameters buffer if they are dirty
-    if (m_hwParamsDirty)
+    m_frameUpdateSlices.clear();
+
+    if (!m_dynamicSky) return;
+
+    if (m_slotReuseFrames > 0u) --m_slotReuseFrames;
+
+    if (!m_isUpdating)
     {
-        m_hwParamsBuffer.writeAndFlushAtIndex(frameData.frameIndex, &m_hwParams, sizeof(HosekWilkieSkyParams));
+        // retired slot may still be sampled by the frames in flight
+        if (!m_hwParamsDirty || m_slotReuseFrames > 0u) return;
+
+        // params are latched for the whole rebuild, changes in between start the next one
+        m_hwParamsBuffer.writeAndFlush(0, &m_hwParams, sizeof(HosekWilkieSkyParams));
         markHosekWilkieParamsClean();
-        m_needToGenerateEnvMaps = true;
+
+        m_isUpdating         = true;
+        m_nextUpdateSliceIdx = 0u;
+        m_updateSlot         = m_activeSlot ^ 1u;
+    }
+
+    // nothing can be shown before the first maps, they are built at once
+    uint32_t sliceCount = m_hasPublishedMaps ? 1u : static_cast<uint32_t>(m_updateSlices.size());
+    for (uint32_t idx = 0u; idx < sliceCount && m_nextUpdateSliceIdx < m_updateSlices.size(); ++idx)
+    {
+        m_frameUpdateSlices.push_back(m_updateSlices[m_nextUpdateSliceIdx++]);
     }
+
+    if (m_nextUpdateSliceIdx < m_updateSlices.size()) return;
+
+    // lighting of this frame already reads the rebuilt slot
+    m_activeSlot       = m_updateSlot;
+    m_isUpdating       = false;
+    m_hasPublishedMaps = true;
+    m_slotReuseFrames  = m_maxFramesCount;
 }
 
 } // namespace dusk
\ No newline at end of file
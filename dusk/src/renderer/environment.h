@@ -26,35 +26,70 @@ const glm::vec3    DEFAULT_NIGHT_SUN_DIRECTION = glm::normalize(glm::vec3(0.0f,
 
 constexpr uint32_t ENV_RENDER_WIDTH            = 512;
 constexpr uint32_t ENV_RENDER_HEIGHT           = 512;
+constexpr uint32_t ENV_MIP_COUNT               = 10;
 const uint32_t     IRRADIANCE_RENDER_WIDTH     = 32;
 const uint32_t     IRRADIANCE_RENDER_HEIGHT    = 32;
 const uint32_t     PREFILTERED_RENDER_WIDTH    = 128;
 const uint32_t     PREFILTERED_RENDER_HEIGHT   = 128;
+constexpr uint32_t PREFILTERED_MIP_COUNT       = 5;
+constexpr uint32_t PREFILTERED_SAMPLE_COUNT    = 1024;
 
+// irradiance is projected on 9 SH coefficients from the sky mip with 32x32 faces,
+// should match gen_env.glsl
+constexpr uint32_t ENV_SH_COEFFICIENT_COUNT    = 9;
+constexpr uint32_t ENV_SH_SOURCE_MIP           = 4;
+
+// lighting reads one slot of the dynamic sky maps while the other one is rebuilt
+constexpr uint32_t IBL_SLOT_COUNT              = 2;
+
+// prefiltered levels of this size and above are rebuilt one face per frame
+constexpr uint32_t IBL_FACE_SLICE_MIN_SIZE     = 64;
+
+static_assert((ENV_RENDER_WIDTH >> (ENV_MIP_COUNT - 1)) == 1, "sky mip chain should go down to 1x1");
+
+// vec3 members are aligned like in std430 buffers
 struct alignas(16) HosekWilkieSkyParams
 {
-    glm::vec3 A = {};
-    glm::vec3 B = {};
-    glm::vec3 C = {};
-    glm::vec3 D = {};
-    glm::vec3 E = {};
-    glm::vec3 F = {};
-    glm::vec3 G = {};
-    glm::vec3 H = {};
-    glm::vec3 I = {};
+    alignas(16) glm::vec3 A = {};
+    alignas(16) glm::vec3 B = {};
+    alignas(16) glm::vec3 C = {};
+    alignas(16) glm::vec3 D = {};
+    alignas(16) glm::vec3 E = {};
+    alignas(16) glm::vec3 F = {};
+    alignas(16) glm::vec3 G = {};
+    alignas(16) glm::vec3 H = {};
+    alignas(16) glm::vec3 I = {};
 
     // Additional parameters for sun and sky
-    glm::vec3 zenithColor  = {};
-    glm::vec4 sunDirection = {}; // w component is for sun disk radius
+    alignas(16) glm::vec3 zenithColor  = {};
+    alignas(16) glm::vec4 sunDirection = {}; // w component is for sun disk radius
 };
 
 struct IBLPushConstant
 {
-    uint32_t frameIndex;
-    uint32_t envCubeMapTexId;
-    uint32_t sampleCount;
-    uint32_t resolution;
-    float    roughness;
+    uint32_t resolution;  // of the written mip
+    uint32_t mipLevel;    // written mip, sampled sky mip for SH projection
+    uint32_t faceOffset;  // first written face, dispatch z covers the rest
+    uint32_t sampleCount; // only for prefiltered maps
+    float    roughness;   // only for prefiltered maps
+};
+
+enum class IBLUpdateStage : uint32_t
+{
+    EnvCubeMap,  // sky radiance of the faces in all mips
+    Irradiance,  // SH projection of the sky, evaluated into irradiance map
+    Prefiltered, // single roughness level of the faces
+};
+
+/**
+ * @brief Part of the dynamic sky maps rebuilt in a frame
+ */
+struct IBLUpdateSlice
+{
+    IBLUpdateStage stage     = IBLUpdateStage::EnvCubeMap;
+    uint32_t       mipLevel  = 0u;
+    uint32_t       faceBegin = 0u;
+    uint32_t       faceCount = 6u;
 };
 
 class Environment
@@ -64,36 +99,61 @@ public:
         m_textureDB(db) { };
     ~Environment() = default;
 
-    bool                 init(VkGfxDescriptorSetLayout& globalDescSetLayout);
-    bool                 initHW(VkGfxDescriptorSetLayout& globalDescSetLayout, uint32_t maxFramesCount);
-    void                 cleanup();
+    bool                  init(VkGfxDescriptorSetLayout& globalDescSetLayout);
+    bool                  initHW(VkGfxDescriptorSetLayout& globalDescSetLayout, uint32_t maxFramesCount);
+    void                  cleanup();
 
-    bool                 areHosekWilkieParamsDirty() const { return m_hwParamsDirty; }
-    void                 markHosekWilkieParamsClean() { m_hwParamsDirty = false; }
+    bool                  areHosekWilkieParamsDirty() const { return m_hwParamsDirty; }
+    void                  markHosekWilkieParamsClean() { m_hwParamsDirty = false; }
 
-    VkGfxDescriptorSet&   getHWSkyDescriptorSet() const { return *m_genCubeDescSet; }
+    VkGfxDescriptorSet&   getHWSkyDescriptorSet(uint32_t slot) const { return *m_genCubeDescSets[slot]; }
 
-    VkGfxRenderPipeline& getSkyRenderPipeline() const { return *m_skyBoxRenderPipeline; }
-    VkGfxPipelineLayout& getSkyRenderPipelineLayout() const { return *m_skyBoxRenderPipelineLayout; }
+    VkGfxRenderPipeline&  getSkyRenderPipeline() const { return *m_skyBoxRenderPipeline; }
+    VkGfxPipelineLayout&  getSkyRenderPipelineLayout() const { return *m_skyBoxRenderPipelineLayout; }
 
+    VkGfxPipelineLayout&  getEnvMapsGenPipelineLayout() const { return *m_genEnvMapsPipelineLayout; }
     VkGfxComputePipeline& getEnvCubeMapGenPipeline() const { return *m_genEnvCubeMapPipeline; }
-    VkGfxPipelineLayout&  getEnvCubeMapGenPipelineLayout() const { return *m_genEnvCubeMapPipelineLayout; }
-
+    VkGfxComputePipeline& getEnvSHGenPipeline() const { return *m_genEnvSHPipeline; }
     VkGfxComputePipeline& getEnvIrradianceGenPipeline() const { return *m_genEnvIrradiancePipeline; }
-    VkGfxPipelineLayout&  getEnvIrradianceGenPipelineLayout() const { return *m_genEnvIrradiancePipelineLayout; }
-
     VkGfxComputePipeline& getEnvPrefilteredGenPipeline() const { return *m_genEnvPrefilteredPipeline; }
-    VkGfxPipelineLayout&  getEnvPrefilteredGenPipelineLayout() const { return *m_genEnvPrefilteredPipelineLayout; }
 
-    uint32_t             getSkyTextureId() const { return m_skyTextureId; };
-    uint32_t             getSkyPrefilteredTextureId() const { return m_skyPrefilteredTexId; };
-    uint32_t             getSkyIrradianceTextureId() const { return m_skyIrradianceTexId; };
+    uint32_t              getSkyTextureId() const { return m_skyTextureIds[m_activeSlot]; };
+    uint32_t              getSkyPrefilteredTextureId() const { return m_skyPrefilteredTexIds[m_activeSlot]; };
+    uint32_t              getSkyIrradianceTextureId() const { return m_skyIrradianceTexIds[m_activeSlot]; };
+
+    uint32_t              getSkyTextureId(uint32_t slot) const { return m_skyTextureIds[slot]; };
+    uint32_t              getSkyPrefilteredTextureId(uint32_t slot) const { return m_skyPrefilteredTexIds[slot]; };
+    uint32_t              getSkyIrradianceTextureId(uint32_t slot) const { return m_skyIrradianceTexIds[slot]; };
 
-    void                 updateHosekWilkieSkyParams(float turbidity, float albedo, glm::vec3 sunDirection);
-    void                 update(FrameData& frameData);
+    void                  updateHosekWilkieSkyParams(float turbidity, float albedo, glm::vec3 sunDirection);
 
-    bool                 needToGenerateEnvMaps() const { return m_needToGenerateEnvMaps; }
-    void                 markEnvMapsGenerated() { m_needToGenerateEnvMaps = false; }
+    /**
+     * @brief Pick the slices of the dynamic sky maps which are rebuilt in the
+     * current frame. Maps are rebuilt in the slot which isn't read by lighting
+     * and the slots are swapped once the last slice is picked, so lighting
+     * of that frame has to wait for the update pass.
+     */
+    void update();
+
+    /**
+     * @brief Check whether the sky is generated from Hosek-Wilkie model
+     */
+    bool isDynamicSky() const { return m_dynamicSky; }
+
+    /**
+     * @brief Get the slices picked for the current frame
+     */
+    const DynamicArray<IBLUpdateSlice>& getFrameUpdateSlices() const { return m_frameUpdateSlices; }
+
+    /**
+     * @brief Get the slot in which the slices of the current frame are written
+     */
+    uint32_t getUpdateSlot() const { return m_updateSlot; }
+
+    /**
+     * @brief Get the slot read by lighting in the current frame
+     */
+    uint32_t getActiveSlot() const { return m_activeSlot; }
 
 private:
     void initSkyBoxPipeline(
@@ -102,35 +162,51 @@ private:
 
     void computeHosekWilkieParams(float turbidity, float albedo, glm::vec3 sunDirection);
 
-    void setupHWSkyResources(const std::string& shaderPath, uint32_t maxFramesCount);
+    void setupHWSkyResources(const std::string& shaderPath);
     void cleanupHWSkyResources();
 
-private:
-    TextureDB&                       m_textureDB;
-
-    HosekWilkieSkyParams             m_hwParams                        = {};
-    bool                             m_hwParamsDirty                   = true;
-    bool                             m_needToGenerateEnvMaps           = true;
+    /**
+     * @brief Split rebuilding of the dynamic sky maps in slices of similar cost
+     */
+    void buildUpdateSlices();
 
-    uint32_t                         m_skyTextureId                    = 0u;
-    uint32_t                         m_skyIrradianceTexId              = 0u;
-    uint32_t                         m_skyPrefilteredTexId             = 0u;
-
-    GfxBuffer                        m_hwParamsBuffer                  = {};
-    Unique<VkGfxDescriptorPool>      m_genCubeDescPool                 = nullptr;
-    Unique<VkGfxDescriptorSetLayout> m_genCubeDescLayout               = nullptr;
-    Unique<VkGfxDescriptorSet>       m_genCubeDescSet                  = nullptr;
-
-    Unique<VkGfxRenderPipeline>      m_skyBoxRenderPipeline            = nullptr;
-    Unique<VkGfxPipelineLayout>      m_skyBoxRenderPipelineLayout      = nullptr;
-
-    Unique<VkGfxComputePipeline>     m_genEnvCubeMapPipeline           = nullptr;
-    Unique<VkGfxPipelineLayout>      m_genEnvCubeMapPipelineLayout     = nullptr;
-
-    Unique<VkGfxComputePipeline>     m_genEnvIrradiancePipeline        = nullptr;
-    Unique<VkGfxPipelineLayout>      m_genEnvIrradiancePipelineLayout  = nullptr;
-
-    Unique<VkGfxComputePipeline>     m_genEnvPrefilteredPipeline       = nullptr;
-    Unique<VkGfxPipelineLayout>      m_genEnvPrefilteredPipelineLayout = nullptr;
+private:
+    TextureDB&                  m_textureDB;
+
+    HosekWilkieSkyParams        m_hwParams                   = {};
+    bool                        m_hwParamsDirty              = true;
+    bool                        m_dynamicSky                 = false;
+
+    Unique<VkGfxRenderPipeline> m_skyBoxRenderPipeline       = nullptr;
+    Unique<VkGfxPipelineLayout> m_skyBoxRenderPipelineLayout = nullptr;
+
+    // static maps are in the first slot
+    Array<uint32_t, IBL_SLOT_COUNT> m_skyTextureIds        = {};
+    Array<uint32_t, IBL_SLOT_COUNT> m_skyIrradianceTexIds  = {};
+    Array<uint32_t, IBL_SLOT_COUNT> m_skyPrefilteredTexIds = {};
+    uint32_t                        m_activeSlot           = 0u;
+
+    // rebuild state of the dynamic sky maps
+    DynamicArray<IBLUpdateSlice> m_updateSlices       = {};
+    DynamicArray<IBLUpdateSlice> m_frameUpdateSlices  = {};
+    uint32_t                     m_nextUpdateSliceIdx = 0u;
+    uint32_t                     m_updateSlot         = 0u;
+    bool                         m_isUpdating         = false;
+    bool                         m_hasPublishedMaps   = false;
+    uint32_t                     m_maxFramesCount     = 0u;
+    uint32_t                     m_slotReuseFrames    = 0u; // frames until retired slot isn't read by frames in flight
+
+    // generation resources of the dynamic sky maps
+    GfxBuffer                                         m_hwParamsBuffer            = {};
+    GfxBuffer                                         m_shCoefficientsBuffer      = {};
+    Unique<VkGfxDescriptorPool>                       m_genCubeDescPool           = nullptr;
+    Unique<VkGfxDescriptorSetLayout>                  m_genCubeDescLayout         = nullptr;
+    Array<Unique<VkGfxDescriptorSet>, IBL_SLOT_COUNT> m_genCubeDescSets           = {};
+
+    Unique<VkGfxPipelineLayout>                       m_genEnvMapsPipelineLayout  = nullptr;
+    Unique<VkGfxComputePipeline>                      m_genEnvCubeMapPipeline     = nullptr;
+    Unique<VkGfxComputePipeline>                      m_genEnvSHPipeline          = nullptr;
+    Unique<VkGfxComputePipeline>                      m_genEnvIrradiancePipeline  = nullptr;
+    Unique<VkGfxComputePipeline>                      m_genEnvPrefilteredPipeline = nullptr;
 };
 } // namespace dusk
\ No newline at end of file
@@ -27,9 +27,17 @@ struct alignas(16) GlobalUbo
     uint32_t  spotLightsCount        = 0u;
     uint32_t  padding                = 0u;
 
-    alignas(16) Array<glm::uvec4, MAX_LIGHTS_PER_TYPE / 4> directionalLightIndices;
-    alignas(16) Array<glm::uvec4, MAX_LIGHTS_PER_TYPE / 4> pointLightIndices;
-    alignas(16) Array<glm::uvec4, MAX_LIGHTS_PER_TYPE / 4> spotLightIndices;
+    // point and spot lights are looked up through the light clusters
+    alignas(16) Array<glm::uvec4, MAX_DIRECTIONAL_LIGHTS / 4> directionalLightIndices;
+
+    // unjittered matrices of the current and previous frame for motion vectors,
+    // jitter of the current frame in ndc is in xy
+    glm::mat4 viewProjection         = { 1.f };
+    glm::mat4 prevViewProjection     = { 1.f };
+    glm::vec4 jitter                 = {};
+
+    // added to the mip level of material textures
+    float     textureLodBias         = 0.f;
 };
 
 struct FrameData
@@ -46,6 +54,7 @@ struct FrameData
 
     VkDescriptorSet&    globalDescriptorSet;
     VkDescriptorSet&    textureDescriptorSet;
+    VkDescriptorSet&    storageTextureDescriptorSet;
     VkDescriptorSet&    lightsDescriptorSet;
     VkDescriptorSet&    materialDescriptorSet;
     VkDescriptorSet&    meshDataDescriptorSet;
@@ -67,4 +67,26 @@ inline Frustum extractFrustumFromMatrix(const glm::mat4& vpMatrix)
     
     return frustum;
 }
+
+// Conservative test, box is rejected only when it lies completely behind one of the planes
+inline bool isAABBInFrustum(const Frustum& frustum, const glm::vec3& center, const glm::vec3& extents)
+{
+    for (const Plane* plane : { &frustum.left, &frustum.right, &frustum.bottom, &frustum.top, &frustum.near, &frustum.far })
+    {
+        float radius = glm::dot(extents, glm::abs(plane->normal));
+        if (glm::dot(plane->normal, center) + plane->distance < -radius) return false;
+    }
+
+    return true;
+}
+
+inline bool isSphereInFrustum(const Frustum& frustum, const glm::vec3& center, float radius)
+{
+    for (const Plane* plane : { &frustum.left, &frustum.right, &frustum.bottom, &frustum.top, &frustum.near, &frustum.far })
+    {
+        if (glm::dot(plane->normal, center) + plane->distance < -radius) return false;
+    }
+
+    return true;
+}
 } // namespace dusk
@@ -21,7 +21,7 @@ void GfxBuffer::createHostWriteBuffer(
     pOutBuffer->init(
         usage,
         pOutBuffer->instanceCount * pOutBuffer->instanceAlignmentSize,
-        GfxBufferMemoryTypeFlags::HostSequentialWrite,
+        GfxBufferMemoryTypeFlags::PersistentlyMapped | GfxBufferMemoryTypeFlags::HostSequentialWrite,
         debugName);
 }
 
@@ -79,7 +79,8 @@ void GfxBuffer::init(
 
     Engine::get().getGfxDevice().createBuffer(bufferParams, &vkBuffer);
 
-    this->usage = usage;
+    this->usage      = usage;
+    this->memoryType = memoryType;
 }
 
 void GfxBuffer::cleanup()
@@ -105,6 +106,12 @@ void GfxBuffer::unmap()
 
 void GfxBuffer::write(uint32_t offset, void* data, size_t size)
 {
+    if (isPersistentlyMapped())
+    {
+        memcpy((char*)vkBuffer.mappedMemory + offset, data, size);
+        return;
+    }
+
     map();
     memcpy((char*)vkBuffer.mappedMemory + offset, data, size);
     unmap();
@@ -117,9 +124,8 @@ void GfxBuffer::writeAndFlush(uint32_t offset, void* data, size_t size)
 
 void GfxBuffer::writeAtIndex(uint32_t index, void* data, size_t size)
 {
-    map();
-    memcpy((char*)vkBuffer.mappedMemory + index * instanceAlignmentSize, data, size);
-    unmap();
+    DASSERT(index < instanceCount);
+    write(index * instanceAlignmentSize, data, size);
 }
 
 void GfxBuffer::writeAndFlushAtIndex(uint32_t index, void* data, size_t size)
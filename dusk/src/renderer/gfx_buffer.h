@@ -17,7 +17,10 @@ enum GfxBufferUsageFlags : uint32_t
     VertexBuffer   = 0x00000008,
     IndexBuffer    = 0x00000010,
     StorageBuffer  = 0x00000020,
-    IndirectBuffer = 0x00000040
+    IndirectBuffer = 0x00000040,
+
+    // accessed from multiple queue families without ownership transfers
+    SharedQueueAccess = 0x00000080
 };
 
 enum GfxBufferMemoryTypeFlags : uint32_t
@@ -49,6 +52,7 @@ struct GfxBuffer
     uint32_t        instanceAlignmentSize = 0u;
     uint32_t        instanceCount         = 0u;
     uint32_t        usage                 = 0u;
+    uint32_t        memoryType            = 0u;
 
     GfxBuffer()                           = default;
     ~GfxBuffer()                          = default;
@@ -100,7 +104,14 @@ struct GfxBuffer
     void unmap();
 
     /**
-     * @brief write data in the mapped buffer at a particular offset
+     * @brief Check if buffer stays mapped for its whole lifetime
+     * @return true if persistently mapped
+     */
+    bool isPersistentlyMapped() const { return memoryType & GfxBufferMemoryTypeFlags::PersistentlyMapped; }
+
+    /**
+     * @brief write data in the mapped buffer at a particular offset. Writes into
+     * persistently mapped buffers are not flushed.
      * @param offset to start of the writing location
      * @param source pointer to read from
      * @param total size to write
@@ -117,7 +128,7 @@ struct GfxBuffer
 
     /**
      * @brief Write data in the mapped buffer at a particular index(if buffer
-     * is being used as an array)
+     * is being used as an array). Writes into persistently mapped buffers are not flushed.
      * @param index of the writing location
      * @param source pointer to read from
      * @param total size to write
@@ -180,7 +191,7 @@ struct GfxBuffer
     VkDescriptorBufferInfo getDescriptorInfo() const;
 
     /**
-     * @brief Create buffer to be used by host to write to
+     * @brief Create persistently mapped buffer to be used by host to write to
      * @param usage type of the buffer
      * @param size of a single instance
      * @param total instances to allocate
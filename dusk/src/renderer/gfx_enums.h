@@ -6,7 +6,18 @@ enum class VertexAttributeFormat
 {
     X32Y32_FLOAT,
     X32Y32Z32_FLOAT,
-    X32Y32Z32W32_FLOAT
+    X32Y32Z32W32_FLOAT,
+    X16Y16_FLOAT,
+    X16Y16_SNORM,
+    X16Y16Z16W16_UNORM
+};
+
+// layout of a mesh in the global geometry buffers
+enum class VertexFormat : uint32_t
+{
+    Full,   // Vertex with uint32 indices
+    Packed, // PackedVertex with uint16 indices
+    Count
 };
 
 enum class GfxLoadOperation : uint8_t
@@ -19,18 +19,43 @@ struct GfxBoundingBoxData
 
 struct GfxMeshData
 {
-    uint32_t indexCount   = 0u;
-    uint32_t firstIndex   = 0u;
-    int32_t  vertexOffset = 0u;
+    uint32_t     indexCount   = 0u;
+    uint32_t     firstIndex   = 0u;
+    int32_t      vertexOffset = 0u;
+    VertexFormat vertexFormat = VertexFormat::Full; // selects vertex and index buffers of the mesh
+
+    // packed positions are dequantized as quantOffset + position * quantScale
+    glm::vec4    quantOffset  = glm::vec4(0.f);
+    glm::vec4    quantScale   = glm::vec4(1.f);
+};
+
+/**
+ * @brief Range of the global vertex and index buffers owned by a set of meshes
+ */
+struct GfxGeometryAllocation
+{
+    VertexFormat format       = VertexFormat::Full;
+    int32_t      vertexOffset = 0;
+    uint32_t     vertexCount  = 0u;
+    uint32_t     firstIndex   = 0u;
+    uint32_t     indexCount   = 0u;
 };
 
+// renderables arrays read by shaders, from model matrices to previous model matrices
+static constexpr uint32_t RENDERABLE_BUFFERS_COUNT = 6u;
+
 struct GfxRenderables
 {
-    DynamicArray<glm::mat4>          modelMatrices  = {};
-    DynamicArray<glm::mat4>          normalMatrices = {};
-    DynamicArray<GfxBoundingBoxData> boundingBoxes  = {};
-    DynamicArray<uint32_t>           meshIds        = {};
-    DynamicArray<uint32_t>           materialIds    = {};
+    DynamicArray<glm::mat4>                   modelMatrices     = {};
+    DynamicArray<glm::mat4>                   normalMatrices    = {};
+    DynamicArray<GfxBoundingBoxData>          boundingBoxes     = {};
+    DynamicArray<uint32_t>                    meshIds           = {};
+    DynamicArray<uint32_t>                    materialIds       = {};
+    DynamicArray<glm::mat4>                   prevModelMatrices = {}; // model matrices of the previous frame
+    DynamicArray<uint8_t>                     staticFlags       = {}; // only read on the host by shadow passes
+
+    // upload arena offsets of the arrays, bound as dynamic offsets of the renderables set
+    Array<uint32_t, RENDERABLE_BUFFERS_COUNT> bufferOffsets     = {};
 };
 
 // TODO:: make it std430 aligned
@@ -63,6 +88,7 @@ struct GfxIndexedIndirectDrawCommand
 
 struct GfxIndexedIndirectDrawCount
 {
-    uint32_t count = 0u;
+    uint32_t count       = 0u;
+    uint32_t packedCount = 0u; // draws of meshes with packed vertices
 };
 } // namespace dusk
\ No newline at end of file
@@ -20,7 +20,7 @@ struct alignas(16) Material
     float     normalScale            = 1.0f; // Scale normal map effect
     float     metal                  = 1.0f; // Uniform fallback
     float     rough                  = 1.0f; // Uniform fallback
-    float     padding0               = 0.0f; // Padding to align vec4
+    float     alphaCutoff            = 0.0f; // Alpha tested when non zero
 
     glm::vec4 albedoColor            = glm::vec4 { 1.f };
     glm::vec4 emissiveColor          = glm::vec4 { 1.f };
@@ -0,0 +1,274 @@
+#include "mip_generator.h"
+
+#include "texture.h"
+
+#include "debug/profiler.h"
+#include "platform/file_system.h"
+
+#include "backend/vulkan/vk.h"
+#include "backend/vulkan/vk_device.h"
+#include "backend/vulkan/vk_pipeline.h"
+#include "backend/vulkan/vk_pipeline_layout.h"
+#include "backend/vulkan/vk_descriptors.h"
+
+#include <filesystem>
+
+namespace dusk
+{
+
+bool MipGenerator::init()
+{
+    auto& ctx        = VkGfxDevice::getSharedVulkanContext();
+
+    m_descriptorPool = VkGfxDescriptorPool::Builder(ctx)
+                           .addPoolSize(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, MIP_GEN_MAX_TEXTURES)
+                           .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, MAX_MIP_GEN_LEVELS * MIP_GEN_MAX_TEXTURES)
+                           .setDebugName("mip_gen_desc_pool")
+                           .build(MIP_GEN_MAX_TEXTURES, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+    CHECK_AND_RETURN_FALSE(!m_descriptorPool);
+
+    m_descriptorSetLayout = VkGfxDescriptorSetLayout::Builder(ctx)
+                                .addBinding(0, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, 1)
+                                .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT, MAX_MIP_GEN_LEVELS, true)
+                                .setDebugName("mip_gen_desc_set_layout")
+                                .build();
+    CHECK_AND_RETURN_FALSE(!m_descriptorSetLayout);
+
+    for (auto& descriptorSet : m_descriptorSets)
+    {
+        descriptorSet = m_descriptorPool->allocateDescriptorSet(*m_descriptorSetLayout, "mip_gen_desc_set");
+        CHECK_AND_RETURN_FALSE(!descriptorSet);
+    }
+
+    m_pipelineLayout = VkGfxPipelineLayout::Builder(ctx)
+                           .addPushConstantRange(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MipGenPushConstant))
+                           .addDescriptorSetLayout(*m_descriptorSetLayout)
+                           .build();
+    CHECK_AND_RETURN_FALSE(!m_pipelineLayout);
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+        (uint64_t)m_pipelineLayout->get(),
+        "gen_mips_pipeline_layout");
+#endif // VK_RENDERER_DEBUG
+
+    std::filesystem::path buildPath  = STRING(DUSK_BUILD_PATH);
+    std::filesystem::path shaderPath = buildPath / "shaders/";
+
+    auto genMipsShader = FileSystem::readFileBinary(shaderPath / "gen_mips.comp.spv");
+
+    m_pipeline         = VkGfxComputePipeline::Builder(ctx)
+                     .setComputeShaderCode(genMipsShader)
+                     .setPipelineLayout(*m_pipelineLayout)
+                     .setDebugName("gen_mips_pipeline")
+                     .build();
+    CHECK_AND_RETURN_FALSE(!m_pipeline);
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        ctx.device,
+        VK_OBJECT_TYPE_PIPELINE,
+        (uint64_t)m_pipeline->get(),
+        "gen_mips_pipeline");
+#endif // VK_RENDERER_DEBUG
+
+    return true;
+}
+
+void MipGenerator::cleanup()
+{
+    releaseTransientResources();
+
+    m_pipeline            = nullptr;
+    m_pipelineLayout      = nullptr;
+
+    m_descriptorSets      = {};
+    m_descriptorSetLayout = nullptr;
+    m_descriptorPool      = nullptr;
+}
+
+bool MipGenerator::isFormatSupported(VkFormat format) const
+{
+    if (!m_pipeline || !m_pipeline->isValid()) return false;
+
+    auto& ctx = VkGfxDevice::getSharedVulkanContext();
+    if (!ctx.physicalDeviceFeatures.shaderStorageImageWriteWithoutFormat) return false;
+
+    // srgb textures are written through a unorm alias with manual encoding
+    VkFormatProperties storageProps;
+    vkGetPhysicalDeviceFormatProperties(ctx.physicalDevice, vulkan::getLinearVkFormat(format), &storageProps);
+
+    VkFormatProperties sampledProps;
+    vkGetPhysicalDeviceFormatProperties(ctx.physicalDevice, format, &sampledProps);
+
+    return (storageProps.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT)
+        && (sampledProps.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT);
+}
+
+Error MipGenerator::recordMipGenerationCmds(
+    VkCommandBuffer cmdBuff,
+    GfxTexture&     texture,
+    float           alphaCutoff)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    DASSERT(m_recordedTextures < MIP_GEN_MAX_TEXTURES, "descriptor sets of pending mip generations are exhausted");
+    DASSERT(texture.numMipLevels <= MAX_MIP_GEN_LEVELS);
+
+    if (texture.numMipLevels <= 1) return Error::Ok;
+
+    VkGfxDescriptorSet& descriptorSet = *m_descriptorSets[m_recordedTextures++];
+
+    VkFormat storageFormat = vulkan::getLinearVkFormat(texture.format);
+
+    // source view samples any mip with the texture format, so
+    // srgb decoding happens in hardware
+    VkImageView  srcView = VK_NULL_HANDLE;
+    VulkanResult result  = m_gfxDevice.createImageView(
+        &texture.image,
+        VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+        texture.format,
+        VK_IMAGE_ASPECT_COLOR_BIT,
+        0,
+        texture.numMipLevels,
+        0,
+        texture.numLayers,
+        &srcView,
+        VK_IMAGE_USAGE_SAMPLED_BIT);
+
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to create mip gen source view for texture {}", texture.name);
+        return Error::InitializationFailed;
+    }
+    m_transientViews.push_back(srcView);
+
+    VkDescriptorImageInfo srcInfo {};
+    srcInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    srcInfo.imageView   = srcView;
+
+    descriptorSet.configureImage(0, 0, 1, &srcInfo);
+
+    DynamicArray<VkDescriptorImageInfo> dstInfos(texture.numMipLevels);
+    for (uint32_t level = 0u; level < texture.numMipLevels; ++level)
+    {
+        VkImageView dstView = VK_NULL_HANDLE;
+        result              = m_gfxDevice.createImageView(
+            &texture.image,
+            VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+            storageFormat,
+            VK_IMAGE_ASPECT_COLOR_BIT,
+            level,
+            1,
+            0,
+            texture.numLayers,
+            &dstView,
+            VK_IMAGE_USAGE_STORAGE_BIT);
+
+        if (result.hasError())
+        {
+            DUSK_ERROR("Unable to create mip gen storage view for texture {}", texture.name);
+            return Error::InitializationFailed;
+        }
+        m_transientViews.push_back(dstView);
+
+        dstInfos[level].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        dstInfos[level].imageView   = dstView;
+    }
+
+    descriptorSet.configureImage(1, 0, texture.numMipLevels, dstInfos.data());
+    descriptorSet.applyConfiguration();
+
+    m_pipeline->bind(cmdBuff);
+
+    vkCmdBindDescriptorSets(
+        cmdBuff,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_pipelineLayout->get(),
+        0,
+        1,
+        &descriptorSet.set,
+        0,
+        nullptr);
+
+    MipGenPushConstant push = {};
+    push.isSRGB             = vulkan::isSRGBFormat(texture.format) ? 1u : 0u;
+    push.alphaCutoff        = alphaCutoff;
+
+    for (uint32_t baseMip = 0u; baseMip < texture.numMipLevels - 1; baseMip += push.numMips)
+    {
+        push.baseMip   = baseMip;
+        push.numMips   = 1u;
+        push.srcWidth  = std::max(1u, texture.width >> baseMip);
+        push.srcHeight = std::max(1u, texture.height >> baseMip);
+
+        // later mips of a dispatch are reduced 2x2 from the previous one, which
+        // only holds while that one has even sizes
+        uint32_t maxMips = std::min(MIP_GEN_MIPS_PER_PASS, texture.numMipLevels - 1 - baseMip);
+        while (push.numMips < maxMips)
+        {
+            uint32_t mipWidth  = std::max(1u, push.srcWidth >> push.numMips);
+            uint32_t mipHeight = std::max(1u, push.srcHeight >> push.numMips);
+            if ((mipWidth & 1u) || (mipHeight & 1u)) break;
+
+            ++push.numMips;
+        }
+
+        vkCmdPushConstants(
+            cmdBuff,
+            m_pipelineLayout->get(),
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            0,
+            sizeof(MipGenPushConstant),
+            &push);
+
+        // every workgroup writes a 32x32 tile of the first generated mip
+        uint32_t dstWidth  = std::max(1u, push.srcWidth >> 1);
+        uint32_t dstHeight = std::max(1u, push.srcHeight >> 1);
+
+        vkCmdDispatch(
+            cmdBuff,
+            (dstWidth + 31) / 32,
+            (dstHeight + 31) / 32,
+            texture.numLayers);
+
+        // generated mips become source of the next dispatch
+        VkImageMemoryBarrier2 barrier           = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+        barrier.srcStageMask                    = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.srcAccessMask                   = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        barrier.dstStageMask                    = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.dstAccessMask                   = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+        barrier.oldLayout                       = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.newLayout                       = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image                           = texture.image.vkImage;
+        barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel   = baseMip + 1;
+        barrier.subresourceRange.levelCount     = push.numMips;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount     = texture.numLayers;
+
+        VkDependencyInfo dependencyInfo         = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependencyInfo.imageMemoryBarrierCount  = 1;
+        dependencyInfo.pImageMemoryBarriers     = &barrier;
+
+        vkCmdPipelineBarrier2(cmdBuff, &dependencyInfo);
+    }
+
+    return Error::Ok;
+}
+
+void MipGenerator::releaseTransientResources()
+{
+    for (auto& view : m_transientViews)
+    {
+        m_gfxDevice.freeImageView(&view);
+    }
+    m_transientViews.clear();
+    m_recordedTextures = 0u;
+}
+
+} // namespace dusk
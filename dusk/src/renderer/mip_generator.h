@@ -0,0 +1,104 @@
+#pragma once
+
+#include "dusk.h"
+#include "backend/vulkan/vk_types.h"
+
+namespace dusk
+{
+class VkGfxDevice;
+class VkGfxComputePipeline;
+class VkGfxPipelineLayout;
+
+struct VkGfxDescriptorPool;
+struct VkGfxDescriptorSetLayout;
+struct VkGfxDescriptorSet;
+struct GfxTexture;
+
+// max mips which can be generated for a texture (32k x 32k)
+constexpr uint32_t MAX_MIP_GEN_LEVELS    = 16u;
+
+// number of mips produced by a single dispatch of the downsampler
+constexpr uint32_t MIP_GEN_MIPS_PER_PASS = 6u;
+
+// textures which can be recorded before transient resources are released
+constexpr uint32_t MIP_GEN_MAX_TEXTURES  = 16u;
+
+struct MipGenPushConstant
+{
+    uint32_t baseMip;
+    uint32_t numMips;
+    uint32_t srcWidth;
+    uint32_t srcHeight;
+    uint32_t isSRGB;
+    float    alphaCutoff;
+};
+
+/**
+ * @brief Compute based mip chain generator. It works for 2D, array and cube
+ * textures and produces upto 6 mips per dispatch, which requires a single
+ * barrier every 6 levels compared to 2 barriers per level of blit chains.
+ * Odd sized levels are filtered with a 3 texel footprint, so a dispatch stops
+ * at them and the next one starts from that level.
+ */
+class MipGenerator
+{
+public:
+    MipGenerator(VkGfxDevice& device) :
+        m_gfxDevice(device) { };
+    ~MipGenerator() = default;
+
+    /**
+     * @brief Create pipeline and descriptors required for mip generation
+     * @return true if successful
+     */
+    bool init();
+
+    /**
+     * @brief Release all the resources
+     */
+    void cleanup();
+
+    /**
+     * @brief Check whether compute mip generation is possible for the format.
+     * Blit based generation should be used in case it is not supported.
+     * @param format of the texture
+     * @return true if supported
+     */
+    bool isFormatSupported(VkFormat format) const;
+
+    /**
+     * @brief Record mip generation cmds for the texture. All mips of the texture
+     * are expected in VK_IMAGE_LAYOUT_GENERAL layout and remain in that layout.
+     * Every texture uses its own descriptor set, so upto MIP_GEN_MAX_TEXTURES
+     * textures can be recorded before releasing transient resources.
+     * @param cmdBuff recording command buffer of a compute capable queue
+     * @param texture for which mips will be generated from mip 0
+     * @param alphaCutoff for preserving alpha tested coverage, 0 to disable
+     * @return Error status of the recording
+     */
+    Error recordMipGenerationCmds(
+        VkCommandBuffer cmdBuff,
+        GfxTexture&     texture,
+        float           alphaCutoff = 0.0f);
+
+    /**
+     * @brief Free transient image views created for the recordings and make
+     * descriptor sets available again. Should be called once the recorded cmds
+     * have finished execution.
+     */
+    void releaseTransientResources();
+
+private:
+    VkGfxDevice&                     m_gfxDevice;
+
+    Unique<VkGfxDescriptorPool>                             m_descriptorPool      = nullptr;
+    Unique<VkGfxDescriptorSetLayout>                        m_descriptorSetLayout = nullptr;
+    Array<Unique<VkGfxDescriptorSet>, MIP_GEN_MAX_TEXTURES> m_descriptorSets      = {};
+
+    Unique<VkGfxPipelineLayout>                             m_pipelineLayout      = nullptr;
+    Unique<VkGfxComputePipeline>                            m_pipeline            = nullptr;
+
+    DynamicArray<VkImageView>                               m_transientViews      = {};
+    uint32_t                                                m_recordedTextures    = 0u;
+};
+} // namespace dusk
@@ -0,0 +1,92 @@
+#include "render_passes.h"
+
+#include "dusk.h"
+#include "vk.h"
+#include "frame_data.h"
+#include "engine.h"
+#include "debug/profiler.h"
+
+namespace dusk
+{
+void dispatchAutoExposureCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!frameData.scene) return;
+
+    auto&            resources = Engine::get().getRenderGraphResources();
+    VkPipelineLayout layout    = resources.autoExposurePipelineLayout->get();
+
+    // textures and storage textures
+    const VkDescriptorSet descriptorSets[] = {
+        frameData.textureDescriptorSet,
+        frameData.storageTextureDescriptorSet
+    };
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        layout,
+        0,
+        static_cast<uint32_t>(std::size(descriptorSets)),
+        descriptorSets,
+        0,
+        nullptr);
+
+    // exposure adapts exponentially over time, first frame takes the target directly
+    float                    frameTime = frameData.frameTime.count();
+    AutoExposurePushConstant push {};
+    push.inputTextureIdx     = resources.lightingRenderTextureId;
+    push.histogramTextureIdx = resources.exposureHistogramTextureId;
+    push.exposureTextureIdx  = resources.exposureTextureId;
+    push.pixelCount          = resources.renderExtent.width * resources.renderExtent.height;
+    push.renderWidth         = resources.renderExtent.width;
+    push.renderHeight        = resources.renderExtent.height;
+    push.adaptationRate      = resources.autoExposureReset ? 1.f : 1.f - glm::exp(-frameTime * EXPOSURE_ADAPTATION_SPEED);
+
+    auto pushConstants = [&]()
+    {
+        vkCmdPushConstants(
+            cmdBuffer,
+            layout,
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            0,
+            sizeof(AutoExposurePushConstant),
+            &push);
+    };
+
+    // previous frame cleared the bins in its exposure dispatch
+    vulkan::insertDispatchBarrier(cmdBuffer);
+
+    // contents of a new histogram are undefined
+    if (resources.autoExposureReset)
+    {
+        push.clearHistogram = 1u;
+
+        resources.exposurePipeline->bind(cmdBuffer);
+        pushConstants();
+        vkCmdDispatch(cmdBuffer, 1, 1, 1);
+
+        vulkan::insertDispatchBarrier(cmdBuffer);
+
+        push.clearHistogram = 0u;
+    }
+
+    resources.luminanceHistogramPipeline->bind(cmdBuffer);
+    pushConstants();
+    vkCmdDispatch(
+        cmdBuffer,
+        (resources.renderExtent.width + EXPOSURE_HISTOGRAM_GROUP_SIZE - 1) / EXPOSURE_HISTOGRAM_GROUP_SIZE,
+        (resources.renderExtent.height + EXPOSURE_HISTOGRAM_GROUP_SIZE - 1) / EXPOSURE_HISTOGRAM_GROUP_SIZE,
+        1);
+
+    vulkan::insertDispatchBarrier(cmdBuffer);
+
+    // single group reduces the histogram and writes the adapted exposure
+    resources.exposurePipeline->bind(cmdBuffer);
+    pushConstants();
+    vkCmdDispatch(cmdBuffer, 1, 1, 1);
+
+    resources.autoExposureReset = false;
+}
+} // namespace dusk
\ No newline at end of file
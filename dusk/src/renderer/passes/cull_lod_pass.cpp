@@ -84,8 +84,8 @@ void dispatchIndirectDrawCompute(VkCommandBuffer cmdBuffer, const FrameData& fra
             2, // binding location
             1,
             &frameData.renderablesDescriptorSet,
-            0,
-            nullptr);
+            RENDERABLE_BUFFERS_COUNT,
+            frameData.renderables->bufferOffsets.data());
 
         // bind indirect draw descriptor set
         vkCmdBindDescriptorSets(
@@ -103,8 +103,9 @@ void dispatchIndirectDrawCompute(VkCommandBuffer cmdBuffer, const FrameData& fra
         DUSK_PROFILE_SECTION("dispatch");
         // push constants
         CullLodPushConstant push {};
-        push.globalUboIdx = frameData.frameIndex;
-        push.objectCount  = frameData.renderables->meshIds.size();
+        push.globalUboIdx      = frameData.frameIndex;
+        push.objectCount       = frameData.renderables->meshIds.size();
+        push.packedDrawsOffset = GBUFFER_PACKED_DRAWS_REGION * MAX_RENDERABLES_COUNT;
 
         vkCmdPushConstants(
             cmdBuffer,
@@ -22,8 +22,16 @@ void recordGBufferCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
 
     const Scene&    scene         = *frameData.scene;
     auto&           resources     = Engine::get().getRenderGraphResources();
+    bool            compactLayout = Engine::get().isCompactGBufferEnabled();
 
-    resources.gbuffPipeline->bind(cmdBuffer);
+    if (compactLayout)
+    {
+        resources.gbuffCompactPipeline->bind(cmdBuffer);
+    }
+    else
+    {
+        resources.gbuffPipeline->bind(cmdBuffer);
+    }
 
     {
         vkCmdBindDescriptorSets(
@@ -53,8 +61,8 @@ void recordGBufferCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
             2, // mesh instance data desc set binding location
             1,
             &frameData.renderablesDescriptorSet,
-            0,
-            nullptr);
+            RENDERABLE_BUFFERS_COUNT,
+            frameData.renderables->bufferOffsets.data());
 
         vkCmdBindDescriptorSets(
             cmdBuffer,
@@ -78,7 +86,8 @@ void recordGBufferCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
     }
 
     GbufferPushConstant push {};
-    push.globalUboIdx = frameData.frameIndex;
+    push.globalUboIdx  = frameData.frameIndex;
+    push.compactLayout = compactLayout ? 1u : 0u;
 
     vkCmdPushConstants(
         cmdBuffer,
@@ -96,9 +105,40 @@ void recordGBufferCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
         vkCmdDrawIndexedIndirectCount(
             cmdBuffer,
             currentIndirectBuffer.vkBuffer.buffer,
-            0,
+            GBUFFER_DRAWS_REGION * MAX_RENDERABLES_COUNT * sizeof(GfxIndexedIndirectDrawCommand),
             currentIndirectDrawCountBuffer.vkBuffer.buffer,
-            0,
+            offsetof(GfxIndexedIndirectDrawCount, count),
+            MAX_RENDERABLES_COUNT,
+            sizeof(GfxIndexedIndirectDrawCommand));
+    }
+
+    // meshes with packed vertices, descriptor sets and push constants stay
+    // bound as both pipelines share the layout
+    if (compactLayout)
+    {
+        resources.gbuffCompactPackedPipeline->bind(cmdBuffer);
+    }
+    else
+    {
+        resources.gbuffPackedPipeline->bind(cmdBuffer);
+    }
+
+    {
+        VkBuffer     buffers[] = { Engine::get().getVertexBuffer(VertexFormat::Packed).vkBuffer.buffer };
+        VkDeviceSize offsets[] = { 0 };
+
+        vkCmdBindVertexBuffers(cmdBuffer, 0, 1, buffers, offsets);
+
+        vkCmdBindIndexBuffer(cmdBuffer, Engine::get().getIndexBuffer(VertexFormat::Packed).vkBuffer.buffer, 0, VK_INDEX_TYPE_UINT16);
+    }
+
+    {
+        vkCmdDrawIndexedIndirectCount(
+            cmdBuffer,
+            currentIndirectBuffer.vkBuffer.buffer,
+            GBUFFER_PACKED_DRAWS_REGION * MAX_RENDERABLES_COUNT * sizeof(GfxIndexedIndirectDrawCommand),
+            currentIndirectDrawCountBuffer.vkBuffer.buffer,
+            offsetof(GfxIndexedIndirectDrawCount, packedCount),
             MAX_RENDERABLES_COUNT,
             sizeof(GfxIndexedIndirectDrawCommand));
     }
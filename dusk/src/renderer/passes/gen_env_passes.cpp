@@ -1,171 +1,151 @@
 #include "render_passes.h"
 
+#include "vk.h"
 #include "engine.h"
 #include "debug/profiler.h"
 
 #include "renderer/environment.h"
-#include "renderer/texture_db.h"
 
 namespace dusk
 {
-
-void dispatchGenEnvCubeMapPass(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+static void dispatchEnvCubeMapSlice(
+    VkCommandBuffer       cmdBuffer,
+    const IBLUpdateSlice& slice,
+    const Environment&    env)
 {
-    DUSK_PROFILE_FUNCTION;
+    env.getEnvCubeMapGenPipeline().bind(cmdBuffer);
 
-    if (!frameData.scene) return;
+    IBLPushConstant push = {};
+    push.faceOffset      = slice.faceBegin;
 
-    auto& env      = Engine::get().getEnvironment();
+    // first mip evaluates the sky model, later ones box filter the previous mip
+    // so that the sun and other small features don't alias away
+    for (uint32_t level = 0u; level < ENV_MIP_COUNT; ++level)
+    {
+        if (level > 0u) vulkan::insertDispatchBarrier(cmdBuffer);
 
-    auto& pipeline = env.getEnvCubeMapGenPipeline();
+        push.resolution = ENV_RENDER_WIDTH >> level;
+        push.mipLevel   = level;
 
-    pipeline.bind(cmdBuffer);
+        vkCmdPushConstants(
+            cmdBuffer,
+            env.getEnvMapsGenPipelineLayout().get(),
+            VK_SHADER_STAGE_COMPUTE_BIT,
+            0,
+            sizeof(IBLPushConstant),
+            &push);
 
-    vkCmdBindDescriptorSets(
-        cmdBuffer,
-        VK_PIPELINE_BIND_POINT_COMPUTE,
-        env.getEnvCubeMapGenPipelineLayout().get(),
-        0,
-        1,
-        &env.getHWSkyDescriptorSet().set,
-        0,
-        nullptr);
+        vkCmdDispatch(
+            cmdBuffer,
+            (push.resolution + 7) / 8,
+            (push.resolution + 7) / 8,
+            slice.faceCount);
+    }
+}
 
-    uint32_t        cubeSize = std::max(ENV_RENDER_WIDTH, ENV_RENDER_HEIGHT);
+static void dispatchIrradianceSlice(
+    VkCommandBuffer       cmdBuffer,
+    const IBLUpdateSlice& slice,
+    const Environment&    env)
+{
+    IBLPushConstant push = {};
+    push.resolution      = ENV_RENDER_WIDTH >> ENV_SH_SOURCE_MIP;
+    push.mipLevel        = ENV_SH_SOURCE_MIP;
 
-    IBLPushConstant push     = {};
-    push.frameIndex          = frameData.frameIndex;
-    push.resolution          = cubeSize;
+    // single group projects the sky on the SH coefficients
+    env.getEnvSHGenPipeline().bind(cmdBuffer);
 
     vkCmdPushConstants(
         cmdBuffer,
-        env.getEnvCubeMapGenPipelineLayout().get(),
+        env.getEnvMapsGenPipelineLayout().get(),
         VK_SHADER_STAGE_COMPUTE_BIT,
         0,
         sizeof(IBLPushConstant),
         &push);
 
-    // dispatch compute shader with 6 workgroups, one for each cube map face
-    vkCmdDispatch(
-        cmdBuffer,
-        cubeSize / 8,
-        cubeSize / 8,
-        6);
-}
+    vkCmdDispatch(cmdBuffer, 1, 1, 1);
 
-void dispatchGenEnvIrradiancePass(VkCommandBuffer cmdBuffer, const FrameData& frameData)
-{
-    DUSK_PROFILE_FUNCTION;
+    vulkan::insertDispatchBarrier(cmdBuffer);
 
-    if (!frameData.scene) return;
+    // irradiance map is evaluated from the coefficients
+    push.resolution = IRRADIANCE_RENDER_WIDTH;
+    push.mipLevel   = 0u;
+    push.faceOffset = slice.faceBegin;
 
-    auto& env      = Engine::get().getEnvironment();
+    env.getEnvIrradianceGenPipeline().bind(cmdBuffer);
 
-    auto& pipeline = env.getEnvIrradianceGenPipeline();
-
-    pipeline.bind(cmdBuffer);
-
-    vkCmdBindDescriptorSets(
+    vkCmdPushConstants(
         cmdBuffer,
-        VK_PIPELINE_BIND_POINT_COMPUTE,
-        env.getEnvIrradianceGenPipelineLayout().get(),
-        0,
-        1,
-        &frameData.textureDescriptorSet,
+        env.getEnvMapsGenPipelineLayout().get(),
+        VK_SHADER_STAGE_COMPUTE_BIT,
         0,
-        nullptr);
+        sizeof(IBLPushConstant),
+        &push);
 
-    vkCmdBindDescriptorSets(
+    vkCmdDispatch(
         cmdBuffer,
-        VK_PIPELINE_BIND_POINT_COMPUTE,
-        env.getEnvIrradianceGenPipelineLayout().get(),
-        1,
-        1,
-        &env.getHWSkyDescriptorSet().set,
-        0,
-        nullptr);
+        (push.resolution + 7) / 8,
+        (push.resolution + 7) / 8,
+        slice.faceCount);
+}
 
-    uint32_t        cubeSize = std::max(IRRADIANCE_RENDER_WIDTH, IRRADIANCE_RENDER_HEIGHT);
+static void dispatchPrefilteredSlice(
+    VkCommandBuffer       cmdBuffer,
+    const IBLUpdateSlice& slice,
+    const Environment&    env)
+{
+    env.getEnvPrefilteredGenPipeline().bind(cmdBuffer);
 
-    IBLPushConstant push     = {};
-    push.frameIndex          = frameData.frameIndex;
-    push.envCubeMapTexId     = env.getSkyTextureId();
-    push.resolution          = cubeSize;
+    // mirror reflections of the first level are a single sample
+    IBLPushConstant push = {};
+    push.resolution      = PREFILTERED_RENDER_WIDTH >> slice.mipLevel;
+    push.mipLevel        = slice.mipLevel;
+    push.faceOffset      = slice.faceBegin;
+    push.sampleCount     = slice.mipLevel == 0u ? 1u : PREFILTERED_SAMPLE_COUNT;
+    push.roughness       = static_cast<float>(slice.mipLevel) / static_cast<float>(PREFILTERED_MIP_COUNT - 1);
 
     vkCmdPushConstants(
         cmdBuffer,
-        env.getEnvIrradianceGenPipelineLayout().get(),
+        env.getEnvMapsGenPipelineLayout().get(),
         VK_SHADER_STAGE_COMPUTE_BIT,
         0,
         sizeof(IBLPushConstant),
         &push);
 
-    // dispatch compute shader with 6 workgroups, one for each cube map face
     vkCmdDispatch(
         cmdBuffer,
-        cubeSize / 8,
-        cubeSize / 8,
-        6);
+        (push.resolution + 7) / 8,
+        (push.resolution + 7) / 8,
+        slice.faceCount);
 }
 
-void dispatchGenEnvPrefilteredPass(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+void dispatchEnvMapsUpdateCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData)
 {
     DUSK_PROFILE_FUNCTION;
 
-    if (!frameData.scene) return;
-
-    auto& env      = Engine::get().getEnvironment();
+    auto& env = Engine::get().getEnvironment();
 
-    auto& pipeline = env.getEnvPrefilteredGenPipeline();
-
-    pipeline.bind(cmdBuffer);
     vkCmdBindDescriptorSets(
         cmdBuffer,
         VK_PIPELINE_BIND_POINT_COMPUTE,
-        env.getEnvPrefilteredGenPipelineLayout().get(),
-        0,
-        1,
-        &frameData.textureDescriptorSet,
+        env.getEnvMapsGenPipelineLayout().get(),
         0,
-        nullptr);
-
-    vkCmdBindDescriptorSets(
-        cmdBuffer,
-        VK_PIPELINE_BIND_POINT_COMPUTE,
-        env.getEnvPrefilteredGenPipelineLayout().get(),
-        1,
         1,
-        &env.getHWSkyDescriptorSet().set,
+        &env.getHWSkyDescriptorSet(env.getUpdateSlot()).set,
         0,
         nullptr);
 
-    uint32_t        cubeSize     = std::max(PREFILTERED_RENDER_WIDTH, PREFILTERED_RENDER_HEIGHT);
-    uint32_t        numMipLevels = TextureDB::cache()->getTexture(env.getSkyPrefilteredTextureId())->numMipLevels;
-
-    IBLPushConstant push         = {};
-    push.frameIndex              = frameData.frameIndex;
-    push.envCubeMapTexId         = env.getSkyTextureId();
-    push.sampleCount             = 1024u;
-    push.resolution              = cubeSize;
-
-    for (uint32_t level = 0u; level < numMipLevels; ++level)
+    for (const IBLUpdateSlice& slice : env.getFrameUpdateSlices())
     {
-        push.roughness = static_cast<float>(level) / static_cast<float>(numMipLevels - 1);
-
-        vkCmdPushConstants(
-            cmdBuffer,
-            env.getEnvPrefilteredGenPipelineLayout().get(),
-            VK_SHADER_STAGE_COMPUTE_BIT,
-            0,
-            sizeof(IBLPushConstant),
-            &push);
-
-        // dispatch compute shader with 6 workgroups, one for each cube map face
-        vkCmdDispatch(
-            cmdBuffer,
-            (cubeSize >> level) / 8,
-            (cubeSize >> level) / 8,
-            6);
+        // filtering reads sky faces written by earlier slices
+        vulkan::insertDispatchBarrier(cmdBuffer);
+
+        switch (slice.stage)
+        {
+            case IBLUpdateStage::EnvCubeMap:  dispatchEnvCubeMapSlice(cmdBuffer, slice, env); break;
+            case IBLUpdateStage::Irradiance:  dispatchIrradianceSlice(cmdBuffer, slice, env); break;
+            case IBLUpdateStage::Prefiltered: dispatchPrefilteredSlice(cmdBuffer, slice, env); break;
+        }
     }
 }
 
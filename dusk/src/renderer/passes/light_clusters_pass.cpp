@@ -0,0 +1,79 @@
+#include "render_passes.h"
+
+#include "dusk.h"
+#include "vk.h"
+#include "frame_data.h"
+#include "engine.h"
+#include "debug/profiler.h"
+
+#include "scene/scene.h"
+#include "scene/components/camera.h"
+
+#include "backend/vulkan/vk_descriptors.h"
+#include "backend/vulkan/vk_pipeline.h"
+#include "backend/vulkan/vk_pipeline_layout.h"
+
+namespace dusk
+{
+void dispatchLightClustersCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!frameData.scene) return;
+
+    auto&            resources = Engine::get().getRenderGraphResources();
+    CameraComponent& camera    = frameData.scene->getMainCamera();
+
+    resources.lightClustersPipeline->bind(cmdBuffer);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        resources.lightClustersPipelineLayout->get(),
+        0,
+        1,
+        &frameData.globalDescriptorSet,
+        0,
+        nullptr);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        resources.lightClustersPipelineLayout->get(),
+        1,
+        1,
+        &frameData.lightsDescriptorSet,
+        0,
+        nullptr);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        resources.lightClustersPipelineLayout->get(),
+        2,
+        1,
+        &resources.lightClustersDescriptorSets[frameData.frameIndex]->set,
+        0,
+        nullptr);
+
+    LightClustersPushConstant push {};
+    push.globalUboIdx = frameData.frameIndex;
+    push.zNear        = camera.nearPlane;
+    push.zFar         = camera.farPlane;
+
+    vkCmdPushConstants(
+        cmdBuffer,
+        resources.lightClustersPipelineLayout->get(),
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        sizeof(LightClustersPushConstant),
+        &push);
+
+    // one invocation per cluster
+    vkCmdDispatch(
+        cmdBuffer,
+        (CLUSTER_COUNT + CLUSTER_GROUP_SIZE - 1) / CLUSTER_GROUP_SIZE,
+        1,
+        1);
+}
+} // namespace dusk
\ No newline at end of file
@@ -8,8 +8,52 @@
 #include "renderer/environment.h"
 #include "renderer/texture_db.h"
 
+#include "scene/scene.h"
+#include "scene/components/camera.h"
+
 namespace dusk
 {
+static LightingPushConstant getLightingPushConstant(const FrameData& frameData)
+{
+    auto&                resources = Engine::get().getRenderGraphResources();
+    auto&                env       = Engine::get().getEnvironment();
+
+    LightingPushConstant push {};
+    push.globalUboIdx = frameData.frameIndex;
+
+    // TODO: Need a better way to handle attachment indices, too much indirection
+    push.albedoTextureIdx       = resources.gbuffRenderTextureIds[0];
+    push.normalTextureIdx       = resources.gbuffRenderTextureIds[1];
+    push.aoRoughMetalTextureIdx = resources.gbuffRenderTextureIds[2];
+    push.emissiveTextureIdx     = resources.gbuffRenderTextureIds[3];
+    push.depthTextureIdx        = resources.gbuffDepthTextureId;
+    push.renderWidth            = resources.renderExtent.width;
+    push.renderHeight           = resources.renderExtent.height;
+
+    // emissive is packed in the material target of the compact layout
+    if (Engine::get().isCompactGBufferEnabled())
+    {
+        push.normalTextureIdx   = resources.gbuffCompactNormalTextureId;
+        push.emissiveTextureIdx = -1;
+        push.compactGBuffer     = 1u;
+    }
+
+    push.brdfLUTIdx             = resources.brdfLUTextureId;
+    push.dirShadowMapTextureIdx = resources.dirShadowMapsTextureId;
+    push.localShadowAtlasIdx    = resources.localShadowAtlasTextureId;
+
+    push.irradianceTextureIdx   = env.getSkyIrradianceTextureId();
+    push.prefilteredTextureIdx  = env.getSkyPrefilteredTextureId();
+    push.maxPrefilteredLODs     = TextureDB::cache()->getTexture(push.prefilteredTextureIdx)->numMipLevels;
+
+    // depth slices of the light clusters, far plane bounds the tile depth range
+    CameraComponent& camera = frameData.scene->getMainCamera();
+    push.zNear              = camera.nearPlane;
+    push.zFar               = camera.farPlane;
+
+    return push;
+}
+
 void recordLightingCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
 {
     DUSK_PROFILE_FUNCTION;
@@ -17,7 +61,6 @@ void recordLightingCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
     if (!frameData.scene) return;
 
     auto& resources = Engine::get().getRenderGraphResources();
-    auto& env       = Engine::get().getEnvironment();
 
     resources.lightingPipeline->bind(cmdBuffer);
 
@@ -51,21 +94,17 @@ void recordLightingCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
         0,
         nullptr);
 
-    LightingPushConstant push {};
-    push.globalUboIdx = frameData.frameIndex;
-
-    // TODO: Need a better way to handle attachment indices, too much indirection
-    push.albedoTextureIdx       = resources.gbuffRenderTextureIds[0];
-    push.normalTextureIdx       = resources.gbuffRenderTextureIds[1];
-    push.aoRoughMetalTextureIdx = resources.gbuffRenderTextureIds[2];
-    push.emissiveTextureIdx     = resources.gbuffRenderTextureIds[3];
-    push.depthTextureIdx        = resources.gbuffDepthTextureId;
-    push.brdfLUTIdx             = resources.brdfLUTextureId;
-    push.dirShadowMapTextureIdx = resources.dirShadowMapsTextureId;
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        resources.lightingPipelineLayout->get(),
+        3,
+        1,
+        &resources.lightClustersDescriptorSets[frameData.frameIndex]->set,
+        0,
+        nullptr);
 
-    push.irradianceTextureIdx   = env.getSkyIrradianceTextureId();
-    push.prefilteredTextureIdx  = env.getSkyPrefilteredTextureId();
-    push.maxPrefilteredLODs     = TextureDB::cache()->getTexture(push.prefilteredTextureIdx)->numMipLevels;
+    LightingPushConstant push = getLightingPushConstant(frameData);
 
     vkCmdPushConstants(
         cmdBuffer,
@@ -79,4 +118,73 @@ void recordLightingCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
         vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
     }
 }
+
+void dispatchTiledLightingCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!frameData.scene) return;
+
+    auto& resources = Engine::get().getRenderGraphResources();
+
+    resources.tiledLightingPipeline->bind(cmdBuffer);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        resources.tiledLightingPipelineLayout->get(),
+        0,
+        1,
+        &frameData.globalDescriptorSet,
+        0,
+        nullptr);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        resources.tiledLightingPipelineLayout->get(),
+        1,
+        1,
+        &frameData.textureDescriptorSet,
+        0,
+        nullptr);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        resources.tiledLightingPipelineLayout->get(),
+        2,
+        1,
+        &frameData.lightsDescriptorSet,
+        0,
+        nullptr);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        resources.tiledLightingPipelineLayout->get(),
+        3,
+        1,
+        &frameData.storageTextureDescriptorSet,
+        0,
+        nullptr);
+
+    LightingPushConstant push = getLightingPushConstant(frameData);
+    push.outputTextureIdx     = resources.lightingRenderTextureId;
+
+    vkCmdPushConstants(
+        cmdBuffer,
+        resources.tiledLightingPipelineLayout->get(),
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        sizeof(LightingPushConstant),
+        &push);
+
+    // one workgroup per screen tile
+    vkCmdDispatch(
+        cmdBuffer,
+        (resources.renderExtent.width + LIGHTING_TILE_SIZE - 1) / LIGHTING_TILE_SIZE,
+        (resources.renderExtent.height + LIGHTING_TILE_SIZE - 1) / LIGHTING_TILE_SIZE,
+        1);
+}
 } // namespace dusk
\ No newline at end of file
@@ -0,0 +1,288 @@
+#include "render_passes.h"
+
+#include "dusk.h"
+#include "vk.h"
+#include "frame_data.h"
+#include "engine.h"
+#include "debug/profiler.h"
+
+#include "scene/scene.h"
+#include "renderer/geometry/frustum.h"
+
+namespace dusk
+{
+/**
+ * @brief Range of indirect draws recorded for a shadow view
+ */
+struct LocalShadowViewDraws
+{
+    uint32_t firstFullDraw    = 0u;
+    uint32_t fullDrawsCount   = 0u;
+    uint32_t firstPackedDraw  = 0u;
+    uint32_t packedDrawsCount = 0u;
+};
+
+static void setTileViewport(VkCommandBuffer cmdBuffer, const ShadowAtlasTile& tile)
+{
+    VkViewport viewport {};
+    viewport.x        = static_cast<float>(tile.x);
+    viewport.y        = static_cast<float>(tile.y);
+    viewport.width    = static_cast<float>(tile.size);
+    viewport.height   = static_cast<float>(tile.size);
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+
+    VkRect2D scissor {};
+    scissor.offset = { static_cast<int32_t>(tile.x), static_cast<int32_t>(tile.y) };
+    scissor.extent = { tile.size, tile.size };
+    vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+}
+
+static void bindLocalShadowDescriptorSets(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    auto& resources = Engine::get().getRenderGraphResources();
+
+    // renderable list descriptor set
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        resources.localShadowPipelineLayout->get(),
+        0,
+        1,
+        &frameData.renderablesDescriptorSet,
+        RENDERABLE_BUFFERS_COUNT,
+        frameData.renderables->bufferOffsets.data());
+
+    // lights descriptor set with the shadow views
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        resources.localShadowPipelineLayout->get(),
+        1,
+        1,
+        &frameData.lightsDescriptorSet,
+        0,
+        nullptr);
+
+    // textures descriptor set for the cached static depth
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        resources.localShadowPipelineLayout->get(),
+        2,
+        1,
+        &frameData.textureDescriptorSet,
+        0,
+        nullptr);
+}
+
+/**
+ * @brief Cull static or dynamic casters against the given views and record
+ * their indirect draws, every view is drawn in its atlas tile
+ * @param cmdBuffer to record into
+ * @param frameData of the current frame
+ * @param views to render
+ * @param staticCasters if static renderables should be drawn instead of dynamic ones
+ * @param firstCommand of the region in the frame local shadow draws buffer
+ */
+static void recordCasterDraws(
+    VkCommandBuffer                                   cmdBuffer,
+    const FrameData&                                  frameData,
+    const DynamicArray<const LocalShadowRenderView*>& views,
+    bool                                              staticCasters,
+    uint32_t                                          firstCommand)
+{
+    auto&                                       resources      = Engine::get().getRenderGraphResources();
+    const auto&                                 shadowViews    = LightsSystem::get().getLocalShadowViews();
+    const auto&                                 meshesData     = frameData.scene->m_sceneMeshes;
+    const GfxRenderables*                       renderables    = frameData.renderables;
+    auto                                        totalInstances = static_cast<uint32_t>(renderables->meshIds.size());
+    uint32_t                                    maxCommands    = MAX_LOCAL_SHADOW_DRAWS / 2;
+
+    DynamicArray<GfxIndexedIndirectDrawCommand> indirectCmds   = {};
+    DynamicArray<GfxIndexedIndirectDrawCommand> packedCmds     = {};
+    DynamicArray<LocalShadowViewDraws>          viewDraws(views.size());
+
+    {
+        DUSK_PROFILE_SECTION("local_shadow_casters_culling");
+
+        for (uint32_t viewIdx = 0u; viewIdx < views.size(); ++viewIdx)
+        {
+            Frustum               viewFrustum = extractFrustumFromMatrix(shadowViews[views[viewIdx]->viewIdx].projView);
+            LocalShadowViewDraws& draws       = viewDraws[viewIdx];
+
+            draws.firstFullDraw               = static_cast<uint32_t>(indirectCmds.size());
+            draws.firstPackedDraw             = static_cast<uint32_t>(packedCmds.size());
+
+            for (uint32_t instanceIdx = 0u; instanceIdx < totalInstances; ++instanceIdx)
+            {
+                if ((renderables->staticFlags[instanceIdx] != 0u) != staticCasters) continue;
+
+                const GfxBoundingBoxData& bounds = renderables->boundingBoxes[instanceIdx];
+                if (!isAABBInFrustum(viewFrustum, glm::vec3(bounds.center), glm::vec3(bounds.extents))) continue;
+
+                // casters beyond the capacity of the region are dropped
+                if (indirectCmds.size() + packedCmds.size() >= maxCommands) break;
+
+                const auto& meshData = meshesData[renderables->meshIds[instanceIdx]];
+                auto&       cmds     = meshData.vertexFormat == VertexFormat::Packed ? packedCmds : indirectCmds;
+                cmds.push_back(
+                    { .indexCount    = meshData.indexCount,
+                      .instanceCount = 1u,
+                      .firstIndex    = meshData.firstIndex,
+                      .vertexOffset  = meshData.vertexOffset,
+                      .firstInstance = instanceIdx });
+            }
+
+            draws.fullDrawsCount   = static_cast<uint32_t>(indirectCmds.size()) - draws.firstFullDraw;
+            draws.packedDrawsCount = static_cast<uint32_t>(packedCmds.size()) - draws.firstPackedDraw;
+        }
+    }
+
+    if (indirectCmds.empty() && packedCmds.empty()) return;
+
+    // packed vertex draws of all the views follow the full vertex draws in the region
+    GfxBuffer& drawsBuffer  = resources.frameLocalShadowDrawsBuffers[frameData.frameIndex];
+    size_t     stride       = sizeof(GfxIndexedIndirectDrawCommand);
+    size_t     fullOffset   = firstCommand * stride;
+    size_t     packedOffset = fullOffset + indirectCmds.size() * stride;
+
+    indirectCmds.insert(indirectCmds.end(), packedCmds.begin(), packedCmds.end());
+    drawsBuffer.writeAndFlush(static_cast<uint32_t>(fullOffset), indirectCmds.data(), indirectCmds.size() * stride);
+
+    DUSK_PROFILE_SECTION("local_shadow_casters_draw");
+
+    LocalShadowPushConstant push {};
+    push.staticAtlasTextureIdx = resources.localShadowStaticAtlasTextureId;
+
+    for (VertexFormat format : { VertexFormat::Full, VertexFormat::Packed })
+    {
+        bool isPacked = format == VertexFormat::Packed;
+
+        if (isPacked)
+        {
+            resources.localShadowPackedPipeline->bind(cmdBuffer);
+        }
+        else
+        {
+            resources.localShadowPipeline->bind(cmdBuffer);
+        }
+
+        VkBuffer     buffers[] = { Engine::get().getVertexBuffer(format).vkBuffer.buffer };
+        VkDeviceSize offsets[] = { 0 };
+
+        vkCmdBindVertexBuffers(cmdBuffer, 0, 1, buffers, offsets);
+        vkCmdBindIndexBuffer(cmdBuffer, Engine::get().getIndexBuffer(format).vkBuffer.buffer, 0, isPacked ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+
+        for (uint32_t viewIdx = 0u; viewIdx < views.size(); ++viewIdx)
+        {
+            const LocalShadowViewDraws& draws      = viewDraws[viewIdx];
+            uint32_t                    drawsCount = isPacked ? draws.packedDrawsCount : draws.fullDrawsCount;
+            size_t                      drawOffset = isPacked ? packedOffset + draws.firstPackedDraw * stride : fullOffset + draws.firstFullDraw * stride;
+
+            if (drawsCount == 0u) continue;
+
+            setTileViewport(cmdBuffer, views[viewIdx]->tile);
+
+            push.viewIdx = views[viewIdx]->viewIdx;
+            vkCmdPushConstants(
+                cmdBuffer,
+                resources.localShadowPipelineLayout->get(),
+                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                0,
+                sizeof(LocalShadowPushConstant),
+                &push);
+
+            vkCmdDrawIndexedIndirect(
+                cmdBuffer,
+                drawsBuffer.vkBuffer.buffer,
+                drawOffset,
+                drawsCount,
+                sizeof(GfxIndexedIndirectDrawCommand));
+        }
+    }
+}
+
+void recordLocalShadowStaticCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!frameData.scene) return;
+
+    DynamicArray<const LocalShadowRenderView*> staleViews = {};
+    DynamicArray<VkClearRect>                  clearRects = {};
+
+    for (const LocalShadowRenderView& view : LightsSystem::get().getLocalShadowRenderViews())
+    {
+        if (!view.isStaticStale) continue;
+
+        staleViews.push_back(&view);
+        clearRects.push_back(
+            { .rect           = { { static_cast<int32_t>(view.tile.x), static_cast<int32_t>(view.tile.y) }, { view.tile.size, view.tile.size } },
+              .baseArrayLayer = 0u,
+              .layerCount     = 1u });
+    }
+
+    if (staleViews.empty()) return;
+
+    // cache is preserved across frames, only the stale tiles are cleared
+    VkClearAttachment clearAttachment {};
+    clearAttachment.aspectMask              = VK_IMAGE_ASPECT_DEPTH_BIT;
+    clearAttachment.clearValue.depthStencil = { 1.f, 0u };
+
+    vkCmdClearAttachments(cmdBuffer, 1, &clearAttachment, static_cast<uint32_t>(clearRects.size()), clearRects.data());
+
+    bindLocalShadowDescriptorSets(cmdBuffer, frameData);
+
+    recordCasterDraws(cmdBuffer, frameData, staleViews, true, 0u);
+}
+
+void recordLocalShadowCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!frameData.scene) return;
+
+    const auto& renderViews = LightsSystem::get().getLocalShadowRenderViews();
+    if (renderViews.empty()) return;
+
+    auto& resources = Engine::get().getRenderGraphResources();
+
+    bindLocalShadowDescriptorSets(cmdBuffer, frameData);
+
+    DynamicArray<const LocalShadowRenderView*> views = {};
+    views.reserve(renderViews.size());
+
+    {
+        DUSK_PROFILE_SECTION("local_shadow_restore");
+
+        // dynamic casters are drawn on top of the cached static depth of every tile
+        resources.localShadowRestorePipeline->bind(cmdBuffer);
+
+        LocalShadowPushConstant push {};
+        push.staticAtlasTextureIdx = resources.localShadowStaticAtlasTextureId;
+
+        for (const LocalShadowRenderView& view : renderViews)
+        {
+            views.push_back(&view);
+
+            setTileViewport(cmdBuffer, view.tile);
+
+            push.viewIdx = view.viewIdx;
+            vkCmdPushConstants(
+                cmdBuffer,
+                resources.localShadowPipelineLayout->get(),
+                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                0,
+                sizeof(LocalShadowPushConstant),
+                &push);
+
+            vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
+        }
+    }
+
+    recordCasterDraws(cmdBuffer, frameData, views, false, MAX_LOCAL_SHADOW_DRAWS / 2);
+}
+
+} // namespace dusk
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "engine.h"
 #include "ui/editor_ui.h"
 #include "debug/profiler.h"
+#include "renderer/texture_db.h"
 
 namespace dusk
 {
@@ -19,15 +20,28 @@ void recordPresentationCmds(VkCommandBuffer cmdBuffer, const FrameData& frameDat
 
     resources.presentPipeline->bind(cmdBuffer);
 
-    vkCmdBindDescriptorSets(
-        cmdBuffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        resources.presentPipelineLayout->get(),
-        0,
-        1,
-        &frameData.textureDescriptorSet,
-        0,
-        nullptr);
+    TextureDB* textureDB = TextureDB::cache();
+    if (textureDB->isDescriptorBufferEnabled())
+    {
+        textureDB->bindTexturesDescriptorBuffer(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            resources.presentPipelineLayout->get(),
+            0,
+            frameData.frameIndex);
+    }
+    else
+    {
+        vkCmdBindDescriptorSets(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            resources.presentPipelineLayout->get(),
+            0,
+            1,
+            &frameData.textureDescriptorSet,
+            0,
+            nullptr);
+    }
 
     PresentationPushConstant push {};
     push.inputTextureIdx = resources.toneMappedRenderTextureId;
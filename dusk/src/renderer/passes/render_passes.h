@@ -7,6 +7,7 @@
 namespace dusk
 {
 struct FrameData;
+struct GfxMeshData;
 struct VkGfxRenderPassContext;
 
 //////////////////////////////////////////////////////
@@ -14,10 +15,53 @@ struct VkGfxRenderPassContext;
 struct GbufferPushConstant
 {
     uint32_t globalUboIdx;
+    uint32_t compactLayout = 0u; // packed targets described in gbuffer.glsl
 };
 
 void recordGBufferCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
 
+//////////////////////////////////////////////////////
+// Visibility Buffer Passes
+
+// triangle bits of the visibility ids, remaining bits hold the renderable index
+// plus one. Should match visibility.glsl.
+constexpr uint32_t VISIBILITY_TRIANGLE_BITS       = 18;
+constexpr uint32_t VISIBILITY_MATERIAL_GROUP_SIZE = 8;
+
+struct VisibilityPushConstant
+{
+    uint32_t globalUboIdx;
+};
+
+struct VisibilityMaterialPushConstant
+{
+    uint32_t globalUboIdx;
+    int32_t  visibilityTextureIdx   = -1;
+    int32_t  irradianceTextureIdx   = -1;
+    int32_t  prefilteredTextureIdx  = -1;
+    int32_t  maxPrefilteredLODs     = -1;
+    int32_t  brdfLUTIdx             = -1;
+    int32_t  dirShadowMapTextureIdx = -1;
+    int32_t  localShadowAtlasIdx    = -1;
+    float    zNear                  = 0.f;
+    float    zFar                   = 0.f;
+    int32_t  outputTextureIdx       = -1;
+    int32_t  velocityTextureIdx     = -1;
+    uint32_t renderWidth            = 0u; // drawn region of the output sized targets
+    uint32_t renderHeight           = 0u;
+};
+
+void recordVisibilityCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+
+void dispatchVisibilityMaterialCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+
+/**
+ * @brief Check that triangle indices of every mesh fit in the visibility ids
+ * @param meshes of the scene
+ * @return true if the scene can be drawn through the visibility buffer
+ */
+bool fitsVisibilityIds(const DynamicArray<GfxMeshData>& meshes);
+
 //////////////////////////////////////////////////////
 // Lighting Pass
 
@@ -34,10 +78,26 @@ struct LightingPushConstant
     int32_t  maxPrefilteredLODs     = -1;
     int32_t  brdfLUTIdx             = -1;
     int32_t  dirShadowMapTextureIdx = -1;
+    int32_t  localShadowAtlasIdx    = -1;
+    float    zNear                  = 0.f;
+    float    zFar                   = 0.f;
+    int32_t  outputTextureIdx       = -1; // only used by the tiled compute path
+    uint32_t compactGBuffer         = 0u;
+    uint32_t renderWidth            = 0u; // drawn region of the output sized targets
+    uint32_t renderHeight           = 0u;
 };
 
 void recordLightingCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
 
+//////////////////////////////////////////////////////
+// Tiled Lighting Pass
+
+// screen tiles of the compute lighting path, should match lighting_tiled.comp
+constexpr uint32_t LIGHTING_TILE_SIZE  = 16;
+constexpr uint32_t MAX_LIGHTS_PER_TILE = 256;
+
+void               dispatchTiledLightingCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+
 //////////////////////////////////////////////////////
 // Skybox Pass
 struct SkyBoxPushConstant
@@ -48,13 +108,63 @@ struct SkyBoxPushConstant
 
 void recordSkyBoxCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
 
+//////////////////////////////////////////////////////
+// Temporal Upscale Pass
+
+// should match taa.comp
+constexpr uint32_t TAA_GROUP_SIZE = 8;
+
+struct TemporalUpscalePushConstant
+{
+    uint32_t globalUboIdx;
+    int32_t  colorTextureIdx    = -1;
+    int32_t  depthTextureIdx    = -1;
+    int32_t  velocityTextureIdx = -1;
+    int32_t  historyTextureIdx  = -1;
+    int32_t  outputTextureIdx   = -1;
+    uint32_t resetHistory       = 0u;
+    uint32_t renderWidth        = 0u; // drawn region of the color, depth and velocity targets
+    uint32_t renderHeight       = 0u;
+};
+
+void dispatchTemporalUpscaleCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+
+//////////////////////////////////////////////////////
+// Auto Exposure Pass
+
+// should match auto_exposure.glsl
+constexpr uint32_t EXPOSURE_HISTOGRAM_BINS       = 256;
+constexpr uint32_t EXPOSURE_HISTOGRAM_GROUP_SIZE = 16;
+constexpr float    EXPOSURE_MIN_LOG_LUMINANCE    = -10.f;
+constexpr float    EXPOSURE_LOG_LUMINANCE_RANGE  = 16.f;
+constexpr float    EXPOSURE_ADAPTATION_SPEED     = 1.5f; // rate of the exponential adaptation per second
+
+struct AutoExposurePushConstant
+{
+    int32_t  inputTextureIdx     = -1;
+    int32_t  histogramTextureIdx = -1;
+    int32_t  exposureTextureIdx  = -1;
+    uint32_t pixelCount          = 0u;
+    float    minLogLuminance     = EXPOSURE_MIN_LOG_LUMINANCE;
+    float    logLuminanceRange   = EXPOSURE_LOG_LUMINANCE_RANGE;
+    float    adaptationRate      = 1.f; // blend towards the target exposure, one skips adaptation
+    uint32_t clearHistogram      = 0u;  // exposure dispatch only clears the bins
+    uint32_t renderWidth         = 0u;  // drawn region of the input
+    uint32_t renderHeight        = 0u;
+};
+
+void dispatchAutoExposureCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+
 //////////////////////////////////////////////////////
 // Tonemap Pass
 
 struct ToneMapPushConstant
 {
-    int32_t inputTextureIdx = -1;
-    float   exposure        = 1.f;
+    int32_t  inputTextureIdx    = -1;
+    float    exposure           = 1.f; // compensation on top of the auto exposure
+    int32_t  exposureTextureIdx = -1;  // adapted exposure written by the auto exposure pass
+    uint32_t renderWidth        = 0u;  // drawn region of the input
+    uint32_t renderHeight       = 0u;
 };
 
 void recordTonemapCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
@@ -74,6 +184,21 @@ void recordPresentationCmds(VkCommandBuffer cmdBuffer, const FrameData& frameDat
 
 void recordShadow2DMapsCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
 
+//////////////////////////////////////////////////////
+// Local Shadow Passes
+
+// indirect draws of the local shadow views, static and dynamic casters get half each
+constexpr uint32_t MAX_LOCAL_SHADOW_DRAWS = 65536;
+
+struct LocalShadowPushConstant
+{
+    uint32_t viewIdx               = 0u;
+    int32_t  staticAtlasTextureIdx = -1;
+};
+
+void               recordLocalShadowStaticCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+void               recordLocalShadowCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+
 //////////////////////////////////////////////////////
 // Cull & LOD Pass
 
@@ -81,23 +206,42 @@ struct CullLodPushConstant
 {
     uint32_t globalUboIdx;
     uint32_t objectCount;
+    uint32_t packedDrawsOffset; // first command of the packed vertices draws
 };
 
 void dispatchIndirectDrawCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
 
 //////////////////////////////////////////////////////
-// Env cube map generation passes
+// Light Clusters Pass
 
-void dispatchGenEnvCubeMapCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+// froxel grid of the view frustum, should match clusters.glsl
+constexpr uint32_t CLUSTER_GRID_X         = 16;
+constexpr uint32_t CLUSTER_GRID_Y         = 9;
+constexpr uint32_t CLUSTER_GRID_Z         = 24;
+constexpr uint32_t CLUSTER_COUNT          = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+constexpr uint32_t CLUSTER_GROUP_SIZE     = 128;
+
+struct LightClustersPushConstant
+{
+    uint32_t globalUboIdx;
+    float    zNear;
+    float    zFar;
+};
+
+void dispatchLightClustersCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
 
 //////////////////////////////////////////////////////
-// Env irradiance cube map generation passes
+// Env maps update pass
 
-void dispatchGenEnvIrradianceCubeMapCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+// dispatches the slices of the dynamic sky maps picked for the frame by Environment::update
+void dispatchEnvMapsUpdateCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
 
 //////////////////////////////////////////////////////
-// Prefiltered Env cube map generation passes
+// Transfer queue passes
+
+void recordTransferUploadCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
 
-void dispatchGenEnvPrefilteredCubeMapCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData);
+void recordTransferReadbackCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData);
 
 } // namespace dusk
@@ -31,8 +31,8 @@ void recordShadow2DMapsCmds(VkCommandBuffer cmdBuffer, const FrameData& frameDat
         0, // renderable desc set binding location
         1,
         &frameData.renderablesDescriptorSet,
-        0,
-        nullptr);
+        RENDERABLE_BUFFERS_COUNT,
+        frameData.renderables->bufferOffsets.data());
 
     // lights descriptor set
     vkCmdBindDescriptorSets(
@@ -60,12 +60,15 @@ void recordShadow2DMapsCmds(VkCommandBuffer cmdBuffer, const FrameData& frameDat
     auto&      meshesData          = scene.m_sceneMeshes;
     auto       renderables         = frameData.renderables;
     auto       totalInstnaces      = static_cast<uint32_t>(renderables->meshIds.size());
+    size_t     shadowDrawsOffset   = SHADOW_DRAWS_REGION * MAX_RENDERABLES_COUNT * sizeof(GfxIndexedIndirectDrawCommand);
+    uint32_t   fullDrawsCount      = 0u;
 
     {
         DUSK_PROFILE_SECTION("shadow_indirect_buffer_prep");
         DynamicArray<GfxIndexedIndirectDrawCommand> indirectCmdsBuffer = {};
+        DynamicArray<GfxIndexedIndirectDrawCommand> packedCmdsBuffer   = {};
 
-        // record cmds in buffer
+        // record cmds in buffer, grouped by vertex format
         indirectCmdsBuffer.reserve(totalInstnaces);
 
         for (uint32_t instanceIdx = 0u; instanceIdx < totalInstnaces; ++instanceIdx)
@@ -73,7 +76,8 @@ void recordShadow2DMapsCmds(VkCommandBuffer cmdBuffer, const FrameData& frameDat
             uint32_t    meshId   = renderables->meshIds[instanceIdx];
             const auto& meshData = meshesData[meshId];
 
-            indirectCmdsBuffer.push_back(
+            auto&       cmds     = meshData.vertexFormat == VertexFormat::Packed ? packedCmdsBuffer : indirectCmdsBuffer;
+            cmds.push_back(
                 { .indexCount    = meshData.indexCount,
                   .instanceCount = 1u,
                   .firstIndex    = meshData.firstIndex,
@@ -81,6 +85,9 @@ void recordShadow2DMapsCmds(VkCommandBuffer cmdBuffer, const FrameData& frameDat
                   .firstInstance = instanceIdx });
         }
 
+        fullDrawsCount = static_cast<uint32_t>(indirectCmdsBuffer.size());
+        indirectCmdsBuffer.insert(indirectCmdsBuffer.end(), packedCmdsBuffer.begin(), packedCmdsBuffer.end());
+
         GfxBuffer stagingBuffer;
         size_t    stagingBufferSize = totalInstnaces * sizeof(GfxIndexedIndirectDrawCommand);
         GfxBuffer::createHostWriteBuffer(
@@ -96,7 +103,7 @@ void recordShadow2DMapsCmds(VkCommandBuffer cmdBuffer, const FrameData& frameDat
         frameIndirectBuffer.copyFrom(
             stagingBuffer,
             0,
-            MAX_RENDERABLES_COUNT * sizeof(GfxIndexedIndirectDrawCommand),
+            shadowDrawsOffset,
             stagingBufferSize);
 
         stagingBuffer.cleanup();
@@ -108,8 +115,26 @@ void recordShadow2DMapsCmds(VkCommandBuffer cmdBuffer, const FrameData& frameDat
         vkCmdDrawIndexedIndirect(
             cmdBuffer,
             frameIndirectBuffer.vkBuffer.buffer,
-            MAX_RENDERABLES_COUNT * sizeof(GfxIndexedIndirectDrawCommand),
-            totalInstnaces,
+            shadowDrawsOffset,
+            fullDrawsCount,
+            sizeof(GfxIndexedIndirectDrawCommand));
+
+        // meshes with packed vertices follow the full vertex draws
+        resources.shadow2DMapPackedPipeline->bind(cmdBuffer);
+
+        {
+            VkBuffer     buffers[] = { Engine::get().getVertexBuffer(VertexFormat::Packed).vkBuffer.buffer };
+            VkDeviceSize offsets[] = { 0 };
+
+            vkCmdBindVertexBuffers(cmdBuffer, 0, 1, buffers, offsets);
+            vkCmdBindIndexBuffer(cmdBuffer, Engine::get().getIndexBuffer(VertexFormat::Packed).vkBuffer.buffer, 0, VK_INDEX_TYPE_UINT16);
+        }
+
+        vkCmdDrawIndexedIndirect(
+            cmdBuffer,
+            frameIndirectBuffer.vkBuffer.buffer,
+            shadowDrawsOffset + fullDrawsCount * sizeof(GfxIndexedIndirectDrawCommand),
+            totalInstnaces - fullDrawsCount,
             sizeof(GfxIndexedIndirectDrawCommand));
     }
 }
@@ -0,0 +1,69 @@
+#include "render_passes.h"
+
+#include "dusk.h"
+#include "vk.h"
+#include "frame_data.h"
+#include "engine.h"
+#include "debug/profiler.h"
+
+namespace dusk
+{
+void dispatchTemporalUpscaleCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!frameData.scene) return;
+
+    auto&            resources = Engine::get().getRenderGraphResources();
+    VkPipelineLayout layout    = resources.taaPipelineLayout->get();
+
+    // global, textures and storage textures
+    const VkDescriptorSet descriptorSets[] = {
+        frameData.globalDescriptorSet,
+        frameData.textureDescriptorSet,
+        frameData.storageTextureDescriptorSet
+    };
+
+    resources.taaPipeline->bind(cmdBuffer);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        layout,
+        0,
+        static_cast<uint32_t>(std::size(descriptorSets)),
+        descriptorSets,
+        0,
+        nullptr);
+
+    // history targets are swapped every frame, the previous output is reprojected
+    uint32_t                    historyIdx = resources.taaHistoryIdx;
+    TemporalUpscalePushConstant push {};
+    push.globalUboIdx       = frameData.frameIndex;
+    push.colorTextureIdx    = resources.lightingRenderTextureId;
+    push.depthTextureIdx    = resources.gbuffDepthTextureId;
+    push.velocityTextureIdx = resources.velocityTextureId;
+    push.historyTextureIdx  = resources.taaHistoryTextureIds[historyIdx ^ 1u];
+    push.outputTextureIdx   = resources.taaHistoryTextureIds[historyIdx];
+    push.resetHistory       = resources.taaResetHistory ? 1u : 0u;
+    push.renderWidth        = resources.renderExtent.width;
+    push.renderHeight       = resources.renderExtent.height;
+
+    vkCmdPushConstants(
+        cmdBuffer,
+        layout,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        sizeof(TemporalUpscalePushConstant),
+        &push);
+
+    // one thread per output pixel, color is upsampled from the render extent
+    vkCmdDispatch(
+        cmdBuffer,
+        (resources.outputExtent.width + TAA_GROUP_SIZE - 1) / TAA_GROUP_SIZE,
+        (resources.outputExtent.height + TAA_GROUP_SIZE - 1) / TAA_GROUP_SIZE,
+        1);
+
+    resources.taaResetHistory = false;
+}
+} // namespace dusk
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "engine.h"
 #include "ui/editor_ui.h"
 #include "debug/profiler.h"
+#include "renderer/texture_db.h"
 
 namespace dusk
 {
@@ -19,18 +20,45 @@ void recordTonemapCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
 
     resources.toneMapPipeline->bind(cmdBuffer);
 
-    vkCmdBindDescriptorSets(
-        cmdBuffer,
-        VK_PIPELINE_BIND_POINT_GRAPHICS,
-        resources.toneMapPipelineLayout->get(),
-        0,
-        1,
-        &frameData.textureDescriptorSet,
-        0,
-        nullptr);
+    TextureDB* textureDB = TextureDB::cache();
+    if (textureDB->isDescriptorBufferEnabled())
+    {
+        textureDB->bindTexturesDescriptorBuffer(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            resources.toneMapPipelineLayout->get(),
+            0,
+            frameData.frameIndex);
+    }
+    else
+    {
+        vkCmdBindDescriptorSets(
+            cmdBuffer,
+            VK_PIPELINE_BIND_POINT_GRAPHICS,
+            resources.toneMapPipelineLayout->get(),
+            0,
+            1,
+            &frameData.textureDescriptorSet,
+            0,
+            nullptr);
+    }
 
+    // temporal upscaling resolves the lighting output into the current history target,
+    // otherwise the render extent of the lighting output is upscaled here
+    bool                temporalUpscaling = Engine::get().isTemporalUpscalingEnabled();
+    VkExtent2D          inputExtent       = temporalUpscaling ? resources.outputExtent : resources.renderExtent;
     ToneMapPushConstant push {};
-    push.inputTextureIdx = resources.lightingRenderTextureId;
+    push.inputTextureIdx = temporalUpscaling
+                           ? resources.taaHistoryTextureIds[resources.taaHistoryIdx]
+                           : resources.lightingRenderTextureId;
+    push.renderWidth     = inputExtent.width;
+    push.renderHeight    = inputExtent.height;
+
+    // adapted exposure stays on the gpu, fixed exposure is used without it
+    if (Engine::get().isAutoExposureEnabled())
+    {
+        push.exposureTextureIdx = resources.exposureTextureId;
+    }
 
     vkCmdPushConstants(
         cmdBuffer,
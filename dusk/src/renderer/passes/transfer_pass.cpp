@@ -0,0 +1,23 @@
+#include "render_passes.h"
+
+#include "frame_data.h"
+#include "engine.h"
+#include "debug/profiler.h"
+#include "renderer/transfer_scheduler.h"
+
+namespace dusk
+{
+void recordTransferUploadCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    Engine::get().getTransferScheduler().recordUploads(cmdBuffer);
+}
+
+void recordTransferReadbackCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    Engine::get().getTransferScheduler().recordReadbacks(cmdBuffer);
+}
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,179 @@
+#include "render_passes.h"
+
+#include "dusk.h"
+#include "vk.h"
+#include "frame_data.h"
+#include "engine.h"
+#include "debug/profiler.h"
+#include "renderer/environment.h"
+#include "renderer/texture_db.h"
+
+#include "scene/scene.h"
+#include "scene/components/camera.h"
+
+namespace dusk
+{
+static_assert(
+    MAX_RENDERABLES_COUNT < (1u << (32 - VISIBILITY_TRIANGLE_BITS)),
+    "renderable indices don't fit in the visibility ids");
+
+bool fitsVisibilityIds(const DynamicArray<GfxMeshData>& meshes)
+{
+    bool fits = true;
+    for (uint32_t meshIdx = 0u; meshIdx < meshes.size(); ++meshIdx)
+    {
+        uint32_t triangleCount = meshes[meshIdx].indexCount / 3u;
+        if (triangleCount > (1u << VISIBILITY_TRIANGLE_BITS))
+        {
+            DUSK_WARN("Mesh {} has {} triangles, more than the visibility ids can hold", meshIdx, triangleCount);
+            fits = false;
+        }
+    }
+
+    return fits;
+}
+
+void recordVisibilityCmds(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!frameData.scene) return;
+
+    auto& resources = Engine::get().getRenderGraphResources();
+
+    resources.visibilityPipeline->bind(cmdBuffer);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        resources.visibilityPipelineLayout->get(),
+        0,
+        1,
+        &frameData.globalDescriptorSet,
+        0,
+        nullptr);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        resources.visibilityPipelineLayout->get(),
+        1,
+        1,
+        &frameData.renderablesDescriptorSet,
+        RENDERABLE_BUFFERS_COUNT,
+        frameData.renderables->bufferOffsets.data());
+
+    VisibilityPushConstant push {};
+    push.globalUboIdx = frameData.frameIndex;
+
+    vkCmdPushConstants(
+        cmdBuffer,
+        resources.visibilityPipelineLayout->get(),
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        0,
+        sizeof(VisibilityPushConstant),
+        &push);
+
+    auto& currentIndirectBuffer          = resources.frameIndirectDrawCommandsBuffers[frameData.frameIndex];
+    auto& currentIndirectDrawCountBuffer = resources.frameIndirectDrawCountBuffers[frameData.frameIndex];
+
+    // same culled draws as the g-buffer pass
+    for (VertexFormat format : { VertexFormat::Full, VertexFormat::Packed })
+    {
+        bool isPacked = format == VertexFormat::Packed;
+
+        if (isPacked)
+        {
+            resources.visibilityPackedPipeline->bind(cmdBuffer);
+        }
+
+        VkBuffer     buffers[] = { Engine::get().getVertexBuffer(format).vkBuffer.buffer };
+        VkDeviceSize offsets[] = { 0 };
+
+        vkCmdBindVertexBuffers(cmdBuffer, 0, 1, buffers, offsets);
+        vkCmdBindIndexBuffer(cmdBuffer, Engine::get().getIndexBuffer(format).vkBuffer.buffer, 0, isPacked ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+
+        uint32_t drawsRegion = isPacked ? GBUFFER_PACKED_DRAWS_REGION : GBUFFER_DRAWS_REGION;
+        size_t   countOffset = isPacked ? offsetof(GfxIndexedIndirectDrawCount, packedCount) : offsetof(GfxIndexedIndirectDrawCount, count);
+
+        vkCmdDrawIndexedIndirectCount(
+            cmdBuffer,
+            currentIndirectBuffer.vkBuffer.buffer,
+            drawsRegion * MAX_RENDERABLES_COUNT * sizeof(GfxIndexedIndirectDrawCommand),
+            currentIndirectDrawCountBuffer.vkBuffer.buffer,
+            countOffset,
+            MAX_RENDERABLES_COUNT,
+            sizeof(GfxIndexedIndirectDrawCommand));
+    }
+}
+
+void dispatchVisibilityMaterialCompute(VkCommandBuffer cmdBuffer, const FrameData& frameData)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!frameData.scene) return;
+
+    auto&            resources = Engine::get().getRenderGraphResources();
+    auto&            env       = Engine::get().getEnvironment();
+    VkPipelineLayout layout    = resources.visibilityMaterialPipelineLayout->get();
+
+    // global, textures, lights, light clusters, materials, renderables, mesh data
+    // with the geometry buffers and storage textures
+    const VkDescriptorSet descriptorSets[] = {
+        frameData.globalDescriptorSet,
+        frameData.textureDescriptorSet,
+        frameData.lightsDescriptorSet,
+        resources.lightClustersDescriptorSets[frameData.frameIndex]->set,
+        frameData.materialDescriptorSet,
+        frameData.renderablesDescriptorSet,
+        frameData.meshDataDescriptorSet,
+        frameData.storageTextureDescriptorSet
+    };
+
+    resources.visibilityMaterialPipeline->bind(cmdBuffer);
+
+    vkCmdBindDescriptorSets(
+        cmdBuffer,
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        layout,
+        0,
+        static_cast<uint32_t>(std::size(descriptorSets)),
+        descriptorSets,
+        RENDERABLE_BUFFERS_COUNT, // renderables set is the only one with dynamic offsets
+        frameData.renderables->bufferOffsets.data());
+
+    VisibilityMaterialPushConstant push {};
+    push.globalUboIdx           = frameData.frameIndex;
+    push.visibilityTextureIdx   = resources.visibilityTextureId;
+    push.brdfLUTIdx             = resources.brdfLUTextureId;
+    push.dirShadowMapTextureIdx = resources.dirShadowMapsTextureId;
+    push.localShadowAtlasIdx    = resources.localShadowAtlasTextureId;
+    push.outputTextureIdx       = resources.lightingRenderTextureId;
+    push.velocityTextureIdx     = resources.velocityTextureId;
+    push.renderWidth            = resources.renderExtent.width;
+    push.renderHeight           = resources.renderExtent.height;
+
+    push.irradianceTextureIdx   = env.getSkyIrradianceTextureId();
+    push.prefilteredTextureIdx  = env.getSkyPrefilteredTextureId();
+    push.maxPrefilteredLODs     = TextureDB::cache()->getTexture(push.prefilteredTextureIdx)->numMipLevels;
+
+    // depth slices of the light clusters
+    CameraComponent& camera = frameData.scene->getMainCamera();
+    push.zNear              = camera.nearPlane;
+    push.zFar               = camera.farPlane;
+
+    vkCmdPushConstants(
+        cmdBuffer,
+        layout,
+        VK_SHADER_STAGE_COMPUTE_BIT,
+        0,
+        sizeof(VisibilityMaterialPushConstant),
+        &push);
+
+    vkCmdDispatch(
+        cmdBuffer,
+        (resources.renderExtent.width + VISIBILITY_MATERIAL_GROUP_SIZE - 1) / VISIBILITY_MATERIAL_GROUP_SIZE,
+        (resources.renderExtent.height + VISIBILITY_MATERIAL_GROUP_SIZE - 1) / VISIBILITY_MATERIAL_GROUP_SIZE,
+        1);
+}
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "range_allocator.h"
+
+namespace dusk
+{
+void RangeAllocator::init(size_t capacity)
+{
+    m_capacity  = capacity;
+    m_freeCount = 0u;
+
+    m_freeRangesByOffset.clear();
+    m_freeRangesBySize.clear();
+
+    if (capacity > 0) insertFreeRange(0u, capacity);
+}
+
+bool RangeAllocator::allocate(size_t count, size_t* outOffset)
+{
+    DASSERT(outOffset, "Not a valid pointer");
+
+    if (count == 0)
+    {
+        *outOffset = 0u;
+        return true;
+    }
+
+    // best fit keeps large ranges intact for big meshes
+    auto sizeIt = m_freeRangesBySize.lower_bound(count);
+    if (sizeIt == m_freeRangesBySize.end())
+    {
+        return false;
+    }
+
+    size_t rangeOffset = sizeIt->second;
+    size_t rangeCount  = sizeIt->first;
+
+    eraseFreeRange(m_freeRangesByOffset.find(rangeOffset));
+
+    if (rangeCount > count)
+    {
+        insertFreeRange(rangeOffset + count, rangeCount - count);
+    }
+
+    *outOffset = rangeOffset;
+
+    return true;
+}
+
+void RangeAllocator::free(size_t offset, size_t count)
+{
+    if (count == 0) return;
+
+    DASSERT(offset + count <= m_capacity, "Range is outside of the allocator");
+
+    size_t mergedOffset = offset;
+    size_t mergedCount  = count;
+
+    // merge with the following free range
+    auto   nextIt       = m_freeRangesByOffset.lower_bound(offset);
+    if (nextIt != m_freeRangesByOffset.end())
+    {
+        DASSERT(nextIt->first >= offset + count, "Range is already free");
+
+        if (nextIt->first == offset + count)
+        {
+            mergedCount += nextIt->second;
+            eraseFreeRange(nextIt);
+        }
+    }
+
+    // merge with the preceding free range
+    auto prevIt = m_freeRangesByOffset.lower_bound(offset);
+    if (prevIt != m_freeRangesByOffset.begin())
+    {
+        --prevIt;
+
+        DASSERT(prevIt->first + prevIt->second <= offset, "Range is already free");
+
+        if (prevIt->first + prevIt->second == offset)
+        {
+            mergedOffset = prevIt->first;
+            mergedCount += prevIt->second;
+            eraseFreeRange(prevIt);
+        }
+    }
+
+    insertFreeRange(mergedOffset, mergedCount);
+}
+
+size_t RangeAllocator::getLargestFreeRange() const
+{
+    if (m_freeRangesBySize.empty()) return 0u;
+
+    return m_freeRangesBySize.rbegin()->first;
+}
+
+void RangeAllocator::insertFreeRange(size_t offset, size_t count)
+{
+    m_freeRangesByOffset.emplace(offset, count);
+    m_freeRangesBySize.emplace(count, offset);
+
+    m_freeCount += count;
+}
+
+void RangeAllocator::eraseFreeRange(std::map<size_t, size_t>::iterator rangeIt)
+{
+    size_t offset = rangeIt->first;
+    size_t count  = rangeIt->second;
+
+    auto   sizeRange = m_freeRangesBySize.equal_range(count);
+    for (auto sizeIt = sizeRange.first; sizeIt != sizeRange.second; ++sizeIt)
+    {
+        if (sizeIt->second == offset)
+        {
+            m_freeRangesBySize.erase(sizeIt);
+            break;
+        }
+    }
+
+    m_freeRangesByOffset.erase(rangeIt);
+
+    m_freeCount -= count;
+}
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "dusk.h"
+
+#include <map>
+
+namespace dusk
+{
+/**
+ * @brief Free-list sub-allocator for ranges of a fixed capacity block, like
+ * elements of a large GPU buffer. Free ranges are tracked by offset for
+ * coalescing and by size for best fit allocations. Allocator only does the
+ * bookkeeping, no memory is owned by it.
+ */
+class RangeAllocator
+{
+public:
+    RangeAllocator()  = default;
+    ~RangeAllocator() = default;
+
+    /**
+     * @brief Reset the allocator with a single free range of given capacity
+     * @param capacity total elements which can be allocated
+     */
+    void init(size_t capacity);
+
+    /**
+     * @brief Allocate a contiguous range
+     * @param count of elements in the range
+     * @param outOffset start of the allocated range
+     * @return true if allocation was successful
+     */
+    bool allocate(size_t count, size_t* outOffset);
+
+    /**
+     * @brief Release a previously allocated range. Adjacent free ranges are merged.
+     * @param offset start of the range
+     * @param count of elements in the range
+     */
+    void free(size_t offset, size_t count);
+
+    /**
+     * @brief Get total capacity of the allocator
+     */
+    size_t getCapacity() const { return m_capacity; };
+
+    /**
+     * @brief Get total free elements, which might not be contiguous
+     */
+    size_t getFreeCount() const { return m_freeCount; };
+
+    /**
+     * @brief Get size of the largest contiguous free range
+     */
+    size_t getLargestFreeRange() const;
+
+private:
+    void insertFreeRange(size_t offset, size_t count);
+    void eraseFreeRange(std::map<size_t, size_t>::iterator rangeIt);
+
+private:
+    size_t                        m_capacity  = 0u;
+    size_t                        m_freeCount = 0u;
+
+    // offset -> count
+    std::map<size_t, size_t>      m_freeRangesByOffset = {};
+
+    // count -> offset
+    std::multimap<size_t, size_t> m_freeRangesBySize   = {};
+};
+} // namespace dusk
\ No newline at end of file
@@ -18,6 +18,13 @@
 
 namespace dusk
 {
+// targets drawn at render scale cover only a corner of their texture
+static VkExtent2D getRenderArea(const RGImageResource& resource)
+{
+    if (resource.renderArea.width > 0u && resource.renderArea.height > 0u) return resource.renderArea;
+
+    return { resource.texture->width, resource.texture->height };
+}
 
 void RenderGraph::addReadResource(
     uint32_t         passId,
@@ -122,6 +129,12 @@ void RenderGraph::markAsFinal(uint32_t passId)
     pass.isFinalPass = true;
 }
 
+void RenderGraph::setPassPriority(uint32_t passId, RGPassPriority priority)
+{
+    auto& pass    = m_passes[passId];
+    pass.priority = priority;
+}
+
 void RenderGraph::setMulitView(uint32_t passId, uint32_t mask, uint32_t numLayers)
 {
     auto& pass      = m_passes[passId];
@@ -154,6 +167,14 @@ DynamicArray<VulkanSubmitBatch> RenderGraph::execute(const FrameData& frameData)
 {
     DASSERT(m_passes.size() <= MAX_RENDER_GRAPH_PASSES, "Currently maximum supported passes in a graph is 64");
 
+    auto* statsRecorder = StatsRecorder::get();
+
+    // gpu times of previous frames drive the overlap of compute and graphics work
+    for (auto& pass : m_passes)
+    {
+        pass.estimatedCostNs = statsRecorder->getPassCostNs(pass.name);
+    }
+
     buildDependencyGraph();
     buildExecutionOrder();
     buildResourcesStates();
@@ -162,9 +183,8 @@ DynamicArray<VulkanSubmitBatch> RenderGraph::execute(const FrameData& frameData)
     DynamicArray<VulkanSubmitBatch> backendSubmitBatches = {};
     auto                            computeBatchesCount  = m_submissionOrder.computeBatches.size();
     auto                            graphicBatchesCount  = m_submissionOrder.graphicBatches.size();
-    backendSubmitBatches.reserve(computeBatchesCount + graphicBatchesCount);
-
-    auto* statsRecorder = StatsRecorder::get();
+    auto                            transferBatchesCount = m_submissionOrder.transferBatches.size();
+    backendSubmitBatches.reserve(computeBatchesCount + graphicBatchesCount + transferBatchesCount + 2);
 
     // add frame start batch for stats recorder
     VkCommandBuffer statsStartCmdBuffer = vulkan::getCmdBuffer(frameData.cmdBufferPools->graphicsPool);
@@ -177,113 +197,100 @@ DynamicArray<VulkanSubmitBatch> RenderGraph::execute(const FrameData& frameData)
         0);
     vulkan::endRecording(statsStartCmdBuffer);
 
+    // all transfer batches, their consumers on other queues wait on transfer timeline values
+    uint32_t lastTransferSignalValue = 0u;
+    for (const auto& batch : m_submissionOrder.transferBatches)
+    {
+        backendSubmitBatches.push_back(recordBatch(frameData, batch, RGQueueFamilyType::Transfer, frameData.cmdBufferPools->transferPool));
+        lastTransferSignalValue = std::max(lastTransferSignalValue, batch.signalValue);
+    }
+
     // all compute batches
     for (const auto& batch : m_submissionOrder.computeBatches)
     {
-        VkCommandBuffer recordingBuffer = vulkan::getCmdBuffer(frameData.cmdBufferPools->computePool);
-        vulkan::beginRecording(recordingBuffer);
-
-        uint32_t targetQueueFamilyIndex = getQueueFamilyIndex(RGQueueFamilyType::Compute);
-
-        uint64_t batchPasses            = batch.passesMask;
-        while (batchPasses)
-        {
-            uint32_t passIdx = std::countr_zero(batchPasses);
-            batchPasses &= batchPasses - 1ULL;
-            auto&    pass             = m_passes[passIdx];
-
-            uint32_t passExecutionIdx = m_passIdToExecutionOrder[passIdx];
-
-            statsRecorder->beginPass(recordingBuffer, pass.name, passExecutionIdx);
-
-            insertPrePassBarriers(frameData, pass, recordingBuffer);
-
-            // DUSK_DEBUG("executing pass: {}", pass.name);
-
-            vkdebug::cmdBeginLabel(recordingBuffer, pass.name.c_str(), glm::vec4(0.7f, 0.7f, 0.f, 0.f));
-
-            beginPass(frameData, pass, recordingBuffer);
-            pass.recordFn(recordingBuffer, frameData);
-            endPass(frameData, pass, recordingBuffer);
-
-            vkdebug::cmdEndLabel(recordingBuffer);
-
-            insertPostPassBarriers(frameData, pass, recordingBuffer);
-
-            statsRecorder->endPass(recordingBuffer, passExecutionIdx);
-        }
-
-        vulkan::endRecording(recordingBuffer);
-
-        backendSubmitBatches.emplace_back(
-            recordingBuffer,
-            targetQueueFamilyIndex,
-            batch.waitValue,
-            batch.signalValue);
+        backendSubmitBatches.push_back(recordBatch(frameData, batch, RGQueueFamilyType::Compute, frameData.cmdBufferPools->computePool));
     }
 
     // all graphics batches
     for (const auto& batch : m_submissionOrder.graphicBatches)
     {
-        VkCommandBuffer recordingBuffer = vulkan::getCmdBuffer(frameData.cmdBufferPools->graphicsPool);
-        vulkan::beginRecording(recordingBuffer);
+        backendSubmitBatches.push_back(recordBatch(frameData, batch, RGQueueFamilyType::Graphics, frameData.cmdBufferPools->graphicsPool));
+    }
 
-        uint32_t targetQueueFamilyIndex = getQueueFamilyIndex(RGQueueFamilyType::Graphics);
+    // stats recorder frame end buffer, must be submitted after all batches
+    VkCommandBuffer statsEndCmdBuffer = vulkan::getCmdBuffer(frameData.cmdBufferPools->graphicsPool);
+    vulkan::beginRecording(statsEndCmdBuffer);
+    statsRecorder->endGPUFrame(statsEndCmdBuffer);
+    // frame fence goes with this batch, so it also waits for readbacks without consumers
+    backendSubmitBatches.emplace_back(
+        statsEndCmdBuffer,
+        m_vkContext.graphicsQueueFamilyIndex,
+        backendSubmitBatches.back().semaphoreSignalValue,
+        backendSubmitBatches.back().semaphoreSignalValue + 1,
+        false,
+        false,
+        lastTransferSignalValue);
+    vulkan::endRecording(statsEndCmdBuffer);
 
-        uint64_t batchPasses            = batch.passesMask;
-        bool     isFinalBatch           = false;
+    return backendSubmitBatches;
+}
 
-        while (batchPasses)
-        {
-            uint32_t passIdx = std::countr_zero(batchPasses);
-            batchPasses &= batchPasses - 1ULL;
-            auto&    pass             = m_passes[passIdx];
+VulkanSubmitBatch RenderGraph::recordBatch(
+    const FrameData&       frameData,
+    const SubmissionBatch& batch,
+    RGQueueFamilyType      queueFamily,
+    VulkanCmdBufferPool*   cmdBufferPool)
+{
+    auto*           statsRecorder   = StatsRecorder::get();
+
+    VkCommandBuffer recordingBuffer = vulkan::getCmdBuffer(cmdBufferPool);
+    vulkan::beginRecording(recordingBuffer);
 
-            uint32_t passExecutionIdx = m_passIdToExecutionOrder[passIdx];
+    uint32_t targetQueueFamilyIndex = getQueueFamilyIndex(queueFamily);
 
-            statsRecorder->beginPass(recordingBuffer, pass.name, passExecutionIdx);
+    uint64_t batchPasses            = batch.passesMask;
+    bool     isFinalBatch           = false;
 
-            insertPrePassBarriers(frameData, pass, recordingBuffer);
+    while (batchPasses)
+    {
+        uint32_t passIdx = std::countr_zero(batchPasses);
+        batchPasses &= batchPasses - 1ULL;
+        auto&    pass             = m_passes[passIdx];
 
-            // DUSK_DEBUG("executing pass: {}", pass.name);
+        uint32_t passExecutionIdx = m_passIdToExecutionOrder[passIdx];
 
-            vkdebug::cmdBeginLabel(recordingBuffer, pass.name.c_str(), glm::vec4(0.7f, 0.7f, 0.f, 0.f));
+        statsRecorder->beginPass(recordingBuffer, pass.name, passExecutionIdx);
 
-            beginPass(frameData, pass, recordingBuffer);
-            pass.recordFn(recordingBuffer, frameData);
-            endPass(frameData, pass, recordingBuffer);
+        insertPrePassBarriers(frameData, pass, recordingBuffer);
 
-            vkdebug::cmdEndLabel(recordingBuffer);
+        // DUSK_DEBUG("executing pass: {}", pass.name);
 
-            insertPostPassBarriers(frameData, pass, recordingBuffer);
+        vkdebug::cmdBeginLabel(recordingBuffer, pass.name.c_str(), glm::vec4(0.7f, 0.7f, 0.f, 0.f));
 
-            statsRecorder->endPass(recordingBuffer, passExecutionIdx);
+        beginPass(frameData, pass, recordingBuffer);
+        pass.recordFn(recordingBuffer, frameData);
+        endPass(frameData, pass, recordingBuffer);
 
-            isFinalBatch |= pass.isFinalPass;
-        }
+        vkdebug::cmdEndLabel(recordingBuffer);
 
-        vulkan::endRecording(recordingBuffer);
+        insertPostPassBarriers(frameData, pass, recordingBuffer);
 
-        backendSubmitBatches.emplace_back(
-            recordingBuffer,
-            targetQueueFamilyIndex,
-            batch.waitValue,
-            batch.signalValue,
-            isFinalBatch);
-    }
+        statsRecorder->endPass(recordingBuffer, passExecutionIdx);
 
-    // stats recorder frame end buffer, must be submitted after all batches
-    VkCommandBuffer statsEndCmdBuffer = vulkan::getCmdBuffer(frameData.cmdBufferPools->graphicsPool);
-    vulkan::beginRecording(statsEndCmdBuffer);
-    statsRecorder->endGPUFrame(statsEndCmdBuffer);
-    backendSubmitBatches.emplace_back(
-        statsEndCmdBuffer,
-        m_vkContext.graphicsQueueFamilyIndex,
-        backendSubmitBatches.back().semaphoreSignalValue,
-        backendSubmitBatches.back().semaphoreSignalValue + 1);
-    vulkan::endRecording(statsEndCmdBuffer);
+        isFinalBatch |= pass.isFinalPass;
+    }
 
-    return backendSubmitBatches;
+    vulkan::endRecording(recordingBuffer);
+
+    return {
+        recordingBuffer,
+        targetQueueFamilyIndex,
+        batch.waitValue,
+        batch.signalValue,
+        isFinalBatch,
+        queueFamily == RGQueueFamilyType::Transfer,
+        batch.transferWaitValue
+    };
 }
 
 void RenderGraph::buildDependencyGraph()
@@ -376,28 +383,51 @@ void RenderGraph::buildExecutionOrder()
     // copying, avoiding modifications on original array
     DynamicArray<uint64_t> inEdgeBitsets = m_inEdgesBitsets;
 
-    // track initial zero in-degree nodes
+    // track initial zero in-degree nodes and nodes of compute queue
     uint64_t zeroInDegreeNodesBitset = 0ULL;
+    uint64_t computeNodesBitset      = 0ULL;
     for (uint32_t nodeIdx = 0; nodeIdx < nodeCount; ++nodeIdx)
     {
         zeroInDegreeNodesBitset |= (uint64_t)(!inEdgeBitsets[nodeIdx]) << nodeIdx;
+        computeNodesBitset |= (uint64_t)(m_passes[nodeIdx].targetQueueFamily == RGQueueFamilyType::Compute) << nodeIdx;
     }
 
+    // scheduled compute passes which graphics queue has not waited on yet and
+    // their cost which is not yet overlapped with independent graphics passes
+    uint64_t pendingComputeNodesBitset = 0ULL;
+    float    pendingComputeCostNs      = 0.f;
+
     // Kahn's algorithm for topological sorting
     // zeroInDegreeNodesBitset will act as a queue
     // TODO:: even faster version exists using SoA 64-Node Tile Graph where edges are stored in a transposed manner
     while (zeroInDegreeNodesBitset)
     {
-        // TODO:: should we consider built-in functions for trailing zero counting?
-        uint32_t nodeIdx = std::countr_zero(zeroInDegreeNodesBitset);
+        uint32_t nodeIdx = pickNextPass(zeroInDegreeNodesBitset, computeNodesBitset, pendingComputeNodesBitset, pendingComputeCostNs);
         uint64_t nodeBit = (1ULL << nodeIdx);
 
         // pop the node from zero in-degree bitset
-        zeroInDegreeNodesBitset &= zeroInDegreeNodesBitset - 1ULL;
+        zeroInDegreeNodesBitset &= ~nodeBit;
 
         // remove node from all nodes bitset for concluding its process
         allNodesBitset &= ~nodeBit;
 
+        // update overlap budget, a graphics pass with compute dependencies is a sync
+        // point after which all the scheduled compute work is waited on
+        if (nodeBit & computeNodesBitset)
+        {
+            pendingComputeNodesBitset |= nodeBit;
+            pendingComputeCostNs += m_passes[nodeIdx].estimatedCostNs;
+        }
+        else if (m_inEdgesBitsets[nodeIdx] & pendingComputeNodesBitset)
+        {
+            pendingComputeNodesBitset = 0ULL;
+            pendingComputeCostNs      = 0.f;
+        }
+        else
+        {
+            pendingComputeCostNs = std::max(0.f, pendingComputeCostNs - m_passes[nodeIdx].estimatedCostNs);
+        }
+
         // add node to execution order
         m_passExecutionOrder.push_back(nodeIdx);
         m_passIdToExecutionOrder[nodeIdx] = static_cast<uint32_t>(m_passExecutionOrder.size() - 1);
@@ -426,6 +456,57 @@ void RenderGraph::buildExecutionOrder()
     }
 }
 
+uint32_t RenderGraph::pickNextPass(
+    uint64_t readyPasses,
+    uint64_t computePasses,
+    uint64_t pendingComputePasses,
+    float    pendingComputeCostNs) const
+{
+    // compute passes go first so their batches are submitted with the
+    // most graphics work left to overlap with
+    uint64_t candidates = readyPasses & computePasses;
+
+    if (!candidates)
+    {
+        candidates = readyPasses;
+
+        // graphics passes which don't have to wait for the pending compute work
+        uint64_t independentPasses = 0ULL;
+        uint64_t readyBits         = readyPasses;
+        while (readyBits)
+        {
+            uint32_t passIdx = std::countr_zero(readyBits);
+            readyBits &= readyBits - 1ULL;
+
+            bool isIndependent = !(m_inEdgesBitsets[passIdx] & pendingComputePasses) || m_passes[passIdx].priority == RGPassPriority::High;
+            independentPasses |= (uint64_t)isIndependent << passIdx;
+        }
+
+        // delay the wait on compute until its cost is hidden, if there is other work
+        if (pendingComputeCostNs > 0.f && independentPasses)
+        {
+            candidates = independentPasses;
+        }
+    }
+
+    // highest priority first, ties keep the declaration order
+    uint32_t pickedIdx = std::countr_zero(candidates);
+    candidates &= candidates - 1ULL;
+
+    while (candidates)
+    {
+        uint32_t passIdx = std::countr_zero(candidates);
+        candidates &= candidates - 1ULL;
+
+        if (m_passes[passIdx].priority > m_passes[pickedIdx].priority)
+        {
+            pickedIdx = passIdx;
+        }
+    }
+
+    return pickedIdx;
+}
+
 void RenderGraph::buildResourcesStates()
 {
     uint32_t nodeCount = static_cast<uint32_t>(m_passExecutionOrder.size());
@@ -441,6 +522,21 @@ void RenderGraph::buildResourcesStates()
         buildWriteBufferResourcesState(pass);
         buildReadBufferResourcesState(pass);
     }
+
+    // persistent images start the next frame from the layout they are left in
+    for (const auto& pass : m_passes)
+    {
+        for (const auto* resources : { &pass.writeTextureResources, &pass.readTextureResources })
+        {
+            for (const auto& resourceRef : *resources)
+            {
+                auto* resource = (RGImageResource*)resourceRef.ptr;
+                if (!resource->preserveContents) continue;
+
+                resource->texture->currentLayout = m_imageExecStates[resource->texture->id].layout;
+            }
+        }
+    }
 }
 
 void RenderGraph::buildSubmissionBatches()
@@ -448,6 +544,7 @@ void RenderGraph::buildSubmissionBatches()
     // start with an empty batch
     m_submissionOrder.graphicBatches.push_back({});
     m_submissionOrder.computeBatches.push_back({});
+    m_submissionOrder.transferBatches.push_back({});
 
     uint32_t nodeCount           = static_cast<uint32_t>(m_passExecutionOrder.size());
     bool     closeCurrentBatches = false;
@@ -455,13 +552,13 @@ void RenderGraph::buildSubmissionBatches()
 
     for (uint32_t execIdx = 0u; execIdx < nodeCount; ++execIdx)
     {
-        uint32_t         passIdx      = m_passExecutionOrder[execIdx];
-        const auto&      pass         = m_passes[passIdx];
+        uint32_t         passIdx              = m_passExecutionOrder[execIdx];
+        const auto&      pass                 = m_passes[passIdx];
 
-        SubmissionBatch& currentBatch = pass.targetQueueFamily == RGQueueFamilyType::Graphics ? m_submissionOrder.graphicBatches.back() : m_submissionOrder.computeBatches.back();
-        SubmissionBatch& otherBatch   = pass.targetQueueFamily == RGQueueFamilyType::Graphics ? m_submissionOrder.computeBatches.back() : m_submissionOrder.graphicBatches.back();
+        SubmissionBatch& currentBatch         = getQueueBatches(pass.targetQueueFamily).back();
 
-        uint32_t         newWaitValue = 0u; // wait value if pass added in new batch
+        uint32_t         newWaitValue         = 0u; // wait value if pass added in new batch
+        uint32_t         newTransferWaitValue = 0u; // transfer timeline wait value if pass added in new batch
 
         // no cross-queue dependencies, add to current batch
         if (pass.crossQueueDeps == 0)
@@ -478,24 +575,46 @@ void RenderGraph::buildSubmissionBatches()
                 uint32_t depIdx = std::countr_zero(deps);
                 deps &= deps - 1;
 
-                signalCounter++;
-                newWaitValue = signalCounter;
+                // transfer batches signal their own timeline
+                bool      isTransferDep = m_passes[depIdx].targetQueueFamily == RGQueueFamilyType::Transfer;
+                uint32_t& depWaitValue  = isTransferDep ? newTransferWaitValue : newWaitValue;
 
                 if (1ULL << depIdx & m_submissionOrder.batchMask)
                 {
-                    // depeendecy already submitted in previous batch
-                    continue;
+                    // depeendecy already submitted in previous batch, wait for the value its batch signals
+                    for (const SubmissionBatch& submittedBatch : getQueueBatches(m_passes[depIdx].targetQueueFamily))
+                    {
+                        if (submittedBatch.passesMask & (1ULL << depIdx))
+                        {
+                            depWaitValue = std::max(depWaitValue, submittedBatch.signalValue);
+                            break;
+                        }
+                    }
                 }
                 else
                 {
-                    // dependency must exist in current batch because of topological order
+                    // dependency must exist in current batch of its queue because of topological order
+                    SubmissionBatch& otherBatch = getQueueBatches(m_passes[depIdx].targetQueueFamily).back();
 
                     DASSERT(otherBatch.passesMask & (1ULL << depIdx), "Critical error in render graph's execution order, dependency doesn't exist in existing batch.");
 
+                    signalCounter++;
+
                     otherBatch.signalValue = signalCounter;
+                    depWaitValue           = signalCounter;
                     closeCurrentBatches    = true;
                 }
             }
+
+            // dependencies were all submitted in previous batches, so the ongoing batch
+            // of the queue only has to wait for them
+            if (!closeCurrentBatches)
+            {
+                currentBatch.passesMask |= (1ULL << passIdx);
+                currentBatch.waitValue         = std::max(newWaitValue, currentBatch.waitValue);
+                currentBatch.transferWaitValue = std::max(newTransferWaitValue, currentBatch.transferWaitValue);
+                currentBatch.signalValue       = std::max(signalCounter, currentBatch.signalValue);
+            }
         }
 
         // We will submit the batch containing cross queue depenedent passes and also submit the ongoing batch
@@ -505,28 +624,44 @@ void RenderGraph::buildSubmissionBatches()
             // commit passes in the submitted batch mask
             m_submissionOrder.batchMask |= m_submissionOrder.graphicBatches.back().passesMask;
             m_submissionOrder.batchMask |= m_submissionOrder.computeBatches.back().passesMask;
+            m_submissionOrder.batchMask |= m_submissionOrder.transferBatches.back().passesMask;
 
             // close current batches and start new batch with current pass
             m_submissionOrder.graphicBatches.push_back({});
             m_submissionOrder.computeBatches.push_back({});
+            m_submissionOrder.transferBatches.push_back({});
 
-            if (pass.targetQueueFamily == RGQueueFamilyType::Graphics)
-            {
-                m_submissionOrder.graphicBatches.back().passesMask |= (1ULL << passIdx);
-                m_submissionOrder.graphicBatches.back().waitValue   = newWaitValue;
-                m_submissionOrder.graphicBatches.back().signalValue = newWaitValue + 1;
-            }
-            else
-            {
-                m_submissionOrder.computeBatches.back().passesMask |= (1ULL << passIdx);
-                m_submissionOrder.computeBatches.back().waitValue   = newWaitValue;
-                m_submissionOrder.computeBatches.back().signalValue = newWaitValue + 1;
-            }
+            SubmissionBatch& newBatch = getQueueBatches(pass.targetQueueFamily).back();
+            newBatch.passesMask |= (1ULL << passIdx);
+            newBatch.waitValue         = newWaitValue;
+            newBatch.transferWaitValue = newTransferWaitValue;
+            newBatch.signalValue       = signalCounter + 1;
 
-            closeCurrentBatches = false;
+            closeCurrentBatches        = false;
         }
     }
 
+#ifdef ENABLE_ASSERT
+    // every scheduled pass is submitted in exactly one batch
+    uint64_t scheduledPasses = 0u;
+    for (uint32_t passIdx : m_passExecutionOrder)
+    {
+        scheduledPasses |= (1ULL << passIdx);
+    }
+
+    uint64_t batchedPasses = 0u;
+    for (const auto* batches : { &m_submissionOrder.graphicBatches, &m_submissionOrder.computeBatches, &m_submissionOrder.transferBatches })
+    {
+        for (const SubmissionBatch& batch : *batches)
+        {
+            DASSERT((batchedPasses & batch.passesMask) == 0, "Render graph pass is added to multiple submission batches");
+            batchedPasses |= batch.passesMask;
+        }
+    }
+
+    DASSERT(batchedPasses == scheduledPasses, "Render graph pass is missing from submission batches");
+#endif // ENABLE_ASSERT
+
     if (m_submissionOrder.graphicBatches.back().passesMask == 0)
     {
         m_submissionOrder.graphicBatches.pop_back();
@@ -536,6 +671,21 @@ void RenderGraph::buildSubmissionBatches()
     {
         m_submissionOrder.computeBatches.pop_back();
     }
+
+    if (m_submissionOrder.transferBatches.back().passesMask == 0)
+    {
+        m_submissionOrder.transferBatches.pop_back();
+    }
+}
+
+DynamicArray<SubmissionBatch>& RenderGraph::getQueueBatches(RGQueueFamilyType queueFamily)
+{
+    switch (queueFamily)
+    {
+        case RGQueueFamilyType::Compute:  return m_submissionOrder.computeBatches;
+        case RGQueueFamilyType::Transfer: return m_submissionOrder.transferBatches;
+        default:                          return m_submissionOrder.graphicBatches;
+    }
 }
 
 void RenderGraph::buildWriteImageResourcesState(RGNode& pass, bool useDepth)
@@ -555,8 +705,19 @@ void RenderGraph::buildWriteImageResourcesState(RGNode& pass, bool useDepth)
         pass.resourceLoadStoreStates[resId].loadOp = GfxLoadOperation::Load;
         if (state.firstWriter == -1)
         {
-            state.firstWriter                          = pass.index;
-            pass.resourceLoadStoreStates[resId].loadOp = GfxLoadOperation::Clear; // TODO:: make configurable, Expose per-pass intent
+            state.firstWriter = pass.index;
+
+            if (!resource->preserveContents)
+            {
+                pass.resourceLoadStoreStates[resId].loadOp = GfxLoadOperation::Clear; // TODO:: make configurable, Expose per-pass intent
+            }
+            else if (state.stage == VK_PIPELINE_STAGE_2_NONE)
+            {
+                // transition from the layout left by the previous frame keeps the contents
+                state.layout = resource->texture->currentLayout;
+                state.stage  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+                state.access = VK_ACCESS_2_MEMORY_WRITE_BIT;
+            }
         }
 
         VkImageAspectFlags imageAspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
@@ -580,18 +741,26 @@ void RenderGraph::buildWriteImageResourcesState(RGNode& pass, bool useDepth)
             newStage  = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
             newAccess = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
-            if (pass.targetQueueFamily == RGQueueFamilyType::Compute)
+            // dispatches write storage images, also when recorded on the graphics queue
+            if (pass.isCompute || pass.targetQueueFamily == RGQueueFamilyType::Compute)
             {
                 newLayout = VK_IMAGE_LAYOUT_GENERAL;
                 newStage  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
                 newAccess = VK_ACCESS_2_SHADER_WRITE_BIT;
             }
+            else if (pass.targetQueueFamily == RGQueueFamilyType::Transfer)
+            {
+                newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                newStage  = VK_PIPELINE_STAGE_2_COPY_BIT;
+                newAccess = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+            }
         }
 
         if (resource->texture->usage & DepthStencilTexture)
         {
             // if reading depth buffer
-            imageAspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            imageAspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
+            if (vulkan::hasStencilComponent(resource->texture->format)) imageAspectFlags |= VK_IMAGE_ASPECT_STENCIL_BIT;
         }
 
         // TODO:: Need proper reasoning about WAW ownership cases. Currently there is no use case for it.
@@ -634,7 +803,7 @@ void RenderGraph::buildWriteImageResourcesState(RGNode& pass, bool useDepth)
 
             oldPass.postImageBarriers.push_back(release);
 
-            pass.crossQueueDeps = 1ULL << state.lastWriter; // ensure submit happens between release and acquire
+            pass.crossQueueDeps |= 1ULL << state.lastWriter; // ensure submit happens between release and acquire
 
             addedReleaseBarrier = true;
         }
@@ -727,7 +896,8 @@ void RenderGraph::buildReadImageResourcesState(RGNode& pass, bool useDepth)
         if (resource->texture->usage & DepthStencilTexture)
         {
             // if reading depth buffer
-            imageAspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+            imageAspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
+            if (vulkan::hasStencilComponent(resource->texture->format)) imageAspectFlags |= VK_IMAGE_ASPECT_STENCIL_BIT;
         }
 
         // handle ownership transfer for Write -> Read cases across different queue families
@@ -769,7 +939,7 @@ void RenderGraph::buildReadImageResourcesState(RGNode& pass, bool useDepth)
 
             oldPass.postImageBarriers.push_back(release);
 
-            pass.crossQueueDeps = 1ULL << state.lastWriter; // ensure submit happens between release and acquire
+            pass.crossQueueDeps |= 1ULL << state.lastWriter; // ensure submit happens between release and acquire
 
             addedReleaseBarrier = true;
         }
@@ -786,12 +956,18 @@ void RenderGraph::buildReadImageResourcesState(RGNode& pass, bool useDepth)
         }
         else
         {
-            if (pass.targetQueueFamily == RGQueueFamilyType::Compute)
+            if (pass.isCompute || pass.targetQueueFamily == RGQueueFamilyType::Compute)
             {
                 newStage  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
                 newAccess = VK_ACCESS_SHADER_READ_BIT;
                 newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
             }
+            else if (pass.targetQueueFamily == RGQueueFamilyType::Transfer)
+            {
+                newStage  = VK_PIPELINE_STAGE_2_COPY_BIT;
+                newAccess = VK_ACCESS_2_TRANSFER_READ_BIT;
+                newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            }
         }
 
         // emit barrier if layout transition is needed
@@ -866,11 +1042,23 @@ void RenderGraph::buildWriteBufferResourcesState(RGNode& pass)
                 newAccess |= VK_ACCESS_2_SHADER_READ_BIT;
             }
         }
+        else if (pass.targetQueueFamily == RGQueueFamilyType::Transfer)
+        {
+            newStage  = VK_PIPELINE_STAGE_2_COPY_BIT;
+            newAccess = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        }
 
-        bool needOwnershipTransfer = state.lastWriter != -1
+        bool isCrossQueueAccess = state.lastWriter != -1
             && state.lastWriter != pass.index
             && state.currentQueueFamily != pass.targetQueueFamily;
 
+        // buffers shared across queues only need the submission dependency
+        bool needOwnershipTransfer = isCrossQueueAccess && !(resource->buffer->usage & GfxBufferUsageFlags::SharedQueueAccess);
+        if (isCrossQueueAccess)
+        {
+            pass.crossQueueDeps |= 1ULL << state.lastWriter;
+        }
+
         bool addedReleaseBarrier = false;
         bool addedAcquireBarrier = false;
 
@@ -898,7 +1086,7 @@ void RenderGraph::buildWriteBufferResourcesState(RGNode& pass)
 
             oldPass.postBufferBarriers.push_back(release);
 
-            pass.crossQueueDeps = 1ULL << state.lastWriter; // ensure submit happens between release and acquire
+            pass.crossQueueDeps |= 1ULL << state.lastWriter; // ensure submit happens between release and acquire
 
             addedReleaseBarrier = true;
         }
@@ -906,11 +1094,13 @@ void RenderGraph::buildWriteBufferResourcesState(RGNode& pass)
         // emit barrier if access or stage flags have changed
         if (state.stage != newStage || state.access != newAccess)
         {
+            // writes of other queues are made visible by the semaphore wait, their
+            // stages may not even be supported on this queue
             VkBufferMemoryBarrier2 barrier { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
-            barrier.srcStageMask  = state.stage;
+            barrier.srcStageMask  = isCrossQueueAccess ? VK_PIPELINE_STAGE_2_NONE : state.stage;
             barrier.dstStageMask  = newStage;
 
-            barrier.srcAccessMask = state.access;
+            barrier.srcAccessMask = isCrossQueueAccess ? VK_ACCESS_2_NONE : state.access;
             barrier.dstAccessMask = newAccess;
 
             barrier.buffer        = resource->buffer->vkBuffer.buffer;
@@ -953,17 +1143,34 @@ void RenderGraph::buildReadBufferResourcesState(RGNode& pass)
         VkPipelineStageFlags2 newStage  = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
         VkAccessFlags2        newAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
 
-        if (resource->buffer->usage & GfxBufferUsageFlags::IndirectBuffer)
+        if (pass.targetQueueFamily == RGQueueFamilyType::Transfer)
+        {
+            newStage  = VK_PIPELINE_STAGE_2_COPY_BIT;
+            newAccess = VK_ACCESS_2_TRANSFER_READ_BIT;
+        }
+        else if (resource->buffer->usage & GfxBufferUsageFlags::IndirectBuffer)
         {
             newStage  = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
             newAccess = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
         }
+        else if (resource->buffer->usage & (GfxBufferUsageFlags::StorageBuffer | GfxBufferUsageFlags::UniformBuffer))
+        {
+            newStage  = pass.isCompute ? VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+            newAccess = VK_ACCESS_2_SHADER_READ_BIT;
+        }
 
         // handle ownership transfer for Write -> Read cases across different queue families
-        bool needOwnershipTransfer = state.lastWriter != -1
+        bool isCrossQueueAccess = state.lastWriter != -1
             && state.lastWriter != pass.index
             && state.currentQueueFamily != pass.targetQueueFamily;
 
+        // buffers shared across queues only need the submission dependency
+        bool needOwnershipTransfer = isCrossQueueAccess && !(resource->buffer->usage & GfxBufferUsageFlags::SharedQueueAccess);
+        if (isCrossQueueAccess)
+        {
+            pass.crossQueueDeps |= 1ULL << state.lastWriter;
+        }
+
         bool addedReleaseBarrier = false;
         bool addedAcquireBarrier = false;
 
@@ -991,7 +1198,7 @@ void RenderGraph::buildReadBufferResourcesState(RGNode& pass)
 
             oldPass.postBufferBarriers.push_back(release);
 
-            pass.crossQueueDeps = 1ULL << state.lastWriter; // ensure submit happens between release and acquire
+            pass.crossQueueDeps |= 1ULL << state.lastWriter; // ensure submit happens between release and acquire
 
             addedReleaseBarrier = true;
         }
@@ -999,11 +1206,13 @@ void RenderGraph::buildReadBufferResourcesState(RGNode& pass)
         // emit barrier if access or stage flags have changed
         if (state.stage != newStage || state.access != newAccess)
         {
+            // writes of other queues are made visible by the semaphore wait, their
+            // stages may not even be supported on this queue
             VkBufferMemoryBarrier2 barrier { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
-            barrier.srcStageMask  = state.stage;
+            barrier.srcStageMask  = isCrossQueueAccess ? VK_PIPELINE_STAGE_2_NONE : state.stage;
             barrier.dstStageMask  = newStage;
 
-            barrier.srcAccessMask = state.access;
+            barrier.srcAccessMask = isCrossQueueAccess ? VK_ACCESS_2_NONE : state.access;
             barrier.dstAccessMask = newAccess;
 
             barrier.buffer        = resource->buffer->vkBuffer.buffer; // TODO: WTF is this?
@@ -1055,7 +1264,8 @@ void RenderGraph::beginPass(const FrameData& frameData, RGNode& pass, VkCommandB
 {
     DUSK_PROFILE_SECTION("begin_pass");
 
-    if (pass.isCompute) return;
+    // dispatches and copies are recorded outside of a rendering scope
+    if (pass.isCompute || pass.targetQueueFamily == RGQueueFamilyType::Transfer) return;
 
     // TODO:: VkRenderingAttachmentInfo can be prepared earlier in buildResourceStates
     VkRenderingInfo                         renderingInfo        = {};
@@ -1064,13 +1274,17 @@ void RenderGraph::beginPass(const FrameData& frameData, RGNode& pass, VkCommandB
     VkRenderingAttachmentInfo               depthAttachmentInfo  = {};
 
     // depth attachment
-    bool     useDepth       = pass.depthResource.has_value();
-    uint32_t depthTextureId = 0u;
+    bool       useDepth       = pass.depthResource.has_value();
+    uint32_t   depthTextureId = 0u;
+
+    // render area follows the attachments, they may not match the swapchain
+    VkExtent2D renderExtent   = { frameData.width, frameData.height };
 
     if (useDepth)
     {
         auto* depthTexture              = pass.depthResource.value()->texture;
         depthTextureId                  = depthTexture->id;
+        renderExtent                    = getRenderArea(*pass.depthResource.value());
         const auto& lsState             = pass.resourceLoadStoreStates[depthTextureId];
 
         depthAttachmentInfo             = { VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
@@ -1106,11 +1320,13 @@ void RenderGraph::beginPass(const FrameData& frameData, RGNode& pass, VkCommandB
         colorAttachmentInfos.push_back(colorAttachment);
 
         colorFormats.push_back(texture->format);
+
+        if (!useDepth) renderExtent = getRenderArea(*resource);
     }
 
     renderingInfo                      = { VK_STRUCTURE_TYPE_RENDERING_INFO };
     renderingInfo.layerCount           = 1;
-    renderingInfo.renderArea           = { { 0, 0 }, { frameData.width, frameData.height } };
+    renderingInfo.renderArea           = { { 0, 0 }, renderExtent };
     renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentInfos.size());
     renderingInfo.pColorAttachments    = colorAttachmentInfos.data();
     renderingInfo.pDepthAttachment     = useDepth ? &depthAttachmentInfo : nullptr;
@@ -1126,15 +1342,15 @@ void RenderGraph::beginPass(const FrameData& frameData, RGNode& pass, VkCommandB
     VkViewport viewport {};
     viewport.x        = 0.0f;
     viewport.y        = 0.0f;
-    viewport.width    = static_cast<float>(frameData.width);
-    viewport.height   = static_cast<float>(frameData.height);
+    viewport.width    = static_cast<float>(renderExtent.width);
+    viewport.height   = static_cast<float>(renderExtent.height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
     vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
 
     VkRect2D scissor {};
     scissor.offset = { 0, 0 };
-    scissor.extent = { frameData.width, frameData.height };
+    scissor.extent = renderExtent;
     vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
 }
 
@@ -1142,7 +1358,7 @@ void RenderGraph::endPass(const FrameData& frameData, RGNode& pass, VkCommandBuf
 {
     DUSK_PROFILE_SECTION("end_pass");
 
-    if (pass.isCompute) return;
+    if (pass.isCompute || pass.targetQueueFamily == RGQueueFamilyType::Transfer) return;
 
     vkCmdEndRendering(cmdBuffer);
 }
@@ -1164,7 +1380,8 @@ void RenderGraph::dumpDebugGraph(const std::string& path) const
         const auto&      pass = m_passes[m_passExecutionOrder[orderIdx]];
 
         DebugGraph::Node node { pass.name };
-        node.isCompute = pass.isCompute;
+        node.isCompute  = pass.isCompute;
+        node.isTransfer = pass.targetQueueFamily == RGQueueFamilyType::Transfer;
 
         for (uint32_t readIdx = 0u; readIdx < pass.readTextureResources.size(); ++readIdx)
         {
@@ -1252,6 +1469,27 @@ void RenderGraph::dumpDebugGraph(const std::string& path) const
         graph.computeBatches.push_back(batch);
     }
 
+    for (uint32_t batchIdx = 0u; batchIdx < m_submissionOrder.transferBatches.size(); ++batchIdx)
+    {
+        DebugGraph::Batch batch  = {};
+        uint64_t          passes = m_submissionOrder.transferBatches[batchIdx].passesMask;
+
+        batch.signalValue        = m_submissionOrder.transferBatches[batchIdx].signalValue;
+        batch.waitValue          = m_submissionOrder.transferBatches[batchIdx].waitValue;
+
+        if (passes == 0) continue;
+
+        while (passes)
+        {
+            uint32_t passIdx = std::countr_zero(passes);
+            passes &= passes - 1;
+
+            batch.nodes.push_back(passIdxtoOrderMap[passIdx]);
+        }
+
+        graph.transferBatches.push_back(batch);
+    }
+
     auto& executor = Engine::get().getTfExecutor();
     executor.silent_async(
         [path, graph]()
@@ -1492,6 +1730,46 @@ void DebugGraph::exportSubmissionDot(const char* path) const
     dotFile << "}\n";
     dotFile << "\n";
 
+    if (!transferBatches.empty())
+    {
+        dotFile << "subgraph cluster_transfers {\n";
+        dotFile << "label=\"Transfer Queue\";\n";
+        dotFile << "style=dotted; \n";
+
+        for (uint32_t batchIdx = 0u; batchIdx < transferBatches.size(); ++batchIdx)
+        {
+            const auto& batch = transferBatches[batchIdx];
+
+            dotFile << "subgraph cluster_transfer_batch_" << batchIdx << " {\n";
+            dotFile << "label=\"Transfer Batch #" << batchIdx << "\n wait=" << batch.waitValue << " signal=" << batch.signalValue << "\";\n";
+            dotFile << "style=dashed; \n";
+
+            for (uint32_t i = 0u; i < batch.nodes.size(); ++i)
+            {
+                uint32_t          nodeIdx = batch.nodes[i];
+                const auto&       node    = nodes[nodeIdx];
+
+                std::stringstream label;
+                label << node.name << "\\n";
+
+                if (!node.writes.empty())
+                {
+                    label << "W: ";
+                    for (auto& w : node.writes) label << w << " ";
+                }
+
+                dotFile << "node_" << nodeIdx
+                        << " [label=\"" << label.str() << "\""
+                        << ", fillcolor=\"khaki\"]; \n";
+            }
+
+            dotFile << "}\n";
+        }
+
+        dotFile << "}\n";
+        dotFile << "\n";
+    }
+
     dotFile << "{rank=same; " << firstGraphicNodeId << "; " << firstComputeNodeId << ";}\n";
 
     for (uint32_t edgeIdx = 0u; edgeIdx < edges.size(); ++edgeIdx)
@@ -33,6 +33,14 @@ enum class RGQueueFamilyType : uint32_t
     Transfer,
 };
 
+// scheduling hint of a pass among the passes which are ready at the same time
+enum class RGPassPriority : uint32_t
+{
+    Low,
+    Normal,
+    High,
+};
+
 struct RGImageExecState
 {
     int32_t               firstWriter        = -1;
@@ -45,10 +53,12 @@ struct RGImageExecState
 
 struct RGImageResource
 {
-    std::string name    = "";
-    GfxTexture* texture = nullptr;
-    uint64_t    writers = {}; // Note: bitset assumption is max 64 passes
-    uint64_t    readers = {}; // Note: bitset assumption is max 64 passes
+    std::string name             = "";
+    GfxTexture* texture          = nullptr;
+    uint64_t    writers          = {};    // Note: bitset assumption is max 64 passes
+    uint64_t    readers          = {};    // Note: bitset assumption is max 64 passes
+    bool        preserveContents = false; // contents carry over frames, first writer loads instead of clearing
+    VkExtent2D  renderArea       = {};    // drawn region of the texture, whole texture when empty
 };
 
 struct RGBufferExecState
@@ -104,30 +114,37 @@ struct RGNode
 
     uint32_t                             waitValue          = 0u;
     uint32_t                             signalValue        = 0u;
+
+    // inputs of the cross queue overlap scheduling
+    RGPassPriority                       priority        = RGPassPriority::Normal;
+    float                                estimatedCostNs = 0.f; // gpu time from previous frames
 };
 
 struct SubmissionBatch
 {
-    uint64_t passesMask  = 0u; // bitmask of passes in the batch
-    uint32_t waitValue   = 0u;
-    uint32_t signalValue = 0u;
+    uint64_t passesMask        = 0u; // bitmask of passes in the batch
+    uint32_t waitValue         = 0u;
+    uint32_t signalValue       = 0u;
+    uint32_t transferWaitValue = 0u; // wait on transfer timeline, signals of transfer batches go there
 };
 
 struct RGSubmissionOrder
 {
-    uint64_t                      batchMask      = 0u; // passes that have been submitted in previous batches
-    DynamicArray<SubmissionBatch> graphicBatches = {};
-    DynamicArray<SubmissionBatch> computeBatches = {};
+    uint64_t                      batchMask       = 0u; // passes that have been submitted in previous batches
+    DynamicArray<SubmissionBatch> graphicBatches  = {};
+    DynamicArray<SubmissionBatch> computeBatches  = {};
+    DynamicArray<SubmissionBatch> transferBatches = {};
 };
 
 struct DebugGraph
 {
     struct Node
     {
-        std::string               name      = "";
-        DynamicArray<std::string> reads     = {};
-        DynamicArray<std::string> writes    = {};
-        bool                      isCompute = false;
+        std::string               name       = "";
+        DynamicArray<std::string> reads      = {};
+        DynamicArray<std::string> writes     = {};
+        bool                      isCompute  = false;
+        bool                      isTransfer = false;
     };
 
     struct Edge
@@ -148,6 +165,7 @@ struct DebugGraph
 
     DynamicArray<Batch> graphicBatches    = {};
     DynamicArray<Batch> computeBatches    = {};
+    DynamicArray<Batch> transferBatches   = {};
 
     uint32_t            graphicNodesCount = 0u;
     uint32_t            computeNodesCount = 0u;
@@ -235,6 +253,15 @@ public:
      */
     void markAsCompute(uint32_t passId);
 
+    /**
+     * @brief Set scheduling priority of a pass. High priority passes are scheduled first
+     * among the ready passes of their queue and are never delayed for overlapping with
+     * async compute work.
+     * @param passId Handle of the pass.
+     * @param priority of the pass.
+     */
+    void setPassPriority(uint32_t passId, RGPassPriority priority);
+
     /**
      * @brief Marks a pass as final, indicating presentation will happen after this pass.
      * @param passId
@@ -262,6 +289,22 @@ private:
      */
     void buildExecutionOrder();
 
+    /**
+     * @brief Pick next pass in the execution order from the ready passes. Compute passes
+     * are picked as soon as they are ready and graphics passes waiting on compute results
+     * are delayed until the estimated compute cost is covered by independent graphics work.
+     * @param readyPasses bitset of passes with all dependencies scheduled
+     * @param computePasses bitset of passes targeting compute queue
+     * @param pendingComputePasses bitset of scheduled compute passes not yet waited on by graphics
+     * @param pendingComputeCostNs estimated cost of compute work not yet overlapped
+     * @return index of the picked pass
+     */
+    uint32_t pickNextPass(
+        uint64_t readyPasses,
+        uint64_t computePasses,
+        uint64_t pendingComputePasses,
+        float    pendingComputeCostNs) const;
+
     /**
      * @brief Generates barriers and load/store states for all resources.
      * as per execution order.
@@ -273,6 +316,27 @@ private:
      */
     void buildSubmissionBatches();
 
+    /**
+     * @brief Get submission batches of the given queue family.
+     * @param queueFamily type
+     * @return array of batches
+     */
+    DynamicArray<SubmissionBatch>& getQueueBatches(RGQueueFamilyType queueFamily);
+
+    /**
+     * @brief Record all the passes of a batch in a new command buffer.
+     * @param frameData
+     * @param batch to record
+     * @param queueFamily type of the queue executing the batch
+     * @param cmdBufferPool pool to get the command buffer from
+     * @return backend submit batch for the recorded command buffer
+     */
+    VulkanSubmitBatch recordBatch(
+        const FrameData&       frameData,
+        const SubmissionBatch& batch,
+        RGQueueFamilyType      queueFamily,
+        VulkanCmdBufferPool*   cmdBufferPool);
+
     /**
      * @brief Genrate barriers and load/store states for write image resources of the pass.
      * @param pass reference
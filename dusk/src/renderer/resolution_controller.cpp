@@ -0,0 +1,86 @@
+#include "resolution_controller.h"
+
+namespace dusk
+{
+// render scale changes in coarse steps, every change resizes the render targets
+static constexpr float RENDER_SCALE_STEP = 0.05f;
+static constexpr float LOD_BIAS_STEP     = 0.5f;
+
+void ResolutionController::init(const Config& config)
+{
+    DASSERT(config.minRenderScale <= config.maxRenderScale, "Render scale bounds are inverted");
+    DASSERT(config.lowerThreshold < config.upperThreshold, "Thresholds need a gap for hysteresis");
+
+    m_config               = config;
+    m_settings             = {};
+    m_settings.renderScale = config.maxRenderScale;
+    m_cooldownFrames       = 0u;
+}
+
+bool ResolutionController::update(TimeStepNs gpuFrameTime)
+{
+    if (m_cooldownFrames > 0u)
+    {
+        --m_cooldownFrames;
+        return false;
+    }
+
+    float targetTimeNs = std::chrono::duration_cast<TimeStepNs>(m_config.targetGpuFrameTime).count();
+    if (targetTimeNs <= 0.f || gpuFrameTime.count() <= 0.f) return false;
+
+    ResolutionSettings prevSettings = m_settings;
+    float              load         = gpuFrameTime.count() / targetTimeNs;
+
+    if (load > m_config.upperThreshold)
+    {
+        lowerQuality(load);
+    }
+    else if (load < m_config.lowerThreshold)
+    {
+        raiseQuality();
+    }
+
+    if (m_settings == prevSettings) return false;
+
+    m_cooldownFrames = m_config.cooldownFrames;
+    return true;
+}
+
+void ResolutionController::lowerQuality(float load)
+{
+    if (m_settings.renderScale > m_config.minRenderScale)
+    {
+        // cost of the render targets follows their pixel count, scale jumps close
+        // to the target at once but always by at least one step
+        float scale            = m_settings.renderScale * glm::sqrt(m_config.upperThreshold / load);
+        scale                  = glm::floor(scale / RENDER_SCALE_STEP + 0.001f) * RENDER_SCALE_STEP;
+        m_settings.renderScale = glm::max(glm::min(scale, m_settings.renderScale - RENDER_SCALE_STEP), m_config.minRenderScale);
+    }
+    else if (m_settings.shadowScale > m_config.minShadowScale)
+    {
+        // atlas tiles are power of two
+        m_settings.shadowScale = glm::max(m_settings.shadowScale * 0.5f, m_config.minShadowScale);
+    }
+    else if (m_settings.textureLodBias < m_config.maxTextureLodBias)
+    {
+        m_settings.textureLodBias = glm::min(m_settings.textureLodBias + LOD_BIAS_STEP, m_config.maxTextureLodBias);
+    }
+}
+
+void ResolutionController::raiseQuality()
+{
+    // single steps up, lower threshold leaves room for the cost of one step
+    if (m_settings.textureLodBias > 0.f)
+    {
+        m_settings.textureLodBias = glm::max(m_settings.textureLodBias - LOD_BIAS_STEP, 0.f);
+    }
+    else if (m_settings.shadowScale < 1.f)
+    {
+        m_settings.shadowScale = glm::min(m_settings.shadowScale * 2.f, 1.f);
+    }
+    else if (m_settings.renderScale < m_config.maxRenderScale)
+    {
+        m_settings.renderScale = glm::min(m_settings.renderScale + RENDER_SCALE_STEP, m_config.maxRenderScale);
+    }
+}
+} // namespace dusk
\ No newline at end of file
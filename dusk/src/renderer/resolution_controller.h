@@ -0,0 +1,102 @@
+#pragma once
+
+#include "dusk.h"
+
+#include "core/dtime.h"
+
+namespace dusk
+{
+/**
+ * @brief Quality settings which are traded for GPU time
+ */
+struct ResolutionSettings
+{
+    float renderScale    = 1.f; // render targets relative to the swapchain
+    float shadowScale    = 1.f; // largest shadow atlas tile relative to its full size
+    float textureLodBias = 0.f; // added to the mip level of material textures
+
+    bool  operator==(const ResolutionSettings&) const = default;
+};
+
+/**
+ * @brief Feedback controller holding the smoothed GPU frame time at a target.
+ * Over the budget render resolution is lowered first, then shadow resolution
+ * and then texture detail, under the budget they are raised in reverse order.
+ * Times between the two thresholds don't change anything and every change is
+ * followed by a cooldown in which the smoothed time settles, which keeps the
+ * settings from oscillating.
+ */
+class ResolutionController
+{
+public:
+    struct Config
+    {
+        TimeStep      targetGpuFrameTime;
+        float         minRenderScale;
+        float         maxRenderScale;
+        float         minShadowScale;
+        float         maxTextureLodBias;
+        float         upperThreshold; // fraction of the target above which quality is lowered
+        float         lowerThreshold; // fraction of the target below which quality is raised
+        uint32_t      cooldownFrames; // frames to skip after a change
+
+        static Config defaultConfig()
+        {
+            auto config               = Config {};
+            config.targetGpuFrameTime = TimeStep(1.f / 60.f);
+            config.minRenderScale     = 0.5f;
+            config.maxRenderScale     = 1.f;
+            config.minShadowScale     = 0.25f;
+            config.maxTextureLodBias  = 1.f;
+            config.upperThreshold     = 0.95f;
+            config.lowerThreshold     = 0.75f;
+            config.cooldownFrames     = 60u;
+            return config;
+        }
+    };
+
+public:
+    ResolutionController()  = default;
+    ~ResolutionController() = default;
+
+    /**
+     * @brief Reset the controller to the highest quality within the bounds
+     * @param config with the target time and the bounds of the settings
+     */
+    void                      init(const Config& config);
+
+    /**
+     * @brief Step the settings towards the target time
+     * @param gpuFrameTime smoothed GPU time of the recent frames
+     * @return true if the settings were changed
+     */
+    bool                      update(TimeStepNs gpuFrameTime);
+
+    /**
+     * @brief Get the current settings
+     */
+    const ResolutionSettings& getSettings() const { return m_settings; }
+
+    /**
+     * @brief Get the target time and the bounds of the settings
+     */
+    const Config&             getConfig() const { return m_config; }
+
+private:
+    /**
+     * @brief Lower the first setting which is not at its bound yet
+     * @param load ratio of the GPU time to the target
+     */
+    void lowerQuality(float load);
+
+    /**
+     * @brief Raise the last lowered setting which is not at its bound yet
+     */
+    void raiseQuality();
+
+private:
+    Config             m_config         = Config::defaultConfig();
+    ResolutionSettings m_settings       = {};
+    uint32_t           m_cooldownFrames = 0u;
+};
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "shadow_atlas.h"
+
+#include <bit>
+
+namespace dusk
+{
+void ShadowAtlas::init(uint32_t resolution, uint32_t minTileSize)
+{
+    DASSERT(std::has_single_bit(resolution) && std::has_single_bit(minTileSize), "Atlas sizes should be power of two");
+
+    m_resolution  = resolution;
+    m_minTileSize = minTileSize;
+    m_freeTexels  = static_cast<uint64_t>(resolution) * resolution;
+
+    m_nodes.clear();
+    m_freeGroups.clear();
+
+    m_nodes.push_back({ .size = resolution });
+}
+
+bool ShadowAtlas::allocate(uint32_t size, ShadowAtlasTile* outTile)
+{
+    DASSERT(outTile, "Not a valid pointer");
+
+    size = glm::max(std::bit_ceil(size), m_minTileSize);
+    if (m_nodes.empty() || size > m_resolution) return false;
+
+    int32_t nodeIdx = findFreeNode(0, size);
+    if (nodeIdx == -1) return false;
+
+    // first quadrant is taken on every split, others stay free for same sized tiles
+    while (m_nodes[nodeIdx].size > size)
+    {
+        splitNode(nodeIdx);
+        nodeIdx = m_nodes[nodeIdx].firstChild;
+    }
+
+    Node& node = m_nodes[nodeIdx];
+    node.state = NodeState::Allocated;
+
+    m_freeTexels -= static_cast<uint64_t>(size) * size;
+
+    *outTile = { .x = node.x, .y = node.y, .size = node.size, .node = nodeIdx };
+
+    return true;
+}
+
+void ShadowAtlas::free(ShadowAtlasTile& tile)
+{
+    if (!tile.isValid()) return;
+
+    DASSERT(m_nodes[tile.node].state == NodeState::Allocated, "Tile is not allocated");
+
+    int32_t parentIdx        = m_nodes[tile.node].parent;
+    m_nodes[tile.node].state = NodeState::Free;
+
+    m_freeTexels += static_cast<uint64_t>(tile.size) * tile.size;
+    tile = {};
+
+    // merge quadrants back into their parent while all of them are free
+    while (parentIdx != -1)
+    {
+        Node& parent = m_nodes[parentIdx];
+        for (int32_t childIdx = 0; childIdx < 4; ++childIdx)
+        {
+            if (m_nodes[parent.firstChild + childIdx].state != NodeState::Free) return;
+        }
+
+        m_freeGroups.push_back(parent.firstChild);
+
+        parent.firstChild = -1;
+        parent.state      = NodeState::Free;
+        parentIdx         = parent.parent;
+    }
+}
+
+int32_t ShadowAtlas::findFreeNode(int32_t nodeIdx, uint32_t size) const
+{
+    const Node& node = m_nodes[nodeIdx];
+
+    if (node.size < size || node.state == NodeState::Allocated) return -1;
+
+    if (node.state == NodeState::Free) return nodeIdx;
+
+    // best fit among the quadrants, exact size can't be improved upon
+    int32_t bestIdx = -1;
+    for (int32_t childIdx = 0; childIdx < 4; ++childIdx)
+    {
+        int32_t foundIdx = findFreeNode(node.firstChild + childIdx, size);
+        if (foundIdx == -1) continue;
+
+        if (bestIdx == -1 || m_nodes[foundIdx].size < m_nodes[bestIdx].size)
+        {
+            bestIdx = foundIdx;
+        }
+
+        if (m_nodes[bestIdx].size == size) break;
+    }
+
+    return bestIdx;
+}
+
+void ShadowAtlas::splitNode(int32_t nodeIdx)
+{
+    int32_t firstChild = static_cast<int32_t>(m_nodes.size());
+    if (!m_freeGroups.empty())
+    {
+        firstChild = m_freeGroups.back();
+        m_freeGroups.pop_back();
+    }
+    else
+    {
+        m_nodes.resize(m_nodes.size() + 4);
+    }
+
+    Node&    node     = m_nodes[nodeIdx];
+    uint32_t halfSize = node.size / 2;
+
+    for (uint32_t childIdx = 0u; childIdx < 4u; ++childIdx)
+    {
+        m_nodes[firstChild + childIdx] = {
+            .x      = node.x + (childIdx & 1u) * halfSize,
+            .y      = node.y + (childIdx >> 1u) * halfSize,
+            .size   = halfSize,
+            .parent = nodeIdx
+        };
+    }
+
+    node.firstChild = firstChild;
+    node.state      = NodeState::Split;
+}
+} // namespace dusk
\ No newline at end of file
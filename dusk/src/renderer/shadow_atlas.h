@@ -0,0 +1,93 @@
+#pragma once
+
+#include "dusk.h"
+
+namespace dusk
+{
+/**
+ * @brief Square region of the shadow atlas in texels
+ */
+struct ShadowAtlasTile
+{
+    uint32_t x    = 0u;
+    uint32_t y    = 0u;
+    uint32_t size = 0u;
+    int32_t  node = -1; // quadtree node owning the region
+
+    bool     isValid() const { return node != -1; }
+};
+
+/**
+ * @brief Quadtree sub-allocator for square power of two tiles of a shadow
+ * atlas. A node is either free, allocated or split in four quadrants, freed
+ * quadrants are merged back into their parent. Allocator only does the
+ * bookkeeping, no texture is owned by it.
+ */
+class ShadowAtlas
+{
+public:
+    ShadowAtlas()  = default;
+    ~ShadowAtlas() = default;
+
+    /**
+     * @brief Reset the allocator with a single free node covering the atlas
+     * @param resolution of the atlas, power of two
+     * @param minTileSize smallest tile which can be allocated, power of two
+     */
+    void init(uint32_t resolution, uint32_t minTileSize);
+
+    /**
+     * @brief Allocate a tile, smallest free node which fits is split down to the
+     * tile size to keep large regions intact
+     * @param size of the tile in texels, rounded up to a power of two
+     * @param outTile allocated tile
+     * @return true if allocation was successful
+     */
+    bool allocate(uint32_t size, ShadowAtlasTile* outTile);
+
+    /**
+     * @brief Release a previously allocated tile. Free sibling nodes are merged.
+     * @param tile to release, invalidated after the call
+     */
+    void free(ShadowAtlasTile& tile);
+
+    /**
+     * @brief Get resolution of the atlas
+     */
+    uint32_t getResolution() const { return m_resolution; }
+
+    /**
+     * @brief Get texels which are not allocated, which might not be contiguous
+     */
+    uint64_t getFreeTexels() const { return m_freeTexels; }
+
+private:
+    enum class NodeState : uint8_t
+    {
+        Free,
+        Allocated,
+        Split
+    };
+
+    struct Node
+    {
+        uint32_t  x          = 0u;
+        uint32_t  y          = 0u;
+        uint32_t  size       = 0u;
+        int32_t   parent     = -1;
+        int32_t   firstChild = -1; // quadrants are stored next to each other
+        NodeState state      = NodeState::Free;
+    };
+
+    int32_t findFreeNode(int32_t nodeIdx, uint32_t size) const;
+    void    splitNode(int32_t nodeIdx);
+
+private:
+    uint32_t              m_resolution  = 0u;
+    uint32_t              m_minTileSize = 0u;
+    uint64_t              m_freeTexels  = 0u;
+
+    DynamicArray<Node>    m_nodes       = {};
+    DynamicArray<int32_t> m_freeGroups  = {}; // first nodes of released quadrants, reused on next split
+};
+} // namespace dusk
\ No newline at end of file
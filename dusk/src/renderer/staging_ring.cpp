@@ -0,0 +1,232 @@
+#include "staging_ring.h"
+
+#include "debug/profiler.h"
+
+#include "backend/vulkan/vk.h"
+#include "backend/vulkan/vk_device.h"
+
+#include <format>
+
+namespace dusk
+{
+bool StagingRing::init()
+{
+    auto& ctx = VkGfxDevice::getSharedVulkanContext();
+
+    m_stagingBuffer.init(
+        GfxBufferUsageFlags::TransferSource,
+        STAGING_RING_CHUNK_SIZE * STAGING_RING_CHUNK_COUNT,
+        GfxBufferMemoryTypeFlags::PersistentlyMapped | GfxBufferMemoryTypeFlags::HostSequentialWrite,
+        "staging_ring_buffer");
+
+    CHECK_AND_RETURN_FALSE(!m_stagingBuffer.isAllocated());
+
+    VkCommandBuffer cmdBuffers[STAGING_RING_CHUNK_COUNT];
+
+    VkCommandBufferAllocateInfo allocInfo { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool        = ctx.transferCommandPool;
+    allocInfo.commandBufferCount = STAGING_RING_CHUNK_COUNT;
+
+    VulkanResult result          = vkAllocateCommandBuffers(ctx.device, &allocInfo, cmdBuffers);
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to allocate staging ring command buffers {}", result.toString());
+        return false;
+    }
+
+    VkFenceCreateInfo fenceInfo { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+
+    for (uint32_t chunkIndex = 0u; chunkIndex < STAGING_RING_CHUNK_COUNT; ++chunkIndex)
+    {
+        Chunk& chunk    = m_chunks[chunkIndex];
+        chunk.cmdBuffer = cmdBuffers[chunkIndex];
+
+        result          = vkCreateFence(ctx.device, &fenceInfo, nullptr, &chunk.fence);
+        if (result.hasError())
+        {
+            DUSK_ERROR("Unable to create staging ring fence {}", result.toString());
+            return false;
+        }
+
+#ifdef VK_RENDERER_DEBUG
+        vkdebug::setObjectName(
+            ctx.device,
+            VK_OBJECT_TYPE_COMMAND_BUFFER,
+            (uint64_t)chunk.cmdBuffer,
+            std::format("staging_ring_cmd_buff_{}", chunkIndex).c_str());
+
+        vkdebug::setObjectName(
+            ctx.device,
+            VK_OBJECT_TYPE_FENCE,
+            (uint64_t)chunk.fence,
+            std::format("staging_ring_fence_{}", chunkIndex).c_str());
+#endif // VK_RENDERER_DEBUG
+    }
+
+    m_currentChunk = 0u;
+
+    return true;
+}
+
+void StagingRing::cleanup()
+{
+    auto& ctx = VkGfxDevice::getSharedVulkanContext();
+
+    flush();
+
+    for (auto& chunk : m_chunks)
+    {
+        if (chunk.cmdBuffer != VK_NULL_HANDLE)
+        {
+            vkFreeCommandBuffers(ctx.device, ctx.transferCommandPool, 1, &chunk.cmdBuffer);
+        }
+
+        if (chunk.fence != VK_NULL_HANDLE)
+        {
+            vkDestroyFence(ctx.device, chunk.fence, nullptr);
+        }
+
+        chunk = {};
+    }
+
+    m_stagingBuffer.cleanup();
+}
+
+Error StagingRing::upload(
+    const void* data,
+    size_t      size,
+    GfxBuffer&  dstBuffer,
+    size_t      dstOffset)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    DASSERT(dstOffset + size <= dstBuffer.getSizeInBytes(), "Upload is outside of the destination buffer");
+
+    const uint8_t* srcData   = static_cast<const uint8_t*>(data);
+    size_t         remaining = size;
+
+    while (remaining > 0)
+    {
+        Chunk& chunk = m_chunks[m_currentChunk];
+
+        if (!chunk.recording)
+        {
+            Error err = beginChunk(chunk);
+            if (err != Error::Ok) return err;
+        }
+
+        size_t available = STAGING_RING_CHUNK_SIZE - chunk.usedSize;
+        if (available == 0)
+        {
+            Error err = submitChunk(chunk);
+            if (err != Error::Ok) return err;
+
+            m_currentChunk = (m_currentChunk + 1) % STAGING_RING_CHUNK_COUNT;
+            continue;
+        }
+
+        size_t copySize      = std::min(available, remaining);
+        size_t stagingOffset = m_currentChunk * STAGING_RING_CHUNK_SIZE + chunk.usedSize;
+
+        m_stagingBuffer.writeAndFlush(stagingOffset, (void*)srcData, copySize);
+
+        VkBufferCopy copyRegion {};
+        copyRegion.srcOffset = stagingOffset;
+        copyRegion.dstOffset = dstOffset;
+        copyRegion.size      = copySize;
+        vkCmdCopyBuffer(chunk.cmdBuffer, m_stagingBuffer.vkBuffer.buffer, dstBuffer.vkBuffer.buffer, 1, &copyRegion);
+
+        chunk.usedSize += copySize;
+        srcData += copySize;
+        dstOffset += copySize;
+        remaining -= copySize;
+    }
+
+    return Error::Ok;
+}
+
+void StagingRing::flush()
+{
+    DUSK_PROFILE_FUNCTION;
+
+    Chunk& currentChunk = m_chunks[m_currentChunk];
+    if (currentChunk.recording)
+    {
+        if (currentChunk.usedSize > 0)
+        {
+            submitChunk(currentChunk);
+            m_currentChunk = (m_currentChunk + 1) % STAGING_RING_CHUNK_COUNT;
+        }
+        else
+        {
+            vkEndCommandBuffer(currentChunk.cmdBuffer);
+            currentChunk.recording = false;
+        }
+    }
+
+    for (auto& chunk : m_chunks)
+    {
+        waitChunk(chunk);
+    }
+}
+
+Error StagingRing::beginChunk(Chunk& chunk)
+{
+    // chunk memory can only be reused once its previous copies are done
+    waitChunk(chunk);
+
+    VkCommandBufferBeginInfo beginInfo { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    beginInfo.flags     = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    VulkanResult result = vkBeginCommandBuffer(chunk.cmdBuffer, &beginInfo);
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to begin staging ring command buffer {}", result.toString());
+        return result.getErrorId();
+    }
+
+    chunk.usedSize  = 0u;
+    chunk.recording = true;
+
+    return Error::Ok;
+}
+
+Error StagingRing::submitChunk(Chunk& chunk)
+{
+    auto& ctx = VkGfxDevice::getSharedVulkanContext();
+
+    vkEndCommandBuffer(chunk.cmdBuffer);
+    chunk.recording = false;
+
+    VkSubmitInfo submitInfo {};
+    submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers    = &chunk.cmdBuffer;
+
+    VulkanResult result           = vkQueueSubmit(ctx.transferQueue, 1, &submitInfo, chunk.fence);
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to submit staging ring copies {}", result.toString());
+        return result.getErrorId();
+    }
+
+    chunk.inFlight = true;
+
+    return Error::Ok;
+}
+
+void StagingRing::waitChunk(Chunk& chunk)
+{
+    if (!chunk.inFlight) return;
+
+    DUSK_PROFILE_SECTION("staging_ring_wait");
+
+    auto& ctx = VkGfxDevice::getSharedVulkanContext();
+
+    vkWaitForFences(ctx.device, 1, &chunk.fence, VK_TRUE, UINT64_MAX);
+    vkResetFences(ctx.device, 1, &chunk.fence);
+
+    chunk.inFlight = false;
+}
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "dusk.h"
+#include "gfx_buffer.h"
+#include "backend/vulkan/vk_types.h"
+
+namespace dusk
+{
+// staging memory is split in chunks, so cpu can fill a chunk while
+// previous chunks are being copied on the transfer queue
+constexpr uint32_t STAGING_RING_CHUNK_COUNT = 4u;
+constexpr size_t   STAGING_RING_CHUNK_SIZE  = 16 * 1024 * 1024;
+
+/**
+ * @brief Persistent staging ring for streaming data into device local buffers
+ * on the transfer queue. Uploads of any size are split into chunks and only
+ * block when all the chunks are in flight. Destination buffers should be
+ * created with GfxBufferUsageFlags::SharedQueueAccess as no queue ownership
+ * transfer is performed.
+ */
+class StagingRing
+{
+public:
+    StagingRing()  = default;
+    ~StagingRing() = default;
+
+    /**
+     * @brief Create staging buffer, command buffers and fences of the ring
+     * @return true if successful
+     */
+    bool init();
+
+    /**
+     * @brief Wait for pending copies and release all the resources
+     */
+    void cleanup();
+
+    /**
+     * @brief Copy host data into the destination buffer through the ring. Data
+     * is consumed before returning, copy itself completes asynchronously.
+     * @param data source pointer to read from
+     * @param size in bytes to copy
+     * @param dstBuffer destination buffer
+     * @param dstOffset byte offset in the destination buffer
+     * @return Error status of the upload
+     */
+    Error upload(
+        const void* data,
+        size_t      size,
+        GfxBuffer&  dstBuffer,
+        size_t      dstOffset);
+
+    /**
+     * @brief Submit partially filled chunk and wait for all the copies to finish.
+     * Destination ranges can be used by other queues after this call.
+     */
+    void flush();
+
+private:
+    struct Chunk
+    {
+        VkCommandBuffer cmdBuffer = VK_NULL_HANDLE;
+        VkFence         fence     = VK_NULL_HANDLE;
+        size_t          usedSize  = 0u;
+        bool            recording = false;
+        bool            inFlight  = false;
+    };
+
+    Error beginChunk(Chunk& chunk);
+    Error submitChunk(Chunk& chunk);
+    void  waitChunk(Chunk& chunk);
+
+private:
+    GfxBuffer m_stagingBuffer;
+    Chunk     m_chunks[STAGING_RING_CHUNK_COUNT] = {};
+    uint32_t  m_currentChunk                     = 0u;
+};
+} // namespace dusk
\ No newline at end of file
@@ -3,20 +3,118 @@
 #include "scene/scene.h"
 #include "scene/transform_system.h"
 #include "scene/components/lights.h"
+#include "scene/components/camera.h"
 
 #include "renderer/frame_data.h"
+#include "renderer/upload_arena.h"
+#include "renderer/geometry/frustum.h"
 
 #include "debug/profiler.h"
 
 #include "backend/vulkan/vk_device.h"
 #include "backend/vulkan/vk_descriptors.h"
+#include "backend/vulkan/vk_bindless_heap.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <bit>
+
 namespace dusk
 {
 
+// should match LIGHT_INFLUENCE_CUTOFF in clusters.glsl
+static constexpr float LIGHT_INFLUENCE_CUTOFF = 0.01f;
+
+// shadow states of spot lights are keyed by their id with this bit set
+static constexpr uint32_t SPOT_SHADOW_KEY_BIT = 1u << 31;
+
+// cube face directions and up vectors, order should match the face selection in lights.glsl
+static const glm::vec3 CUBE_FACE_DIRECTIONS[6] = {
+    { 1.f, 0.f, 0.f },
+    { -1.f, 0.f, 0.f },
+    { 0.f, 1.f, 0.f },
+    { 0.f, -1.f, 0.f },
+    { 0.f, 0.f, 1.f },
+    { 0.f, 0.f, -1.f }
+};
+static const glm::vec3 CUBE_FACE_UPS[6]        = {
+    { 0.f, 1.f, 0.f },
+    { 0.f, 1.f, 0.f },
+    { 0.f, 0.f, 1.f },
+    { 0.f, 0.f, -1.f },
+    { 0.f, 1.f, 0.f },
+    { 0.f, 1.f, 0.f }
+};
+
+/**
+ * @brief Distance where the attenuated light falls below the influence cutoff,
+ * same as the range used for binning lights on the device
+ */
+static float getLightRange(const glm::vec4& color, float constant, float linear, float quad)
+{
+    float intensity = glm::max(glm::max(color.r, color.g), color.b) * color.w;
+    float target    = intensity / LIGHT_INFLUENCE_CUTOFF;
+
+    if (quad > 0.f)
+        return (-linear + glm::sqrt(glm::max(linear * linear - 4.f * quad * (constant - target), 0.f))) / (2.f * quad);
+
+    if (linear > 0.f)
+        return glm::max(target - constant, 0.f) / linear;
+
+    return std::numeric_limits<float>::max(); // no falloff
+}
+
+/**
+ * @brief Approximate fraction of the screen height covered by a sphere
+ */
+static float getScreenCoverage(const glm::vec3& center, float radius, const glm::vec3& cameraPosition, float tanHalfFovY)
+{
+    float distance = glm::length(center - cameraPosition);
+    if (distance <= radius) return 1.f;
+
+    return glm::min(radius / (distance * tanHalfFovY), 1.f);
+}
+
+static bool isSphereIntersectingAABB(const glm::vec3& center, float radius, const AABB& aabb)
+{
+    glm::vec3 delta = glm::clamp(center, aabb.min, aabb.max) - center;
+    return glm::dot(delta, delta) <= radius * radius;
+}
+
+/**
+ * @brief Test the volume of a view against a frustum, view is rejected only when
+ * all of its corners are behind one of the frustum planes
+ */
+static bool isViewInFrustum(const Frustum& frustum, const glm::mat4& projView)
+{
+    glm::mat4 inverseProjView = glm::inverse(projView);
+    glm::vec3 corners[8];
+    for (uint32_t cornerIdx = 0u; cornerIdx < 8u; ++cornerIdx)
+    {
+        glm::vec4 corner = inverseProjView * glm::vec4((cornerIdx & 1u) ? 1.f : -1.f, (cornerIdx & 2u) ? 1.f : -1.f, (cornerIdx & 4u) ? 1.f : 0.f, 1.f);
+        corners[cornerIdx] = glm::vec3(corner) / corner.w;
+    }
+
+    for (const Plane* plane : { &frustum.left, &frustum.right, &frustum.bottom, &frustum.top, &frustum.near, &frustum.far })
+    {
+        bool isOutside = true;
+        for (const glm::vec3& corner : corners)
+        {
+            if (glm::dot(plane->normal, corner) + plane->distance >= 0.f)
+            {
+                isOutside = false;
+                break;
+            }
+        }
+
+        if (isOutside) return false;
+    }
+
+    return true;
+}
+
 LightsSystem* LightsSystem::s_instance = nullptr;
 
 LightsSystem::LightsSystem()
@@ -25,6 +123,9 @@ LightsSystem::LightsSystem()
     s_instance = this;
 
     setupDescriptors();
+
+    m_localShadowAtlas.init(LOCAL_SHADOW_ATLAS_RESOLUTION, LOCAL_SHADOW_MIN_TILE_SIZE);
+    m_localShadowViews.reserve(MAX_LOCAL_SHADOW_VIEWS);
 }
 
 LightsSystem::~LightsSystem()
@@ -37,17 +138,35 @@ LightsSystem::~LightsSystem()
     m_directionalLightsBuffer.cleanup();
     m_pointLightsBuffer.cleanup();
     m_spotLightsBuffer.cleanup();
+
+    for (auto& buffer : m_localShadowViewsBuffers)
+    {
+        buffer.cleanup();
+    }
 }
 
 void LightsSystem::registerAllLights(Scene& scene)
 {
-    auto ambDescInfo = m_ambientLightBuffer.getDescriptorInfoAtIndex(0);
+    configureLightsBinding(AMBIENT_BIND_INDEX, 0, m_ambientLightBuffer.getDescriptorInfoAtIndex(0));
 
-    m_lightsDescriptorSet->configureBuffer(
-        AMBIENT_BIND_INDEX,
-        0,
-        1,
-        &ambDescInfo);
+    // every frame set reads the shadow views written for its frame
+    for (uint32_t frameIdx = 0u; frameIdx < MAX_FRAMES_IN_FLIGHT; ++frameIdx)
+    {
+        auto shadowViewsDescInfo = m_localShadowViewsBuffers[frameIdx].getDescriptorInfo();
+
+        m_lightsDescriptorSets[frameIdx]->configureBuffer(
+            SHADOW_VIEWS_BIND_INDEX,
+            0,
+            1,
+            &shadowViewsDescInfo);
+
+        m_lightsDescriptorSets[frameIdx]->applyConfiguration();
+    }
+
+    // light ids of a previous scene might be reused, cached shadows are dropped
+    m_localShadowAtlas.init(LOCAL_SHADOW_ATLAS_RESOLUTION, LOCAL_SHADOW_MIN_TILE_SIZE);
+    m_localShadowStates.clear();
+    m_localShadowKeys.clear();
 
     auto directionalLightList = scene.GetGameObjectsWith<DirectionalLightComponent>();
     for (auto& entity : directionalLightList)
@@ -80,81 +199,69 @@ void LightsSystem::registerAllLights(Scene& scene)
 
         registerSpotLight(light);
     }
-
-    m_lightsDescriptorSet->applyConfiguration();
 }
 
 void LightsSystem::registerAmbientLight(AmbientLightComponent& light)
 {
-    auto descInfo = m_ambientLightBuffer.getDescriptorInfoAtIndex(0);
-
-    m_lightsDescriptorSet->configureBuffer(
-        AMBIENT_BIND_INDEX,
-        0,
-        1,
-        &descInfo);
-
-    m_lightsDescriptorSet->applyConfiguration();
+    configureLightsBinding(AMBIENT_BIND_INDEX, 0, m_ambientLightBuffer.getDescriptorInfoAtIndex(0));
 }
 
 void LightsSystem::registerDirectionalLight(DirectionalLightComponent& light)
 {
     DASSERT(light.id == -1, "Id already registerd");
-    DASSERT(m_directionalLightsCount < MAX_LIGHTS_PER_TYPE);
+    DASSERT(m_directionalLightsCount < MAX_DIRECTIONAL_LIGHTS);
 
     light.id = m_directionalLightsCount;
     ++m_directionalLightsCount;
 
-    auto descInfo = m_directionalLightsBuffer.getDescriptorInfoAtIndex(light.id);
-
-    m_lightsDescriptorSet->configureBuffer(
-        DIRECTIONAL_BIND_INDEX,
-        light.id,
-        1,
-        &descInfo);
-
-    m_lightsDescriptorSet->applyConfiguration();
+    configureLightsBinding(DIRECTIONAL_BIND_INDEX, light.id, m_directionalLightsBuffer.getDescriptorInfoAtIndex(light.id));
 }
 
 void LightsSystem::registerPointLight(PointLightComponent& light)
 {
     DASSERT(light.id == -1, "Id already registerd");
-    DASSERT(m_pointLightsCount < MAX_LIGHTS_PER_TYPE);
+    if (m_pointLightsCount >= m_lightsCapacity)
+    {
+        DUSK_WARN("Point light can't be registered, limit of {} lights is reached", m_lightsCapacity);
+        return;
+    }
 
     light.id = m_pointLightsCount;
     ++m_pointLightsCount;
 
-    auto descInfo = m_pointLightsBuffer.getDescriptorInfoAtIndex(light.id);
-
-    m_lightsDescriptorSet->configureBuffer(
-        POINT_BIND_INDEX,
-        light.id,
-        1,
-        &descInfo);
-
-    m_lightsDescriptorSet->applyConfiguration();
+    configureLightsBinding(POINT_BIND_INDEX, light.id, m_pointLightsBuffer.getDescriptorInfoAtIndex(light.id));
 }
 
 void LightsSystem::registerSpotLight(SpotLightComponent& light)
 {
     DASSERT(light.id == -1, "Id already registerd");
-    DASSERT(m_spotLightsCount < MAX_LIGHTS_PER_TYPE);
+    if (m_spotLightsCount >= m_lightsCapacity)
+    {
+        DUSK_WARN("Spot light can't be registered, limit of {} lights is reached", m_lightsCapacity);
+        return;
+    }
 
     light.id = m_spotLightsCount;
     ++m_spotLightsCount;
 
-    auto descInfo = m_spotLightsBuffer.getDescriptorInfoAtIndex(light.id);
+    configureLightsBinding(SPOT_BIND_INDEX, light.id, m_spotLightsBuffer.getDescriptorInfoAtIndex(light.id));
+}
 
-    m_lightsDescriptorSet->configureBuffer(
-        SPOT_BIND_INDEX,
-        light.id,
-        1,
-        &descInfo);
+void LightsSystem::configureLightsBinding(uint32_t binding, uint32_t index, VkDescriptorBufferInfo descInfo)
+{
+    for (auto& descriptorSet : m_lightsDescriptorSets)
+    {
+        descriptorSet->configureBuffer(
+            binding,
+            index,
+            1,
+            &descInfo);
 
-    m_lightsDescriptorSet->applyConfiguration();
+        descriptorSet->applyConfiguration();
+    }
 }
 
-void LightsSystem::updateLights(Scene& scene, GlobalUbo& ubo)
+void LightsSystem::updateLights(Scene& scene, GlobalUbo& ubo, UploadArena& uploadArena, uint32_t frameIndex)
 {
     DUSK_PROFILE_FUNCTION;
 
@@ -163,11 +270,13 @@ void LightsSystem::updateLights(Scene& scene, GlobalUbo& ubo)
     {
         auto& light = ambientLightList.get<AmbientLightComponent>(entity);
 
-        m_ambientLightBuffer.writeAndFlush(0, &light, sizeof(AmbientLightComponent));
+        m_ambientLightBuffer.write(0, &light, sizeof(AmbientLightComponent));
+        uploadArena.queueFlush(m_ambientLightBuffer, 0, sizeof(AmbientLightComponent));
     }
 
-    auto     directionalLightList = scene.GetGameObjectsWith<DirectionalLightComponent>();
-    uint32_t counter              = 0u;
+    const CameraComponent& camera               = scene.getMainCamera();
+    auto                   directionalLightList = scene.GetGameObjectsWith<DirectionalLightComponent>();
+    uint32_t               counter              = 0u;
     for (auto& entity : directionalLightList)
     {
         auto& light = directionalLightList.get<DirectionalLightComponent>(entity);
@@ -176,28 +285,20 @@ void LightsSystem::updateLights(Scene& scene, GlobalUbo& ubo)
 
         if (light.id > 0) continue; // only one directional light for now
 
-        // ortho projection for dir lights
-        glm::mat4 projection = glm::orthoRH_ZO(-10.0f, 10.0f, 10.0f, -10.0f, 0.1f, 1000.0f);
-        projection[1][1] *= -1; // flip Y for Vulkan
+        updateShadowCascades(light, camera);
 
-        glm::vec3 lightPos = glm::vec3(0.f) - light.direction * 30.0f;
-        glm::mat4 view     = glm::lookAtRH(
-            lightPos,
-            glm::vec3(0.f),
-            glm::vec3(0.0f, 1.0f, 0.0f));
-
-        light.projView = projection * view;
-
-        m_directionalLightsBuffer.writeAndFlushAtIndex(light.id, &light, sizeof(DirectionalLightComponent));
+        m_directionalLightsBuffer.writeAtIndex(light.id, &light, sizeof(DirectionalLightComponent));
 
         ubo.directionalLightIndices[counter / 4][counter % 4] = light.id;
         ++counter;
     }
     ubo.directionalLightsCount = m_directionalLightsCount;
 
+    // shadow view indices are written with the rest of the light data
+    updateLocalShadows(scene, camera, uploadArena, frameIndex);
+
     // TODO: maybe not the efficient data oriented desgin
     auto pointLightList = scene.GetGameObjectsWith<PointLightComponent>();
-    counter             = 0u;
     for (auto& entity : pointLightList)
     {
         auto& light    = pointLightList.get<PointLightComponent>(entity);
@@ -205,15 +306,12 @@ void LightsSystem::updateLights(Scene& scene, GlobalUbo& ubo)
 
         if (light.id == -1) continue;
 
-        m_pointLightsBuffer.writeAndFlushAtIndex(light.id, &light, sizeof(PointLightComponent));
-
-        ubo.pointLightIndices[counter / 4][counter % 4] = light.id;
-        ++counter;
+        m_pointLightsBuffer.writeAtIndex(light.id, &light, sizeof(PointLightComponent));
     }
     ubo.pointLightsCount = m_pointLightsCount;
 
-    auto spotLightList   = scene.GetGameObjectsWith<SpotLightComponent>();
-    counter              = 0u;
+    // point and spot light ids are dense, light clusters pass reads them by index
+    auto spotLightList = scene.GetGameObjectsWith<SpotLightComponent>();
     for (auto& entity : spotLightList)
     {
         auto& light    = spotLightList.get<SpotLightComponent>(entity);
@@ -221,54 +319,389 @@ void LightsSystem::updateLights(Scene& scene, GlobalUbo& ubo)
 
         if (light.id == -1) continue;
 
-        m_spotLightsBuffer.writeAndFlushAtIndex(light.id, &light, sizeof(SpotLightComponent));
-
-        ubo.spotLightIndices[counter / 4][counter % 4] = light.id;
-        ++counter;
+        m_spotLightsBuffer.writeAtIndex(light.id, &light, sizeof(SpotLightComponent));
     }
     ubo.spotLightsCount = m_spotLightsCount;
+
+    // light ids are dense, so a single range covers all the writes of a type
+    uploadArena.queueFlush(m_directionalLightsBuffer, 0, m_directionalLightsCount * m_directionalLightsBuffer.instanceAlignmentSize);
+    uploadArena.queueFlush(m_pointLightsBuffer, 0, m_pointLightsCount * m_pointLightsBuffer.instanceAlignmentSize);
+    uploadArena.queueFlush(m_spotLightsBuffer, 0, m_spotLightsCount * m_spotLightsBuffer.instanceAlignmentSize);
+}
+
+void LightsSystem::updateShadowCascades(DirectionalLightComponent& light, const CameraComponent& camera)
+{
+    float     zNear           = camera.nearPlane;
+    float     zFar            = glm::min(camera.farPlane, DIR_SHADOW_MAX_DISTANCE);
+
+    // corners of the camera frustum, near plane followed by far plane
+    glm::mat4 inverseProjView = glm::inverse(camera.projectionMatrix * camera.viewMatrix);
+    glm::vec3 frustumCorners[8];
+    for (uint32_t cornerIdx = 0u; cornerIdx < 8u; ++cornerIdx)
+    {
+        glm::vec4 ndc {
+            (cornerIdx & 1u) ? 1.f : -1.f,
+            (cornerIdx & 2u) ? 1.f : -1.f,
+            (cornerIdx & 4u) ? 1.f : 0.f,
+            1.f
+        };
+
+        glm::vec4 corner          = inverseProjView * ndc;
+        frustumCorners[cornerIdx] = glm::vec3(corner) / corner.w;
+    }
+
+    glm::vec3 lightDirection = glm::normalize(light.direction);
+    glm::vec3 up             = glm::abs(lightDirection.y) > 0.99f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(0.f, 1.f, 0.f);
+    float     splitStart     = zNear;
+
+    for (uint32_t cascadeIdx = 0u; cascadeIdx < DIR_SHADOW_CASCADES_COUNT; ++cascadeIdx)
+    {
+        // practical split scheme, logarithmic splits blended with uniform ones
+        float ratio    = static_cast<float>(cascadeIdx + 1u) / DIR_SHADOW_CASCADES_COUNT;
+        float logSplit = zNear * glm::pow(zFar / zNear, ratio);
+        float uniSplit = zNear + (zFar - zNear) * ratio;
+        float splitEnd = DIR_SHADOW_SPLIT_LAMBDA * logSplit + (1.f - DIR_SHADOW_SPLIT_LAMBDA) * uniSplit;
+
+        // corners of the cascade lie on the edges of the camera frustum
+        float     startT = (splitStart - camera.nearPlane) / (camera.farPlane - camera.nearPlane);
+        float     endT   = (splitEnd - camera.nearPlane) / (camera.farPlane - camera.nearPlane);
+
+        glm::vec3 cascadeCorners[8];
+        glm::vec3 center = glm::vec3(0.f);
+        for (uint32_t edgeIdx = 0u; edgeIdx < 4u; ++edgeIdx)
+        {
+            glm::vec3 edge               = frustumCorners[edgeIdx + 4u] - frustumCorners[edgeIdx];
+            cascadeCorners[edgeIdx]      = frustumCorners[edgeIdx] + edge * startT;
+            cascadeCorners[edgeIdx + 4u] = frustumCorners[edgeIdx] + edge * endT;
+
+            center += cascadeCorners[edgeIdx] + cascadeCorners[edgeIdx + 4u];
+        }
+        center /= 8.f;
+
+        // bounding sphere keeps the projection size constant while the camera rotates
+        float radius = 0.f;
+        for (const glm::vec3& corner : cascadeCorners)
+        {
+            radius = glm::max(radius, glm::length(corner - center));
+        }
+        radius = glm::ceil(radius * 16.f) / 16.f;
+
+        // depth range also keeps casters up to a sphere diameter towards the light
+        glm::mat4 view       = glm::lookAtRH(center - lightDirection * radius, center, up);
+        glm::mat4 projection = glm::orthoRH_ZO(-radius, radius, -radius, radius, -2.f * radius, 2.f * radius);
+
+        // snap the projection to shadow map texels to avoid shimmering edges
+        glm::vec4 origin     = projection * view * glm::vec4(0.f, 0.f, 0.f, 1.f);
+        glm::vec2 texelPos   = glm::vec2(origin) * (DIR_SHADOW_MAP_RESOLUTION * 0.5f);
+        glm::vec2 offset     = (glm::round(texelPos) - texelPos) * (2.f / DIR_SHADOW_MAP_RESOLUTION);
+
+        projection[3][0] += offset.x;
+        projection[3][1] += offset.y;
+
+        light.cascadeProjViews[cascadeIdx] = projection * view;
+        light.cascadeSplits[cascadeIdx]    = splitEnd;
+
+        splitStart                         = splitEnd;
+    }
+}
+
+void LightsSystem::updateLocalShadows(Scene& scene, const CameraComponent& camera, UploadArena& uploadArena, uint32_t frameIndex)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    ++m_localShadowFrame;
+    m_localShadowViews.clear();
+    m_localShadowRenderViews.clear();
+    m_staleLocalShadowViewsCount = 0u;
+
+    struct ShadowCaster
+    {
+        uint32_t  key           = 0u;
+        int32_t*  shadowViewIdx = nullptr;
+        glm::vec3 position      = glm::vec3 { 0.f };
+        glm::vec3 direction     = glm::vec3 { 0.f }; // zero for point lights
+        float     range         = 0.f;
+        float     outerCutOff   = 0.f;
+        float     coverage      = 0.f;
+    };
+
+    Frustum                    cameraFrustum  = extractFrustumFromMatrix(camera.projectionMatrix * camera.viewMatrix);
+    glm::vec3                  cameraPosition = glm::vec3(glm::inverse(camera.viewMatrix)[3]);
+    float                      tanHalfFovY    = glm::tan(camera.fovY * 0.5f);
+
+    DynamicArray<ShadowCaster> casters        = {};
+
+    // lights cast shadows only when their volume is visible and large enough on screen
+    auto addCaster = [&](ShadowCaster& caster)
+    {
+        if (!isSphereInFrustum(cameraFrustum, caster.position, caster.range)) return;
+
+        caster.coverage = getScreenCoverage(caster.position, caster.range, cameraPosition, tanHalfFovY);
+        if (caster.coverage < LOCAL_SHADOW_MIN_COVERAGE) return;
+
+        casters.push_back(caster);
+    };
+
+    auto pointLightList = scene.GetGameObjectsWith<PointLightComponent>();
+    for (auto& entity : pointLightList)
+    {
+        auto& light         = pointLightList.get<PointLightComponent>(entity);
+        light.shadowViewIdx = -1;
+
+        if (light.id == -1) continue;
+
+        ShadowCaster caster {
+            .key           = static_cast<uint32_t>(light.id),
+            .shadowViewIdx = &light.shadowViewIdx,
+            .position      = TransformSystem::getPosition(entity),
+            .range         = glm::min(getLightRange(light.color, light.constantAttenuationFactor, light.linearAttenuationFactor, light.quadraticAttenuationFactor), camera.farPlane)
+        };
+        addCaster(caster);
+    }
+
+    auto spotLightList = scene.GetGameObjectsWith<SpotLightComponent>();
+    for (auto& entity : spotLightList)
+    {
+        auto& light         = spotLightList.get<SpotLightComponent>(entity);
+        light.shadowViewIdx = -1;
+
+        if (light.id == -1) continue;
+
+        ShadowCaster caster {
+            .key           = static_cast<uint32_t>(light.id) | SPOT_SHADOW_KEY_BIT,
+            .shadowViewIdx = &light.shadowViewIdx,
+            .position      = TransformSystem::getPosition(entity),
+            .direction     = glm::normalize(light.direction),
+            .range         = glm::min(getLightRange(light.color, light.constantAttenuationFactor, light.linearAttenuationFactor, light.quadraticAttenuationFactor), camera.farPlane),
+            .outerCutOff   = light.outerCutOff
+        };
+        addCaster(caster);
+    }
+
+    // lights covering more of the screen get the atlas space first
+    std::sort(
+        casters.begin(),
+        casters.end(),
+        [](const ShadowCaster& a, const ShadowCaster& b)
+        { return a.coverage > b.coverage; });
+
+    // tiles of lights which stopped casting shadows are released before allocating new ones
+    for (const ShadowCaster& caster : casters)
+    {
+        if (m_localShadowStates.contains(caster.key))
+        {
+            m_localShadowStates[caster.key].lastUsedFrame = m_localShadowFrame;
+        }
+    }
+
+    for (uint32_t keyIdx = 0u; keyIdx < m_localShadowKeys.size();)
+    {
+        uint32_t          key   = m_localShadowKeys[keyIdx];
+        LocalShadowState& state = m_localShadowStates[key];
+
+        if (state.lastUsedFrame == m_localShadowFrame)
+        {
+            ++keyIdx;
+            continue;
+        }
+
+        for (ShadowAtlasTile& tile : state.tiles)
+        {
+            m_localShadowAtlas.free(tile);
+        }
+
+        m_localShadowStates.erase(key);
+        m_localShadowKeys[keyIdx] = m_localShadowKeys.back();
+        m_localShadowKeys.pop_back();
+    }
+
+    const DynamicArray<AABB>& movedStaticBounds = scene.getMovedStaticBounds();
+
+    // largest tile follows the shadow resolution scale in power of two steps
+    uint32_t maxTileSize = glm::max(
+        std::bit_floor(static_cast<uint32_t>(LOCAL_SHADOW_MAX_TILE_SIZE * m_shadowResolutionScale)),
+        LOCAL_SHADOW_MIN_TILE_SIZE);
+
+    for (const ShadowCaster& caster : casters)
+    {
+        bool     isSpot     = caster.key & SPOT_SHADOW_KEY_BIT;
+        uint32_t viewsCount = isSpot ? 1u : 6u;
+
+        if (!m_localShadowStates.contains(caster.key))
+        {
+            m_localShadowStates[caster.key] = {};
+            m_localShadowKeys.push_back(caster.key);
+        }
+
+        LocalShadowState& state = m_localShadowStates[caster.key];
+        state.lastUsedFrame     = m_localShadowFrame;
+
+        // tiles follow the coverage in power of two steps
+        uint32_t tileSize = glm::clamp(
+            std::bit_ceil(static_cast<uint32_t>(caster.coverage * maxTileSize)),
+            LOCAL_SHADOW_MIN_TILE_SIZE,
+            maxTileSize);
+
+        if (state.tileSize != tileSize || m_localShadowViews.size() + viewsCount > MAX_LOCAL_SHADOW_VIEWS)
+        {
+            for (ShadowAtlasTile& tile : state.tiles)
+            {
+                m_localShadowAtlas.free(tile);
+            }
+            state.tileSize = tileSize;
+        }
+
+        if (m_localShadowViews.size() + viewsCount > MAX_LOCAL_SHADOW_VIEWS) continue;
+
+        // cached static depth was rendered from another light volume or before
+        // static geometry around the light moved
+        bool isStaticStale = state.position != caster.position
+            || state.direction != caster.direction
+            || state.range != caster.range
+            || state.outerCutOff != caster.outerCutOff;
+
+        for (uint32_t boundsIdx = 0u; boundsIdx < movedStaticBounds.size() && !isStaticStale; ++boundsIdx)
+        {
+            isStaticStale = isSphereIntersectingAABB(caster.position, caster.range, movedStaticBounds[boundsIdx]);
+        }
+
+        if (isStaticStale)
+        {
+            state.isStaticValid.fill(false);
+        }
+
+        state.position        = caster.position;
+        state.direction       = caster.direction;
+        state.range           = caster.range;
+        state.outerCutOff     = caster.outerCutOff;
+
+        *caster.shadowViewIdx = static_cast<int32_t>(m_localShadowViews.size());
+
+        // spot light cone is clamped to keep the projection valid
+        float fovY       = isSpot ? 2.f * glm::acos(glm::clamp(caster.outerCutOff, 0.05f, 0.9999f)) : glm::half_pi<float>();
+        float tanHalfFov = glm::tan(fovY * 0.5f);
+        float nearPlane  = LOCAL_SHADOW_NEAR_PLANE;
+        float farPlane   = glm::max(caster.range, nearPlane * 2.f);
+        float atlasScale = 1.f / m_localShadowAtlas.getResolution();
+
+        for (uint32_t faceIdx = 0u; faceIdx < viewsCount; ++faceIdx)
+        {
+            glm::vec3 direction = isSpot ? caster.direction : CUBE_FACE_DIRECTIONS[faceIdx];
+            glm::vec3 up        = CUBE_FACE_UPS[faceIdx];
+
+            if (isSpot)
+            {
+                up = glm::abs(direction.y) > 0.99f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(0.f, 1.f, 0.f);
+            }
+
+            glm::mat4 view       = glm::lookAtRH(caster.position, caster.position + direction, up);
+            glm::mat4 projection = glm::perspectiveRH_ZO(fovY, 1.f, nearPlane, farPlane);
+
+            uint32_t  viewIdx    = static_cast<uint32_t>(m_localShadowViews.size());
+            m_localShadowViews.push_back({ .projView = projection * view });
+
+            ShadowAtlasTile& tile = state.tiles[faceIdx];
+
+            // views outside of the camera frustum can't shadow visible fragments
+            if (!isViewInFrustum(cameraFrustum, m_localShadowViews[viewIdx].projView))
+            {
+                m_localShadowAtlas.free(tile);
+                continue;
+            }
+
+            if (!tile.isValid())
+            {
+                // smaller tiles are tried when the atlas is full
+                for (uint32_t size = tileSize; size >= LOCAL_SHADOW_MIN_TILE_SIZE; size /= 2)
+                {
+                    if (m_localShadowAtlas.allocate(size, &tile)) break;
+                }
+
+                if (!tile.isValid()) continue;
+
+                state.isStaticValid[faceIdx] = false;
+            }
+
+            m_localShadowViews[viewIdx].atlasRect = glm::vec4(tile.x, tile.y, tile.size, tile.size) * atlasScale;
+            m_localShadowViews[viewIdx].params.x  = 2.f * tanHalfFov / tile.size;
+
+            m_localShadowRenderViews.push_back(
+                { .viewIdx       = viewIdx,
+                  .tile          = tile,
+                  .isStaticStale = !state.isStaticValid[faceIdx] });
+
+            if (!state.isStaticValid[faceIdx])
+            {
+                ++m_staleLocalShadowViewsCount;
+            }
+
+            state.isStaticValid[faceIdx] = true;
+        }
+    }
+
+    if (!m_localShadowViews.empty())
+    {
+        // older frames in flight keep reading their own copy
+        GfxBuffer& viewsBuffer = m_localShadowViewsBuffers[frameIndex];
+        size_t     viewsSize   = m_localShadowViews.size() * sizeof(GfxLocalShadowView);
+        viewsBuffer.write(0, m_localShadowViews.data(), viewsSize);
+        uploadArena.queueFlush(viewsBuffer, 0, viewsSize);
+    }
 }
 
 void LightsSystem::setupDescriptors()
 {
-    VulkanContext ctx      = VkGfxDevice::getSharedVulkanContext();
+    VulkanContext ctx = VkGfxDevice::getSharedVulkanContext();
+
+    // point and spot lights arrays share the storage buffers limit with ambient and directional lights
+    uint32_t storageBuffersLimit = VkGfxBindlessHeap::getDescriptorCountLimit(ctx, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2 * MAX_LIGHTS_PER_TYPE + 2);
+    m_lightsCapacity             = (storageBuffersLimit - 2) / 2;
 
-    m_lightsDescriptorPool = VkGfxDescriptorPool::Builder(ctx)
-                                 .addPoolSize(
-                                     VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                     MAX_LIGHTS_PER_TYPE)
-                                 .setDebugName("lights_desc_pool")
-                                 .build(
-                                     1,
-                                     VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+    m_lightsDescriptorPool       = VkGfxDescriptorPool::Builder(ctx)
+                                       .addPoolSize(
+                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                           (2 * m_lightsCapacity + 3) * MAX_FRAMES_IN_FLIGHT)
+                                       .setDebugName("lights_desc_pool")
+                                       .build(
+                                           MAX_FRAMES_IN_FLIGHT,
+                                           VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
 
     m_lightsDescriptorSetLayout = VkGfxDescriptorSetLayout::Builder(ctx)
                                       .addBinding(
                                           AMBIENT_BIND_INDEX,
                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
                                           1) // Ambient light
                                       .addBinding(
                                           DIRECTIONAL_BIND_INDEX,
                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
                                           1) // Directional Light
                                       .addBinding(
                                           POINT_BIND_INDEX,
                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                                          MAX_LIGHTS_PER_TYPE,
+                                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+                                          m_lightsCapacity,
                                           true) // Point Light
                                       .addBinding(
                                           SPOT_BIND_INDEX,
                                           VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-                                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                                          MAX_LIGHTS_PER_TYPE,
+                                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+                                          m_lightsCapacity,
                                           true) // Spot Light
+                                      .addBinding(
+                                          SHADOW_VIEWS_BIND_INDEX,
+                                          VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                          VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+                                          1) // Shadow views of point and spot lights
                                       .setDebugName("lights_desc_set_layout")
                                       .build();
 
-    m_lightsDescriptorSet = m_lightsDescriptorPool->allocateDescriptorSet(*m_lightsDescriptorSetLayout, "lights_desc_set");
+    m_lightsDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t frameIdx = 0u; frameIdx < MAX_FRAMES_IN_FLIGHT; ++frameIdx)
+    {
+        m_lightsDescriptorSets[frameIdx] = m_lightsDescriptorPool->allocateDescriptorSet(*m_lightsDescriptorSetLayout, "lights_desc_set");
+    }
 
     // create ambient light buffer
     GfxBuffer::createHostWriteBuffer(
@@ -290,7 +723,7 @@ void LightsSystem::setupDescriptors()
     GfxBuffer::createHostWriteBuffer(
         GfxBufferUsageFlags::StorageBuffer,
         sizeof(PointLightComponent),
-        MAX_LIGHTS_PER_TYPE,
+        m_lightsCapacity,
         "point_lights_buffer",
         &m_pointLightsBuffer);
 
@@ -298,9 +731,21 @@ void LightsSystem::setupDescriptors()
     GfxBuffer::createHostWriteBuffer(
         GfxBufferUsageFlags::StorageBuffer,
         sizeof(SpotLightComponent),
-        MAX_LIGHTS_PER_TYPE,
+        m_lightsCapacity,
         "spot_lights_buffer",
         &m_spotLightsBuffer);
+
+    // create shadow views buffer of every frame, views are read as a single array
+    m_localShadowViewsBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+    for (uint32_t frameIdx = 0u; frameIdx < MAX_FRAMES_IN_FLIGHT; ++frameIdx)
+    {
+        GfxBuffer::createHostWriteBuffer(
+            GfxBufferUsageFlags::StorageBuffer,
+            sizeof(GfxLocalShadowView) * MAX_LOCAL_SHADOW_VIEWS,
+            1,
+            "local_shadow_views_buffer",
+            &m_localShadowViewsBuffers[frameIdx]);
+    }
 }
 
 } // namespace dusk
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "dusk.h"
 #include "renderer/gfx_buffer.h"
+#include "renderer/shadow_atlas.h"
 
 namespace dusk
 {
@@ -13,6 +14,8 @@ class AmbientLightComponent;
 class DirectionalLightComponent;
 class PointLightComponent;
 class SpotLightComponent;
+class UploadArena;
+struct CameraComponent;
 
 struct VkGfxDescriptorPool;
 struct VkGfxDescriptorSetLayout;
@@ -20,11 +23,50 @@ struct VkGfxDescriptorSet;
 
 // need multiple of 4 for easy packing inside global ubo (uvec4[])
 // but not a strict rule
-inline constexpr uint32_t MAX_LIGHTS_PER_TYPE    = 128;
+inline constexpr uint32_t MAX_DIRECTIONAL_LIGHTS = 128;
+// requested count of point and spot lights each, clamped to the update after bind
+// limits of the device. These are binned in light clusters instead of the global ubo.
+inline constexpr uint32_t MAX_LIGHTS_PER_TYPE    = 4096;
 inline constexpr uint32_t AMBIENT_BIND_INDEX     = 0;
 inline constexpr uint32_t DIRECTIONAL_BIND_INDEX = 1;
 inline constexpr uint32_t POINT_BIND_INDEX       = 2;
 inline constexpr uint32_t SPOT_BIND_INDEX        = 3;
+inline constexpr uint32_t SHADOW_VIEWS_BIND_INDEX = 4;
+
+// cascaded shadow maps of the directional light
+inline constexpr uint32_t DIR_SHADOW_MAP_RESOLUTION = 2048;
+inline constexpr float    DIR_SHADOW_MAX_DISTANCE   = 200.f; // view depth covered by the last cascade
+inline constexpr float    DIR_SHADOW_SPLIT_LAMBDA   = 0.75f; // blend between logarithmic and uniform splits
+
+// point and spot light shadows are rendered in tiles of a shared atlas, six
+// views per point light and one per spot light
+inline constexpr uint32_t LOCAL_SHADOW_ATLAS_RESOLUTION = 4096;
+inline constexpr uint32_t LOCAL_SHADOW_MIN_TILE_SIZE    = 128;
+inline constexpr uint32_t LOCAL_SHADOW_MAX_TILE_SIZE    = 1024;
+inline constexpr uint32_t MAX_LOCAL_SHADOW_VIEWS        = 384;
+inline constexpr float    LOCAL_SHADOW_MIN_COVERAGE     = 0.05f; // screen height fraction of the light volume to cast shadows
+inline constexpr float    LOCAL_SHADOW_NEAR_PLANE       = 0.05f;
+
+/**
+ * @brief Shadow view of a point light cube face or a spot light, read by the
+ * shadow passes and the lighting passes
+ */
+struct alignas(16) GfxLocalShadowView
+{
+    glm::mat4 projView  = { 1.f };
+    glm::vec4 atlasRect = glm::vec4 { 0.f }; // uv offset in xy and uv scale in zw, zero when view has no tile
+    glm::vec4 params    = glm::vec4 { 0.f }; // x is world size of a texel per unit of distance from the light
+};
+
+/**
+ * @brief Shadow view with an atlas tile which has to be rendered in the frame
+ */
+struct LocalShadowRenderView
+{
+    uint32_t        viewIdx       = 0u;
+    ShadowAtlasTile tile          = {};
+    bool            isStaticStale = false; // static casters have to be rendered in the cache again
+};
 
 class LightsSystem
 {
@@ -69,11 +111,14 @@ public:
     void registerSpotLight(SpotLightComponent& light);
 
     /**
-     * @brief update all the lights data into the graphics buffer and update global ubo with count and indices
+     * @brief update all the lights data into the graphics buffer and update global ubo with count and indices.
+     * Written ranges are queued for the frame flush of the upload arena.
      * @param scene
      * @param ubo to update
+     * @param uploadArena flushing host writes of the frame
+     * @param frameIndex of the frame being recorded
      */
-    void updateLights(Scene& scene, GlobalUbo& ubo);
+    void updateLights(Scene& scene, GlobalUbo& ubo, UploadArena& uploadArena, uint32_t frameIndex);
 
     /**
      * @brief Get lights descriptor set layout
@@ -82,34 +127,122 @@ public:
     VkGfxDescriptorSetLayout& getLightsDescriptorSetLayout() const { return *m_lightsDescriptorSetLayout; };
 
     /**
-     * @brief Get lights descriptor set
+     * @brief Get lights descriptor set of a frame in flight
+     * @param frameIndex of the frame
      * @return descriptor set
      */
-    VkGfxDescriptorSet& getLightsDescriptorSet() const { return *m_lightsDescriptorSet; };
+    VkGfxDescriptorSet& getLightsDescriptorSet(uint32_t frameIndex) const { return *m_lightsDescriptorSets[frameIndex]; };
 
     uint32_t            getDirectionalLightsCount() { return m_directionalLightsCount; };
     uint32_t            getPointLightsCount() { return m_pointLightsCount; };
     uint32_t            getSpotLightsCount() { return m_spotLightsCount; };
 
+    /**
+     * @brief Get maximum count of point and spot lights each supported by the device
+     * @return count of lights per type
+     */
+    uint32_t            getLightsCapacity() const { return m_lightsCapacity; }
+
+    /**
+     * @brief Get shadow views of point and spot lights written for the frame
+     * @return array of views indexed by the shadow view index of the lights
+     */
+    const DynamicArray<GfxLocalShadowView>&    getLocalShadowViews() const { return m_localShadowViews; }
+
+    /**
+     * @brief Get shadow views of point and spot lights with atlas tiles, in the
+     * order of their view indices
+     * @return array of views rendered in the frame
+     */
+    const DynamicArray<LocalShadowRenderView>& getLocalShadowRenderViews() const { return m_localShadowRenderViews; }
+
+    /**
+     * @brief Get count of views whose cached static depth has to be rendered again
+     * @return count of views
+     */
+    uint32_t                                   getStaleLocalShadowViewsCount() const { return m_staleLocalShadowViewsCount; }
+
+    /**
+     * @brief Scale the largest atlas tile of point and spot light shadows, tiles
+     * of the lights are reallocated on the next update
+     * @param scale clamped to [0, 1], tiles stay at least LOCAL_SHADOW_MIN_TILE_SIZE
+     */
+    void                                       setShadowResolutionScale(float scale) { m_shadowResolutionScale = glm::clamp(scale, 0.f, 1.f); }
+    float                                      getShadowResolutionScale() const { return m_shadowResolutionScale; }
+
 private:
     /**
      * @brief Setup all the descriptors and buffer related resources
      */
     void setupDescriptors();
 
+    /**
+     * @brief Split the camera frustum into cascades and fit a texel snapped
+     * orthographic projection of the light around each of them
+     * @param light directional light to update
+     * @param camera whose frustum is covered by the cascades
+     */
+    void updateShadowCascades(DirectionalLightComponent& light, const CameraComponent& camera);
+
+    /**
+     * @brief Pick point and spot lights casting shadows by their screen coverage,
+     * allocate atlas tiles for their visible views and track which cached static
+     * depth is stale
+     * @param scene with the lights
+     * @param camera viewing the lights
+     * @param uploadArena flushing host writes of the frame
+     * @param frameIndex of the frame being recorded
+     */
+    void updateLocalShadows(Scene& scene, const CameraComponent& camera, UploadArena& uploadArena, uint32_t frameIndex);
+
+    /**
+     * @brief Point a light buffer binding of all frame sets to the range
+     * @param binding in the lights set
+     * @param index of the array element
+     * @param descInfo of the buffer range
+     */
+    void configureLightsBinding(uint32_t binding, uint32_t index, VkDescriptorBufferInfo descInfo);
+
 private:
-    Unique<VkGfxDescriptorPool>      m_lightsDescriptorPool      = nullptr;
-    Unique<VkGfxDescriptorSetLayout> m_lightsDescriptorSetLayout = nullptr;
-    Unique<VkGfxDescriptorSet>       m_lightsDescriptorSet       = nullptr;
-
-    GfxBuffer                        m_ambientLightBuffer;
-    GfxBuffer                        m_directionalLightsBuffer;
-    GfxBuffer                        m_pointLightsBuffer;
-    GfxBuffer                        m_spotLightsBuffer;
-
-    uint32_t                         m_directionalLightsCount = 0u;
-    uint32_t                         m_pointLightsCount       = 0u;
-    uint32_t                         m_spotLightsCount        = 0u;
+    Unique<VkGfxDescriptorPool>              m_lightsDescriptorPool      = nullptr;
+    Unique<VkGfxDescriptorSetLayout>         m_lightsDescriptorSetLayout = nullptr;
+    DynamicArray<Unique<VkGfxDescriptorSet>> m_lightsDescriptorSets      = {}; // per frame, only shadow views differ
+
+    GfxBuffer                                m_ambientLightBuffer;
+    GfxBuffer                                m_directionalLightsBuffer;
+    GfxBuffer                                m_pointLightsBuffer;
+    GfxBuffer                                m_spotLightsBuffer;
+    DynamicArray<GfxBuffer>                  m_localShadowViewsBuffers; // per frame, views change every frame
+
+    uint32_t                                 m_directionalLightsCount = 0u;
+    uint32_t                                 m_pointLightsCount       = 0u;
+    uint32_t                                 m_spotLightsCount        = 0u;
+    uint32_t                                 m_lightsCapacity         = 0u;
+
+    /**
+     * @brief Atlas tiles of a shadow casting light, cached static depth stays
+     * valid while the light and the static geometry around it don't move
+     */
+    struct LocalShadowState
+    {
+        Array<ShadowAtlasTile, 6> tiles         = {};
+        Array<bool, 6>            isStaticValid = {};
+        uint32_t                  tileSize      = 0u;
+        glm::vec3                 position      = glm::vec3 { 0.f };
+        glm::vec3                 direction     = glm::vec3 { 0.f };
+        float                     range         = 0.f;
+        float                     outerCutOff   = 0.f;
+        uint64_t                  lastUsedFrame = 0u;
+    };
+
+    ShadowAtlas                         m_localShadowAtlas           = {};
+    HashMap<uint32_t, LocalShadowState> m_localShadowStates          = {}; // keyed by light id, spot lights have the high bit set
+    DynamicArray<uint32_t>              m_localShadowKeys            = {}; // keys of the tracked states
+    DynamicArray<GfxLocalShadowView>    m_localShadowViews           = {};
+    DynamicArray<LocalShadowRenderView> m_localShadowRenderViews     = {};
+    uint32_t                            m_staleLocalShadowViewsCount = 0u;
+    uint64_t                            m_localShadowFrame           = 0u;
+    float                               m_shadowResolutionScale      = 1.f;
 
 private:
     static LightsSystem* s_instance;
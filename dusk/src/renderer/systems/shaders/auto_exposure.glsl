@@ -0,0 +1,38 @@
+#ifndef AUTO_EXPOSURE_GLSL
+#define AUTO_EXPOSURE_GLSL
+
+// should match the auto exposure constants in render_passes.h. Bin zero collects
+// pixels below the range and is left out of the average, histogram groups have
+// one invocation per bin.
+#define EXPOSURE_HISTOGRAM_BINS 256
+#define EXPOSURE_HISTOGRAM_GROUP_SIZE 16
+
+// middle grey the average luminance is mapped to, and bounds of the exposure
+#define EXPOSURE_KEY 0.18
+#define MIN_EXPOSURE 0.0001
+#define MAX_EXPOSURE 64.0
+
+layout (set = 0, binding = 0) uniform sampler2D textures[];
+
+layout (set = 1, binding = 0, r32ui) uniform uimage2D histogramImages[];
+layout (set = 1, binding = 0, r32f) uniform image2D exposureImages[];
+
+layout(push_constant) uniform PushConstant
+{
+	int inputTextureIdx;
+	int histogramTextureIdx;
+	int exposureTextureIdx;
+	uint pixelCount;
+	float minLogLuminance;
+	float logLuminanceRange;
+	float adaptationRate;
+	uint clearHistogram;
+	uint renderWidth;
+	uint renderHeight;
+} push;
+
+float luminance(vec3 color)
+{
+	return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+#endif
\ No newline at end of file
@@ -20,8 +20,6 @@ layout (set = 0, binding = 0) uniform GlobalUBO
 	uint padding;
 	
 	uvec4 directionalLightIndices[32];
-	uvec4 pointLightIndices[32];
-	uvec4 spotLightIndices[32];
 } globalubo[];
 
 layout (set = 0, binding = 1) uniform sampler2D textures[];
@@ -46,6 +44,8 @@ layout(set = 2, binding = 1) buffer DirectionalLight
 	int pad0;
 	int pad1;
 	int pad2;
+	mat4 cascadeProjViews[4];
+	vec4 cascadeSplits;
 	vec4 color;
 	vec3 direction;
 } dirLights[];
@@ -58,6 +58,7 @@ layout(set = 2, binding = 2) buffer PointLight
 	float quadraticAttenuationFactor;
 	vec4 color;
 	vec3 position;
+	int shadowViewIdx;
 } pointLights[];
 
 layout(set = 2, binding = 3) buffer SpotLight
@@ -71,6 +72,7 @@ layout(set = 2, binding = 3) buffer SpotLight
 	float innerCutOff;
 	vec3 direction;
 	float outerCutOff;
+	int shadowViewIdx;
 } spotLights[];
 
 layout(push_constant) uniform DrawData 
@@ -204,30 +206,18 @@ void main() {
         if (4u*v + 3u < dirCount) lightColor = lightColor + computeDirectionalLight(idx4.w, viewDirection, surfaceNormal);
     }
 
-	// compute contribution of all point lights
+	// compute contribution of all point lights, their ids are dense
 	uint pointCount  = globalubo[guboIdx].pointLightsCount;
-    vec4Count = (pointCount + 3u) >> 2;   // divide by 4, round up
-    for (uint v = 0u; v < vec4Count; ++v)
+    for (uint lightIdx = 0u; lightIdx < pointCount; ++lightIdx)
     {
-        uvec4 idx4 = globalubo[guboIdx].pointLightIndices[v];
-
-        if (4u*v + 0u < pointCount) lightColor = lightColor + computePointLight(idx4.x, fragWorldPos, viewDirection, surfaceNormal);
-        if (4u*v + 1u < pointCount) lightColor = lightColor + computePointLight(idx4.y, fragWorldPos, viewDirection, surfaceNormal);
-        if (4u*v + 2u < pointCount) lightColor = lightColor + computePointLight(idx4.z, fragWorldPos, viewDirection, surfaceNormal);
-        if (4u*v + 3u < pointCount) lightColor = lightColor + computePointLight(idx4.w, fragWorldPos, viewDirection, surfaceNormal);
+        lightColor = lightColor + computePointLight(lightIdx, fragWorldPos, viewDirection, surfaceNormal);
     }
 
 	// compute contribution of all spot lights
 	uint spotCount  = globalubo[guboIdx].spotLightsCount;
-    vec4Count = (spotCount + 3u) >> 2;   // divide by 4, round up
-    for (uint v = 0u; v < vec4Count; ++v)
+    for (uint lightIdx = 0u; lightIdx < spotCount; ++lightIdx)
     {
-        uvec4 idx4 = globalubo[guboIdx].spotLightIndices[v];
-
-        if (4u*v + 0u < spotCount) lightColor = lightColor + computeSpotLight(idx4.x, fragWorldPos, viewDirection, surfaceNormal);
-        if (4u*v + 1u < spotCount) lightColor = lightColor + computeSpotLight(idx4.y, fragWorldPos, viewDirection, surfaceNormal);
-        if (4u*v + 2u < spotCount) lightColor = lightColor + computeSpotLight(idx4.z, fragWorldPos, viewDirection, surfaceNormal);
-        if (4u*v + 3u < spotCount) lightColor = lightColor + computeSpotLight(idx4.w, fragWorldPos, viewDirection, surfaceNormal);
+        lightColor = lightColor + computeSpotLight(lightIdx, fragWorldPos, viewDirection, surfaceNormal);
     }
 	
 	lightColor = lightColor + ambientColor;
@@ -22,8 +22,6 @@ layout (set = 0, binding = 0) uniform GlobalUBO
 	uint padding;
 	
 	vec4 directionalLightIndices[32];
-	vec4 pointLightIndices[32];
-	vec4 spotLightIndices[32];
 } globalubo[];
 
 layout (set = 3, binding = 0) uniform ModelUBO 
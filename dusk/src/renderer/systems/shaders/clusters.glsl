@@ -0,0 +1,50 @@
+#ifndef CLUSTERS_GLSL
+#define CLUSTERS_GLSL
+
+// should match the cluster grid constants in render_passes.h
+#define CLUSTER_GRID_X 16u
+#define CLUSTER_GRID_Y 9u
+#define CLUSTER_GRID_Z 24u
+#define CLUSTER_COUNT (CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z)
+#define MAX_LIGHTS_PER_CLUSTER 128u
+
+// attenuated intensity below which a light doesn't contribute to a cluster
+#define LIGHT_INFLUENCE_CUTOFF 0.01
+
+// depth slices are distributed exponentially between near and far planes
+uint getClusterSlice(float viewDepth, float zNear, float zFar)
+{
+	float slice = log(max(viewDepth, zNear) / zNear) / log(zFar / zNear) * float(CLUSTER_GRID_Z);
+	return min(uint(max(slice, 0.0)), CLUSTER_GRID_Z - 1);
+}
+
+float getClusterSliceDepth(uint slice, float zNear, float zFar)
+{
+	return zNear * pow(zFar / zNear, float(slice) / float(CLUSTER_GRID_Z));
+}
+
+// uv is the screen position in [0, 1] range and viewDepth is the positive distance along the view direction
+uint getClusterIndex(vec2 uv, float viewDepth, float zNear, float zFar)
+{
+	uvec2 tile = min(uvec2(uv * vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y)), uvec2(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1));
+	uint  slice = getClusterSlice(viewDepth, zNear, zFar);
+
+	return tile.x + tile.y * CLUSTER_GRID_X + slice * CLUSTER_GRID_X * CLUSTER_GRID_Y;
+}
+
+// distance at which attenuated intensity of a light drops below the cutoff
+float getLightRange(vec4 color, float constant, float linear, float quad)
+{
+	float intensity = max(max(color.r, color.g), color.b) * color.w;
+	float target = intensity / LIGHT_INFLUENCE_CUTOFF;
+
+	if (quad > 0.0)
+		return (-linear + sqrt(max(linear * linear - 4.0 * quad * (constant - target), 0.0))) / (2.0 * quad);
+
+	if (linear > 0.0)
+		return max(target - constant, 0.0) / linear;
+
+	return 3.402823466e+38; // no falloff
+}
+
+#endif
\ No newline at end of file
@@ -3,6 +3,8 @@
 #extension GL_EXT_multiview : enable
 #extension GL_EXT_nonuniform_qualifier : enable
 
+// only position is used, packed positions are mapped back to object space
+// by the model matrix so both vertex formats share this shader
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec3 tangent;
@@ -15,23 +17,28 @@ layout (set = 0, binding = 0) buffer ModelMatrixBuffer
 	mat4 modelMatrix[];
 };
 
+// should match DIR_SHADOW_CASCADES_COUNT in lights.h
+#define DIR_SHADOW_CASCADES_COUNT 4
+
 layout(set = 1, binding = 1) buffer DirectionalLight
 {
 	int id;
 	int pad0;
 	int pad1;
 	int pad2;
-	mat4 projView;
+	mat4 cascadeProjViews[DIR_SHADOW_CASCADES_COUNT];
+	vec4 cascadeSplits;
 	vec4 color;
 	vec3 direction;
 } dirLights[];
 
 void main() 
 {
-	uint dirLightIdx = nonuniformEXT(gl_ViewIndex);
+	// every view renders a cascade of the shadow casting directional light
+	uint cascadeIdx = gl_ViewIndex;
 
 	mat4 modelMat = modelMatrix[gl_InstanceIndex];
-	mat4 projViewMat = dirLights[dirLightIdx].projView;
+	mat4 projViewMat = dirLights[0].cascadeProjViews[cascadeIdx];
 
 	gl_Position = projViewMat * (modelMat * vec4(position, 1.0));
 }
\ No newline at end of file
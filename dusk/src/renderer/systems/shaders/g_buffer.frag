@@ -1,16 +1,23 @@
 #version 450
+#extension GL_ARB_shading_language_include : enable
 #extension GL_EXT_nonuniform_qualifier : enable
 
+#include "gbuffer.glsl"
+
 layout(location = 0) in vec3 fragWorldPos;
 layout(location = 1) in vec2 fragUV;
 layout(location = 2) in vec3 fragTangent;
 layout(location = 3) in vec3 fragNormal;
 layout(location = 4) in flat int fragInstanceId;
+layout(location = 5) in vec4 fragCurrClipPos;
+layout(location = 6) in vec4 fragPrevClipPos;
 
+// compact layout writes the first four targets, see gbuffer.glsl
 layout (location = 0) out vec4 outColor;
-layout (location = 1) out vec4 outNormal; // TODO: explore octohedral representation for effecient packing
+layout (location = 1) out vec4 outNormal;
 layout (location = 2) out vec4 outAORoughMetal; // R: AO, G: Roughness, B: Metallic
-layout (location = 3) out vec4 outEmissiveColor;
+layout (location = 3) out vec2 outVelocity;     // uv offset from the previous frame
+layout (location = 4) out vec4 outEmissiveColor;
 
 struct Material 
 {
@@ -25,7 +32,7 @@ struct Material
 	float normalScale;
 	float metal;
 	float rough;
-	float padding0;
+	float alphaCutoff;
 	vec4 albedoColor;
 	vec4 emissiveColor;
 
@@ -46,8 +53,12 @@ layout (set = 0, binding = 0) uniform GlobalUBO
 	uint padding;
 	
 	uvec4 directionalLightIndices[32];
-	uvec4 pointLightIndices[32];
-	uvec4 spotLightIndices[32];
+
+	mat4 viewProjection;
+	mat4 prevViewProjection;
+	vec4 jitter;
+
+	float textureLodBias;
 } globalubo[];
 
 layout (set = 1, binding = 0) buffer MaterialBuffer 
@@ -66,6 +77,7 @@ layout (set = 3, binding = 0) uniform sampler2D textures[];
 layout(push_constant) uniform DrawData 
 {
 	uint cameraIdx;
+	uint compactLayout;
 } push;
 
 void main()
@@ -89,24 +101,24 @@ void main()
     vec3 emissiveSample = vec3(0.0);
     vec3 normalSample   = vec3(0.0);
 
+	float lodBias = globalubo[guboIdx].textureLodBias;
+
 	// fetch textures
 	if (albedoTexIdx >= 0)
-        albedoSample = texture(textures[albedoTexIdx], fragUV);
+        albedoSample = texture(textures[albedoTexIdx], fragUV, lodBias);
 
     if (metalRoughTexIdx >= 0)
-        mrSample = texture(textures[metalRoughTexIdx], fragUV).rgb;
+        mrSample = texture(textures[metalRoughTexIdx], fragUV, lodBias).rgb;
 
     if (aoTexIdx >= 0)
-        aoSample = texture(textures[aoTexIdx], fragUV).r;
+        aoSample = texture(textures[aoTexIdx], fragUV, lodBias).r;
 
     if (emissiveTexIdx >= 0)
-        emissiveSample = texture(textures[emissiveTexIdx], fragUV).rgb;
+        emissiveSample = texture(textures[emissiveTexIdx], fragUV, lodBias).rgb;
 
     if (normalTexIdx >= 0)
-        normalSample = texture(textures[normalTexIdx], fragUV).xyz;
+        normalSample = texture(textures[normalTexIdx], fragUV, lodBias).xyz;
 
-	vec3 emissiveColor = texture(textures[emissiveTexIdx], fragUV).rgb;
-	
 	vec3 viewDirection = normalize(cameraPos - fragWorldPos);
 
 	vec4 baseColor = m.albedoColor;
@@ -135,8 +147,18 @@ void main()
 	}
 
 
+	outVelocity = (fragCurrClipPos.xy / fragCurrClipPos.w - fragPrevClipPos.xy / fragPrevClipPos.w) * 0.5;
+
+	if (push.compactLayout != 0u)
+	{
+		outColor = vec4(lightColor.rgb, metallic);
+		outNormal = vec4(encodeOctahedralNormal(surfaceNormal), 0.f, 0.f);
+		outAORoughMetal = encodeCompactSurface(roughness, ao, emissiveSample);
+		return;
+	}
+
 	outColor = vec4(lightColor.rgb, 1.f);
 	outNormal = vec4(surfaceNormal.xyz * 0.5 + 0.5, 0.f);
 	outAORoughMetal = vec4(ao, roughness, metallic, 1.0f);
-	outEmissiveColor = vec4(emissiveColor.rgb, 1.0f);
+	outEmissiveColor = vec4(emissiveSample.rgb, 1.0f);
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #version 450
 #extension GL_EXT_nonuniform_qualifier : enable
 
+// packed vertices store octahedral normal and tangent. Quantized position is
+// mapped back to object space by the model matrix and uv is fetched as half float.
+layout(constant_id = 0) const bool PACKED_VERTEX = false;
+
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec3 tangent;
@@ -11,6 +15,8 @@ layout(location = 1) out vec2 fragUV;
 layout(location = 2) out vec3 fragTangent;
 layout(location = 3) out vec3 fragNormal;
 layout(location = 4) out int fragInstanceId;
+layout(location = 5) out vec4 fragCurrClipPos;
+layout(location = 6) out vec4 fragPrevClipPos;
 
 layout (set = 0, binding = 0) uniform GlobalUBO 
 {
@@ -27,8 +33,10 @@ layout (set = 0, binding = 0) uniform GlobalUBO
 	uint padding;
 	
 	uvec4 directionalLightIndices[32];
-	uvec4 pointLightIndices[32];
-	uvec4 spotLightIndices[32];
+
+	mat4 viewProjection;
+	mat4 prevViewProjection;
+	vec4 jitter;
 } globalubo[];
 
 layout (set = 2, binding = 0) buffer InstanceModelMatrixBuffer 
@@ -41,11 +49,25 @@ layout (set = 2, binding = 1) buffer InstanceNormalMatrixBuffer
 	mat4 normalMatrices[];
 };
 
+layout (set = 2, binding = 5) buffer InstancePrevModelMatrixBuffer 
+{
+	mat4 prevModelMatrices[];
+};
+
 layout(push_constant) uniform DrawData 
 {
 	uint cameraIdx;
 } push;
 
+vec3 decodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	float t = clamp(-n.z, 0.0, 1.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
 void main() {	
 	uint globalIdx = nonuniformEXT(push.cameraIdx);
 
@@ -56,13 +78,20 @@ void main() {
 
 	vec4 worldPos = model * vec4(position, 1.0);
 	
-	fragTangent = normalize(normalMat * tangent);
-	fragNormal = normalize(normalMat * normal);
+	vec3 objectTangent = PACKED_VERTEX ? decodeOctahedral(tangent.xy) : tangent;
+	vec3 objectNormal = PACKED_VERTEX ? decodeOctahedral(normal.xy) : normal;
+
+	fragTangent = normalize(normalMat * objectTangent);
+	fragNormal = normalize(normalMat * objectNormal);
 
 	fragUV = uv;
 	fragWorldPos = worldPos.xyz;
 
 	fragInstanceId = gl_InstanceIndex;
 
+	// unjittered positions of this and the previous frame for motion vectors
+	fragCurrClipPos = globalubo[globalIdx].viewProjection * worldPos;
+	fragPrevClipPos = globalubo[globalIdx].prevViewProjection * (prevModelMatrices[gl_InstanceIndex] * vec4(position, 1.0));
+
 	gl_Position = proj * (view * worldPos);
 }
\ No newline at end of file
@@ -0,0 +1,79 @@
+#ifndef GBUFFER_GLSL
+#define GBUFFER_GLSL
+
+// compact layout targets:
+// 0: RGBA8 albedo and metallic
+// 1: RG16 octahedral normal
+// 2: RGBA8 roughness, ao with material flags, emissive as 5:6:5 in B and A
+// 3: RG16F motion vectors, shared with the full layout
+#define GBUFFER_FLAG_EMISSIVE 1u
+
+struct GBufferSurface
+{
+	vec3 albedo;
+	vec3 normal;
+	vec3 aoRM; // R: AO, G: Roughness, B: Metallic
+	vec3 emissive;
+};
+
+vec2 encodeOctahedralNormal(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 e = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return e * 0.5 + 0.5;
+}
+
+vec3 decodeOctahedralNormal(vec2 encoded)
+{
+	vec2 e = encoded * 2.0 - 1.0;
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	float t = clamp(-n.z, 0.0, 1.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+// ao keeps 7 bits so the flags fit in the same channel, emissive is square
+// root encoded to spend the bits on the darker values
+vec4 encodeCompactSurface(float roughness, float ao, vec3 emissive)
+{
+	uint flags = any(greaterThan(emissive, vec3(0.0))) ? GBUFFER_FLAG_EMISSIVE : 0u;
+	uint aoFlags = (uint(round(clamp(ao, 0.0, 1.0) * 127.0)) << 1u) | flags;
+
+	uvec3 e = uvec3(round(sqrt(clamp(emissive, 0.0, 1.0)) * vec3(31.0, 63.0, 31.0)));
+	uint packedEmissive = (e.r << 11u) | (e.g << 5u) | e.b;
+
+	return vec4(roughness, float(aoFlags), float(packedEmissive & 0xffu), float(packedEmissive >> 8u)) / vec4(1.0, 255.0, 255.0, 255.0);
+}
+
+GBufferSurface decodeGBuffer(bool compactLayout, vec4 albedoSample, vec4 normalSample, vec4 aoRMSample, vec3 emissiveSample)
+{
+	GBufferSurface surface;
+
+	if (!compactLayout)
+	{
+		surface.albedo = albedoSample.rgb;
+		surface.normal = normalize(normalSample.xyz * 2.0 - 1.0);
+		surface.aoRM = aoRMSample.rgb;
+		surface.emissive = emissiveSample;
+		return surface;
+	}
+
+	uint aoFlags = uint(round(aoRMSample.g * 255.0));
+
+	surface.albedo = albedoSample.rgb;
+	surface.normal = decodeOctahedralNormal(normalSample.xy);
+	surface.aoRM = vec3(float(aoFlags >> 1u) / 127.0, aoRMSample.r, albedoSample.a);
+	surface.emissive = vec3(0.0);
+
+	if ((aoFlags & GBUFFER_FLAG_EMISSIVE) != 0u)
+	{
+		uint packedEmissive = uint(round(aoRMSample.b * 255.0)) | (uint(round(aoRMSample.a * 255.0)) << 8u);
+		vec3 e = vec3(packedEmissive >> 11u, (packedEmissive >> 5u) & 0x3fu, packedEmissive & 0x1fu) / vec3(31.0, 63.0, 31.0);
+		surface.emissive = e * e;
+	}
+
+	return surface;
+}
+
+#endif
\ No newline at end of file
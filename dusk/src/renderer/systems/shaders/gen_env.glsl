@@ -0,0 +1,45 @@
+#ifndef GEN_ENV_GLSL
+#define GEN_ENV_GLSL
+
+// should match environment.h
+#define ENV_MIP_COUNT 10
+#define PREFILTERED_MIP_COUNT 5
+#define SH_COEFFICIENT_COUNT 9
+
+// mips are written through 2d array views with a layer per face
+layout (set = 0, binding = 1, rgba16f) writeonly uniform image2DArray envCubeMips[ENV_MIP_COUNT];
+layout (set = 0, binding = 2, rgba16f) writeonly uniform image2DArray irradianceCubeMap;
+layout (set = 0, binding = 3, rgba16f) writeonly uniform image2DArray prefilteredCubeMips[PREFILTERED_MIP_COUNT];
+
+// sky of the slot, stays in general layout while it is filtered
+layout (set = 0, binding = 4) uniform samplerCube envCubeMap;
+
+layout (set = 0, binding = 5, std430) buffer SHCoefficients
+{
+	vec4 shCoefficients[SH_COEFFICIENT_COUNT];
+};
+
+layout(push_constant) uniform IBLPushConstant
+{
+	uint resolution;
+	uint mipLevel;
+	uint faceOffset;
+	uint sampleCount;
+	float roughness;
+} push;
+
+// real SH basis up to the second band
+void evalSHBasis(vec3 dir, out float basis[SH_COEFFICIENT_COUNT])
+{
+	basis[0] = 0.282095;
+	basis[1] = 0.488603 * dir.y;
+	basis[2] = 0.488603 * dir.z;
+	basis[3] = 0.488603 * dir.x;
+	basis[4] = 1.092548 * dir.x * dir.y;
+	basis[5] = 1.092548 * dir.y * dir.z;
+	basis[6] = 0.315392 * (3.0 * dir.z * dir.z - 1.0);
+	basis[7] = 1.092548 * dir.x * dir.z;
+	basis[8] = 0.546274 * (dir.x * dir.x - dir.y * dir.y);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,330 @@
+#ifndef LIGHTS_GLSL
+#define LIGHTS_GLSL
+
+// light buffers and evaluation shared by the deferred lighting paths. Lights
+// descriptor set is expected at set 2, shadowMaps[] (sampler2DArrayShadow) and
+// localShadowMaps[] (sampler2DShadow) have to be declared by the including shader.
+
+// should match DIR_SHADOW_CASCADES_COUNT in lights.h
+#define DIR_SHADOW_CASCADES_COUNT 4
+
+layout(set = 2, binding = 0) buffer AmbientLight
+{
+	vec4 color;
+} ambientLight;
+
+layout(set = 2, binding = 1) buffer DirectionalLight
+{
+	int id;
+	int pad0;
+	int pad1;
+	int pad2;
+	mat4 cascadeProjViews[DIR_SHADOW_CASCADES_COUNT];
+	vec4 cascadeSplits;
+	vec4 color;
+	vec3 direction;
+} dirLights;
+
+layout(set = 2, binding = 2) buffer PointLight
+{
+	int id;
+	float constantAttenuationFactor;
+	float linearAttenuationFactor;
+	float quadraticAttenuationFactor;
+	mat4 projView;
+	vec4 color;
+	vec3 position;
+	int shadowViewIdx;
+} pointLights[];
+
+layout(set = 2, binding = 3) buffer SpotLight
+{
+	int id;
+	float constantAttenuationFactor;
+	float linearAttenuationFactor;
+	float quadraticAttenuationFactor;
+	mat4 projView;
+	vec4 color;
+	vec3 position;
+	float innerCutOff;
+	vec3 direction;
+	float outerCutOff;
+	int shadowViewIdx;
+} spotLights[];
+
+struct LocalShadowView
+{
+	mat4 projView;
+	vec4 atlasRect; // uv offset in xy and uv scale in zw, zero when view has no tile
+	vec4 params; // x is world size of a texel per unit of distance from the light
+};
+
+layout(set = 2, binding = 4) readonly buffer LocalShadowViews
+{
+	LocalShadowView views[];
+} localShadowViews;
+
+// index of the cube face view looking at the direction, should match
+// CUBE_FACE_DIRECTIONS in lights_system.cpp
+uint getCubeFace(vec3 direction)
+{
+	vec3 absDirection = abs(direction);
+
+	if (absDirection.x >= absDirection.y && absDirection.x >= absDirection.z)
+		return direction.x > 0.0 ? 0u : 1u;
+
+	if (absDirection.y >= absDirection.z)
+		return direction.y > 0.0 ? 2u : 3u;
+
+	return direction.z > 0.0 ? 4u : 5u;
+}
+
+// visibility of the fragment from a point or spot light, views without an atlas
+// tile are not shadowed
+float computeLocalShadow(
+	int localShadowMapIdx,
+	int viewIdx,
+	vec3 lightPosition,
+	vec3 fragWorldPos,
+	vec3 normal)
+{
+	if (localShadowMapIdx < 0 || viewIdx < 0)
+		return 1.0;
+
+	vec4 atlasRect = localShadowViews.views[viewIdx].atlasRect;
+	if (atlasRect.z <= 0.0)
+		return 1.0;
+
+	// offset along the normal by the size of a shadow texel at fragment distance
+	float texelSize = localShadowViews.views[viewIdx].params.x * length(lightPosition - fragWorldPos);
+	vec4 fragLightSpacePos = localShadowViews.views[viewIdx].projView * vec4(fragWorldPos + normal * texelSize * 1.5, 1.0);
+	vec3 projCoords = fragLightSpacePos.xyz / fragLightSpacePos.w;
+	vec2 uv = projCoords.xy * 0.5 + 0.5;
+
+	// outside of the spot light cone
+	if (any(lessThan(uv, vec2(0.0))) || any(greaterThan(uv, vec2(1.0))))
+		return 1.0;
+
+	// filtering must not pick texels of the neighbouring tiles
+	vec2 halfTexel = 0.5 / vec2(textureSize(localShadowMaps[localShadowMapIdx], 0));
+	uv = clamp(atlasRect.xy + uv * atlasRect.zw, atlasRect.xy + halfTexel, atlasRect.xy + atlasRect.zw - halfTexel);
+
+	// hardware pcf
+	float shadow = texture(localShadowMaps[localShadowMapIdx], vec3(uv, projCoords.z - 0.00005));
+
+	return 1.0 - shadow;
+}
+
+vec3 computeDirLightsNonPBR(vec3 viewDirection, vec3 normal)
+{
+    vec3 lightDirection = normalize(-dirLights.direction);
+	vec3 lightColor = dirLights.color.xyz;
+	float lightIntensity = dirLights.color.w;
+    
+	// diffuse shading
+    float diff = max(dot(normal, lightDirection), 0.0);
+    
+	// specular shading
+    //vec3 reflectDirection = reflect(-lightDirection, normal);
+    //float spec = pow(max(dot(viewDirection, reflectDirection), 0.0), 300);
+	vec3 halfAngle = normalize(lightDirection + viewDirection);
+	float blinnTerm = dot(normal, halfAngle);
+	blinnTerm = clamp(blinnTerm, 0, 1);
+	float spec = pow(blinnTerm, 512.0);
+    
+	// combine results
+    vec3 diffuse  = lightColor * diff * lightIntensity;
+    vec3 specular = lightColor * spec * lightIntensity;
+    return (diffuse + specular);
+}
+
+// viewDepth is the positive distance of the fragment along the view direction
+vec3 computeDirectionalLight(
+	int dirShadowMapIdx,
+	float viewDepth,
+	vec3 fragWorldPos,
+	vec3 albedo, 
+	vec3 f0, 
+	vec3 aoRM, 
+	vec3 viewDirection, 
+	vec3 normal)
+{
+	vec3 lightDirection = normalize(-dirLights.direction);
+	vec3 halfDirection = normalize(lightDirection + viewDirection);
+	
+	vec3 lightColor = dirLights.color.xyz * dirLights.color.w;
+	vec3 radiance = lightColor;
+	
+	// cook-torrance
+	float r = (aoRM.g + 1.0f);
+    float k = (r*r) / 8.0f;
+
+	float ndf = distributionGGX(normal, halfDirection, aoRM.g);
+	float g = geometrySmith(normal, viewDirection, lightDirection, k);
+	vec3 f = fresnelSchlick(max(dot(halfDirection, viewDirection), 0.0), f0);
+
+	vec3 ks = f;
+	vec3 kd = vec3(1.0) - ks;
+	kd *= 1.0 - aoRM.b;
+
+	float ndotl = max(dot(normal, lightDirection), 0.0);
+	float ndotv = max(dot(normal, viewDirection), 0.0);
+
+	vec3 numer = ndf * g * f;
+	float denom = 4.0 * ndotv * ndotl + 0.0001;
+	vec3 specular = numer / denom;
+
+	lightColor = (kd * albedo / PI + specular) * radiance * ndotl;
+
+	// shadow calculations, first cascade which covers the fragment is used
+	uint cascade = 0u;
+	while (cascade < DIR_SHADOW_CASCADES_COUNT && viewDepth > dirLights.cascadeSplits[cascade])
+		++cascade;
+
+	// fragment is beyond the shadow distance
+	if (cascade == DIR_SHADOW_CASCADES_COUNT)
+		return lightColor;
+
+	vec4 fragLightSpacePos = (dirLights.cascadeProjViews[cascade] * vec4(fragWorldPos, 1.0));
+	float NdotL = max(dot(normal, lightDirection), 0.0);
+	vec3 projCoords = fragLightSpacePos.xyz / fragLightSpacePos.w;
+	projCoords.xy = projCoords.xy * 0.5 + 0.5; // only xy because z is in [0,1] after perspective divide
+	float currentDepth = projCoords.z;
+
+	// farther cascades cover more world space per texel
+	float bias =  max(0.0001 * (1.0 - NdotL), 0.00005) * float(cascade + 1u);
+
+	// hardware pcf
+	float shadow = texture(
+		shadowMaps[dirShadowMapIdx],
+		vec4(projCoords.xy, float(cascade), projCoords.z - bias)
+	);
+
+	return (1.0f - shadow) * lightColor;
+}
+
+// light ids come from the cluster or tile light lists, so indexing is non uniform
+vec3 computePointLight(
+	int localShadowMapIdx,
+	uint lightIdx,
+	vec3 albedo, 
+	vec3 f0, 
+	vec3 aoRM, 
+	vec3 fragPosition, 
+	vec3 viewDirection, 
+	vec3 normal)
+{
+	vec3 lightPosition = pointLights[nonuniformEXT(lightIdx)].position;
+	vec3 lightDirection = normalize(lightPosition - fragPosition);
+	vec3 halfDirection = normalize(lightDirection + viewDirection);
+
+	vec3 lightColor = pointLights[nonuniformEXT(lightIdx)].color.xyz * pointLights[nonuniformEXT(lightIdx)].color.w;
+    
+	// attenuation
+	float constant = pointLights[nonuniformEXT(lightIdx)].constantAttenuationFactor;
+	float linear = pointLights[nonuniformEXT(lightIdx)].linearAttenuationFactor;
+	float quad = pointLights[nonuniformEXT(lightIdx)].quadraticAttenuationFactor;
+    float distance    = length(lightPosition - fragPosition);
+    float attenuation = 1.0 / (constant + linear * distance + 
+  			     quad * (distance * distance));
+
+	vec3 radiance = lightColor * attenuation;
+    
+	// cook-torrance
+	float ndf = distributionGGX(normal, halfDirection, aoRM.g);
+	float r = (aoRM.g + 1.0);
+    float k = (r*r) / 8.0;
+	float g = geometrySmith(normal, viewDirection, lightDirection, k);
+	vec3 f = fresnelSchlick(max(dot(halfDirection, viewDirection), 0.0), f0);
+
+	vec3 ks = f;
+	vec3 kd = vec3(1.0) - ks;
+	kd *= 1.0 - aoRM.b;
+
+	float ndotl = max(dot(normal, lightDirection), 0.0);
+	float ndotv = max(dot(normal, viewDirection), 0.0);
+
+	vec3 numer = ndf * g * f;
+	float denom = 4.0 * ndotv * ndotl + 0.0001;
+	vec3 specular = numer / denom;
+
+	// cube face views of the light are stored next to each other
+	int shadowViewIdx = pointLights[nonuniformEXT(lightIdx)].shadowViewIdx;
+	if (shadowViewIdx >= 0)
+		shadowViewIdx += int(getCubeFace(fragPosition - lightPosition));
+
+	float visibility = computeLocalShadow(localShadowMapIdx, shadowViewIdx, lightPosition, fragPosition, normal);
+
+	return (kd * albedo / PI + specular) * radiance * ndotl * visibility;
+}
+
+vec3 computeSpotLight(
+	int localShadowMapIdx,
+	uint lightIdx,
+	vec3 albedo, 
+	vec3 f0, 
+	vec3 aoRM, 
+	vec3 fragPosition, 
+	vec3 viewDirection, 
+	vec3 normal)
+{
+	vec3 lightPosition = spotLights[nonuniformEXT(lightIdx)].position;
+	vec3 lightSrcDirection = normalize(lightPosition - fragPosition);
+	vec3 lightDirection = normalize(-spotLights[nonuniformEXT(lightIdx)].direction);
+	vec3 halfDirection = normalize(lightDirection + viewDirection);
+
+	vec3 lightColor = spotLights[nonuniformEXT(lightIdx)].color.xyz * spotLights[nonuniformEXT(lightIdx)].color.w;
+
+	// cutoff calculations
+	float theta     = dot(lightSrcDirection, lightDirection);
+	float innerCutOff = spotLights[nonuniformEXT(lightIdx)].innerCutOff;
+	float outerCutOff = spotLights[nonuniformEXT(lightIdx)].outerCutOff;
+	float epsilon   = innerCutOff - outerCutOff;
+	
+	if (theta > outerCutOff)
+	{
+		float intensityFalloffMult = 1.f;
+		if (theta < innerCutOff)
+			intensityFalloffMult = clamp((theta - outerCutOff) / epsilon, 0.0, 1.0);
+
+		lightColor *= intensityFalloffMult;
+		
+		// attenuation
+		float constant = spotLights[nonuniformEXT(lightIdx)].constantAttenuationFactor;
+		float linear = spotLights[nonuniformEXT(lightIdx)].linearAttenuationFactor;
+		float quad = spotLights[nonuniformEXT(lightIdx)].quadraticAttenuationFactor;
+		float distance    = length(lightPosition - fragPosition);
+		float attenuation = 1.0 / (constant + linear * distance + 
+  					 quad * (distance * distance));
+
+		vec3 radiance = lightColor * attenuation;
+    
+		// cook-torrance
+		float ndf = distributionGGX(normal, halfDirection, aoRM.g);
+		float r = (aoRM.g + 1.0);
+		float k = (r*r) / 8.0;
+		float g = geometrySmith(normal, viewDirection, lightDirection, k);
+		vec3 f = fresnelSchlick(max(dot(halfDirection, viewDirection), 0.0), f0);
+
+		vec3 ks = f;
+		vec3 kd = vec3(1.0) - ks;
+		kd *= 1.0 - aoRM.b;
+
+		float ndotl = max(dot(normal, lightDirection), 0.0);
+		float ndotv = max(dot(normal, viewDirection), 0.0);
+
+		vec3 numer = ndf * g * f;
+		float denom = 4.0 * ndotv * ndotl + 0.0001;
+		vec3 specular = numer / denom;
+
+		float visibility = computeLocalShadow(localShadowMapIdx, spotLights[nonuniformEXT(lightIdx)].shadowViewIdx, lightPosition, fragPosition, normal);
+
+		return (kd * albedo / PI + specular) * radiance * ndotl * visibility;
+	}
+	else
+	{
+		return vec3(0.f); // no color
+	}
+}
+
+#endif
\ No newline at end of file
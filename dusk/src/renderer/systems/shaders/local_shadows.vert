@@ -0,0 +1,43 @@
+#version 450
+
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// only position is used, packed positions are mapped back to object space
+// by the model matrix so both vertex formats share this shader
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec3 tangent;
+layout(location = 3) in vec2 uv;
+
+layout (set = 0, binding = 0) buffer ModelMatrixBuffer 
+{
+	mat4 modelMatrix[];
+};
+
+// should match GfxLocalShadowView in lights_system.h
+struct LocalShadowView
+{
+	mat4 projView;
+	vec4 atlasRect;
+	vec4 params;
+};
+
+layout(set = 1, binding = 4) readonly buffer LocalShadowViews
+{
+	LocalShadowView views[];
+} localShadowViews;
+
+layout(push_constant) uniform PushConstant
+{
+	uint viewIdx;
+	int staticAtlasTextureIdx;
+} push;
+
+void main() 
+{
+	// viewport and scissor of the draw cover the atlas tile of the view
+	mat4 modelMat = modelMatrix[gl_InstanceIndex];
+	mat4 projViewMat = localShadowViews.views[push.viewIdx].projView;
+
+	gl_Position = projViewMat * (modelMat * vec4(position, 1.0));
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 450
+
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// copies cached static depth of a tile into the shadow atlas before dynamic
+// casters are drawn, viewport covers the tile and both atlases have the same
+// resolution so the fragment coordinates address the same texel
+layout (set = 2, binding = 0) uniform sampler2D textures[];
+
+layout(push_constant) uniform PushConstant
+{
+	uint viewIdx;
+	int staticAtlasTextureIdx;
+} push;
+
+void main()
+{
+	gl_FragDepth = texelFetch(textures[nonuniformEXT(push.staticAtlasTextureIdx)], ivec2(gl_FragCoord.xy), 0).r;
+}
\ No newline at end of file
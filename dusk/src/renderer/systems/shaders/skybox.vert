@@ -41,8 +41,6 @@ layout (set = 0, binding = 0) uniform GlobalUBO
 	uint padding;
 	
 	uvec4 directionalLightIndices[32];
-	uvec4 pointLightIndices[32];
-	uvec4 spotLightIndices[32];
 } globalubo[];
 
 layout(push_constant) uniform SkyBoxPushConstant 
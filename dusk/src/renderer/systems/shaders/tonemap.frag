@@ -11,6 +11,9 @@ layout(push_constant) uniform PushConstant
 {
 	int inputTextureIdx;
     float exposure;
+    int exposureTextureIdx;
+    uint renderWidth;
+    uint renderHeight;
 } push;
 
 
@@ -62,10 +65,20 @@ void main()
 {
     int hdrTextureIdx = nonuniformEXT(push.inputTextureIdx);
 
-    vec3 hdrColor = texture(textures[hdrTextureIdx], fragUV).rgb;
+    // input may be drawn into a corner of its texture at lower render scale
+    vec2 renderSize = vec2(push.renderWidth, push.renderHeight);
+    vec2 inputUV    = clamp(fragUV * renderSize, vec2(0.5), renderSize - 0.5) / vec2(textureSize(textures[hdrTextureIdx], 0));
 
-    // exposure
-    hdrColor *= push.exposure;
+    vec3 hdrColor = texture(textures[hdrTextureIdx], inputUV).rgb;
+
+    // exposure, fixed one compensates the adapted exposure when available
+    float exposure = push.exposure;
+    if (push.exposureTextureIdx >= 0)
+    {
+        exposure *= texelFetch(textures[nonuniformEXT(push.exposureTextureIdx)], ivec2(0), 0).r;
+    }
+
+    hdrColor *= exposure;
 
     // tonemap
     hdrColor = ReinhardJodie(hdrColor);
@@ -0,0 +1,15 @@
+#version 450
+#extension GL_ARB_shading_language_include : enable
+
+#include "visibility.glsl"
+
+layout(location = 0) in flat uint fragInstanceId;
+
+layout(location = 0) out uint outVisibility;
+
+void main()
+{
+	// primitive id restarts with every draw, material pass finds the triangle
+	// from the first index of the mesh drawn for the instance
+	outVisibility = encodeVisibility(fragInstanceId, uint(gl_PrimitiveID));
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef VISIBILITY_GLSL
+#define VISIBILITY_GLSL
+
+// should match VISIBILITY_TRIANGLE_BITS in render_passes.h. Upper bits hold the
+// renderable index plus one so a cleared texel reads as empty.
+#define VISIBILITY_TRIANGLE_BITS 18u
+#define VISIBILITY_TRIANGLE_MASK ((1u << VISIBILITY_TRIANGLE_BITS) - 1u)
+#define VISIBILITY_EMPTY 0u
+
+uint encodeVisibility(uint instanceIdx, uint triangleIdx)
+{
+	return ((instanceIdx + 1u) << VISIBILITY_TRIANGLE_BITS) | (triangleIdx & VISIBILITY_TRIANGLE_MASK);
+}
+
+uint getVisibilityInstance(uint visibility)
+{
+	return (visibility >> VISIBILITY_TRIANGLE_BITS) - 1u;
+}
+
+uint getVisibilityTriangle(uint visibility)
+{
+	return visibility & VISIBILITY_TRIANGLE_MASK;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#version 450
+
+#extension GL_EXT_nonuniform_qualifier : enable
+
+// only position is used, packed positions are mapped back to object space
+// by the model matrix so both vertex formats share this shader
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec3 tangent;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out flat uint fragInstanceId;
+
+layout (set = 0, binding = 0) uniform GlobalUBO 
+{
+	mat4 projection;
+	mat4 view;
+	mat4 inverseView;
+	mat4 inverseProjection;
+
+	vec4 frustumPlanes[6];
+		
+	uint directionalLightsCount;
+	uint pointLightsCount;     
+	uint spotLightsCount;      
+	uint padding;
+	
+	uvec4 directionalLightIndices[32];
+} globalubo[];
+
+layout (set = 1, binding = 0) buffer InstanceModelMatrixBuffer 
+{
+	mat4 modelMatrices[];
+};
+
+layout(push_constant) uniform DrawData 
+{
+	uint cameraIdx;
+} push;
+
+void main() 
+{
+	uint globalIdx = nonuniformEXT(push.cameraIdx);
+
+	mat4 model = modelMatrices[gl_InstanceIndex];
+	mat4 view = globalubo[globalIdx].view;
+	mat4 proj = globalubo[globalIdx].projection;
+
+	fragInstanceId = gl_InstanceIndex;
+
+	gl_Position = proj * (view * (model * vec4(position, 1.0)));
+}
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "engine.h"
 #include "image.h"
 #include "gfx_buffer.h"
+#include "texture_db.h"
+#include "mip_generator.h"
 
 #include "debug/profiler.h"
 
@@ -277,14 +279,13 @@ Error GfxTexture::init(
 }
 
 Error GfxTexture::init(
-    ImageData&      texImage,
-    TextureType     type,
-    VkFormat        format,
-    uint32_t        usage,
-    VkCommandBuffer graphicsBuffer,
-    VkCommandBuffer transferBuffer,
-    bool            generateMips,
-    const char*     debugName)
+    ImageData&          texImage,
+    TextureType         type,
+    VkFormat            format,
+    uint32_t            usage,
+    TextureUploadBatch& batch,
+    bool                generateMips,
+    const char*         debugName)
 {
     DUSK_PROFILE_FUNCTION;
 
@@ -308,7 +309,7 @@ Error GfxTexture::init(
         imageAspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
     }
 
-    // staging buffer for transfer
+    // staging buffer for transfer, released with the batch
     GfxBuffer stagingBuffer;
     GfxBuffer::createHostWriteBuffer(
         GfxBufferUsageFlags::TransferSource,
@@ -323,6 +324,9 @@ Error GfxTexture::init(
     // copy image data
     stagingBuffer.writeAndFlushAtIndex(0, texImage.data, texImage.size);
 
+    batch.stagingBuffers.push_back(stagingBuffer);
+    batch.stagingSize += texImage.size;
+
     // copy region for each mip level
     DynamicArray<VkBufferImageCopy> bufferCopyRegions(numMipLevels);
     for (uint32_t mipLevel = 0u; mipLevel < numMipLevels; ++mipLevel)
@@ -341,6 +345,14 @@ Error GfxTexture::init(
     if (generateMips)
         this->numMipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
 
+    // mips are generated on async compute queue when format allows it, otherwise
+    // fallback to blit chain on graphics queue
+    MipGenerator& mipGenerator   = TextureDB::cache()->getMipGenerator();
+    bool          useComputeMips = generateMips
+        && numMipLevels > 1
+        && batch.computeBuffer != VK_NULL_HANDLE
+        && mipGenerator.isFormatSupported(format);
+
     // create dest image
     VkImageCreateInfo imageInfo { VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO };
     imageInfo.imageType     = vulkan::getImageType(type);
@@ -359,6 +371,15 @@ Error GfxTexture::init(
     if (type == TextureType::Cube)
         imageInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
 
+    if (useComputeMips)
+    {
+        imageInfo.usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+
+        // srgb formats don't support storage, so mips are written through a unorm view
+        if (vulkan::isSRGBFormat(format))
+            imageInfo.flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+    }
+
     // create image
     VulkanResult result = vulkan::allocateGPUImage(
         vkContext.gpuAllocator,
@@ -384,11 +405,6 @@ Error GfxTexture::init(
     }
 #endif // VK_RENDERER_DEBUG
 
-    VkCommandBufferBeginInfo beginInfo { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(transferBuffer, &beginInfo);
-
     VkImageMemoryBarrier barrier { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
     barrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
     barrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
@@ -404,7 +420,7 @@ Error GfxTexture::init(
     barrier.dstAccessMask                   = VK_ACCESS_MEMORY_WRITE_BIT;
 
     vkCmdPipelineBarrier(
-        transferBuffer,
+        batch.transferBuffer,
         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
         VK_PIPELINE_STAGE_TRANSFER_BIT,
         0,
@@ -416,7 +432,7 @@ Error GfxTexture::init(
         &barrier);
 
     vkCmdCopyBufferToImage(
-        transferBuffer,
+        batch.transferBuffer,
         stagingBuffer.vkBuffer.buffer,
         image.vkImage,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -426,9 +442,9 @@ Error GfxTexture::init(
     // release ownership from transfer queue
     barrier                                 = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
     barrier.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout                       = useComputeMips ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
     barrier.srcQueueFamilyIndex             = vkContext.transferQueueFamilyIndex;
-    barrier.dstQueueFamilyIndex             = vkContext.graphicsQueueFamilyIndex;
+    barrier.dstQueueFamilyIndex             = useComputeMips ? vkContext.computeQueueFamilyIndex : vkContext.graphicsQueueFamilyIndex;
     barrier.image                           = image.vkImage;
     barrier.subresourceRange.aspectMask     = imageAspectFlags;
     barrier.subresourceRange.baseMipLevel   = 0;
@@ -438,7 +454,7 @@ Error GfxTexture::init(
     barrier.srcAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
 
     vkCmdPipelineBarrier(
-        transferBuffer,
+        batch.transferBuffer,
         VK_PIPELINE_STAGE_TRANSFER_BIT,
         VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
         0,
@@ -449,83 +465,47 @@ Error GfxTexture::init(
         1,
         &barrier);
 
-    vkEndCommandBuffer(transferBuffer);
-
-    VkSemaphoreCreateInfo semInfo { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
-
-    VkSemaphore           uploadFinishedSemaphore;
-    vkCreateSemaphore(vkContext.device, &semInfo, nullptr, &uploadFinishedSemaphore);
-
-    // submit transfer work
-    VkSubmitInfo submitInfo { VK_STRUCTURE_TYPE_SUBMIT_INFO };
-    submitInfo.commandBufferCount   = 1;
-    submitInfo.pCommandBuffers      = &transferBuffer;
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores    = &uploadFinishedSemaphore;
-
-    vkQueueSubmit(vkContext.transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
-
-    vkBeginCommandBuffer(graphicsBuffer, &beginInfo);
-
-    // graphics queue will require ownership
-    barrier                                 = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
-    barrier.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barrier.newLayout                       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    barrier.srcQueueFamilyIndex             = vkContext.transferQueueFamilyIndex;
-    barrier.dstQueueFamilyIndex             = vkContext.graphicsQueueFamilyIndex;
-    barrier.image                           = image.vkImage;
-    barrier.subresourceRange.aspectMask     = imageAspectFlags;
-    barrier.subresourceRange.baseMipLevel   = 0;
-    barrier.subresourceRange.levelCount     = numMipLevels;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount     = numLayers;
-    barrier.dstAccessMask                   = VK_ACCESS_SHADER_READ_BIT;
-
-    vkCmdPipelineBarrier(
-        graphicsBuffer,
-        VK_PIPELINE_STAGE_TRANSFER_BIT,
-        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-        0,
-        0,
-        nullptr,
-        0,
-        nullptr,
-        1,
-        &barrier);
-
-    this->currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-    // start mip genration
-    if (generateMips)
+    if (useComputeMips)
     {
-        recordMipGenerationCmds(graphicsBuffer);
+        recordComputeMipGeneration(batch, mipGenerator);
     }
+    else
+    {
+        // graphics queue will require ownership
+        barrier                                 = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+        barrier.oldLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout                       = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcQueueFamilyIndex             = vkContext.transferQueueFamilyIndex;
+        barrier.dstQueueFamilyIndex             = vkContext.graphicsQueueFamilyIndex;
+        barrier.image                           = image.vkImage;
+        barrier.subresourceRange.aspectMask     = imageAspectFlags;
+        barrier.subresourceRange.baseMipLevel   = 0;
+        barrier.subresourceRange.levelCount     = numMipLevels;
+        barrier.subresourceRange.baseArrayLayer = 0;
+        barrier.subresourceRange.layerCount     = numLayers;
+        barrier.dstAccessMask                   = VK_ACCESS_SHADER_READ_BIT;
 
-    vkEndCommandBuffer(graphicsBuffer);
-
-    VkPipelineStageFlags waitStages[] = {
-        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT
-    };
-
-    submitInfo                    = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers    = &graphicsBuffer;
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores    = &uploadFinishedSemaphore;
-    submitInfo.pWaitDstStageMask  = waitStages;
+        vkCmdPipelineBarrier(
+            batch.graphicsBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            1,
+            &barrier);
 
-    vkQueueSubmit(vkContext.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+        this->currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-    // wait for graphics queue operation to finish
-    {
-        DUSK_PROFILE_SECTION("graphics_queue_wait");
-        vkQueueWaitIdle(vkContext.graphicsQueue);
+        // start mip genration
+        if (generateMips)
+        {
+            recordMipGenerationCmds(batch.graphicsBuffer);
+        }
     }
 
-    vkDestroySemaphore(vkContext.device, uploadFinishedSemaphore, nullptr);
-
-    stagingBuffer.cleanup();
-
     result = device.createImageView(
         &image,
         vulkan::getImageViewType(type),
@@ -535,7 +515,8 @@ Error GfxTexture::init(
         numMipLevels,
         0,
         numLayers,
-        &imageView);
+        &imageView,
+        vulkan::getTextureUsageFlagBits(usage));
 
     if (result.hasError())
     {
@@ -553,6 +534,72 @@ Error GfxTexture::init(
     return Error::Ok;
 }
 
+void GfxTexture::recordComputeMipGeneration(
+    TextureUploadBatch& batch,
+    MipGenerator&       mipGenerator)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    auto&                 vkContext         = VkGfxDevice::getSharedVulkanContext();
+    bool                  isSameFamily      = vkContext.computeQueueFamilyIndex == vkContext.graphicsQueueFamilyIndex;
+
+    VkImageMemoryBarrier2 barrier           = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+    barrier.image                           = image.vkImage;
+    barrier.subresourceRange.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel   = 0;
+    barrier.subresourceRange.levelCount     = numMipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount     = numLayers;
+
+    VkDependencyInfo dependencyInfo         = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+    dependencyInfo.imageMemoryBarrierCount  = 1;
+    dependencyInfo.pImageMemoryBarriers     = &barrier;
+
+    // compute queue will acquire ownership from transfer queue
+    if (vkContext.transferQueueFamilyIndex != vkContext.computeQueueFamilyIndex)
+    {
+        barrier.srcStageMask        = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask       = VK_ACCESS_2_NONE;
+        barrier.dstStageMask        = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.dstAccessMask       = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        barrier.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout           = VK_IMAGE_LAYOUT_GENERAL;
+        barrier.srcQueueFamilyIndex = vkContext.transferQueueFamilyIndex;
+        barrier.dstQueueFamilyIndex = vkContext.computeQueueFamilyIndex;
+
+        vkCmdPipelineBarrier2(batch.computeBuffer, &dependencyInfo);
+    }
+
+    currentLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+    mipGenerator.recordMipGenerationCmds(batch.computeBuffer, *this, alphaCutoff);
+
+    // release ownership to graphics queue
+    barrier.srcStageMask        = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+    barrier.srcAccessMask       = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    barrier.dstStageMask        = isSameFamily ? VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT : VK_PIPELINE_STAGE_2_NONE;
+    barrier.dstAccessMask       = isSameFamily ? VK_ACCESS_2_SHADER_SAMPLED_READ_BIT : VK_ACCESS_2_NONE;
+    barrier.oldLayout           = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = vkContext.computeQueueFamilyIndex;
+    barrier.dstQueueFamilyIndex = vkContext.graphicsQueueFamilyIndex;
+
+    vkCmdPipelineBarrier2(batch.computeBuffer, &dependencyInfo);
+
+    if (!isSameFamily)
+    {
+        // graphics queue will acquire ownership, layout transition was part of release
+        barrier.srcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.dstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+
+        vkCmdPipelineBarrier2(batch.graphicsBuffer, &dependencyInfo);
+    }
+
+    currentLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
 void GfxTexture::recordMipGenerationCmds(VkCommandBuffer cmdBuff)
 {
     VkImageMemoryBarrier barrier            = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
@@ -812,7 +859,8 @@ void GfxTexture::recordTransitionLayout(
     VkImageAspectFlags imageAspectFlags = VK_IMAGE_ASPECT_COLOR_BIT;
     if (vulkan::getTextureUsageFlagBits(usage) & DepthStencilTexture)
     {
-        imageAspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        imageAspectFlags = VK_IMAGE_ASPECT_DEPTH_BIT;
+        if (vulkan::hasStencilComponent(format)) imageAspectFlags |= VK_IMAGE_ASPECT_STENCIL_BIT;
     }
 
     VkImageMemoryBarrier barrier { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "dusk.h"
+#include "renderer/gfx_buffer.h"
 #include "backend/vulkan/vk_types.h"
 
 #include <thread>
@@ -8,7 +9,7 @@
 namespace dusk
 {
 struct ImageData;
-class GfxBuffer;
+class MipGenerator;
 
 enum TextureUsageFlags : uint32_t
 {
@@ -30,6 +31,22 @@ enum class TextureType : uint32_t
     CubeArray,
 };
 
+/**
+ * @brief Cmd buffers and transient resources shared by textures which are
+ * uploaded together. Cmds of all the textures are recorded first and the
+ * batch is submitted once, its completion is tracked by a single timeline value.
+ */
+struct TextureUploadBatch
+{
+    VkCommandBuffer         graphicsBuffer = VK_NULL_HANDLE;
+    VkCommandBuffer         transferBuffer = VK_NULL_HANDLE;
+    VkCommandBuffer         computeBuffer  = VK_NULL_HANDLE;
+
+    DynamicArray<GfxBuffer> stagingBuffers = {}; // alive till the batch finishes execution
+    VkDeviceSize            stagingSize    = 0u;
+    DynamicArray<uint32_t>  textureIds     = {};
+};
+
 struct GfxTexture
 {
     uint32_t       id;
@@ -41,6 +58,7 @@ struct GfxTexture
     uint32_t       usage         = 0u;
     TextureType    type          = TextureType::Texture2D;
     size_t         uploadHash    = {}; // used for tracking ongoing uploads
+    float          alphaCutoff   = 0.f; // alpha tested coverage is preserved in generated mips, 0 to disable
 
     VulkanGfxImage image         = {};
     VkImageView    imageView     = {};
@@ -102,33 +120,44 @@ struct GfxTexture
         const char* name = nullptr);
 
     /**
-     * @brief Initialize texture and use given command buffers for upload.
-     * It will use texture queue to upload and then transfer ownership
-     * to graphics queue for usage.
+     * @brief Initialize texture and record its upload in the cmd buffers of the
+     * batch. It will use transfer queue to upload and then transfer ownership
+     * to graphics queue for usage. Mips are generated on compute queue
+     * when the format supports it. Texture can be used once the batch has
+     * finished execution.
      * @param Image data
      * @param type of texture
      * @param usage flags
-     * @param graphicsBuffer command buffer corresponding to graphics queue
-     * @param transferBuffer command buffer corresponding to transfer queue
+     * @param batch with cmd buffers in recording state
+     * @param generateMips whether mips needs to be generated from mip 0
      * @param name Optional name for the texture resources
      * @return Error status for the complete operation
      */
     Error init(
-        ImageData&      texImage,
-        TextureType     type,
-        VkFormat        format,
-        uint32_t        usage,
-        VkCommandBuffer graphicsBuffer,
-        VkCommandBuffer transferBuffer,
-        bool            generateMips,
-        const char*     name = nullptr);
+        ImageData&          texImage,
+        TextureType         type,
+        VkFormat            format,
+        uint32_t            usage,
+        TextureUploadBatch& batch,
+        bool                generateMips,
+        const char*         name = nullptr);
 
     /**
-     * @brief Record cmds for generating mip maps
-     * @param cmdBuff 
+     * @brief Record cmds for generating mip maps using blit chain
+     * @param cmdBuff
      */
     void recordMipGenerationCmds(VkCommandBuffer cmdBuff);
 
+    /**
+     * @brief Record mip generation on compute queue after acquiring the image
+     * from transfer queue. Ownership is released to graphics queue afterwards.
+     * @param batch with cmd buffers in recording state
+     * @param mipGenerator for recording compute dispatches
+     */
+    void recordComputeMipGeneration(
+        TextureUploadBatch& batch,
+        MipGenerator&       mipGenerator);
+
     /**
      * @brief free the allocated Image and ImageView for the texture
      */
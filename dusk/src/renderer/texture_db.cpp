@@ -10,15 +10,19 @@
 #include "backend/vulkan/vk_device.h"
 #include "backend/vulkan/vk_descriptors.h"
 
+#include <algorithm>
+
 namespace dusk
 {
-TextureDB*     TextureDB::s_db         = nullptr;
+TextureDB*     TextureDB::s_db          = nullptr;
 
-constexpr char texTransferBufferName[] = "tex_transfer_buffer";
-constexpr char texGraphicBufferName[]  = "tex_graphic_buffer";
+constexpr char texTransferBufferName[]  = "tex_transfer_buffer";
+constexpr char texGraphicBufferName[]   = "tex_graphic_buffer";
+constexpr char texComputeBufferName[]   = "tex_compute_buffer";
+constexpr char texUploadSemaphoreName[] = "tex_upload_timeline_semaphore";
 
 TextureDB::TextureDB(VkGfxDevice& device) :
-    m_gfxDevice(device)
+    m_gfxDevice(device), m_mipGenerator(device)
 {
     DASSERT(!s_db, "Texture DB instance already exists");
     s_db = this;
@@ -34,6 +38,37 @@ bool TextureDB::init()
     err = initDefaultTexture();
     if (err != Error::Ok) return false;
 
+    // upload batches signal their completion on a single timeline
+    auto&                     vkContext          = m_gfxDevice.getSharedVulkanContext();
+
+    VkSemaphoreTypeCreateInfo timelineCreateInfo = { VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO };
+    timelineCreateInfo.semaphoreType             = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineCreateInfo.initialValue              = 0;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo    = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+    semaphoreCreateInfo.pNext                    = &timelineCreateInfo;
+
+    VulkanResult result                          = vkCreateSemaphore(vkContext.device, &semaphoreCreateInfo, nullptr, &m_uploadSemaphore);
+    if (result.hasError())
+    {
+        DUSK_ERROR("Unable to create texture upload timeline semaphore {}", result.toString());
+        return false;
+    }
+
+#ifdef VK_RENDERER_DEBUG
+    vkdebug::setObjectName(
+        vkContext.device,
+        VK_OBJECT_TYPE_SEMAPHORE,
+        (uint64_t)m_uploadSemaphore,
+        texUploadSemaphoreName);
+#endif // VK_RENDERER_DEBUG
+
+    // blit chains will be used for mips if compute generator is not available
+    if (!m_mipGenerator.init())
+    {
+        DUSK_WARN("Unable to initialize compute mip generator");
+    }
+
     return true;
 }
 
@@ -44,6 +79,29 @@ void TextureDB::cleanup()
 
 void TextureDB::freeAllResources()
 {
+    auto& vkContext = m_gfxDevice.getSharedVulkanContext();
+
+    // textures of the batch in flight are published so they are freed with the rest
+    if (m_uploadInFlight)
+    {
+        VkSemaphoreWaitInfo waitInfo { VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO };
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores    = &m_uploadSemaphore;
+        waitInfo.pValues        = &m_uploadTimelineValue;
+
+        vkWaitSemaphores(vkContext.device, &waitInfo, UINT64_MAX);
+        finishUploadBatch(m_uploadBatch);
+    }
+
+    if (m_uploadSemaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(vkContext.device, m_uploadSemaphore, nullptr);
+        m_uploadSemaphore     = VK_NULL_HANDLE;
+        m_uploadTimelineValue = 0u;
+    }
+
+    m_mipGenerator.cleanup();
+
     m_gfxDevice.freeImageSampler(&m_defaultSampler);
 
     for (auto& sampler : m_extraSamplers)
@@ -52,6 +110,18 @@ void TextureDB::freeAllResources()
         m_gfxDevice.freeImageSampler(&vksam); // TODO: not very clean way
     }
 
+    m_textureHeap.cleanup();
+
+    m_textureDescriptorBuffer.cleanup();
+    m_textureDescriptorBufferLayout = nullptr;
+    m_useDescriptorBuffer           = false;
+    m_descriptorBufferSets          = 0u;
+    m_descriptorBufferWrites.clear();
+
+    // released textures are still owned by the texture array
+    m_pendingReleases.clear();
+    m_textureRefCounts.clear();
+
     m_textureDescriptorPool->resetPool();
     m_textureDescriptorSetLayout = nullptr;
     m_textureDescriptorPool      = nullptr;
@@ -95,21 +165,11 @@ Error TextureDB::initDefaultTexture()
         "default_tex_2d");
 
     default2dTexture.sampler = m_defaultSampler.sampler;
-    m_textures.push_back(default2dTexture);
 
-    // update corrosponding descriptor with new image
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = default2dTexture.imageView;
-    texDescInfos.sampler     = m_defaultSampler.sampler;
+    // slot of the default texture is reserved by the heap
+    storeTexture(default2dTexture);
+    m_textureHeap.flush();
 
-    m_textureDescriptorSet->configureImage(
-        0,
-        default2dTexture.id,
-        1,
-        &texDescInfos);
-
-    m_textureDescriptorSet->applyConfiguration();
     return err;
 }
 
@@ -136,11 +196,19 @@ Error TextureDB::initDefaultSampler()
 
 bool TextureDB::setupDescriptors()
 {
-    auto& ctx               = m_gfxDevice.getSharedVulkanContext();
+    auto& ctx = m_gfxDevice.getSharedVulkanContext();
+
+    // texture ids index both sampled and storage arrays, so both share the capacity
+    m_textureCapacity = std::min(
+        VkGfxBindlessHeap::getDescriptorCountLimit(ctx, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxAllowedTextures),
+        VkGfxBindlessHeap::getDescriptorCountLimit(ctx, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxAllowedTextures));
+
+    m_textureHeap.init(ctx, m_textureCapacity, 1u);
+    DUSK_INFO("Bindless texture capacity {}", m_textureCapacity);
 
     m_textureDescriptorPool = VkGfxDescriptorPool::Builder(ctx)
-                                  .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * maxAllowedTextures) // twice because of 2 descriptors per cubemaps
-                                  .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, maxAllowedTextures)
+                                  .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2 * m_textureCapacity) // twice because of 2 descriptors per cubemaps
+                                  .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, m_textureCapacity)
                                   .setDebugName("texture_desc_pool")
                                   .build(3, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
     CHECK_AND_RETURN_FALSE(!m_textureDescriptorPool);
@@ -150,7 +218,7 @@ bool TextureDB::setupDescriptors()
                                            COLOR_BINDING_INDEX,
                                            VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
                                            VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
-                                           maxAllowedTextures,
+                                           m_textureCapacity,
                                            true)
                                        .setDebugName("texture_desc_set_layout")
                                        .build();
@@ -164,7 +232,7 @@ bool TextureDB::setupDescriptors()
                                                   COLOR_BINDING_INDEX,
                                                   VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
                                                   VK_SHADER_STAGE_COMPUTE_BIT,
-                                                  maxAllowedTextures,
+                                                  m_textureCapacity,
                                                   true)
                                               .setDebugName("texture_desc_set_layout")
                                               .build();
@@ -173,46 +241,81 @@ bool TextureDB::setupDescriptors()
     m_storageTextureDescriptorSet = m_textureDescriptorPool->allocateDescriptorSet(*m_storageTextureDescriptorSetLayout, "storage_texture_desc_set");
     CHECK_AND_RETURN_FALSE(!m_storageTextureDescriptorSet);
 
+    // passes which only sample textures can skip descriptor sets with a descriptor buffer
+    if (ctx.descriptorBufferSupported)
+    {
+        m_textureDescriptorBufferLayout = VkGfxDescriptorSetLayout::Builder(ctx)
+                                              .addBinding(
+                                                  COLOR_BINDING_INDEX,
+                                                  VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                                  VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT,
+                                                  m_textureCapacity,
+                                                  true)
+                                              .setDescriptorBufferCompatible()
+                                              .setDebugName("texture_desc_buffer_layout")
+                                              .build();
+
+        m_useDescriptorBuffer = m_textureDescriptorBufferLayout
+                                && m_textureDescriptorBuffer.init(ctx, *m_textureDescriptorBufferLayout, MAX_FRAMES_IN_FLIGHT, "texture_desc_buffer") == Error::Ok;
+
+        if (!m_useDescriptorBuffer)
+        {
+            DUSK_WARN("Using descriptor sets for texture passes");
+            m_textureDescriptorBufferLayout = nullptr;
+        }
+    }
+
     return true;
 }
 
 uint32_t TextureDB::createTextureAsync(
     const std::string& path,
     TextureType        type,
-    PixelFormat        format)
+    PixelFormat        format,
+    float              alphaCutoff)
 {
     DASSERT(!path.empty());
 
     auto uploadHash = hash(path.c_str());
 
-    if (m_currentlyLoadingTextures.has(uploadHash)) return m_currentlyLoadingTextures[uploadHash];
+    // requests of the same path share the texture, each holds a reference
+    uint32_t sharedId = INVALID_TEXTURE_ID;
+    if (m_currentlyLoadingTextures.has(uploadHash)) sharedId = m_currentlyLoadingTextures[uploadHash];
+    else if (m_loadedTextures.has(uploadHash)) sharedId = m_loadedTextures[uploadHash];
 
-    if (m_loadedTextures.has(uploadHash)) return m_loadedTextures[uploadHash];
+    if (sharedId != INVALID_TEXTURE_ID)
+    {
+        std::lock_guard<std::mutex> updateLock(m_mutex);
+        if (m_textureRefCounts.has(sharedId)) ++m_textureRefCounts[sharedId];
+        return sharedId;
+    }
 
     uint32_t newId = 0;
 
     {
         std::lock_guard<std::mutex> updateLock(m_mutex);
-        newId = m_textures.size();
+        newId = allocateTextureId();
+        if (newId == INVALID_TEXTURE_ID) return getDefaultTexture2D().id;
 
         GfxTexture newTex { newId };
-        newTex.uploadHash = uploadHash;
-        newTex.name       = path;
-        newTex.type       = type;
+        newTex.uploadHash  = uploadHash;
+        newTex.name        = path;
+        newTex.type        = type;
+        newTex.sampler     = m_defaultSampler.sampler;
+        newTex.alphaCutoff = alphaCutoff;
 
         // default texture image till actual tex is uploaded
         newTex.image     = m_textures[0].image;
         newTex.imageView = m_textures[0].imageView;
 
-        m_textures.push_back(newTex);
+        storeTexture(newTex);
         m_currentlyLoadingTextures.emplace(uploadHash, newId);
+        m_textureRefCounts.emplace(newId, 1u);
     }
 
     DASSERT(newId != 0);
 
-    GfxTexture& newTexture = m_textures[newId];
-
-    auto&       executor   = Engine::get().getTfExecutor();
+    auto& executor = Engine::get().getTfExecutor();
     executor.silent_async(
         [&, newId, path, format]()
         {
@@ -226,22 +329,6 @@ uint32_t TextureDB::createTextureAsync(
             }
         });
 
-    newTexture.sampler = m_defaultSampler.sampler;
-
-    // update corrosponding descriptor to use default image
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = newTexture.imageView;
-    texDescInfos.sampler     = newTexture.sampler;
-
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        newId,
-        1,
-        &texDescInfos);
-
-    m_textureDescriptorSet->applyConfiguration();
-
     return newId;
 }
 
@@ -249,13 +336,29 @@ void TextureDB::onUpdate()
 {
     DUSK_PROFILE_FUNCTION;
 
+    ++m_frameCounter;
+    m_textureHeap.beginFrame();
+    releasePendingTextures();
+
+    auto& vkContext = m_gfxDevice.getSharedVulkanContext();
+
+    if (m_uploadInFlight)
+    {
+        uint64_t completedValue = 0u;
+        vkGetSemaphoreCounterValue(vkContext.device, m_uploadSemaphore, &completedValue);
+
+        // next batch is recorded only after the one in flight has finished
+        if (completedValue < m_uploadTimelineValue) return;
+
+        std::lock_guard<std::mutex> updateLock(m_mutex);
+        finishUploadBatch(m_uploadBatch);
+    }
+
     if (m_pendingImages.size() > 0)
     {
         std::lock_guard<std::mutex> updateLock(m_mutex);
 
-        auto&                       vkContext = m_gfxDevice.getSharedVulkanContext();
-        VkCommandBuffer             gfxBuffer;
-        VkCommandBuffer             transferBuffer;
+        TextureUploadBatch&         batch = m_uploadBatch;
 
         VkCommandBufferAllocateInfo allocInfo {};
         allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -263,13 +366,13 @@ void TextureDB::onUpdate()
         allocInfo.commandPool        = vkContext.transferCommandPool;
         allocInfo.commandBufferCount = 1;
 
-        vkAllocateCommandBuffers(vkContext.device, &allocInfo, &transferBuffer);
+        vkAllocateCommandBuffers(vkContext.device, &allocInfo, &batch.transferBuffer);
 
 #ifdef VK_RENDERER_DEBUG
         vkdebug::setObjectName(
             vkContext.device,
             VK_OBJECT_TYPE_COMMAND_BUFFER,
-            (uint64_t)transferBuffer,
+            (uint64_t)batch.transferBuffer,
             texTransferBufferName);
 #endif // VK_RENDERER_DEBUG
 
@@ -279,16 +382,37 @@ void TextureDB::onUpdate()
         allocInfo.commandPool        = vkContext.commandPool;
         allocInfo.commandBufferCount = 1;
 
-        vkAllocateCommandBuffers(vkContext.device, &allocInfo, &gfxBuffer);
+        vkAllocateCommandBuffers(vkContext.device, &allocInfo, &batch.graphicsBuffer);
 
 #ifdef VK_RENDERER_DEBUG
         vkdebug::setObjectName(
             vkContext.device,
             VK_OBJECT_TYPE_COMMAND_BUFFER,
-            (uint64_t)gfxBuffer,
+            (uint64_t)batch.graphicsBuffer,
             texGraphicBufferName);
 #endif // VK_RENDERER_DEBUG
 
+        allocInfo                    = {};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool        = vkContext.computeCommandPool;
+        allocInfo.commandBufferCount = 1;
+
+        vkAllocateCommandBuffers(vkContext.device, &allocInfo, &batch.computeBuffer);
+
+#ifdef VK_RENDERER_DEBUG
+        vkdebug::setObjectName(
+            vkContext.device,
+            VK_OBJECT_TYPE_COMMAND_BUFFER,
+            (uint64_t)batch.computeBuffer,
+            texComputeBufferName);
+#endif // VK_RENDERER_DEBUG
+
+        beginUploadBatch(batch);
+
+        // images beyond the batch limits stay pending for the next batch
+        DynamicArray<uint32_t> recordedImages;
+
         for (uint32_t key : m_pendingImages.keys())
         {
             GfxTexture& tex    = m_textures[key];
@@ -309,42 +433,159 @@ void TextureDB::onUpdate()
                 tex.type,
                 format,
                 TransferDstTexture | SampledTexture,
-                gfxBuffer,
-                transferBuffer,
+                batch,
                 generateMipMaps,
                 tex.name.c_str());
 
+            recordedImages.push_back(key);
+
             if (err != Error::Ok)
             {
                 DUSK_ERROR("Unable to record texture upload cmds for {}", tex.name);
                 break;
             }
 
-            m_currentlyLoadingTextures.erase(tex.uploadHash);
-            m_loadedTextures.emplace(tex.uploadHash, tex.id);
+            batch.textureIds.push_back(tex.id);
 
-            DUSK_DEBUG("Texture {} (id={}) loaded to gpu", tex.name, tex.id);
+            if (batch.textureIds.size() >= MAX_TEXTURE_UPLOAD_BATCH_COUNT || batch.stagingSize >= MAX_TEXTURE_UPLOAD_BATCH_SIZE)
+            {
+                break;
+            }
+        }
 
-            // update corrosponding descriptor with new image
-            VkDescriptorImageInfo texDescInfos {};
-            texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            texDescInfos.imageView   = tex.imageView;
-            texDescInfos.sampler     = tex.sampler;
+        for (uint32_t key : recordedImages)
+        {
+            m_pendingImages.erase(key);
+        }
 
-            m_textureDescriptorSet->configureImage(
-                COLOR_BINDING_INDEX,
-                tex.id,
-                1,
-                &texDescInfos);
+        submitUploadBatch(batch);
+    }
+}
 
-            m_textureDescriptorSet->applyConfiguration();
-        }
+void TextureDB::beginUploadBatch(TextureUploadBatch& batch)
+{
+    VkCommandBufferBeginInfo beginInfo { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    vkBeginCommandBuffer(batch.transferBuffer, &beginInfo);
+    vkBeginCommandBuffer(batch.computeBuffer, &beginInfo);
+    vkBeginCommandBuffer(batch.graphicsBuffer, &beginInfo);
+}
+
+void TextureDB::submitUploadBatch(TextureUploadBatch& batch)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    auto& vkContext = m_gfxDevice.getSharedVulkanContext();
+
+    vkEndCommandBuffer(batch.transferBuffer);
+    vkEndCommandBuffer(batch.computeBuffer);
+    vkEndCommandBuffer(batch.graphicsBuffer);
+
+    // queues are chained transfer -> compute -> graphics on the upload timeline, so
+    // the value signaled by graphics covers the whole batch. Blit mips and ownership
+    // acquires are on graphics.
+    uint64_t                      uploadFinishedValue = m_uploadTimelineValue + 1;
+    uint64_t                      mipsFinishedValue   = m_uploadTimelineValue + 2;
+    uint64_t                      batchFinishedValue  = m_uploadTimelineValue + 3;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues    = &uploadFinishedValue;
+
+    VkSubmitInfo submitInfo { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.pNext                = &timelineInfo;
+    submitInfo.commandBufferCount   = 1;
+    submitInfo.pCommandBuffers      = &batch.transferBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores    = &m_uploadSemaphore;
+
+    vkQueueSubmit(vkContext.transferQueue, 1, &submitInfo, VK_NULL_HANDLE);
+
+    VkPipelineStageFlags computeWaitStage  = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    VkPipelineStageFlags graphicsWaitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+    timelineInfo                           = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+    timelineInfo.waitSemaphoreValueCount   = 1;
+    timelineInfo.pWaitSemaphoreValues      = &uploadFinishedValue;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues    = &mipsFinishedValue;
+
+    submitInfo                             = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.pNext                       = &timelineInfo;
+    submitInfo.commandBufferCount          = 1;
+    submitInfo.pCommandBuffers             = &batch.computeBuffer;
+    submitInfo.waitSemaphoreCount          = 1;
+    submitInfo.pWaitSemaphores             = &m_uploadSemaphore;
+    submitInfo.pWaitDstStageMask           = &computeWaitStage;
+    submitInfo.signalSemaphoreCount        = 1;
+    submitInfo.pSignalSemaphores           = &m_uploadSemaphore;
+
+    vkQueueSubmit(vkContext.computeQueue, 1, &submitInfo, VK_NULL_HANDLE);
+
+    timelineInfo                           = { VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO };
+    timelineInfo.waitSemaphoreValueCount   = 1;
+    timelineInfo.pWaitSemaphoreValues      = &mipsFinishedValue;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues    = &batchFinishedValue;
+
+    submitInfo                             = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submitInfo.pNext                       = &timelineInfo;
+    submitInfo.commandBufferCount          = 1;
+    submitInfo.pCommandBuffers             = &batch.graphicsBuffer;
+    submitInfo.waitSemaphoreCount          = 1;
+    submitInfo.pWaitSemaphores             = &m_uploadSemaphore;
+    submitInfo.pWaitDstStageMask           = &graphicsWaitStage;
+    submitInfo.signalSemaphoreCount        = 1;
+    submitInfo.pSignalSemaphores           = &m_uploadSemaphore;
+
+    vkQueueSubmit(vkContext.graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+
+    // batch is finished on a later update once the timeline reaches its value
+    m_uploadTimelineValue = batchFinishedValue;
+    m_uploadInFlight      = true;
+}
+
+void TextureDB::finishUploadBatch(TextureUploadBatch& batch)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    auto& vkContext = m_gfxDevice.getSharedVulkanContext();
+
+    vkFreeCommandBuffers(vkContext.device, vkContext.transferCommandPool, 1, &batch.transferBuffer);
+    vkFreeCommandBuffers(vkContext.device, vkContext.commandPool, 1, &batch.graphicsBuffer);
+    vkFreeCommandBuffers(vkContext.device, vkContext.computeCommandPool, 1, &batch.computeBuffer);
+
+    for (auto& stagingBuffer : batch.stagingBuffers)
+    {
+        stagingBuffer.cleanup();
+    }
+
+    m_mipGenerator.releaseTransientResources();
+
+    // textures are visible to frames only after their upload has finished
+    for (uint32_t textureId : batch.textureIds)
+    {
+        GfxTexture& tex = m_textures[textureId];
+
+        m_currentlyLoadingTextures.erase(tex.uploadHash);
+        m_loadedTextures.emplace(tex.uploadHash, tex.id);
 
-        vkFreeCommandBuffers(vkContext.device, vkContext.transferCommandPool, 1, &transferBuffer);
-        vkFreeCommandBuffers(vkContext.device, vkContext.commandPool, 1, &gfxBuffer);
+        DUSK_DEBUG("Texture {} (id={}) loaded to gpu", tex.name, tex.id);
 
-        m_pendingImages.clear();
+        // update corrosponding descriptor with new image
+        writeTextureDescriptors(tex);
+
+        // released while loading and not requested again
+        if (m_textureRefCounts.has(textureId) && m_textureRefCounts[textureId] == 0u)
+        {
+            m_textureRefCounts.erase(textureId);
+            queueTextureRelease(textureId);
+        }
     }
+
+    batch            = {};
+    m_uploadInFlight  = false;
 }
 
 uint32_t TextureDB::createColorTexture(
@@ -356,7 +597,8 @@ uint32_t TextureDB::createColorTexture(
     std::lock_guard<std::mutex> updateLock(m_mutex);
 
     // initialize texture for render target
-    uint32_t   newId = m_textures.size();
+    uint32_t newId = allocateTextureId();
+    if (newId == INVALID_TEXTURE_ID) return getDefaultTexture2D().id;
 
     GfxTexture newTex { newId };
     newTex.init(
@@ -371,21 +613,7 @@ uint32_t TextureDB::createColorTexture(
 
     newTex.sampler = m_defaultSampler.sampler;
 
-    m_textures.push_back(newTex);
-
-    // update corrosponding descriptor with new image
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = newTex.imageView;
-    texDescInfos.sampler     = newTex.sampler;
-
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        newTex.id,
-        1,
-        &texDescInfos);
-
-    m_textureDescriptorSet->applyConfiguration();
+    storeTexture(newTex);
 
     return newId;
 }
@@ -400,7 +628,8 @@ uint32_t TextureDB::createCubeColorTexture(
     std::lock_guard<std::mutex> updateLock(m_mutex);
 
     // initialize texture for render target
-    uint32_t   newId = m_textures.size();
+    uint32_t newId = allocateTextureId();
+    if (newId == INVALID_TEXTURE_ID) return getDefaultTexture2D().id;
 
     GfxTexture newTex { newId };
     newTex.init(
@@ -415,21 +644,7 @@ uint32_t TextureDB::createCubeColorTexture(
 
     newTex.sampler = m_defaultSampler.sampler;
 
-    // update corrosponding descriptor with new image
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = newTex.imageView;
-    texDescInfos.sampler     = newTex.sampler;
-
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        newTex.id,
-        1,
-        &texDescInfos);
-
-    m_textureDescriptorSet->applyConfiguration();
-
-    m_textures.push_back(newTex);
+    storeTexture(newTex);
 
     return newId;
 }
@@ -445,7 +660,8 @@ uint32_t TextureDB::createCubeColorTextureArray(
     std::lock_guard<std::mutex> updateLock(m_mutex);
 
     // initialize texture for render target
-    uint32_t   newId = m_textures.size();
+    uint32_t newId = allocateTextureId();
+    if (newId == INVALID_TEXTURE_ID) return getDefaultTexture2D().id;
 
     GfxTexture newTex { newId };
     newTex.init(
@@ -460,21 +676,7 @@ uint32_t TextureDB::createCubeColorTextureArray(
 
     newTex.sampler = m_defaultSampler.sampler;
 
-    // update corrosponding descriptor with new image
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = newTex.imageView;
-    texDescInfos.sampler     = newTex.sampler;
-
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        newTex.id,
-        1,
-        &texDescInfos);
-
-    m_textureDescriptorSet->applyConfiguration();
-
-    m_textures.push_back(newTex);
+    storeTexture(newTex);
 
     return newId;
 }
@@ -488,7 +690,8 @@ uint32_t TextureDB::createStorageTexture(
     std::lock_guard<std::mutex> updateLock(m_mutex);
 
     // initialize texture for render target
-    uint32_t   newId = m_textures.size();
+    uint32_t newId = allocateTextureId();
+    if (newId == INVALID_TEXTURE_ID) return getDefaultTexture2D().id;
 
     GfxTexture newTex { newId };
     newTex.init(
@@ -503,35 +706,7 @@ uint32_t TextureDB::createStorageTexture(
 
     newTex.sampler = m_defaultSampler.sampler;
 
-    m_textures.push_back(newTex);
-
-    // update corrosponding combined image sampler descriptor with new
-    // image so that we can sample images used as storage.
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = newTex.imageView;
-    texDescInfos.sampler     = newTex.sampler;
-
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        newTex.id,
-        1,
-        &texDescInfos);
-
-    m_textureDescriptorSet->applyConfiguration();
-
-    // update corrosponding storage descriptor with new image
-    VkDescriptorImageInfo storageTexDescInfos {};
-    storageTexDescInfos.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    storageTexDescInfos.imageView   = newTex.imageView;
-
-    m_storageTextureDescriptorSet->configureImage(
-        STORAGE_BINDING_INDEX,
-        newTex.id,
-        1,
-        &storageTexDescInfos);
-
-    m_storageTextureDescriptorSet->applyConfiguration();
+    storeTexture(newTex);
 
     return newId;
 }
@@ -546,7 +721,8 @@ uint32_t TextureDB::createCubeStorageTexture(
     std::lock_guard<std::mutex> updateLock(m_mutex);
 
     // initialize texture for render target
-    uint32_t   newId = m_textures.size();
+    uint32_t newId = allocateTextureId();
+    if (newId == INVALID_TEXTURE_ID) return getDefaultTexture2D().id;
 
     GfxTexture newTex { newId };
     newTex.init(
@@ -561,40 +737,11 @@ uint32_t TextureDB::createCubeStorageTexture(
 
     newTex.sampler = m_defaultSampler.sampler;
 
-    m_textures.push_back(newTex);
-
-    // update corrosponding combined image sampler descriptor with new
-    // image so that we can sample images used as storage.
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = newTex.imageView;
-    texDescInfos.sampler     = newTex.sampler;
-
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        newTex.id,
-        1,
-        &texDescInfos);
-
-    m_textureDescriptorSet->applyConfiguration();
-
-    // update corrosponding storage descriptor with new image
-    VkDescriptorImageInfo storageTexDescInfos {};
-    storageTexDescInfos.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-    storageTexDescInfos.imageView   = newTex.imageView;
-
-    m_storageTextureDescriptorSet->configureImage(
-        STORAGE_BINDING_INDEX,
-        newTex.id,
-        1,
-        &storageTexDescInfos);
-
-    m_storageTextureDescriptorSet->applyConfiguration();
+    storeTexture(newTex);
 
     return newId;
 }
 
-
 uint32_t TextureDB::createDepthTexture(
     const std::string& name,
     uint32_t           width,
@@ -604,7 +751,8 @@ uint32_t TextureDB::createDepthTexture(
     std::lock_guard<std::mutex> updateLock(m_mutex);
 
     // initialize texture for render target
-    uint32_t   newId = m_textures.size();
+    uint32_t newId = allocateTextureId();
+    if (newId == INVALID_TEXTURE_ID) return getDefaultTexture2D().id;
 
     GfxTexture newTex { newId };
     newTex.init(
@@ -619,21 +767,7 @@ uint32_t TextureDB::createDepthTexture(
 
     newTex.sampler = m_defaultSampler.sampler;
 
-    m_textures.push_back(newTex);
-
-    // update corrosponding descriptor with new image
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = newTex.imageView;
-    texDescInfos.sampler     = newTex.sampler;
-
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        newTex.id,
-        1,
-        &texDescInfos);
-
-    m_textureDescriptorSet->applyConfiguration();
+    storeTexture(newTex);
 
     return newId;
 }
@@ -648,7 +782,8 @@ uint32_t TextureDB::createDepthTextureArray(
     std::lock_guard<std::mutex> updateLock(m_mutex);
 
     // initialize texture for render target
-    uint32_t   newId = m_textures.size();
+    uint32_t newId = allocateTextureId();
+    if (newId == INVALID_TEXTURE_ID) return getDefaultTexture2D().id;
 
     GfxTexture newTex { newId };
     newTex.init(
@@ -663,21 +798,7 @@ uint32_t TextureDB::createDepthTextureArray(
 
     newTex.sampler = m_defaultSampler.sampler;
 
-    m_textures.push_back(newTex);
-
-    // update corrosponding descriptor with new image
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = newTex.imageView;
-    texDescInfos.sampler     = newTex.sampler;
-
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        newTex.id,
-        1,
-        &texDescInfos);
-
-    m_textureDescriptorSet->applyConfiguration();
+    storeTexture(newTex);
 
     return newId;
 }
@@ -693,7 +814,8 @@ uint32_t TextureDB::createCubeDepthTextureArray(
     std::lock_guard<std::mutex> updateLock(m_mutex);
 
     // initialize texture for render target
-    uint32_t   newId = m_textures.size();
+    uint32_t newId = allocateTextureId();
+    if (newId == INVALID_TEXTURE_ID) return getDefaultTexture2D().id;
 
     GfxTexture newTex { newId };
     newTex.init(
@@ -708,23 +830,48 @@ uint32_t TextureDB::createCubeDepthTextureArray(
 
     newTex.sampler = m_defaultSampler.sampler;
 
-    // update corrosponding descriptor with new image
-    VkDescriptorImageInfo texDescInfos {};
-    texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    texDescInfos.imageView   = newTex.imageView;
-    texDescInfos.sampler     = newTex.sampler;
+    storeTexture(newTex);
+
+    return newId;
+}
+
+bool TextureDB::resizeRenderTexture(
+    uint32_t    textureId,
+    uint32_t    width,
+    uint32_t    height,
+    GfxTexture* pOutOldTexture)
+{
+    std::lock_guard<std::mutex> updateLock(m_mutex);
 
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        newTex.id,
+    GfxTexture& tex = m_textures[textureId];
+    DASSERT(tex.type == TextureType::Texture2D && tex.numLayers == 1u && tex.numMipLevels == 1u, "only single layer 2D render textures can be resized");
+
+    GfxTexture newTex { textureId };
+    Error      err = newTex.init(
+        tex.type,
+        width,
+        height,
         1,
-        &texDescInfos);
+        1,
+        tex.format,
+        tex.usage,
+        tex.name.c_str());
 
-    m_textureDescriptorSet->applyConfiguration();
+    if (err != Error::Ok)
+    {
+        DUSK_ERROR("Unable to resize render texture {} to {}x{}", tex.name, width, height);
+        return false;
+    }
 
-    m_textures.push_back(newTex);
+    newTex.sampler  = tex.sampler;
 
-    return newId;
+    *pOutOldTexture = tex;
+    tex             = newTex;
+
+    // point existing descriptors to the new image
+    writeTextureDescriptors(tex);
+
+    return true;
 }
 
 void TextureDB::updateTextureSampler(uint32_t textureId, VkSampler sampler)
@@ -732,20 +879,218 @@ void TextureDB::updateTextureSampler(uint32_t textureId, VkSampler sampler)
     GfxTexture& tex = m_textures[textureId];
     tex.sampler     = sampler;
 
+    writeTextureDescriptors(tex);
+
+    m_extraSamplers.push_back(sampler);
+}
+
+void TextureDB::releaseTexture(uint32_t textureId)
+{
+    std::lock_guard<std::mutex> updateLock(m_mutex);
+
+    DASSERT(textureId != 0u, "Default texture can't be released");
+
+    GfxTexture& tex       = m_textures[textureId];
+    bool        isLoading = m_currentlyLoadingTextures.has(tex.uploadHash)
+        && m_currentlyLoadingTextures[tex.uploadHash] == textureId;
+
+    if (m_textureRefCounts.has(textureId))
+    {
+        if (m_textureRefCounts[textureId] == 0u)
+        {
+            DUSK_WARN("Texture {} (id={}) is already released", tex.name, textureId);
+            return;
+        }
+
+        if (--m_textureRefCounts[textureId] > 0u) return;
+    }
+
+    // count stays at zero till the upload finishes, new requests of the
+    // path take a reference again and cancel the release
+    if (isLoading) return;
+
+    m_textureRefCounts.erase(textureId);
+    queueTextureRelease(textureId);
+}
+
+void TextureDB::queueTextureRelease(uint32_t textureId)
+{
+    GfxTexture& tex = m_textures[textureId];
+
+    // new requests of the path load it again
+    if (m_loadedTextures.has(tex.uploadHash) && m_loadedTextures[tex.uploadHash] == textureId)
+    {
+        m_loadedTextures.erase(tex.uploadHash);
+    }
+
+    // frames in flight can still sample the slot, so its descriptor is
+    // rewritten only once they are done
+    m_pendingReleases.push_back({ textureId, m_frameCounter + MAX_FRAMES_IN_FLIGHT });
+}
+
+BindlessHandle TextureDB::getTextureHandle(uint32_t textureId) const
+{
+    return m_textureHeap.getHandle(textureId);
+}
+
+bool TextureDB::isTextureHandleValid(BindlessHandle handle) const
+{
+    return m_textureHeap.isValid(handle);
+}
+
+void TextureDB::flushDescriptorWrites()
+{
+    m_textureHeap.flush();
+}
+
+uint32_t TextureDB::allocateTextureId()
+{
+    BindlessHandle handle = m_textureHeap.allocate();
+    if (handle.isNull())
+    {
+        DUSK_ERROR("Texture capacity of {} reached, using default texture", m_textureCapacity);
+        return INVALID_TEXTURE_ID;
+    }
+
+    return handle.index;
+}
+
+void TextureDB::storeTexture(const GfxTexture& tex)
+{
+    // released ids are reused, so texture can land inside the array
+    if (tex.id >= m_textures.size())
+    {
+        m_textures.resize(tex.id + 1u);
+    }
+    m_textures[tex.id] = tex;
+
+    writeTextureDescriptors(tex);
+}
+
+void TextureDB::writeTextureDescriptors(const GfxTexture& tex)
+{
+    // every texture can be sampled, including storage textures
     VkDescriptorImageInfo texDescInfos {};
     texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
     texDescInfos.imageView   = tex.imageView;
     texDescInfos.sampler     = tex.sampler;
 
-    m_textureDescriptorSet->configureImage(
-        COLOR_BINDING_INDEX,
-        tex.id,
-        1,
-        &texDescInfos);
+    m_textureHeap.writeImage(*m_textureDescriptorSet, COLOR_BINDING_INDEX, tex.id, texDescInfos);
 
-    m_textureDescriptorSet->applyConfiguration();
+    // copies of frames in flight are written when their frame is recorded next
+    if (m_useDescriptorBuffer)
+    {
+        std::lock_guard<std::mutex> writesLock(m_descriptorBufferMutex);
+        if (m_descriptorBufferSets != 0u)
+        {
+            m_descriptorBufferWrites.push_back({ tex.id, texDescInfos, m_descriptorBufferSets });
+        }
+    }
 
-    m_extraSamplers.push_back(sampler);
+    if (tex.usage & StorageTexture)
+    {
+        VkDescriptorImageInfo storageTexDescInfos {};
+        storageTexDescInfos.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+        storageTexDescInfos.imageView   = tex.imageView;
+
+        m_textureHeap.writeImage(*m_storageTextureDescriptorSet, STORAGE_BINDING_INDEX, tex.id, storageTexDescInfos);
+    }
+}
+
+void TextureDB::bindTexturesDescriptorBuffer(
+    VkCommandBuffer     cmdBuffer,
+    VkPipelineBindPoint bindPoint,
+    VkPipelineLayout    pipelineLayout,
+    uint32_t            firstSet,
+    uint32_t            frameIndex) const
+{
+    DASSERT(m_useDescriptorBuffer, "texture descriptor buffer is not enabled");
+    DASSERT(m_descriptorBufferSets & (1u << frameIndex), "descriptor buffer copy of the frame is not written");
+
+    m_textureDescriptorBuffer.bindBuffer(cmdBuffer);
+    m_textureDescriptorBuffer.bindSet(cmdBuffer, bindPoint, pipelineLayout, firstSet, frameIndex);
+}
+
+void TextureDB::applyDescriptorBufferWrites(uint32_t frameIndex)
+{
+    DUSK_PROFILE_FUNCTION;
+
+    if (!m_useDescriptorBuffer) return;
+
+    DASSERT(frameIndex < MAX_FRAMES_IN_FLIGHT);
+
+    std::lock_guard<std::mutex> updateLock(m_mutex);
+    std::lock_guard<std::mutex> writesLock(m_descriptorBufferMutex);
+
+    uint32_t                    setMask = 1u << frameIndex;
+
+    // first use of the copy, write all textures as they are now
+    if (!(m_descriptorBufferSets & setMask))
+    {
+        for (const GfxTexture& tex : m_textures)
+        {
+            if (tex.imageView == VK_NULL_HANDLE) continue;
+
+            VkDescriptorImageInfo texDescInfos {};
+            texDescInfos.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            texDescInfos.imageView   = tex.imageView;
+            texDescInfos.sampler     = tex.sampler;
+
+            m_textureDescriptorBuffer.writeImage(frameIndex, COLOR_BINDING_INDEX, tex.id, texDescInfos);
+        }
+
+        m_descriptorBufferSets |= setMask;
+        return;
+    }
+
+    // writes are applied in order, so the latest write of an element wins
+    for (auto& write : m_descriptorBufferWrites)
+    {
+        if (!(write.pendingSets & setMask)) continue;
+
+        m_textureDescriptorBuffer.writeImage(frameIndex, COLOR_BINDING_INDEX, write.textureId, write.imageInfo);
+        write.pendingSets &= ~setMask;
+    }
+
+    auto it = std::remove_if(
+        m_descriptorBufferWrites.begin(),
+        m_descriptorBufferWrites.end(),
+        [](const DescriptorBufferWrite& write)
+        { return write.pendingSets == 0u; });
+
+    m_descriptorBufferWrites.erase(it, m_descriptorBufferWrites.end());
+}
+
+void TextureDB::releasePendingTextures()
+{
+    std::lock_guard<std::mutex> updateLock(m_mutex);
+
+    auto it = std::remove_if(
+        m_pendingReleases.begin(),
+        m_pendingReleases.end(),
+        [&](PendingTextureRelease& pending)
+        {
+            if (pending.releaseFrame > m_frameCounter) return false;
+
+            // failed loads keep sampling the default image
+            GfxTexture& tex = m_textures[pending.textureId];
+            if (tex.image.vkImage != m_textures[0].image.vkImage)
+                tex.cleanup();
+
+            // stale ids sample the default texture till the slot is reused
+            GfxTexture releasedTex { pending.textureId };
+            releasedTex.image     = m_textures[0].image;
+            releasedTex.imageView = m_textures[0].imageView;
+            releasedTex.sampler   = m_defaultSampler.sampler;
+
+            tex                   = releasedTex;
+            writeTextureDescriptors(tex);
+
+            m_textureHeap.release(m_textureHeap.getHandle(pending.textureId));
+            return true;
+        });
+
+    m_pendingReleases.erase(it, m_pendingReleases.end());
 }
 
 void TextureDB::saveTextureAsKTX(
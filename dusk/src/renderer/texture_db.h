@@ -4,6 +4,10 @@
 
 #include "texture.h"
 #include "image.h"
+#include "mip_generator.h"
+
+#include "backend/vulkan/vk_bindless_heap.h"
+#include "backend/vulkan/vk_descriptor_buffer.h"
 
 #include <taskflow/taskflow.hpp>
 #include <thread>
@@ -19,7 +23,13 @@ struct VkGfxDescriptorPool;
 struct VkGfxDescriptorSetLayout;
 struct VkGfxDescriptorSet;
 
-constexpr uint32_t maxAllowedTextures = 1000;
+// requested size of bindless texture arrays, clamped to update after bind limits of the device
+constexpr uint32_t maxAllowedTextures = 16384;
+constexpr uint32_t INVALID_TEXTURE_ID = ~0u;
+
+// uploads are submitted once either limit of the batch is reached
+constexpr uint32_t     MAX_TEXTURE_UPLOAD_BATCH_COUNT = MIP_GEN_MAX_TEXTURES;
+constexpr VkDeviceSize MAX_TEXTURE_UPLOAD_BATCH_SIZE  = 256ull * 1024 * 1024;
 
 class TextureDB
 {
@@ -53,22 +63,40 @@ public:
      * and returns its identifier.
      * @params Paths of all images
      * @params type of the texture
+     * @params alphaCutoff of alpha tested base color textures, their coverage
+     * is preserved in generated mips. 0 for other textures.
      * @return The unique identifier of the loaded texture.
      */
     uint32_t createTextureAsync(
         const std::string& path,
         TextureType        type,
-        PixelFormat        format);
+        PixelFormat        format,
+        float              alphaCutoff = 0.f);
+
+    /**
+     * @brief Get descriptor set for color textures. Queued descriptor writes
+     * are applied before returning.
+     */
+    VkGfxDescriptorSet& getTexturesDescriptorSet()
+    {
+        flushDescriptorWrites();
+        return *m_textureDescriptorSet;
+    };
 
     /**
-     * @brief Get descriptor set for color textures
+     * @brief Get descriptor set for storage textures. Queued descriptor writes
+     * are applied before returning.
      */
-    VkGfxDescriptorSet& getTexturesDescriptorSet() const { return *m_textureDescriptorSet; };
+    VkGfxDescriptorSet& getStorageTexturesDescriptorSet()
+    {
+        flushDescriptorWrites();
+        return *m_storageTextureDescriptorSet;
+    };
 
     /**
-     * @brief Get descriptor set for storage textures
+     * @brief Apply all queued texture descriptor writes with a single update
      */
-    VkGfxDescriptorSet& getStorageTexturesDescriptorSet() const { return *m_storageTextureDescriptorSet; };
+    void flushDescriptorWrites();
 
     /**
      * @brief Get descriptor set layout for texture set
@@ -81,7 +109,42 @@ public:
     VkGfxDescriptorSetLayout& getStorageTexturesDescriptorSetLayout() const { return *m_storageTextureDescriptorSetLayout; };
 
     /**
-     * @brief Per frame update call to upload pending textures
+     * @brief Check whether color textures are also available through a descriptor buffer
+     */
+    bool isDescriptorBufferEnabled() const { return m_useDescriptorBuffer; };
+
+    /**
+     * @brief Get descriptor buffer compatible layout for color textures. Only valid
+     * when descriptor buffer is enabled.
+     */
+    VkGfxDescriptorSetLayout& getTexturesDescriptorBufferLayout() const { return *m_textureDescriptorBufferLayout; };
+
+    /**
+     * @brief Apply queued texture writes to the descriptor buffer copy of the
+     * frame. Each frame in flight reads its own copy, so it should be called
+     * once the previous submission of the frame has finished.
+     * @param frameIndex of the frame being recorded
+     */
+    void applyDescriptorBufferWrites(uint32_t frameIndex);
+
+    /**
+     * @brief Bind color textures descriptor buffer for the pipeline layout
+     * @param cmdBuffer being recorded
+     * @param bindPoint of the pipeline
+     * @param pipelineLayout created with descriptor buffer layout of textures
+     * @param firstSet set number of textures in the pipeline layout
+     * @param frameIndex of the frame being recorded
+     */
+    void bindTexturesDescriptorBuffer(
+        VkCommandBuffer     cmdBuffer,
+        VkPipelineBindPoint bindPoint,
+        VkPipelineLayout    pipelineLayout,
+        uint32_t            firstSet,
+        uint32_t            frameIndex) const;
+
+    /**
+     * @brief Per frame update call to upload pending textures and recycle
+     * released texture slots
      */
     void onUpdate();
 
@@ -211,6 +274,23 @@ public:
         uint32_t           mipLevels,
         VkFormat           format);
 
+    /**
+     * @brief Reallocate a 2D render texture with a new size. Texture keeps its id,
+     * format, usage and sampler so descriptors and pipelines referring to it stay
+     * valid. Texture should not be in use by any pending frame.
+     * @param textureId of the render texture
+     * @param width new width of the texture
+     * @param height new height of the texture
+     * @param pOutOldTexture receives previous resources of the texture. Caller
+     * owns them and should cleanup once frames using them have finished.
+     * @return true if successful
+     */
+    bool resizeRenderTexture(
+        uint32_t    textureId,
+        uint32_t    width,
+        uint32_t    height,
+        GfxTexture* pOutOldTexture);
+
     /**
      * @brief Update the sampler of the texture with a new one
      * @param textureId of the texture for update
@@ -218,6 +298,34 @@ public:
      */
     void updateTextureSampler(uint32_t textureId, VkSampler sampler);
 
+    /**
+     * @brief Release a reference to a texture, every createTextureAsync call
+     * holds one. Slot and images stay untouched till frames in flight are done
+     * with them, after that the id samples the default texture till it is reused.
+     * Textures which are still loading are released once their upload finishes.
+     * @param textureId of the texture
+     */
+    void releaseTexture(uint32_t textureId);
+
+    /**
+     * @brief Get generation checked handle of a texture
+     * @param textureId of the texture
+     * @return handle of the texture slot
+     */
+    BindlessHandle getTextureHandle(uint32_t textureId) const;
+
+    /**
+     * @brief Check whether handle still refers to the texture it was taken for
+     * @param handle of the texture slot
+     * @return true if texture has not been released
+     */
+    bool isTextureHandleValid(BindlessHandle handle) const;
+
+    /**
+     * @brief Get count of texture slots
+     */
+    uint32_t getTextureCapacity() const { return m_textureCapacity; }
+
     /**
      * @brief Save texture in a ktx file. Different thread will be used to
      * save file
@@ -226,6 +334,11 @@ public:
      */
     void saveTextureAsKTX(uint32_t textureId, const std::string& filePath);
 
+    /**
+     * @brief Get compute mip generator
+     */
+    MipGenerator& getMipGenerator() { return m_mipGenerator; };
+
     /**
      * @brief Check whether the texture has been uploaded to GPU
      * @param id of the texture
@@ -260,6 +373,69 @@ private:
      */
     void freeAllResources();
 
+    /**
+     * @brief Allocate a slot for a new texture
+     * @return id of the texture, INVALID_TEXTURE_ID if capacity is reached
+     */
+    uint32_t allocateTextureId();
+
+    /**
+     * @brief Store texture at its id and queue its descriptor writes
+     * @param tex texture to store
+     */
+    void storeTexture(const GfxTexture& tex);
+
+    /**
+     * @brief Queue sampled and storage descriptor writes for the texture
+     * @param tex texture to write
+     */
+    void writeTextureDescriptors(const GfxTexture& tex);
+
+    /**
+     * @brief Free images of released textures which are no longer used by any frame in flight
+     */
+    void releasePendingTextures();
+
+    /**
+     * @brief Queue the slot and images of an unreferenced texture for release
+     * @param textureId of the texture
+     */
+    void queueTextureRelease(uint32_t textureId);
+
+    /**
+     * @brief Start recording in the cmd buffers of the batch
+     * @param batch to begin
+     */
+    void beginUploadBatch(TextureUploadBatch& batch);
+
+    /**
+     * @brief Submit recorded uploads of the batch without waiting for them.
+     * Completion is signaled on the upload timeline semaphore.
+     * @param batch to submit
+     */
+    void submitUploadBatch(TextureUploadBatch& batch);
+
+    /**
+     * @brief Publish uploaded textures of a finished batch and release its
+     * staging buffers, cmd buffers and mip generator transient resources
+     * @param batch which has finished execution
+     */
+    void finishUploadBatch(TextureUploadBatch& batch);
+
+private:
+    struct PendingTextureRelease
+    {
+        uint32_t textureId;
+        uint64_t releaseFrame;
+    };
+
+    struct DescriptorBufferWrite
+    {
+        uint32_t              textureId;
+        VkDescriptorImageInfo imageInfo;
+        uint32_t              pendingSets; // mask of frame copies still missing the write
+    };
+
 private:
     std::mutex                           m_mutex;
 
@@ -267,6 +443,7 @@ private:
     HashMap<size_t, uint32_t>            m_loadedTextures           = {};
     HashMap<size_t, uint32_t>            m_currentlyLoadingTextures = {};
     HashMap<uint32_t, Shared<ImageData>> m_pendingImages            = {};
+    HashMap<uint32_t, uint32_t>          m_textureRefCounts         = {};
 
     VkGfxDevice&                         m_gfxDevice;
     Unique<VkGfxDescriptorPool>          m_textureDescriptorPool             = nullptr;
@@ -275,9 +452,30 @@ private:
     Unique<VkGfxDescriptorSetLayout>     m_storageTextureDescriptorSetLayout = nullptr;
     Unique<VkGfxDescriptorSet>           m_storageTextureDescriptorSet       = nullptr;
 
+    // color textures mirrored into a descriptor buffer when the device supports it
+    bool                                 m_useDescriptorBuffer           = false;
+    Unique<VkGfxDescriptorSetLayout>     m_textureDescriptorBufferLayout = nullptr;
+    VkGfxDescriptorBuffer                m_textureDescriptorBuffer;
+    std::mutex                           m_descriptorBufferMutex;
+    DynamicArray<DescriptorBufferWrite>  m_descriptorBufferWrites = {};
+    uint32_t                             m_descriptorBufferSets   = 0u; // mask of frame copies in use
+
+    VkGfxBindlessHeap                    m_textureHeap;
+    uint32_t                             m_textureCapacity = 0u;
+    DynamicArray<PendingTextureRelease>  m_pendingReleases = {};
+    uint64_t                             m_frameCounter    = 0u;
+
     VulkanSampler                        m_defaultSampler;
     DynamicArray<VkSampler>              m_extraSamplers; // TODO:: need uniqueness check
 
+    MipGenerator                         m_mipGenerator;
+
+    // one batch is in flight at a time as mip generator resources are shared by it
+    TextureUploadBatch                   m_uploadBatch         = {};
+    VkSemaphore                          m_uploadSemaphore     = VK_NULL_HANDLE;
+    uint64_t                             m_uploadTimelineValue = 0u;
+    bool                                 m_uploadInFlight      = false;
+
 private:
     static TextureDB* s_db;
 };
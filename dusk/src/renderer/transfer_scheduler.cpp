@@ -0,0 +1,100 @@
+#include "transfer_scheduler.h"
+
+#include "debug/profiler.h"
+
+#include <algorithm>
+
+namespace dusk
+{
+void TransferScheduler::queueUpload(
+    VkBuffer   srcBuffer,
+    size_t     srcOffset,
+    GfxBuffer& dstBuffer,
+    size_t     dstOffset,
+    size_t     size)
+{
+    DASSERT(dstOffset + size <= dstBuffer.vkBuffer.sizeInBytes, "upload is out of destination buffer bounds");
+
+    if (size == 0u) return;
+
+    GfxBufferCopy copy {};
+    copy.srcBuffer        = srcBuffer;
+    copy.dstBuffer        = dstBuffer.vkBuffer.buffer;
+    copy.region.srcOffset = srcOffset;
+    copy.region.dstOffset = dstOffset;
+    copy.region.size      = size;
+
+    m_uploads.push_back(copy);
+}
+
+void TransferScheduler::queueReadback(
+    GfxBuffer& srcBuffer,
+    size_t     srcOffset,
+    GfxBuffer& dstBuffer,
+    size_t     dstOffset,
+    size_t     size)
+{
+    DASSERT(srcOffset + size <= srcBuffer.vkBuffer.sizeInBytes, "readback is out of source buffer bounds");
+    DASSERT(dstOffset + size <= dstBuffer.vkBuffer.sizeInBytes, "readback is out of destination buffer bounds");
+
+    if (size == 0u) return;
+
+    GfxBufferCopy copy {};
+    copy.srcBuffer        = srcBuffer.vkBuffer.buffer;
+    copy.dstBuffer        = dstBuffer.vkBuffer.buffer;
+    copy.region.srcOffset = srcOffset;
+    copy.region.dstOffset = dstOffset;
+    copy.region.size      = size;
+
+    m_readbacks.push_back(copy);
+
+    if (std::find(m_readbackSources.begin(), m_readbackSources.end(), &srcBuffer) == m_readbackSources.end())
+    {
+        m_readbackSources.push_back(&srcBuffer);
+    }
+}
+
+void TransferScheduler::recordUploads(VkCommandBuffer cmdBuffer) const
+{
+    DUSK_PROFILE_FUNCTION;
+
+    recordCopies(cmdBuffer, m_uploads);
+}
+
+void TransferScheduler::recordReadbacks(VkCommandBuffer cmdBuffer) const
+{
+    DUSK_PROFILE_FUNCTION;
+
+    recordCopies(cmdBuffer, m_readbacks);
+}
+
+void TransferScheduler::clear()
+{
+    m_uploads.clear();
+    m_readbacks.clear();
+    m_readbackSources.clear();
+}
+
+void TransferScheduler::recordCopies(VkCommandBuffer cmdBuffer, const DynamicArray<GfxBufferCopy>& copies)
+{
+    DynamicArray<VkBufferCopy> regions;
+    regions.reserve(copies.size());
+
+    for (uint32_t copyIdx = 0u; copyIdx < copies.size();)
+    {
+        const GfxBufferCopy& first = copies[copyIdx];
+
+        // consecutive copies between the same buffers go in a single command
+        regions.clear();
+        while (copyIdx < copies.size()
+               && copies[copyIdx].srcBuffer == first.srcBuffer
+               && copies[copyIdx].dstBuffer == first.dstBuffer)
+        {
+            regions.push_back(copies[copyIdx].region);
+            ++copyIdx;
+        }
+
+        vkCmdCopyBuffer(cmdBuffer, first.srcBuffer, first.dstBuffer, static_cast<uint32_t>(regions.size()), regions.data());
+    }
+}
+} // namespace dusk
\ No newline at end of file
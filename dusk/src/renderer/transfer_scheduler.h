@@ -0,0 +1,101 @@
+#pragma once
+
+#include "dusk.h"
+#include "gfx_buffer.h"
+#include "backend/vulkan/vk_types.h"
+
+namespace dusk
+{
+/**
+ * @brief Buffer copy queued for the transfer passes of the render graph
+ */
+struct GfxBufferCopy
+{
+    VkBuffer     srcBuffer = VK_NULL_HANDLE;
+    VkBuffer     dstBuffer = VK_NULL_HANDLE;
+    VkBufferCopy region    = {};
+};
+
+/**
+ * @brief Collects buffer copies of a frame which are recorded by the transfer
+ * queue passes of the render graph. Unlike the staging ring, nothing blocks on
+ * the host, copies are ordered against the rendering work with timeline
+ * semaphores of the graph.
+ *
+ * Upload sources should stay alive until the frame has finished on the device,
+ * like the regions of the frame upload arena. Readback destinations are host
+ * visible buffers which can be read once the frame fence is signaled.
+ */
+class TransferScheduler
+{
+public:
+    TransferScheduler()  = default;
+    ~TransferScheduler() = default;
+
+    CLASS_UNCOPYABLE(TransferScheduler);
+
+    /**
+     * @brief Queue a copy from a host visible buffer into a device local buffer
+     * @param srcBuffer host visible buffer holding the data
+     * @param srcOffset byte offset in the source buffer
+     * @param dstBuffer destination buffer
+     * @param dstOffset byte offset in the destination buffer
+     * @param size in bytes to copy
+     */
+    void queueUpload(
+        VkBuffer   srcBuffer,
+        size_t     srcOffset,
+        GfxBuffer& dstBuffer,
+        size_t     dstOffset,
+        size_t     size);
+
+    /**
+     * @brief Queue a copy from a device local buffer into a host visible buffer
+     * @param srcBuffer buffer written by the device
+     * @param srcOffset byte offset in the source buffer
+     * @param dstBuffer host visible destination buffer
+     * @param dstOffset byte offset in the destination buffer
+     * @param size in bytes to copy
+     */
+    void queueReadback(
+        GfxBuffer& srcBuffer,
+        size_t     srcOffset,
+        GfxBuffer& dstBuffer,
+        size_t     dstOffset,
+        size_t     size);
+
+    /**
+     * @brief Record all the queued uploads, copies between same buffers are merged
+     * @param cmdBuffer of the transfer queue
+     */
+    void recordUploads(VkCommandBuffer cmdBuffer) const;
+
+    /**
+     * @brief Record all the queued readbacks, copies between same buffers are merged
+     * @param cmdBuffer of the transfer queue
+     */
+    void recordReadbacks(VkCommandBuffer cmdBuffer) const;
+
+    /**
+     * @brief Drop all the queued copies once the frame has been recorded
+     */
+    void clear();
+
+    bool                            hasUploads() const { return !m_uploads.empty(); }
+    bool                            hasReadbacks() const { return !m_readbacks.empty(); }
+
+    /**
+     * @brief Get unique buffers written by the device which are read back, render
+     * graph has to order the readback pass after their writers
+     */
+    const DynamicArray<GfxBuffer*>& getReadbackSources() const { return m_readbackSources; }
+
+private:
+    static void recordCopies(VkCommandBuffer cmdBuffer, const DynamicArray<GfxBufferCopy>& copies);
+
+private:
+    DynamicArray<GfxBufferCopy> m_uploads         = {};
+    DynamicArray<GfxBufferCopy> m_readbacks       = {};
+    DynamicArray<GfxBuffer*>    m_readbackSources = {};
+};
+} // namespace dusk
\ No newline at end of file
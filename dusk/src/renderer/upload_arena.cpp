@@ -0,0 +1,132 @@
+#include "upload_arena.h"
+
+#include "engine.h"
+#include "debug/profiler.h"
+#include "utils/utils.h"
+
+#include "backend/vulkan/vk_device.h"
+
+#include <algorithm>
+
+namespace dusk
+{
+bool UploadArena::init(size_t frameCapacity, size_t reservedSize, const std::string& debugName)
+{
+    auto& limits = VkGfxDevice::getSharedVulkanContext().physicalDeviceProperties.limits;
+
+    // allocations can be bound as uniform or storage buffers, or copied on the transfer queue
+    m_alignment     = std::max(limits.minUniformBufferOffsetAlignment, limits.minStorageBufferOffsetAlignment);
+    m_reservedSize  = getAlignment(reservedSize, m_alignment);
+    m_frameCapacity = getAlignment(std::max(frameCapacity, m_reservedSize), m_alignment);
+
+    m_buffer.init(
+        GfxBufferUsageFlags::UniformBuffer | GfxBufferUsageFlags::StorageBuffer | GfxBufferUsageFlags::TransferSource,
+        m_frameCapacity * MAX_FRAMES_IN_FLIGHT,
+        GfxBufferMemoryTypeFlags::PersistentlyMapped | GfxBufferMemoryTypeFlags::HostSequentialWrite,
+        debugName);
+
+    CHECK_AND_RETURN_FALSE(!m_buffer.isAllocated());
+
+    beginFrame(0u);
+
+    return true;
+}
+
+void UploadArena::cleanup()
+{
+    m_buffer.cleanup();
+
+    m_flushBuffers.clear();
+    m_flushOffsets.clear();
+    m_flushSizes.clear();
+}
+
+void UploadArena::beginFrame(uint32_t frameIndex)
+{
+    DASSERT(frameIndex < MAX_FRAMES_IN_FLIGHT, "frame index is out of bounds");
+
+    m_frameStart = frameIndex * m_frameCapacity;
+    m_head       = m_frameStart + m_reservedSize;
+}
+
+GfxUploadAllocation UploadArena::allocate(size_t size)
+{
+    // empty ranges can't be bound, so every allocation takes at least one aligned block
+    size_t alignedSize = getAlignment(std::max(size, (size_t)1u), m_alignment);
+
+    if (m_head + alignedSize > m_frameStart + m_frameCapacity)
+    {
+        DUSK_ERROR("Upload arena is full, requested {} bytes with {} bytes left", size, m_frameStart + m_frameCapacity - m_head);
+        return {};
+    }
+
+    GfxUploadAllocation allocation {};
+    allocation.data   = (char*)m_buffer.vkBuffer.mappedMemory + m_head;
+    allocation.offset = m_head;
+    allocation.size   = alignedSize;
+
+    m_head += alignedSize;
+
+    return allocation;
+}
+
+GfxUploadAllocation UploadArena::upload(const void* data, size_t size)
+{
+    GfxUploadAllocation allocation = allocate(size);
+
+    if (allocation.isValid() && size > 0u)
+    {
+        memcpy(allocation.data, data, size);
+    }
+
+    return allocation;
+}
+
+GfxUploadAllocation UploadArena::getReservedBlock(uint32_t frameIndex) const
+{
+    DASSERT(frameIndex < MAX_FRAMES_IN_FLIGHT, "frame index is out of bounds");
+
+    GfxUploadAllocation allocation {};
+    allocation.offset = frameIndex * m_frameCapacity;
+    allocation.data   = (char*)m_buffer.vkBuffer.mappedMemory + allocation.offset;
+    allocation.size   = m_reservedSize;
+
+    return allocation;
+}
+
+void UploadArena::queueFlush(GfxBuffer& buffer, size_t offset, size_t size)
+{
+    // writes to coherent memory are visible without a flush
+    if (buffer.vkBuffer.memoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) return;
+    if (size == 0u) return;
+
+    m_flushBuffers.push_back(&buffer.vkBuffer);
+    m_flushOffsets.push_back(offset);
+    m_flushSizes.push_back(size);
+}
+
+void UploadArena::flush()
+{
+    DUSK_PROFILE_FUNCTION;
+
+    queueFlush(m_buffer, m_frameStart, m_head - m_frameStart);
+
+    if (m_flushBuffers.empty()) return;
+
+    Engine::get().getGfxDevice().flushBufferRanges(m_flushBuffers, m_flushOffsets, m_flushSizes);
+
+    m_flushBuffers.clear();
+    m_flushOffsets.clear();
+    m_flushSizes.clear();
+}
+
+VkDescriptorBufferInfo UploadArena::getDescriptorInfo(const GfxUploadAllocation& allocation) const
+{
+    VkDescriptorBufferInfo bufferInfo {};
+    bufferInfo.buffer = m_buffer.vkBuffer.buffer;
+    bufferInfo.offset = allocation.offset;
+    bufferInfo.range  = allocation.size;
+
+    return bufferInfo;
+}
+} // namespace dusk
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "dusk.h"
+#include "gfx_buffer.h"
+#include "backend/vulkan/vk_types.h"
+
+#include <string>
+
+namespace dusk
+{
+/**
+ * @brief Range of the upload arena handed out for the current frame
+ */
+struct GfxUploadAllocation
+{
+    void*  data   = nullptr;
+    size_t offset = 0u;
+    size_t size   = 0u;
+
+    bool   isValid() const { return data != nullptr; }
+};
+
+/**
+ * @brief Linear allocator for per frame host data over a single persistently mapped
+ * buffer. Buffer is split in a region per frame in flight, allocations bump the head
+ * of the current region and are written in place. All the writes of a frame, including
+ * queued ranges of other persistently mapped buffers, are made visible to the device
+ * with a single flush which is skipped for host coherent memory.
+ *
+ * Every region starts with a reserved block at a fixed offset, so data which is bound
+ * once through descriptors (like global uniforms) can live in the arena as well.
+ */
+class UploadArena
+{
+public:
+    UploadArena()  = default;
+    ~UploadArena() = default;
+
+    CLASS_UNCOPYABLE(UploadArena);
+
+    /**
+     * @brief Create arena buffer
+     * @param frameCapacity size in bytes of the region of each frame, including reserved block
+     * @param reservedSize size in bytes of the block at the start of each region
+     * @param debugName of the buffer
+     * @return true if successful
+     */
+    bool init(size_t frameCapacity, size_t reservedSize, const std::string& debugName);
+
+    /**
+     * @brief Release the arena buffer
+     */
+    void cleanup();
+
+    /**
+     * @brief Reset region of the frame. Region should no longer be used by the device.
+     * @param frameIndex of the frame in flight
+     */
+    void beginFrame(uint32_t frameIndex);
+
+    /**
+     * @brief Allocate aligned range in the region of current frame
+     * @param size in bytes
+     * @return allocation, invalid if region is full
+     */
+    GfxUploadAllocation allocate(size_t size);
+
+    /**
+     * @brief Allocate range in the region of current frame and copy data into it
+     * @param data source pointer to read from
+     * @param size in bytes
+     * @return allocation, invalid if region is full
+     */
+    GfxUploadAllocation upload(const void* data, size_t size);
+
+    /**
+     * @brief Get reserved block at the start of the region of a frame
+     * @param frameIndex of the frame in flight
+     * @return allocation of the reserved block
+     */
+    GfxUploadAllocation getReservedBlock(uint32_t frameIndex) const;
+
+    /**
+     * @brief Queue host writes of a persistently mapped buffer to be flushed along
+     * with the arena
+     * @param buffer written by the host
+     * @param offset in bytes of the written range
+     * @param size in bytes of the written range
+     */
+    void queueFlush(GfxBuffer& buffer, size_t offset, size_t size);
+
+    /**
+     * @brief Flush writes of the current frame and all the queued ranges at once
+     */
+    void flush();
+
+    /**
+     * @brief Get descriptor info of an allocation
+     * @param allocation of the arena
+     * @return descriptor buffer info
+     */
+    VkDescriptorBufferInfo getDescriptorInfo(const GfxUploadAllocation& allocation) const;
+
+    /**
+     * @brief Get bytes allocated in the region of current frame
+     */
+    size_t getUsedSize() const { return m_head - m_frameStart; }
+
+    size_t getFrameCapacity() const { return m_frameCapacity; }
+
+    /**
+     * @brief Get arena buffer to use allocations as source of transfer copies
+     */
+    VkBuffer getVkBuffer() const { return m_buffer.vkBuffer.buffer; }
+
+private:
+    GfxBuffer                      m_buffer;
+
+    size_t                         m_frameCapacity = 0u;
+    size_t                         m_reservedSize  = 0u;
+    size_t                         m_alignment     = 1u;
+
+    size_t                         m_frameStart    = 0u;
+    size_t                         m_head          = 0u;
+
+    DynamicArray<VulkanGfxBuffer*> m_flushBuffers  = {};
+    DynamicArray<VkDeviceSize>     m_flushOffsets  = {};
+    DynamicArray<VkDeviceSize>     m_flushSizes    = {};
+};
+} // namespace dusk
\ No newline at end of file
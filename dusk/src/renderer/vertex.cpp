@@ -0,0 +1,46 @@
+#include "vertex.h"
+
+#include <glm/gtc/packing.hpp>
+
+namespace dusk
+{
+static glm::vec2 encodeOctahedral(const glm::vec3& direction)
+{
+    float     length  = glm::abs(direction.x) + glm::abs(direction.y) + glm::abs(direction.z);
+    glm::vec3 n       = length > 0.f ? direction / length : glm::vec3(0.f, 0.f, 1.f);
+    glm::vec2 encoded = glm::vec2(n.x, n.y);
+
+    // fold lower hemisphere over the diagonals
+    if (n.z < 0.f)
+    {
+        encoded.x = (1.f - glm::abs(n.y)) * (n.x >= 0.f ? 1.f : -1.f);
+        encoded.y = (1.f - glm::abs(n.x)) * (n.y >= 0.f ? 1.f : -1.f);
+    }
+
+    return encoded;
+}
+
+PackedVertex PackedVertex::pack(const Vertex& vertex, const glm::vec3& quantOffset, const glm::vec3& quantScale)
+{
+    PackedVertex packed;
+
+    glm::vec3    normalizedPosition = (vertex.position - quantOffset) / quantScale;
+    glm::vec2    normal             = encodeOctahedral(vertex.normal);
+    glm::vec2    tangent            = encodeOctahedral(vertex.tangent);
+
+    packed.position[0]              = glm::packUnorm1x16(normalizedPosition.x);
+    packed.position[1]              = glm::packUnorm1x16(normalizedPosition.y);
+    packed.position[2]              = glm::packUnorm1x16(normalizedPosition.z);
+
+    packed.normal[0]                = static_cast<int16_t>(glm::packSnorm1x16(normal.x));
+    packed.normal[1]                = static_cast<int16_t>(glm::packSnorm1x16(normal.y));
+
+    packed.tangent[0]               = static_cast<int16_t>(glm::packSnorm1x16(tangent.x));
+    packed.tangent[1]               = static_cast<int16_t>(glm::packSnorm1x16(tangent.y));
+
+    packed.uv[0]                    = glm::packHalf1x16(vertex.uv.x);
+    packed.uv[1]                    = glm::packHalf1x16(vertex.uv.y);
+
+    return packed;
+}
+} // namespace dusk
\ No newline at end of file
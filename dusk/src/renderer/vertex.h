@@ -54,4 +54,58 @@ struct Vertex
         return attributesInfo;
     }
 };
+
+// largest mesh which can be addressed with uint16 indices
+constexpr uint32_t MAX_PACKED_MESH_VERTICES = 65536u;
+
+/**
+ * @brief Compressed vertex. Position is quantized relative to the mesh bounds,
+ * normal and tangent are octahedral encoded and uv is stored as half floats.
+ */
+struct PackedVertex
+{
+    uint16_t position[4] = {}; // unorm xyz relative to mesh bounds, w is padding
+    int16_t  normal[2]   = {}; // snorm octahedral
+    int16_t  tangent[2]  = {}; // snorm octahedral
+    uint16_t uv[2]       = {}; // half float
+
+    /**
+     * @brief Check whether a mesh can be stored with packed vertices and uint16 indices
+     * @param vertexCount of the mesh
+     * @return true if mesh can be packed
+     */
+    static bool canPack(size_t vertexCount) { return vertexCount > 0 && vertexCount <= MAX_PACKED_MESH_VERTICES; }
+
+    /**
+     * @brief Compress a vertex
+     * @param vertex to compress
+     * @param quantOffset minimum corner of the mesh bounds
+     * @param quantScale extent of the mesh bounds
+     * @return packed vertex
+     */
+    static PackedVertex pack(const Vertex& vertex, const glm::vec3& quantOffset, const glm::vec3& quantScale);
+
+    /**
+     * @brief Get all vertex attributes location and offset
+     * @return Array containing vertex attributes info
+     */
+    static DynamicArray<VertexAttributeDescription> getVertexAttributesDescription()
+    {
+        DynamicArray<VertexAttributeDescription> attributesInfo;
+
+        // position
+        attributesInfo.push_back({ 0, offsetof(PackedVertex, position), VertexAttributeFormat ::X16Y16Z16W16_UNORM });
+
+        // normal
+        attributesInfo.push_back({ 1, offsetof(PackedVertex, normal), VertexAttributeFormat ::X16Y16_SNORM });
+
+        // tangent
+        attributesInfo.push_back({ 2, offsetof(PackedVertex, tangent), VertexAttributeFormat ::X16Y16_SNORM });
+
+        // uv
+        attributesInfo.push_back({ 3, offsetof(PackedVertex, uv), VertexAttributeFormat ::X16Y16_FLOAT });
+
+        return attributesInfo;
+    }
+};
 } // namespace dusk
\ No newline at end of file
@@ -52,6 +52,12 @@ struct CameraComponent
 
     bool      isPerspective           = false;
 
+    // projection offset by the sub-pixel jitter of temporal upscaling, the
+    // unjittered projection is kept for culling and motion vectors
+    glm::mat4 jitteredProjectionMatrix        = glm::mat4 { 1.0f };
+    glm::mat4 inverseJitteredProjectionMatrix = glm::mat4 { 1.0f };
+    glm::vec2 jitter                          = glm::vec2 { 0.0f }; // offset in ndc
+
     /**
      * @brief Set camera projection as orthographic
      * @param left plane of the projection volume
@@ -82,6 +88,8 @@ struct CameraComponent
         projectionMatrix[1][1] *= -1; // Flip Y
 
         inverseProjectionMatrix = glm::inverse(projectionMatrix);
+
+        updateJitteredProjection();
     };
 
     /**
@@ -105,6 +113,8 @@ struct CameraComponent
         projectionMatrix[1][1] *= -1; // Flip Y
 
         inverseProjectionMatrix = glm::inverse(projectionMatrix);
+
+        updateJitteredProjection();
     };
 
     void setAspectRatio(float aspect)
@@ -115,6 +125,39 @@ struct CameraComponent
         }
     }
 
+    /**
+     * @brief Set the sub-pixel offset applied to the jittered projection
+     * @param offset in normalized device coordinates
+     */
+    void setJitter(glm::vec2 offset)
+    {
+        jitter = offset;
+        updateJitteredProjection();
+    }
+
+    /**
+     * @brief Rebuild the jittered projection from the current projection and jitter
+     */
+    void updateJitteredProjection()
+    {
+        jitteredProjectionMatrix = projectionMatrix;
+
+        // offset is applied after the perspective divide, so it's scaled by w
+        // which is -z for perspective and 1 for orthographic projections
+        if (isPerspective)
+        {
+            jitteredProjectionMatrix[2][0] -= jitter.x;
+            jitteredProjectionMatrix[2][1] -= jitter.y;
+        }
+        else
+        {
+            jitteredProjectionMatrix[3][0] += jitter.x;
+            jitteredProjectionMatrix[3][1] += jitter.y;
+        }
+
+        inverseJitteredProjectionMatrix = glm::inverse(jitteredProjectionMatrix);
+    }
+
     /**
      * @brief Set view as per camera's position and rotation
      * @param position position of the camera
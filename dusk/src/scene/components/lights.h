@@ -9,15 +9,20 @@ struct AmbientLightComponent
     glm::vec4 color = glm::vec4 { 1.0f }; // w component for intensity
 };
 
+// shadow cascades of a directional light, rendered as layers of a single depth array
+inline constexpr uint32_t DIR_SHADOW_CASCADES_COUNT     = 4;
+inline constexpr uint32_t DIR_SHADOW_CASCADES_VIEW_MASK = (1u << DIR_SHADOW_CASCADES_COUNT) - 1u;
+
 struct alignas(16) DirectionalLightComponent
 {
     int32_t   id = -1;
     int32_t   pad0;
     int32_t   pad1;
     int32_t   pad2;
-    glm::mat4 projView  = { 1.0f };
-    glm::vec4 color     = glm::vec4 { 1.0f }; // w component for intensity
-    glm::vec3 direction = glm::vec3 { 0.f };
+    glm::mat4 cascadeProjViews[DIR_SHADOW_CASCADES_COUNT] = {};
+    glm::vec4 cascadeSplits                               = glm::vec4 { 0.f };  // view depth where each cascade ends
+    glm::vec4 color                                       = glm::vec4 { 1.0f }; // w component for intensity
+    glm::vec3 direction                                   = glm::vec3 { 0.f };
 };
 
 struct alignas(16) PointLightComponent
@@ -32,6 +37,7 @@ struct alignas(16) PointLightComponent
     glm::mat4 projView                   = { 1.0f };
     glm::vec4 color                      = glm::vec4 { 1.0f }; // w component for intensity
     glm::vec3 position                   = glm::vec4 { 0.f };
+    int32_t   shadowViewIdx              = -1;                 // first of the six cube face views in the shadow atlas
 };
 
 struct alignas(16) SpotLightComponent
@@ -49,5 +55,6 @@ struct alignas(16) SpotLightComponent
     float     innerCutOff                = 0.f;                // cosine of angle
     glm::vec3 direction                  = glm::vec4 { 0.f };  // direction where light is being pointed
     float     outerCutOff                = 0.f;                // cosine of angle
+    int32_t   shadowViewIdx              = -1;                 // view in the shadow atlas
 };
 } // namespace dusk
\ No newline at end of file
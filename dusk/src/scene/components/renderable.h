@@ -7,9 +7,14 @@ namespace dusk
 {
 struct RenderableComponent
 {
-    DynamicArray<uint32_t> meshes     = {};
-    DynamicArray<uint32_t> materials  = {};
-    AABB                   objectAABB = {};
-    AABB                   worldAABB  = {};
+    DynamicArray<uint32_t> meshes             = {};
+    DynamicArray<uint32_t> materials          = {};
+    AABB                   objectAABB         = {};
+    AABB                   worldAABB          = {};
+    bool                   isStatic           = false; // depth is cached by local light shadows, moving it invalidates the cache
+
+    // world matrix of the previously rendered frame for motion vectors
+    glm::mat4              prevWorldMatrix    = glm::mat4 { 1.f };
+    bool                   hasPrevWorldMatrix = false;
 };
 } // namespace dusk
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "events/event.h"
 
 #include "loaders/assimp_loader.h"
+#include "loaders/dscene_loader.h"
 
 #include "components/camera.h"
 #include "components/renderable.h"
@@ -14,6 +15,8 @@
 
 #include "backend/vulkan/vk_renderer.h"
 
+#include <glm/gtc/matrix_transform.hpp>
+
 namespace dusk
 {
 Scene::Scene(const std::string_view name) :
@@ -50,6 +53,12 @@ Scene::~Scene()
 
     freeMaterials();
 
+    // geometry is released by Engine::unloadScene, engine may already be gone here
+    if (m_geometryAllocation.vertexCount > 0 || m_packedGeometryAllocation.vertexCount > 0)
+    {
+        DUSK_WARN("Scene {} is destroyed without unloading its geometry", m_name);
+    }
+
     Registry::getRegistry().clear();
 }
 
@@ -63,6 +72,8 @@ void Scene::onUpdate(TimeStep dt)
     DUSK_PROFILE_FUNCTION;
     m_cameraController->onUpdate(dt);
 
+    m_movedStaticBounds.clear();
+
     // TODO:: this can be optimized further by maintaining a list of dirty transforms
     // update world AABBs for all mesh components whose transforms are dirty
     Registry::getRegistry().view<RenderableComponent>().each(
@@ -73,8 +84,19 @@ void Scene::onUpdate(TimeStep dt)
                 return;
             }
 
+            // both old and new bounds of static geometry have stale cached shadows
+            if (meshData.isStatic)
+            {
+                m_movedStaticBounds.push_back(meshData.worldAABB);
+            }
+
             glm::mat4 worldMatrix = TransformSystem::getWorldMatrix(entity);
             meshData.worldAABB    = recomputeAABB(meshData.objectAABB, worldMatrix);
+
+            if (meshData.isStatic)
+            {
+                m_movedStaticBounds.push_back(meshData.worldAABB);
+            }
         });
 }
 
@@ -128,19 +150,70 @@ Unique<Scene> Scene::createSceneFromGLTF(const std::string& fileName)
 {
     DUSK_PROFILE_FUNCTION;
 
+    std::filesystem::path sourcePath = fileName;
+
+    if (sourcePath.extension() == DSCENE_EXTENSION)
+    {
+        DSceneLoader cookedLoader {};
+        return cookedLoader.readScene(sourcePath);
+    }
+
+    // prefer the cooked scene, assimp import is only needed when source changes
+    std::filesystem::path cookedPath = DSceneLoader::getCookedPath(sourcePath);
+    if (DSceneLoader::isCookedSceneFresh(cookedPath, sourcePath))
+    {
+        DSceneLoader cookedLoader {};
+        auto         scene = cookedLoader.readScene(cookedPath);
+
+        if (scene) return scene;
+
+        DUSK_WARN("Unable to load cooked scene {}, importing source scene", cookedPath.generic_string());
+    }
+
     AssimpLoader loader {};
-    return loader.readScene(fileName);
+    return loader.readScene(sourcePath, cookedPath);
 }
 
 void Scene::addMaterial(Material& mat)
 {
     mat.id = m_materials.size();
     m_materials.push_back(std::move(mat));
+
+    markMaterialDirty(m_materials.back().id);
 }
 
 void Scene::freeMaterials()
 {
     m_materials.clear();
+    clearDirtyMaterials();
+}
+
+void Scene::markMaterialDirty(uint32_t matId)
+{
+    DASSERT(matId < m_materials.size(), "material id is out of bounds");
+
+    if (m_dirtyMaterialsSet.has(matId)) return;
+
+    m_dirtyMaterialsSet.emplace(matId);
+    m_dirtyMaterials.push_back(matId);
+}
+
+void Scene::markAllMaterialsDirty()
+{
+    clearDirtyMaterials();
+
+    m_dirtyMaterials.reserve(m_materials.size());
+    for (uint32_t matId = 0u; matId < m_materials.size(); ++matId)
+    {
+        m_dirtyMaterialsSet.emplace(matId);
+        m_dirtyMaterials.push_back(matId);
+    }
+}
+
+void Scene::clearDirtyMaterials()
+{
+    m_dirtyMaterialsSet.clear();
+    m_dirtyMaterials.clear();
 }
 
 void Scene::gatherRenderables(GfxRenderables* currentFrameRenderables)
@@ -149,12 +222,30 @@ void Scene::gatherRenderables(GfxRenderables* currentFrameRenderables)
     Registry::getRegistry().view<RenderableComponent>().each(
         [&](auto entity, auto& renderableData)
         {
-            glm::vec3 center  = (renderableData.worldAABB.min + renderableData.worldAABB.max) * 0.5f;
-            glm::vec3 extents = (renderableData.worldAABB.max - renderableData.worldAABB.min) * 0.5f;
+            glm::mat4 worldMatrix     = TransformSystem::getWorldMatrix(entity);
+            glm::vec3 center          = (renderableData.worldAABB.min + renderableData.worldAABB.max) * 0.5f;
+            glm::vec3 extents         = (renderableData.worldAABB.max - renderableData.worldAABB.min) * 0.5f;
+
+            // newly added renderables have no motion in their first frame
+            glm::mat4 prevWorldMatrix = renderableData.hasPrevWorldMatrix ? renderableData.prevWorldMatrix : worldMatrix;
 
             for (uint32_t index = 0u; index < renderableData.meshes.size(); ++index)
             {
-                currentFrameRenderables->modelMatrices.push_back(TransformSystem::getWorldMatrix(entity));
+                const GfxMeshData& meshData = m_sceneMeshes[renderableData.meshes[index]];
+
+                // packed positions are dequantized by the model matrix
+                if (meshData.vertexFormat == VertexFormat::Packed)
+                {
+                    glm::mat4 dequantize = glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(meshData.quantOffset)), glm::vec3(meshData.quantScale));
+                    currentFrameRenderables->modelMatrices.push_back(worldMatrix * dequantize);
+                    currentFrameRenderables->prevModelMatrices.push_back(prevWorldMatrix * dequantize);
+                }
+                else
+                {
+                    currentFrameRenderables->modelMatrices.push_back(worldMatrix);
+                    currentFrameRenderables->prevModelMatrices.push_back(prevWorldMatrix);
+                }
+
                 currentFrameRenderables->normalMatrices.push_back(TransformSystem::getNormalMatrix(entity));
                 currentFrameRenderables->boundingBoxes.push_back(
                     GfxBoundingBoxData {
@@ -162,7 +253,11 @@ void Scene::gatherRenderables(GfxRenderables* currentFrameRenderables)
                         .extents = glm::vec4(extents, 0.f) });
                 currentFrameRenderables->meshIds.push_back(renderableData.meshes[index]);
                 currentFrameRenderables->materialIds.push_back(renderableData.materials[index]);
+                currentFrameRenderables->staticFlags.push_back(renderableData.isStatic ? 1u : 0u);
             }
+
+            renderableData.prevWorldMatrix    = worldMatrix;
+            renderableData.hasPrevWorldMatrix = true;
         });
 }
 
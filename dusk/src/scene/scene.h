@@ -7,6 +7,7 @@
 #include "renderer/texture.h"
 #include "renderer/material.h"
 #include "renderer/gfx_types.h"
+#include "renderer/geometry/aabb.h"
 
 #include <string>
 
@@ -103,7 +104,38 @@ public:
     void                    gatherRenderables(GfxRenderables* currentFrameRenderables);
 
     /**
-     * @brief Create a scene from a gltf file
+     * @brief Get world bounds of static renderables moved in the current update,
+     * both before and after the move
+     * @return array of world space bounds
+     */
+    const DynamicArray<AABB>& getMovedStaticBounds() const { return m_movedStaticBounds; }
+
+    /**
+     * @brief Mark material as modified so it is uploaded to the gpu again
+     * @param matId id of the material
+     */
+    void markMaterialDirty(uint32_t matId);
+
+    /**
+     * @brief Mark all the materials as modified, required when the scene is
+     * (re)loaded in the engine
+     */
+    void markAllMaterialsDirty();
+
+    /**
+     * @brief Get ids of the materials modified since the last upload
+     * @return array of unique material ids in the order they were marked
+     */
+    const DynamicArray<uint32_t>& getDirtyMaterials() const { return m_dirtyMaterials; }
+
+    /**
+     * @brief Clear dirty materials after they have been uploaded
+     */
+    void clearDirtyMaterials();
+
+    /**
+     * @brief Create a scene from a gltf file. Cooked scene next to the file is
+     * used when it is up to date, otherwise it is written after the import.
      * @param fileName
      * @return unique pointer to the scene object
      */
@@ -120,9 +152,17 @@ private:
     Unique<CameraController> m_cameraController;
 
     DynamicArray<Material>   m_materials;
+    HashSet<uint32_t>        m_dirtyMaterialsSet {};
+    DynamicArray<uint32_t>   m_dirtyMaterials {};
+
+    DynamicArray<AABB>       m_movedStaticBounds {};
 
 public:
     // TODO:: figure out a good system to manage scene meshes
-    DynamicArray<GfxMeshData> m_sceneMeshes = {};
+    DynamicArray<GfxMeshData> m_sceneMeshes              = {};
+
+    // ranges of global geometry buffers owned by scene meshes
+    GfxGeometryAllocation     m_geometryAllocation       = {};
+    GfxGeometryAllocation     m_packedGeometryAllocation = { .format = VertexFormat::Packed };
 };
 } // namespace dusk
@@ -3,6 +3,7 @@
 #include "dusk.h"
 #include "engine.h"
 #include "ui_states.h"
+#include "backend/vulkan/vk_renderer.h"
 
 #include <imgui.h>
 
@@ -16,6 +17,34 @@ inline void drawRendererWidget()
 
     ImGui::Checkbox("Skybox", &rendererState.useSkybox);
 
+    if (ImGui::CollapsingHeader("Frame Pacing"))
+    {
+        Engine&         engine         = Engine::get();
+        VulkanRenderer& renderer       = engine.getRenderer();
+
+        int             framesInFlight = static_cast<int>(renderer.getFramesInFlight());
+        if (ImGui::SliderInt("Frames In Flight", &framesInFlight, 1, MAX_FRAMES_IN_FLIGHT))
+        {
+            renderer.setFramesInFlight(static_cast<uint32_t>(framesInFlight));
+        }
+
+        bool lowLatency = renderer.isLowLatencyMode();
+        if (ImGui::Checkbox("Low Latency", &lowLatency))
+        {
+            renderer.setLowLatencyMode(lowLatency);
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled(renderer.getSwapChain().supportsPresentWait() ? "(present wait)" : "(fence wait)");
+
+        // limiter is edited as frame rate, zero disables it
+        float targetFrameTime = engine.getTargetFrameTime().count();
+        float targetFps       = targetFrameTime > 0.f ? 1.f / targetFrameTime : 0.f;
+        if (ImGui::DragFloat("Frame Limit (fps)", &targetFps, 1.f, 0.f, 1000.f, "%.0f"))
+        {
+            engine.setTargetFrameTime(TimeStep(targetFps > 0.f ? 1.f / targetFps : 0.f));
+        }
+    }
+
     ImGui::End();
 }
 } // namespace dusk
\ No newline at end of file
@@ -123,16 +123,19 @@ inline void drawSceneGraphWidget(Scene& scene)
 
             ImGui::SeparatorText("Material");
 
-            Material& mat = scene.getMaterial(mesh.materials[sceneState.selectedMeshId]);
+            Material& mat     = scene.getMaterial(mesh.materials[sceneState.selectedMeshId]);
+            bool      changed = false;
             ImGui::Text("Mesh id: %d", mesh.materials[sceneState.selectedMeshId]);
-            ImGui::ColorEdit4("Albedo Color", (float*)&mat.albedoColor);
+            if (ImGui::ColorEdit4("Albedo Color", (float*)&mat.albedoColor)) changed = true;
             ImGui::Text("Albedo Texture id: %d", mat.albedoTexId);
             ImGui::Text("Normal Texture id: %d", mat.normalTexId);
             ImGui::Text("Emissive Texture id: %d", mat.emissiveTexId);
             ImGui::Text("Metal-Rough Texture id: %d", mat.metallicRoughnessTexId);
 
-            ImGui::SliderFloat("Roughness", &mat.rough, 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_None);
-            ImGui::SliderFloat("Metallic", &mat.metal, 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_None);
+            if (ImGui::SliderFloat("Roughness", &mat.rough, 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_None)) changed = true;
+            if (ImGui::SliderFloat("Metallic", &mat.metal, 0.0f, 1.0f, "%.3f", ImGuiSliderFlags_None)) changed = true;
+
+            if (changed) scene.markMaterialDirty(mat.id);
         }
 
         if (selectedGameObject.hasComponent<CameraComponent>())
@@ -567,8 +567,8 @@ void IBLGenerator::setupHDRToCubeMapPipeline(
 
     m_hdrToCubeMapPipelineLayout = VkGfxPipelineLayout::Builder(vkCtx)
                                        .addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(CubeMapPushConstant))
-                                       .addDescriptorSetLayout(TextureDB::cache()->getTexturesDescriptorSetLayout().layout)
-                                       .addDescriptorSetLayout(m_cubeProjViewDescLayout->layout)
+                                       .addDescriptorSetLayout(TextureDB::cache()->getTexturesDescriptorSetLayout())
+                                       .addDescriptorSetLayout(*m_cubeProjViewDescLayout)
                                        .build();
 
     m_hdrToCubeMapPipeline = VkGfxRenderPipeline::Builder(vkCtx)
@@ -597,8 +597,8 @@ void IBLGenerator::setupIrradiancePipeline(
 
     m_irradiancePipelineLayout = VkGfxPipelineLayout::Builder(vkCtx)
                                      .addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(IBLPushConstant))
-                                     .addDescriptorSetLayout(TextureDB::cache()->getTexturesDescriptorSetLayout().layout)
-                                     .addDescriptorSetLayout(m_cubeProjViewDescLayout->layout)
+                                     .addDescriptorSetLayout(TextureDB::cache()->getTexturesDescriptorSetLayout())
+                                     .addDescriptorSetLayout(*m_cubeProjViewDescLayout)
                                      .build();
 
     m_irradiancePipeline = VkGfxRenderPipeline::Builder(vkCtx)
@@ -634,8 +634,8 @@ void IBLGenerator::setupPrefilteredPipeline(
 
     m_prefilteredPipelineLayout = VkGfxPipelineLayout::Builder(vkCtx)
                                       .addPushConstantRange(VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(IBLPushConstant))
-                                      .addDescriptorSetLayout(TextureDB::cache()->getTexturesDescriptorSetLayout().layout)
-                                      .addDescriptorSetLayout(m_cubeProjViewDescLayout->layout)
+                                      .addDescriptorSetLayout(TextureDB::cache()->getTexturesDescriptorSetLayout())
+                                      .addDescriptorSetLayout(*m_cubeProjViewDescLayout)
                                       .build();
 
     m_prefilteredPipeline = VkGfxRenderPipeline::Builder(vkCtx)
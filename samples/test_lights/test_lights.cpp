@@ -71,6 +71,9 @@ bool TestLights::start()
 
 void TestLights::shutdown()
 {
+    if (m_testScene)
+        Engine::get().unloadScene(m_testScene.get());
+
     m_testScene = nullptr;
 }
 
@@ -49,6 +49,9 @@ bool TestPBR::start()
 
 void TestPBR::shutdown()
 {
+    if (m_testPBR)
+        Engine::get().unloadScene(m_testPBR.get());
+
     m_testPBR = nullptr;
 }
 
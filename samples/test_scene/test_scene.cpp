@@ -56,6 +56,9 @@ bool TestScene::start()
 
 void TestScene::shutdown()
 {
+    if (m_testScene)
+        Engine::get().unloadScene(m_testScene.get());
+
     m_testScene = nullptr;
 }
 
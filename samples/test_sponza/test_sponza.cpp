@@ -52,6 +52,9 @@ bool TestSponza::start()
 
 void TestSponza::shutdown()
 {
+    if (m_testSponza)
+        Engine::get().unloadScene(m_testSponza.get());
+
     m_testSponza = nullptr;
 }
 